@@ -0,0 +1,752 @@
+#include <benchmark/benchmark.h>
+#include <lnkfilearchivereader.hpp>
+#include <lnkfileasyncreader.hpp>
+#include <lnkfilecache.hpp>
+#include <lnkfilecarver.hpp>
+#include <lnkfileinfo.hpp>
+#include <lnkfileinfobatch.hpp>
+#include <lnkfilerecord.hpp>
+#include <lnkfilescanner.hpp>
+#include <lnkfileserializer.hpp>
+#include <lnkfiletargetchecker.hpp>
+#include <lnkfilewatcher.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * Number of calls to the global operator new since the program started, used to report the number of allocations per parse.
+ */
+static std::atomic<size_t> allocationCount{0};
+
+/**
+ * Allocates memory for all forms of the global operator new and counts the allocation. Returns a null pointer if the allocation fails.
+ */
+static void* countedAllocate(size_t size, size_t alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__) noexcept {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    size = size != 0 ? size : 1;
+    if(alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__){
+        return std::malloc(size);
+    }
+    //The size given to aligned_alloc must be a multiple of the alignment
+    size = (size + alignment - 1) / alignment * alignment;
+    #ifdef _WIN32
+        return _aligned_malloc(size, alignment);
+    #else
+        return std::aligned_alloc(alignment, size);
+    #endif
+}
+
+/**
+ * Frees memory that was allocated by `countedAllocate()` with the same alignment.
+ */
+static void countedFree(void* pointer, size_t alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__) noexcept {
+    #ifdef _WIN32
+        if(alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__){
+            _aligned_free(pointer);
+            return;
+        }
+    #else
+        (void)alignment;
+    #endif
+    std::free(pointer);
+}
+
+/**
+ * Same as `countedAllocate()`, but throws `std::bad_alloc` if the allocation fails.
+ */
+static void* countedAllocateOrThrow(size_t size, size_t alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__){
+    if(void* result = countedAllocate(size, alignment)){
+        return result;
+    }
+    throw std::bad_alloc();
+}
+
+//All replaceable forms of operator new and operator delete are replaced so that every allocation is counted and every pointer is freed by the function matching the one that allocated it
+void* operator new(size_t size){
+    return countedAllocateOrThrow(size);
+}
+
+void* operator new[](size_t size){
+    return countedAllocateOrThrow(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment){
+    return countedAllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment){
+    return countedAllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocate(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* pointer) noexcept {
+    countedFree(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    countedFree(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    countedFree(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+    countedFree(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t alignment) noexcept {
+    countedFree(pointer, static_cast<size_t>(alignment));
+}
+
+void operator delete[](void* pointer, std::align_val_t alignment) noexcept {
+    countedFree(pointer, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* pointer, size_t, std::align_val_t alignment) noexcept {
+    countedFree(pointer, static_cast<size_t>(alignment));
+}
+
+void operator delete[](void* pointer, size_t, std::align_val_t alignment) noexcept {
+    countedFree(pointer, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    countedFree(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    countedFree(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    countedFree(pointer, static_cast<size_t>(alignment));
+}
+
+void operator delete[](void* pointer, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    countedFree(pointer, static_cast<size_t>(alignment));
+}
+
+/**
+ * Measures the number of allocations in a benchmark loop and reports it as a counter.
+ */
+class AllocationCounter {
+public:
+    explicit AllocationCounter(benchmark::State& state): _state(state), _start(allocationCount.load(std::memory_order_relaxed)) {}
+
+    ~AllocationCounter(){
+        const double allocations = static_cast<double>(allocationCount.load(std::memory_order_relaxed) - this->_start);
+        this->_state.counters["allocs/parse"] = benchmark::Counter(allocations, benchmark::Counter::kAvgIterations);
+    }
+
+private:
+    benchmark::State& _state;
+    const size_t _start;
+};
+
+static const char* const testLnkFiles[] = {
+    "BasicLnkFile.lnk",
+    "UsbLnkFile.lnk",
+    "NetworkDriveLnkFile.lnk",
+    "EmojiLnkFile.lnk",
+    "ÅÄÖLnkFile.lnk",
+    "😊LnkFile.lnk"
+};
+
+static std::string testFilePath(int index){
+    return std::string(TEST_LNK_FILES_DIR "/") + testLnkFiles[index];
+}
+
+static std::vector<uint8_t> readFile(const std::string& filePath){
+    std::ifstream file(filePath, std::ios::binary);
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+/**
+ * Builds a minimal valid LNK file in memory whose description is the given UTF-16 string, pointing to the given target on a volume with serial number zero.
+ */
+static std::vector<uint8_t> makeLnkFile(const std::u16string& description, const std::string& targetPath = "C:\\Target.txt"){
+    std::vector<uint8_t> bytes(78, 0);
+    bytes[0] = 0x4C;
+    bytes[20] = 0x06;    //Has link info and description
+    const auto appendInteger = [&bytes](uint32_t value, int size){
+        for(int i = 0; i < size; i++){
+            bytes.push_back(static_cast<uint8_t>(value >> (i * 8)));
+        }
+    };
+    const uint32_t linkInfoSize = 28 + 17 + static_cast<uint32_t>(targetPath.size()) + 2;
+    for(const uint32_t value: {linkInfoSize, 0x1Cu, 0x01u, 28u, 28u + 17u, 0u, linkInfoSize - 1, 17u, 3u, 0u, 16u}){
+        appendInteger(value, 4);
+    }
+    bytes.push_back(0);
+    bytes.insert(bytes.end(), targetPath.begin(), targetPath.end());
+    bytes.push_back(0);
+    bytes.push_back(0);
+    appendInteger(static_cast<uint32_t>(description.size()), 2);
+    for(const char16_t codeUnit: description){
+        appendInteger(codeUnit, 2);
+    }
+    appendInteger(0, 4);
+    return bytes;
+}
+
+/**
+ * Re-reads and parses a test LNK file from the file system.
+ */
+static void BM_Refresh(benchmark::State& state){
+    const std::string filePath = testFilePath(static_cast<int>(state.range(0)));
+    const LnkFileInfo::ParseOptions options = static_cast<LnkFileInfo::ParseOptions>(state.range(1));
+    state.SetLabel(testLnkFiles[state.range(0)]);
+    LnkFileInfo lnk(filePath, options);
+    const AllocationCounter allocationCounter(state);
+    for(auto _: state){
+        lnk.refresh();
+        benchmark::DoNotOptimize(lnk.absoluteTargetPath().data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * std::filesystem::file_size(filePath)));
+}
+BENCHMARK(BM_Refresh)->ArgsProduct({{0, 1, 2, 3, 4, 5}, {LnkFileInfo::NoOptions, LnkFileInfo::MemoryMapped, LnkFileInfo::LazyStrings, LnkFileInfo::TargetOnly}});
+
+/**
+ * Polls a test LNK file that hasn't changed, which should only cost a single stat call.
+ */
+static void BM_RefreshIfChanged(benchmark::State& state){
+    LnkFileInfo lnk(testFilePath(0));
+    for(auto _: state){
+        benchmark::DoNotOptimize(lnk.refreshIfChanged());
+    }
+}
+BENCHMARK(BM_RefreshIfChanged);
+
+/**
+ * Reads and parses a test LNK file from the file system with a reused parser, which shouldn't allocate any memory after the first iteration.
+ */
+static void BM_LnkParser(benchmark::State& state){
+    const std::string filePath = testFilePath(static_cast<int>(state.range(0)));
+    const LnkFileInfo::ParseOptions options = static_cast<LnkFileInfo::ParseOptions>(state.range(1));
+    state.SetLabel(testLnkFiles[state.range(0)]);
+    LnkParser parser(options);
+    parser.open(filePath);
+    const AllocationCounter allocationCounter(state);
+    for(auto _: state){
+        benchmark::DoNotOptimize(parser.open(filePath).absoluteTargetPath().data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * std::filesystem::file_size(filePath)));
+}
+BENCHMARK(BM_LnkParser)->ArgsProduct({{0, 1, 2, 3, 4, 5}, {LnkFileInfo::NoOptions, LnkFileInfo::MemoryMapped, LnkFileInfo::LazyStrings}});
+
+/**
+ * Constructs an LnkFileInfo object from a relative path (0), from an absolute path (1) or from an absolute path with `LnkFileInfo::AbsolutePath` (2).
+ */
+static void BM_Open(benchmark::State& state){
+    const std::string absolutePath = std::filesystem::absolute(testFilePath(0)).string();
+    const std::string filePath = state.range(0) == 0 ? std::filesystem::relative(absolutePath).string() : absolutePath;
+    const LnkFileInfo::ParseOptions options = state.range(0) == 2 ? LnkFileInfo::AbsolutePath : LnkFileInfo::NoOptions;
+    const AllocationCounter allocationCounter(state);
+    for(auto _: state){
+        const LnkFileInfo lnk(filePath, options);
+        benchmark::DoNotOptimize(lnk.absoluteFilePath().data());
+    }
+}
+BENCHMARK(BM_Open)->DenseRange(0, 2);
+
+/**
+ * Copies the test LNK files into an index of 1000 LnkFileInfo objects without (0) or with (1) interning their strings in a shared pool, and reports the number of heap allocations per copy.
+ */
+static void BM_InternStrings(benchmark::State& state){
+    std::vector<LnkFileInfo> parsed;
+    for(int i = 0; i < static_cast<int>(std::size(testLnkFiles)); i++){
+        parsed.emplace_back(testFilePath(i));
+    }
+    if(state.range(0) == 1){
+        const std::shared_ptr<LnkFileInfo::StringPool> pool = std::make_shared<LnkFileInfo::StringPool>();
+        for(LnkFileInfo& lnk: parsed){
+            lnk.internStrings(pool);
+        }
+    }
+    std::vector<LnkFileInfo> index;
+    index.reserve(1000);
+    size_t allocations = 0;
+    for(auto _: state){
+        index.clear();
+        const size_t start = allocationCount.load(std::memory_order_relaxed);
+        for(size_t i = 0; i < 1000; i++){
+            index.push_back(parsed[i % parsed.size()]);
+        }
+        allocations += allocationCount.load(std::memory_order_relaxed) - start;
+    }
+    state.counters["allocs/file"] = static_cast<double>(allocations) / static_cast<double>(state.iterations() * 1000);
+    state.SetLabel(state.range(0) == 0 ? "own strings" : "interned strings");
+}
+BENCHMARK(BM_InternStrings)->Arg(0)->Arg(1);
+
+/**
+ * Looks up LnkFileInfo objects with long paths that only differ at the end in an `std::unordered_set`.
+ */
+static void BM_HashSetLookup(benchmark::State& state){
+    const std::vector<uint8_t> bytes = readFile(testFilePath(0));
+    std::unordered_set<LnkFileInfo> set;
+    std::vector<LnkFileInfo> lookups;
+    for(int i = 0; i < 1000; i++){
+        const std::string filePath = "/home/user/Documents/Projects/Archive/2025/Shortcuts/Very/Deeply/Nested/Directory/Shortcut" + std::to_string(i) + ".lnk";
+        set.emplace(bytes, filePath);
+        lookups.emplace_back(bytes, filePath);
+        lookups.emplace_back(bytes, filePath + ".missing");
+    }
+    size_t index = 0;
+    for(auto _: state){
+        benchmark::DoNotOptimize(set.count(lookups[index]));
+        index = (index + 1) % lookups.size();
+    }
+}
+BENCHMARK(BM_HashSetLookup);
+
+/**
+ * Parses a test LNK file that has already been loaded into memory.
+ */
+static void BM_ParseFromBytes(benchmark::State& state){
+    const std::vector<uint8_t> bytes = readFile(testFilePath(static_cast<int>(state.range(0))));
+    state.SetLabel(testLnkFiles[state.range(0)]);
+    const AllocationCounter allocationCounter(state);
+    for(auto _: state){
+        LnkFileInfo::ErrorCode error;
+        const std::optional<LnkFileInfo> lnk = LnkFileInfo::tryParse(bytes.data(), bytes.size(), error);
+        benchmark::DoNotOptimize(lnk->absoluteTargetPath().data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes.size()));
+}
+BENCHMARK(BM_ParseFromBytes)->DenseRange(0, 5);
+
+/**
+ * Parses a test LNK file with a reused parser that also decodes the ID list and the extra data blocks, to compare with the cost of only parsing the default sections.
+ */
+static void BM_ParseAllSections(benchmark::State& state){
+    const std::vector<uint8_t> bytes = readFile(testFilePath(static_cast<int>(state.range(0))));
+    state.SetLabel(testLnkFiles[state.range(0)]);
+    LnkParser parser(LnkFileInfo::IdList | LnkFileInfo::ExtraData);
+    const AllocationCounter allocationCounter(state);
+    for(auto _: state){
+        LnkFileInfo::ErrorCode error;
+        const LnkFileInfo* lnk = parser.tryParse(bytes.data(), bytes.size(), error);
+        benchmark::DoNotOptimize(lnk->trackerObjectId().bytes);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes.size()));
+}
+BENCHMARK(BM_ParseAllSections)->DenseRange(0, 5);
+
+/**
+ * Parses a test LNK file with a reused parser and a filter, to compare the cost of rejecting LNK files early with the cost of parsing them completely. The argument selects the filter: none, one that matches, one that rejects the LNK file by its attributes and one that rejects it by its target path.
+ */
+static void BM_ParseWithFilter(benchmark::State& state){
+    static const char* const labels[] = {"No filter", "Matching", "Rejected by attributes", "Rejected by target path"};
+    const std::vector<uint8_t> bytes = readFile(testFilePath(3));
+    state.SetLabel(labels[state.range(0)]);
+    LnkFileInfo::Filter filter;
+    switch(state.range(0)){
+    case 1:
+        filter.requiredAttributes = LnkFileInfo::Archive;
+        filter.targetPathPattern = "*.txt";
+        break;
+    case 2:
+        filter.requiredAttributes = LnkFileInfo::Directory;
+        break;
+    case 3:
+        filter.targetPathPattern = "*.ps1";
+        break;
+    }
+    LnkParser parser;
+    const AllocationCounter allocationCounter(state);
+    for(auto _: state){
+        LnkFileInfo::ErrorCode error;
+        benchmark::DoNotOptimize(state.range(0) == 0 ? parser.tryParse(bytes.data(), bytes.size(), error) : parser.tryParse(bytes.data(), bytes.size(), error, "", filter));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes.size()));
+}
+BENCHMARK(BM_ParseWithFilter)->DenseRange(0, 3);
+
+/**
+ * Parses a test LNK file with all sections, either from bytes or from a content cache that already contains an LNK file with the same contents, to compare the cost of a cache hit with the cost of parsing. The second argument is 1 if the cache is used.
+ */
+static void BM_ParseWithContentCache(benchmark::State& state){
+    const std::vector<uint8_t> bytes = readFile(testFilePath(static_cast<int>(state.range(0))));
+    const bool useCache = state.range(1);
+    state.SetLabel(std::string(testLnkFiles[state.range(0)]) + (useCache ? " (cached)" : ""));
+    constexpr LnkFileInfo::ParseOptions options = LnkFileInfo::IdList | LnkFileInfo::ExtraData;
+    LnkFileInfo::ContentCache cache;
+    LnkFileInfo::ErrorCode error;
+    cache.tryParse(bytes.data(), bytes.size(), error, "", options);
+    const AllocationCounter allocationCounter(state);
+    for(auto _: state){
+        const std::optional<LnkFileInfo> lnk = useCache ? cache.tryParse(bytes.data(), bytes.size(), error, "", options) : LnkFileInfo::tryParse(bytes.data(), bytes.size(), error, "", options);
+        benchmark::DoNotOptimize(lnk->trackerObjectId().bytes);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes.size()));
+}
+BENCHMARK(BM_ParseWithContentCache)->ArgsProduct({{0, 1, 2, 3, 4, 5}, {0, 1}});
+
+/**
+ * Decodes a long UTF-16 description, to measure UTF-16 to UTF-8 conversion on its own. The argument selects the kind of characters in the description.
+ */
+static void BM_Utf16Conversion(benchmark::State& state){
+    static const char16_t* const samples[] = {u"ASCII text", u"Åäö Latin1", u"中文字符", u"😊😂🤣"};
+    static const char* const labels[] = {"ASCII", "Latin1", "CJK", "Surrogate pairs"};
+    std::u16string description;
+    while(description.size() < 30000){
+        description += samples[state.range(0)];
+    }
+    const std::vector<uint8_t> bytes = makeLnkFile(description);
+    state.SetLabel(labels[state.range(0)]);
+    for(auto _: state){
+        const LnkFileInfo lnk(bytes);
+        benchmark::DoNotOptimize(lnk.description().data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * description.size() * 2));
+}
+BENCHMARK(BM_Utf16Conversion)->DenseRange(0, 3);
+
+/**
+ * Checks whether a file is an LNK file without parsing it.
+ */
+static void BM_Probe(benchmark::State& state){
+    const std::string filePath = testFilePath(0);
+    for(auto _: state){
+        benchmark::DoNotOptimize(LnkFileInfo::probe(filePath));
+    }
+}
+BENCHMARK(BM_Probe);
+
+/**
+ * Gets the information about a test LNK file that hasn't changed from a cache file.
+ */
+static void BM_CacheHit(benchmark::State& state){
+    const std::string filePath = testFilePath(static_cast<int>(state.range(0)));
+    const std::string cacheFilePath = (std::filesystem::temp_directory_path() / "LnkFileInfoBenchmark.cache").string();
+    std::filesystem::remove(cacheFilePath);
+    {
+        LnkFileCache cache(cacheFilePath);
+        cache.open(filePath);
+        cache.save();
+    }
+    LnkFileCache cache(cacheFilePath);
+    state.SetLabel(testLnkFiles[state.range(0)]);
+    const AllocationCounter allocationCounter(state);
+    for(auto _: state){
+        benchmark::DoNotOptimize(cache.open(filePath).absoluteTargetPath().data());
+    }
+}
+BENCHMARK(BM_CacheHit)->DenseRange(0, 5);
+
+/**
+ * Encodes all test LNK files, with or without string interning depending on the argument.
+ */
+static void BM_Encode(benchmark::State& state){
+    std::vector<LnkFileInfo> lnkFiles;
+    for(int i = 0; i < static_cast<int>(std::size(testLnkFiles)); i++){
+        lnkFiles.emplace_back(testFilePath(i));
+    }
+    LnkFileEncoder encoder(state.range(0));
+    for(auto _: state){
+        encoder.clear();
+        for(const LnkFileInfo& lnk: lnkFiles){
+            encoder.add(lnk);
+        }
+        benchmark::DoNotOptimize(encoder.bytes().data());
+    }
+    state.counters["bytes/record"] = static_cast<double>(encoder.bytes().size()) / lnkFiles.size();
+    state.SetItemsProcessed(state.iterations() * lnkFiles.size());
+}
+BENCHMARK(BM_Encode)->Arg(0)->Arg(1);
+
+/**
+ * Decodes all test LNK files, with or without string interning depending on the argument.
+ */
+static void BM_Decode(benchmark::State& state){
+    LnkFileEncoder encoder(state.range(0));
+    for(int i = 0; i < static_cast<int>(std::size(testLnkFiles)); i++){
+        encoder.add(LnkFileInfo(testFilePath(i)));
+    }
+    const AllocationCounter allocationCounter(state);
+    for(auto _: state){
+        LnkFileDecoder decoder(encoder.bytes());
+        LnkFileDecoder::Record record;
+        while(decoder.next(record)){
+            benchmark::DoNotOptimize(record.absoluteTargetPath.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * encoder.recordCount());
+}
+BENCHMARK(BM_Decode)->Arg(0)->Arg(1);
+
+/**
+ * Counts the hidden targets on removable drives among many LNK files, stored either as a vector of LnkFileInfo objects or as a columnar batch depending on the argument.
+ */
+static void BM_Filter(benchmark::State& state){
+    std::vector<LnkFileInfo> lnkFiles;
+    LnkFileInfoBatch batch;
+    for(int i = 0; i < 100000; i++){
+        lnkFiles.emplace_back(testFilePath(i % std::size(testLnkFiles)));
+        batch.add(lnkFiles.back());
+    }
+    for(auto _: state){
+        size_t count = 0;
+        if(state.range(0) == 0){
+            for(const LnkFileInfo& lnk: lnkFiles){
+                count += lnk.targetHasAttribute(LnkFileInfo::Hidden) && lnk.targetVolumeType() == LnkFileInfo::Removable;
+            }
+        }
+        else{
+            const std::vector<uint16_t>& attributes = batch.targetAttributes();
+            const std::vector<LnkFileInfo::VolumeType>& volumeTypes = batch.targetVolumeTypes();
+            for(size_t i = 0; i < batch.size(); i++){
+                count += (attributes[i] & LnkFileInfo::Hidden) && volumeTypes[i] == LnkFileInfo::Removable;
+            }
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetLabel(state.range(0) == 0 ? "std::vector<LnkFileInfo>" : "LnkFileInfoBatch");
+    state.SetItemsProcessed(state.iterations() * lnkFiles.size());
+}
+BENCHMARK(BM_Filter)->Arg(0)->Arg(1);
+
+/**
+ * Sorts many LNK files by target volume serial number, stored either as a vector of LnkFileInfo objects or as a vector of LnkFileRecord objects depending on the argument.
+ */
+static void BM_SortByVolumeSerial(benchmark::State& state){
+    std::vector<LnkFileInfo> lnkFiles;
+    std::vector<LnkFileRecord> records;
+    LnkFileRecordStrings strings;
+    for(int i = 0; i < 100000; i++){
+        std::vector<uint8_t> bytes = makeLnkFile(u"Shortcut description", "C:\\Users\\User\\Documents\\Target" + std::to_string(i) + ".txt");
+        const uint32_t serial = static_cast<uint32_t>(i) * 2654435761u;
+        for(int j = 0; j < 4; j++){
+            bytes[114 + j] = static_cast<uint8_t>(serial >> (j * 8));    //The volume serial number in the link info
+        }
+        lnkFiles.emplace_back(bytes, "Shortcut" + std::to_string(i) + ".lnk");
+        records.push_back(strings.add(lnkFiles.back()));
+    }
+    for(auto _: state){
+        state.PauseTiming();
+        std::vector<LnkFileInfo> lnkFilesCopy = lnkFiles;
+        std::vector<LnkFileRecord> recordsCopy = records;
+        state.ResumeTiming();
+        if(state.range(0) == 0){
+            std::sort(lnkFilesCopy.begin(), lnkFilesCopy.end(), [](const LnkFileInfo& a, const LnkFileInfo& b){
+                return a.targetVolumeSerial() < b.targetVolumeSerial();
+            });
+        }
+        else{
+            std::sort(recordsCopy.begin(), recordsCopy.end(), [](const LnkFileRecord& a, const LnkFileRecord& b){
+                return a.targetVolumeSerial < b.targetVolumeSerial;
+            });
+        }
+        benchmark::DoNotOptimize(lnkFilesCopy.data());
+        benchmark::DoNotOptimize(recordsCopy.data());
+    }
+    state.SetLabel(state.range(0) == 0 ? "std::vector<LnkFileInfo>" : "std::vector<LnkFileRecord>");
+    state.SetItemsProcessed(state.iterations() * lnkFiles.size());
+}
+BENCHMARK(BM_SortByVolumeSerial)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+constexpr int syntheticDirectories = 20;
+constexpr int syntheticFilesPerDirectory = 100;
+
+/**
+ * Creates a directory tree containing copies of the test LNK files in the temporary directory if it doesn't already exist, and returns its path.
+ */
+static std::filesystem::path syntheticDirectoryTree(){
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "LnkFileInfoBenchmark";
+    if(!std::filesystem::exists(root / std::to_string(syntheticDirectories - 1) / (std::to_string(syntheticFilesPerDirectory - 1) + ".lnk"))){
+        std::filesystem::remove_all(root);
+        for(int i = 0; i < syntheticDirectories; i++){
+            std::filesystem::create_directories(root / std::to_string(i));
+            for(int j = 0; j < syntheticFilesPerDirectory; j++){
+                std::filesystem::copy_file(testFilePath(j % std::size(testLnkFiles)), root / std::to_string(i) / (std::to_string(j) + ".lnk"));
+            }
+        }
+    }
+    return root;
+}
+
+/**
+ * Returns the paths of all LNK files in the synthetic directory tree.
+ */
+static std::vector<std::string> syntheticFilePaths(){
+    const std::filesystem::path root = syntheticDirectoryTree();
+    std::vector<std::string> result;
+    for(int i = 0; i < syntheticDirectories; i++){
+        for(int j = 0; j < syntheticFilesPerDirectory; j++){
+            result.push_back((root / std::to_string(i) / (std::to_string(j) + ".lnk")).string());
+        }
+    }
+    return result;
+}
+
+/**
+ * Scans a synthetic directory tree containing many copies of the test LNK files. The argument is the number of threads.
+ */
+static void BM_ScanDirectory(benchmark::State& state){
+    const std::filesystem::path root = syntheticDirectoryTree();
+    LnkFileScanner::Options options;
+    options.threads = static_cast<unsigned int>(state.range(0));
+    for(auto _: state){
+        size_t parsed = 0;
+        LnkFileScanner::scanDirectory(root.string(), options, [&parsed](LnkFileScanner::Result&& result){
+            parsed += result.lnkFileInfo.has_value();
+        });
+        benchmark::DoNotOptimize(parsed);
+    }
+    state.SetItemsProcessed(state.iterations() * syntheticDirectories * syntheticFilesPerDirectory);
+}
+BENCHMARK(BM_ScanDirectory)->Arg(1)->Arg(4)->Arg(0)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+/**
+ * Reads the files in the synthetic directory tree with LnkFileAsyncReader. The argument is the maximum number of reads in flight.
+ */
+static void BM_AsyncReader(benchmark::State& state){
+    const std::vector<std::string> filePaths = syntheticFilePaths();
+    state.SetLabel(LnkFileAsyncReader::usesIoUring() ? "io_uring" : "threads");
+    LnkFileAsyncReader::Options options;
+    options.maxInFlight = static_cast<unsigned int>(state.range(0));
+    for(auto _: state){
+        size_t parsed = 0;
+        LnkFileAsyncReader::readFiles(filePaths, options, [&parsed](LnkFileAsyncReader::Result&& result){
+            parsed += result.lnkFileInfo.has_value();
+        });
+        benchmark::DoNotOptimize(parsed);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * filePaths.size()));
+}
+BENCHMARK(BM_AsyncReader)->Arg(1)->Arg(16)->Arg(64)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+/**
+ * Reads the files in the synthetic directory tree one after the other, for comparison with BM_AsyncReader.
+ */
+static void BM_SequentialReader(benchmark::State& state){
+    const std::vector<std::string> filePaths = syntheticFilePaths();
+    for(auto _: state){
+        size_t parsed = 0;
+        for(const std::string &filePath: filePaths){
+            LnkFileInfo::ErrorCode error;
+            parsed += LnkFileInfo::tryOpen(filePath, error).has_value();
+        }
+        benchmark::DoNotOptimize(parsed);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * filePaths.size()));
+}
+BENCHMARK(BM_SequentialReader)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+/**
+ * Keeps the index of a synthetic directory tree that doesn't change up to date, by rescanning it (0) or by checking for file system events without waiting (1).
+ */
+static void BM_Watcher(benchmark::State& state){
+    LnkFileWatcher watcher({syntheticDirectoryTree().string()});
+    for(auto _: state){
+        benchmark::DoNotOptimize(state.range(0) == 0 ? watcher.rescan() : watcher.waitForChanges(std::chrono::milliseconds(0)));
+    }
+    state.SetLabel(state.range(0) == 0 ? "rescan()" : "waitForChanges()");
+}
+BENCHMARK(BM_Watcher)->Arg(0)->Arg(1);
+
+/**
+ * Reads the LNK files in one of the test archives, which has already been loaded into memory. The argument selects the ZIP (0) or TAR (1) archive.
+ */
+static void BM_ReadArchive(benchmark::State& state){
+    static const char* const archives[] = {"LnkFiles.zip", "LnkFiles.tar"};
+    const std::vector<uint8_t> bytes = readFile(std::string(TEST_ARCHIVES_DIR "/") + archives[state.range(0)]);
+    state.SetLabel(archives[state.range(0)]);
+    LnkFileArchiveReader::MemorySource source(bytes.data(), bytes.size());
+    size_t files = 0;
+    for(auto _: state){
+        LnkFileArchiveReader::readArchive(source, LnkFileArchiveReader::Options(), [&files](LnkFileArchiveReader::Result&& result){
+            files += result.lnkFileInfo.has_value();
+        });
+    }
+    benchmark::DoNotOptimize(files);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes.size()));
+}
+BENCHMARK(BM_ReadArchive)->Arg(0)->Arg(1);
+
+static void BM_Carve(benchmark::State& state){
+    //Random bytes with each test file embedded once per mebibyte
+    std::vector<uint8_t> bytes(64 * 1024 * 1024);
+    uint32_t random = 12345;
+    for(uint8_t &byte: bytes){
+        random = random * 1103515245 + 12345;
+        byte = static_cast<uint8_t>(random >> 16);
+    }
+    for(size_t offset = 0; offset + 1024 * 1024 <= bytes.size(); offset += 1024 * 1024){
+        const std::vector<uint8_t> lnkFile = readFile(testFilePath((offset / (1024 * 1024)) % std::size(testLnkFiles)));
+        std::copy(lnkFile.begin(), lnkFile.end(), bytes.begin() + static_cast<std::ptrdiff_t>(offset));
+    }
+    size_t matches = 0;
+    for(auto _: state){
+        LnkFileCarver::carve(bytes.data(), bytes.size(), LnkFileCarver::Options(), [&matches](LnkFileCarver::Match&&){
+            matches++;
+        });
+    }
+    benchmark::DoNotOptimize(matches);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes.size()));
+}
+BENCHMARK(BM_Carve);
+
+/**
+ * Checks whether the targets of many LNK files exist, half of which point to files in the synthetic directory tree and half of which point to missing files. The argument is 0 to call `std::filesystem::exists` for each target one after the other, and 1 to use `LnkFileTargetChecker`.
+ */
+static void BM_CheckTargets(benchmark::State& state){
+    const std::filesystem::path root = syntheticDirectoryTree();
+    std::vector<LnkFileInfo> lnkFiles;
+    for(int i = 0; i < syntheticDirectories; i++){
+        for(int j = 0; j < syntheticFilesPerDirectory; j++){
+            lnkFiles.emplace_back(makeLnkFile(u"", "C:\\" + std::to_string(i) + "\\" + std::to_string(j) + ".lnk"));
+            lnkFiles.emplace_back(makeLnkFile(u"", "C:\\" + std::to_string(i) + "\\Missing" + std::to_string(j) + ".lnk"));
+        }
+    }
+    LnkFileTargetChecker::Options options;
+    options.volumeMountPoints[0] = root.string();
+    options.checkSize = false;
+    size_t missing = 0;
+    for(auto _: state){
+        if(state.range(0) == 0){
+            for(const LnkFileInfo& lnkFileInfo: lnkFiles){
+                std::string targetPath = root.string() + lnkFileInfo.absoluteTargetPath().substr(2);
+                std::replace(targetPath.begin(), targetPath.end(), '\\', '/');
+                missing += !std::filesystem::exists(targetPath);
+            }
+        }
+        else{
+            for(const LnkFileTargetChecker::Result& result: LnkFileTargetChecker::checkTargets(lnkFiles, options)){
+                missing += result.status == LnkFileTargetChecker::Missing;
+            }
+        }
+    }
+    benchmark::DoNotOptimize(missing);
+    state.SetLabel(state.range(0) == 0 ? "std::filesystem::exists" : "LnkFileTargetChecker");
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * lnkFiles.size()));
+}
+BENCHMARK(BM_CheckTargets)->Arg(0)->Arg(1)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,584 @@
+#include <lnkfileinfo.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+    #include <fcntl.h>
+    #include <io.h>
+#endif
+
+static const char usage[] =
+    "Usage: lnkinfo [OPTION]... PATH...\n"
+    "Parses LNK files and writes the information about them to the standard output, one record per LNK file.\n"
+    "Each PATH can be an LNK file, a directory to search for files with the .lnk extension, or - to read a list of\n"
+    "NUL-separated paths of LNK files from the standard input, for example from `find ... -print0`.\n"
+    "\n"
+    "  -f, --format FORMAT   ndjson (the default) for one JSON object per line, or csv\n"
+    "  -j, --threads N       the number of threads to parse LNK files on, the default is one per hardware thread\n"
+    "  -o, --ordered         write the records in the order the paths were given instead of as soon as they're parsed\n"
+    "      --no-recursive    don't search subdirectories of the given directories\n"
+    "      --target-only     only read the target and volume information\n"
+    "  -h, --help            show this help and exit\n"
+    "\n"
+    "The exit status is 0 if all LNK files were parsed, 1 if some of them couldn't be parsed and 2 if the arguments\n"
+    "are invalid.\n";
+
+/**
+ * The columns of the output, in the order they're written. Records of LNK files that couldn't be parsed only contain the path and the error.
+ */
+static const char* const columns[] = {
+    "path", "error", "targetPath", "targetVolumeName", "targetVolumeType", "targetVolumeSerial", "targetIsOnNetwork", "targetSize", "targetAttributes",
+    "targetCreationTime", "targetAccessTime", "targetWriteTime", "description", "relativeTargetPath", "workingDirectory", "commandLineArgs", "iconPath", "iconIndex"
+};
+
+/**
+ * Writes the records of parsed LNK files in one of the output formats. Each thread needs its own formatter.
+ */
+class RecordFormatter final {
+public:
+    enum Format {
+        Ndjson,
+        Csv
+    };
+
+    explicit RecordFormatter(Format format): _format(format) {}
+
+    /**
+     * Returns the line that is written before the first record, or an empty string if there is none.
+     */
+    std::string header() const {
+        std::string result;
+        if(this->_format == Format::Csv){
+            for(const char* column: columns){
+                result += result.empty() ? "" : ",";
+                result += column;
+            }
+            result += "\r\n";
+        }
+        return result;
+    }
+
+    /**
+     * Replaces the contents of `line` with the record of an LNK file, including the line break. `lnkFileInfo` is null if the LNK file couldn't be parsed.
+     */
+    void format(std::string &line, const std::string &filePath, const LnkFileInfo* lnkFileInfo, LnkFileInfo::ErrorCode error){
+        line.clear();
+        this->_column = 0;
+        this->beginRecord(line);
+        this->addString(line, filePath);
+        if(lnkFileInfo == nullptr){
+            this->addString(line, LnkFileInfo::errorMessage(error));
+            if(this->_format == Format::Csv){
+                line.append(std::size(columns) - 2, ',');
+            }
+        }
+        else{
+            this->addNull(line);
+            this->addString(line, lnkFileInfo->absoluteTargetPath());
+            this->addString(line, lnkFileInfo->targetVolumeName());
+            this->addString(line, volumeTypeName(lnkFileInfo->targetVolumeType()));
+            this->addNumber(line, static_cast<uint32_t>(lnkFileInfo->targetVolumeSerial()));
+            this->addBoolean(line, lnkFileInfo->targetIsOnNetwork());
+            this->addNumber(line, lnkFileInfo->targetSize());
+            this->addNumber(line, targetAttributes(*lnkFileInfo));
+            this->addNumber(line, lnkFileInfo->targetCreationTime());
+            this->addNumber(line, lnkFileInfo->targetAccessTime());
+            this->addNumber(line, lnkFileInfo->targetWriteTime());
+            this->addString(line, lnkFileInfo->description());
+            this->addString(line, lnkFileInfo->relativeTargetPath());
+            this->addString(line, lnkFileInfo->workingDirectory());
+            this->addString(line, lnkFileInfo->commandLineArgs());
+            this->addString(line, lnkFileInfo->iconPath());
+            this->addNumber(line, lnkFileInfo->iconIndex());
+        }
+        line += this->_format == Format::Ndjson ? "}\n" : "\r\n";
+    }
+
+private:
+    void beginRecord(std::string &line){
+        if(this->_format == Format::Ndjson){
+            line += '{';
+        }
+    }
+
+    /**
+     * Adds the separator and, in JSON, the name of the next column.
+     */
+    void beginValue(std::string &line){
+        const size_t column = this->_column++;
+        if(column != 0){
+            line += ',';
+        }
+        if(this->_format == Format::Ndjson){
+            line += '"';
+            line += columns[column];
+            line += "\":";
+        }
+    }
+
+    void addNull(std::string &line){
+        this->beginValue(line);
+        if(this->_format == Format::Ndjson){
+            line += "null";
+        }
+    }
+
+    void addBoolean(std::string &line, bool value){
+        this->beginValue(line);
+        line += value ? "true" : "false";
+    }
+
+    template<typename T>
+    void addNumber(std::string &line, T value){
+        this->beginValue(line);
+        line += std::to_string(value);
+    }
+
+    /**
+     * Adds a string, escaped as a JSON string or quoted as a CSV field if needed.
+     */
+    void addString(std::string &line, std::string_view value){
+        this->beginValue(line);
+        if(this->_format == Format::Ndjson){
+            line += '"';
+            for(const char c: value){
+                switch(c){
+                case '"':
+                    line += "\\\"";
+                    break;
+                case '\\':
+                    line += "\\\\";
+                    break;
+                case '\n':
+                    line += "\\n";
+                    break;
+                case '\r':
+                    line += "\\r";
+                    break;
+                case '\t':
+                    line += "\\t";
+                    break;
+                default:
+                    if(static_cast<unsigned char>(c) < 0x20){
+                        static const char hexDigits[] = "0123456789abcdef";
+                        line += "\\u00";
+                        line += hexDigits[c >> 4];
+                        line += hexDigits[c & 0xF];
+                    }
+                    else{
+                        line += c;
+                    }
+                }
+            }
+            line += '"';
+        }
+        else if(value.find_first_of(",\"\r\n") != std::string_view::npos){
+            line += '"';
+            for(const char c: value){
+                line += c;
+                if(c == '"'){
+                    line += '"';
+                }
+            }
+            line += '"';
+        }
+        else{
+            line += value;
+        }
+    }
+
+    static const char* volumeTypeName(LnkFileInfo::VolumeType volumeType){
+        switch(volumeType){
+        case LnkFileInfo::NoRootDirectory:
+            return "NoRootDirectory";
+        case LnkFileInfo::Removable:
+            return "Removable";
+        case LnkFileInfo::HardDrive:
+            return "HardDrive";
+        case LnkFileInfo::NetworkDrive:
+            return "NetworkDrive";
+        case LnkFileInfo::CdRom:
+            return "CdRom";
+        case LnkFileInfo::RamDrive:
+            return "RamDrive";
+        default:
+            return "Unknown";
+        }
+    }
+
+    /**
+     * Returns the attributes of the target as a combination of `LnkFileInfo::Attribute` values.
+     */
+    static uint16_t targetAttributes(const LnkFileInfo &lnkFileInfo){
+        uint16_t result = 0;
+        for(uint16_t attribute = LnkFileInfo::ReadOnly; attribute <= LnkFileInfo::Offline; attribute <<= 1){
+            if(lnkFileInfo.targetHasAttribute(static_cast<LnkFileInfo::Attribute>(attribute))){
+                result |= attribute;
+            }
+        }
+        return result;
+    }
+
+    Format _format;
+    size_t _column = 0;    //The index of the next column in the record that is being formatted
+};
+
+/**
+ * Parses LNK files on several threads and writes their records to the standard output on another thread. At most `capacity` paths are in flight at any time, i.e. submitted but not yet written, so `submit()` blocks when the output can't keep up. This keeps the memory usage bounded no matter how many paths there are.
+ */
+class Pipeline final {
+public:
+    Pipeline(unsigned int threadCount, bool ordered, RecordFormatter formatter, LnkFileInfo::ParseOptions parseOptions):
+        _capacity(threadCount * 64), _ordered(ordered), _formatter(formatter), _slots(ordered ? threadCount * 64 : 0)
+    {
+        this->_workers.reserve(threadCount);
+        for(unsigned int i = 0; i < threadCount; i++){
+            this->_workers.emplace_back(&Pipeline::work, this, parseOptions);
+        }
+        this->_writer = std::thread(&Pipeline::write, this);
+    }
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    /**
+     * Queues an LNK file to be parsed, waiting until there's room for it. Returns false if writing to the standard output failed, in which case nothing more will be written.
+     */
+    bool submit(std::string filePath){
+        std::unique_lock lock(this->_mutex);
+        this->_spaceAvailable.wait(lock, [this]{
+            return this->_submitted - this->_written < this->_capacity || this->_writeFailed;
+        });
+        if(this->_writeFailed){
+            return false;
+        }
+        this->_pending.push_back(Pending{this->_submitted++, std::move(filePath)});
+        this->_workAvailable.notify_one();
+        return true;
+    }
+
+    /**
+     * Waits until all queued LNK files have been parsed and written. Returns false if writing to the standard output failed, in which case `errno` is set to the reason.
+     */
+    bool finish(){
+        {
+            const std::lock_guard lock(this->_mutex);
+            this->_closed = true;
+        }
+        this->_workAvailable.notify_all();
+        this->_resultAvailable.notify_all();
+        for(std::thread &worker: this->_workers){
+            worker.join();
+        }
+        this->_writer.join();
+        if(this->_writeFailed){
+            errno = this->_writeError;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Returns true if at least one LNK file couldn't be parsed.
+     */
+    bool hadErrors() const {
+        const std::lock_guard lock(this->_mutex);
+        return this->_hadErrors;
+    }
+
+private:
+    struct Pending {
+        uint64_t sequence;
+        std::string filePath;
+    };
+
+    struct Slot {
+        std::string line;
+        bool ready = false;
+    };
+
+    void work(LnkFileInfo::ParseOptions parseOptions){
+        LnkParser parser(parseOptions);
+        RecordFormatter formatter = this->_formatter;
+        std::string line;
+        for(;;){
+            Pending pending;
+            {
+                std::unique_lock lock(this->_mutex);
+                this->_workAvailable.wait(lock, [this]{
+                    return !this->_pending.empty() || this->_closed;
+                });
+                if(this->_pending.empty()){
+                    return;
+                }
+                pending = std::move(this->_pending.front());
+                this->_pending.pop_front();
+            }
+
+            LnkFileInfo::ErrorCode error;
+            const LnkFileInfo* lnkFileInfo = parser.tryOpen(pending.filePath, error);
+            formatter.format(line, pending.filePath, lnkFileInfo, error);
+
+            const std::lock_guard lock(this->_mutex);
+            this->_hadErrors |= lnkFileInfo == nullptr;
+            if(this->_ordered){
+                //Swap the strings so that both the slot and this thread keep the capacity they already have
+                Slot &slot = this->_slots[pending.sequence % this->_capacity];
+                slot.line.swap(line);
+                slot.ready = true;
+                if(pending.sequence == this->_written){
+                    this->_resultAvailable.notify_one();
+                }
+            }
+            else{
+                this->_finished.push_back(std::move(line));
+                this->_resultAvailable.notify_one();
+            }
+        }
+    }
+
+    /**
+     * Collects the records that are ready and writes them in chunks, so that the lock isn't held while writing.
+     */
+    void write(){
+        std::string buffer = this->_formatter.header();
+        std::deque<std::string> finished;
+        for(;;){
+            {
+                std::unique_lock lock(this->_mutex);
+                this->_resultAvailable.wait(lock, [this]{
+                    return this->hasReadyResult() || (this->_closed && this->_written == this->_submitted);
+                });
+                if(!this->hasReadyResult()){
+                    break;
+                }
+                if(this->_ordered){
+                    while(this->hasReadyResult()){
+                        Slot &slot = this->_slots[this->_written % this->_capacity];
+                        buffer += slot.line;
+                        slot.ready = false;
+                        this->_written++;
+                    }
+                }
+                else{
+                    finished.swap(this->_finished);
+                    this->_written += finished.size();
+                }
+            }
+            this->_spaceAvailable.notify_all();
+            for(const std::string &line: finished){
+                buffer += line;
+            }
+            finished.clear();
+            if(!this->flush(buffer)){
+                return;
+            }
+        }
+        this->flush(buffer);
+    }
+
+    bool hasReadyResult() const {
+        return this->_ordered ? this->_written != this->_submitted && this->_slots[this->_written % this->_capacity].ready : !this->_finished.empty();
+    }
+
+    /**
+     * Writes the buffer to the standard output and clears it. If writing fails, stops accepting new paths and returns false.
+     */
+    bool flush(std::string &buffer){
+        if(std::fwrite(buffer.data(), 1, buffer.size(), stdout) != buffer.size() || std::fflush(stdout) != 0){
+            {
+                const std::lock_guard lock(this->_mutex);
+                this->_writeFailed = true;
+                this->_writeError = errno;
+            }
+            this->_spaceAvailable.notify_all();
+            return false;
+        }
+        buffer.clear();
+        return true;
+    }
+
+    const uint64_t _capacity;
+    const bool _ordered;
+    const RecordFormatter _formatter;           //Copied by each worker
+    mutable std::mutex _mutex;
+    std::condition_variable _workAvailable;      //Notified when a path is queued or when the pipeline is closed
+    std::condition_variable _resultAvailable;    //Notified when a record can be written or when the pipeline is closed
+    std::condition_variable _spaceAvailable;     //Notified when records have been written or when writing failed
+    std::deque<Pending> _pending;                //The paths that are waiting to be parsed
+    std::vector<Slot> _slots;                    //With ordered output, the record of each path in flight, indexed by its sequence number modulo the capacity
+    std::deque<std::string> _finished;           //With unordered output, the records that are ready to be written
+    uint64_t _submitted = 0;
+    uint64_t _written = 0;
+    bool _closed = false;
+    bool _hadErrors = false;
+    bool _writeFailed = false;
+    int _writeError = 0;                         //The value of `errno` when writing failed
+    std::vector<std::thread> _workers;
+    std::thread _writer;
+};
+
+/**
+ * Converts a path to a UTF-8 encoded string. `std::filesystem::path::string()` isn't used since it uses the ANSI code page on Windows.
+ */
+static std::string pathToUtf8(const std::filesystem::path &path){
+    const auto utf8 = path.u8string();    //std::string in C++17, std::u8string in C++20
+    return std::string(utf8.begin(), utf8.end());
+}
+
+/**
+ * Returns true if the given path has the `.lnk` extension, case insensitive.
+ */
+static bool isLnkFile(const std::filesystem::path &path){
+    const std::string extension = pathToUtf8(path.extension());
+    return extension.size() == 4 && extension[0] == '.'
+        && (extension[1] == 'l' || extension[1] == 'L')
+        && (extension[2] == 'n' || extension[2] == 'N')
+        && (extension[3] == 'k' || extension[3] == 'K');
+}
+
+/**
+ * Submits all LNK files in the given directory. Directories that can't be listed are submitted as well so that they appear in the output with an error. Returns false if writing the output failed.
+ */
+static bool submitDirectory(Pipeline &pipeline, const std::filesystem::path &root, bool recursive){
+    std::vector<std::filesystem::path> directories{root};
+    while(!directories.empty()){
+        const std::filesystem::path directory = std::move(directories.back());
+        directories.pop_back();
+        std::error_code error;
+        std::filesystem::directory_iterator it(directory, std::filesystem::directory_options::skip_permission_denied, error);
+        for(; !error && it != std::filesystem::directory_iterator(); it.increment(error)){
+            std::error_code typeError;
+            if(recursive && it->is_directory(typeError) && !it->is_symlink(typeError)){
+                directories.push_back(it->path());
+            }
+            else if(isLnkFile(it->path()) && it->is_regular_file(typeError) && !pipeline.submit(pathToUtf8(it->path()))){
+                return false;
+            }
+        }
+        if(error && !pipeline.submit(pathToUtf8(directory))){
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv){
+    //Only std::cin is used as a C++ stream, so it doesn't need to be synchronized with stdio. Its effect is implementation-defined once I/O has been done, so it's called before anything else.
+    std::ios::sync_with_stdio(false);
+
+    RecordFormatter::Format format = RecordFormatter::Ndjson;
+    unsigned int threadCount = 0;
+    bool ordered = false;
+    bool recursive = true;
+    LnkFileInfo::ParseOptions parseOptions = LnkFileInfo::NoOptions;
+    std::vector<std::string> inputs;
+    bool onlyInputs = false;
+    for(int i = 1; i < argc; i++){
+        const std::string_view argument = argv[i];
+        if(onlyInputs || argument == "-" || argument.empty() || argument[0] != '-'){
+            inputs.emplace_back(argument);
+        }
+        else if(argument == "--"){
+            onlyInputs = true;
+        }
+        else if(argument == "-h" || argument == "--help"){
+            std::fputs(usage, stdout);
+            return EXIT_SUCCESS;
+        }
+        else if((argument == "-f" || argument == "--format") && i + 1 < argc){
+            const std::string_view value = argv[++i];
+            if(value == "ndjson"){
+                format = RecordFormatter::Ndjson;
+            }
+            else if(value == "csv"){
+                format = RecordFormatter::Csv;
+            }
+            else{
+                std::fprintf(stderr, "lnkinfo: unknown format '%s'\n", argv[i]);
+                return 2;
+            }
+        }
+        else if((argument == "-j" || argument == "--threads") && i + 1 < argc){
+            char* end;
+            const unsigned long value = std::strtoul(argv[++i], &end, 10);
+            if(*end != '\0' || value == 0 || value > 1024){
+                std::fprintf(stderr, "lnkinfo: invalid number of threads '%s'\n", argv[i]);
+                return 2;
+            }
+            threadCount = static_cast<unsigned int>(value);
+        }
+        else if(argument == "-o" || argument == "--ordered"){
+            ordered = true;
+        }
+        else if(argument == "--no-recursive"){
+            recursive = false;
+        }
+        else if(argument == "--target-only"){
+            parseOptions |= LnkFileInfo::TargetOnly;
+        }
+        else{
+            std::fprintf(stderr, "lnkinfo: invalid option '%s'\n%s", argv[i], usage);
+            return 2;
+        }
+    }
+    if(inputs.empty()){
+        std::fputs(usage, stderr);
+        return 2;
+    }
+    if(threadCount == 0){
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    #ifdef _WIN32
+        //Write the line breaks as they are instead of converting them to CRLF
+        _setmode(_fileno(stdout), _O_BINARY);
+        _setmode(_fileno(stdin), _O_BINARY);
+    #endif
+    Pipeline pipeline(threadCount, ordered, RecordFormatter(format), parseOptions);
+    bool writeSucceeded = true;
+    for(const std::string &input: inputs){
+        if(input == "-"){
+            std::string filePath;
+            while(writeSucceeded && std::getline(std::cin, filePath, '\0')){
+                if(!filePath.empty()){
+                    writeSucceeded = pipeline.submit(filePath);
+                }
+            }
+        }
+        else{
+            const std::filesystem::path path = std::filesystem::u8path(input);
+            std::error_code error;
+            if(std::filesystem::is_directory(path, error)){
+                writeSucceeded = submitDirectory(pipeline, path, recursive);
+            }
+            else{
+                writeSucceeded = pipeline.submit(input);
+            }
+        }
+        if(!writeSucceeded){
+            break;
+        }
+    }
+    if(!pipeline.finish() || !writeSucceeded){
+        std::fprintf(stderr, "lnkinfo: writing the output failed: %s\n", std::strerror(errno));
+        return EXIT_FAILURE;
+    }
+    return pipeline.hadErrors() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
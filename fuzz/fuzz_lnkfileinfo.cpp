@@ -0,0 +1,85 @@
+#include <lnkfileinfo.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <vector>
+
+#ifdef LNKFILEINFO_FUZZ_STANDALONE
+    #include <filesystem>
+    #include <fstream>
+    #include <iostream>
+    #include <iterator>
+#endif
+
+/**
+ * Touches every string of a parsed LNK file so that lazily decoded strings are decoded, and returns them concatenated so that different parse options can be compared.
+ */
+static std::string allStrings(const LnkFileInfo &lnk){
+    std::string result = lnk.absoluteTargetPath() + '\0' + lnk.targetVolumeName() + '\0' + lnk.description() + '\0' + lnk.relativeTargetPath() + '\0' + lnk.workingDirectory() + '\0' + lnk.commandLineArgs() + '\0' + lnk.iconPath() + '\0' + lnk.environmentTargetPath() + '\0' + lnk.trackerMachineId();
+    for(const std::vector<uint8_t> &item: lnk.idList()){
+        result += '\0';
+        result.append(item.begin(), item.end());
+    }
+    return result;
+}
+
+/**
+ * Parses arbitrary bytes with every combination of parse options that changes how the bytes are decoded. Crashes if the options that should give the same result don't, so that the fuzzer reports it.
+ */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size){
+    LnkFileInfo::ErrorCode eagerError = LnkFileInfo::Success;
+    const std::optional<LnkFileInfo> eager = LnkFileInfo::tryParse(data, size, eagerError, "", LnkFileInfo::IdList | LnkFileInfo::ExtraData);
+    LnkFileInfo::ErrorCode lazyError = LnkFileInfo::Success;
+    const std::optional<LnkFileInfo> lazy = LnkFileInfo::tryParse(data, size, lazyError, "", LnkFileInfo::LazyStrings | LnkFileInfo::IdList | LnkFileInfo::ExtraData);
+    if(eagerError != lazyError || (eager.has_value() && allStrings(*eager) != allStrings(*lazy))){
+        std::abort();
+    }
+
+    LnkFileInfo::ErrorCode targetOnlyError = LnkFileInfo::Success;
+    const std::optional<LnkFileInfo> targetOnly = LnkFileInfo::tryParse(data, size, targetOnlyError, "", LnkFileInfo::TargetOnly);
+    if(eager.has_value() && (!targetOnly.has_value() || targetOnly->absoluteTargetPath() != eager->absoluteTargetPath())){
+        std::abort();
+    }
+    if(targetOnly.has_value()){
+        allStrings(*targetOnly);
+    }
+
+    //A reused parser must give the same result as parsing from scratch, even after parsing other bytes
+    static LnkParser parser(LnkFileInfo::IdList | LnkFileInfo::ExtraData);
+    LnkFileInfo::ErrorCode parserError = LnkFileInfo::Success;
+    const LnkFileInfo* reused = parser.tryParse(data, size, parserError);
+    if(parserError != eagerError || (reused != nullptr && allStrings(*reused) != allStrings(*eager))){
+        std::abort();
+    }
+    return 0;
+}
+
+#ifdef LNKFILEINFO_FUZZ_STANDALONE
+/**
+ * Runs the fuzz target on the given files, and on the files in the given directories, for compilers that don't support libFuzzer.
+ */
+int main(int argc, char** argv){
+    size_t count = 0;
+    for(int i = 1; i < argc; i++){
+        std::vector<std::filesystem::path> paths;
+        if(std::filesystem::is_directory(argv[i])){
+            for(const std::filesystem::directory_entry &entry: std::filesystem::directory_iterator(argv[i])){
+                paths.push_back(entry.path());
+            }
+        }
+        else{
+            paths.push_back(argv[i]);
+        }
+        for(const std::filesystem::path &path: paths){
+            std::ifstream file(path, std::ios::binary);
+            const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            LLVMFuzzerTestOneInput(bytes.data(), bytes.size());
+            count++;
+        }
+    }
+    std::cout << "Ran " << count << " inputs" << std::endl;
+    return 0;
+}
+#endif
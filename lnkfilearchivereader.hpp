@@ -0,0 +1,1068 @@
+/*
+ * LNK file archive reader, part of the LnkFileInfo library
+ * By Gustav Lindberg
+ * https://github.com/GustavLindberg99/LnkFileInfo
+ */
+
+#ifndef LNKFILEARCHIVEREADER_HPP
+#define LNKFILEARCHIVEREADER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "lnkfileinfo.hpp"
+
+/**
+ * The LnkFileArchiveReader class finds the LNK files inside ZIP and TAR archives and parses them directly from the archive, without extracting them to disk first.
+ *
+ * Archives are read through the `LnkFileArchiveReader::Source` interface, which reads bytes at arbitrary offsets. This makes it possible to read archives from files, from memory, or from inside disk images with a third-party image reader. Only the headers of the archive and the members whose names have the `.lnk` extension are read, so the time it takes doesn't depend on the size of the other members.
+ *
+ * ZIP archives may be stored or compressed with DEFLATE, and may use ZIP64. TAR archives may be in the ustar, GNU or pax format, but may not be compressed.
+ */
+class LnkFileArchiveReader final {
+public:
+    /**
+     * Interface to read an archive at arbitrary offsets. Implement this interface to read archives that are stored somewhere else than in a file or in memory, for example inside a disk image.
+     */
+    class Source {
+    public:
+        virtual ~Source() = default;
+
+        /**
+         * Returns the size of the archive in bytes.
+         */
+        virtual uint64_t size() = 0;
+
+        /**
+         * Reads bytes from the archive.
+         *
+         * @param offset    The offset to start reading at.
+         * @param buffer    The buffer to read the bytes into.
+         * @param size      The number of bytes to read.
+         *
+         * @return The number of bytes read. Must be equal to `size` unless the end of the archive is reached.
+         *
+         * @throws LnkFileInfo::IoError if reading the archive failed.
+         */
+        virtual size_t read(uint64_t offset, uint8_t* buffer, size_t size) = 0;
+    };
+
+    /**
+     * Reads an archive from a file.
+     */
+    class FileSource final: public Source {
+    public:
+        /**
+         * Opens the given archive.
+         *
+         * @param filePath  The path of the archive, encoded in UTF-8.
+         *
+         * @throws LnkFileInfo::IoError if opening the archive failed.
+         */
+        explicit FileSource(const std::string& filePath): _filePath(filePath) {
+            #ifdef _WIN32
+                this->_file = CreateFileW(LnkFileInfo::utf8ToNativeEncoding(filePath).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+                LARGE_INTEGER size;
+                if(this->_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(this->_file, &size)){
+                    const std::error_code error(static_cast<int>(GetLastError()), std::system_category());
+                    if(this->_file != INVALID_HANDLE_VALUE){
+                        CloseHandle(this->_file);
+                    }
+                    throw LnkFileInfo::IoError(std::filesystem::filesystem_error("Could not open archive", filePath, error));
+                }
+                this->_size = static_cast<uint64_t>(size.QuadPart);
+            #else
+                this->_file = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+                struct stat status;
+                if(this->_file < 0 || fstat(this->_file, &status) != 0){
+                    const std::error_code error(errno, std::generic_category());
+                    if(this->_file >= 0){
+                        ::close(this->_file);
+                    }
+                    throw LnkFileInfo::IoError(std::filesystem::filesystem_error("Could not open archive", filePath, error));
+                }
+                this->_size = static_cast<uint64_t>(status.st_size);
+            #endif
+        }
+
+        FileSource(const FileSource&) = delete;
+        FileSource& operator=(const FileSource&) = delete;
+
+        ~FileSource(){
+            #ifdef _WIN32
+                CloseHandle(this->_file);
+            #else
+                ::close(this->_file);
+            #endif
+        }
+
+        uint64_t size() override {
+            return this->_size;
+        }
+
+        size_t read(uint64_t offset, uint8_t* buffer, size_t size) override {
+            size_t bytesRead = 0;
+            while(bytesRead < size){
+                #ifdef _WIN32
+                    OVERLAPPED overlapped = {};
+                    overlapped.Offset = static_cast<DWORD>(offset + bytesRead);
+                    overlapped.OffsetHigh = static_cast<DWORD>((offset + bytesRead) >> 32);
+                    DWORD result = 0;
+                    if(!ReadFile(this->_file, buffer + bytesRead, static_cast<DWORD>(std::min<size_t>(size - bytesRead, 0x40000000)), &result, &overlapped)){
+                        if(GetLastError() == ERROR_HANDLE_EOF){
+                            break;
+                        }
+                        throw LnkFileInfo::IoError(std::filesystem::filesystem_error("Could not read archive", this->_filePath, std::error_code(static_cast<int>(GetLastError()), std::system_category())));
+                    }
+                #else
+                    const ssize_t result = pread(this->_file, buffer + bytesRead, size - bytesRead, static_cast<off_t>(offset + bytesRead));
+                    if(result < 0){
+                        if(errno == EINTR){
+                            continue;
+                        }
+                        throw LnkFileInfo::IoError(std::filesystem::filesystem_error("Could not read archive", this->_filePath, std::error_code(errno, std::generic_category())));
+                    }
+                #endif
+                if(result == 0){
+                    break;
+                }
+                bytesRead += static_cast<size_t>(result);
+            }
+            return bytesRead;
+        }
+
+    private:
+        std::string _filePath;
+        uint64_t _size = 0;
+        #ifdef _WIN32
+            HANDLE _file;
+        #else
+            int _file;
+        #endif
+    };
+
+    /**
+     * Reads an archive that has already been loaded into memory. The bytes aren't copied and must outlive the source.
+     */
+    class MemorySource final: public Source {
+    public:
+        MemorySource(const uint8_t* data, size_t size): _data(data), _size(size) {}
+
+        uint64_t size() override {
+            return this->_size;
+        }
+
+        size_t read(uint64_t offset, uint8_t* buffer, size_t size) override {
+            if(offset >= this->_size){
+                return 0;
+            }
+            size = std::min<size_t>(size, this->_size - static_cast<size_t>(offset));
+            std::memcpy(buffer, this->_data + offset, size);
+            return size;
+        }
+
+    private:
+        const uint8_t* _data;
+        size_t _size;
+    };
+
+    /**
+     * The format of an archive.
+     */
+    enum Format: uint8_t {
+        AutoDetect,    //Detect the format from the first bytes of the archive.
+        Zip,
+        Tar
+    };
+
+    /**
+     * Options that change how archives are read.
+     */
+    struct Options {
+        Format format = AutoDetect;                                      //The format of the archive.
+        size_t maxEntrySize = 16 * 1024 * 1024;                          //Members larger than this, compressed or uncompressed, are reported with `LnkFileInfo::ReadFailed` instead of being read.
+        LnkFileInfo::ParseOptions parseOptions = LnkFileInfo::NoOptions;    //The options to parse the LNK files with. `LnkFileInfo::MemoryMapped` has no effect.
+        LnkFileInfo::ParseStats* stats = nullptr;                           //If not null, the statistics of parsing the LNK files are added to this object, with the uncompressed size of the members as `bytesRead`. Members that couldn't be read are counted as `LnkFileInfo::ReadFailed` errors. Only recorded if `LNKFILEINFO_STATS` is defined.
+        std::shared_ptr<LnkFileInfo::ContentCache> contentCache;           //If not null, members with the same contents as one that was already parsed are copied from this cache instead of being parsed again.
+    };
+
+    /**
+     * The result of reading a single LNK file from an archive.
+     */
+    struct Result {
+        std::string filePath;                       //The path of the LNK file inside the archive, encoded in UTF-8.
+        std::optional<LnkFileInfo> lnkFileInfo;     //The parsed LNK file, or `std::nullopt` if reading or parsing it failed. Its `filePath()` and `absoluteFilePath()` are the path inside the archive.
+        LnkFileInfo::ErrorCode error;               //Why reading or parsing the LNK file failed, or `LnkFileInfo::Success` if it succeeded. Members that are encrypted, use an unsupported compression method, are corrupt or are larger than `Options::maxEntrySize` are reported with `LnkFileInfo::ReadFailed`.
+    };
+
+    /**
+     * Finds all members with the `.lnk` extension (case insensitive) in the given archive and parses them. Errors in individual members don't stop the other members from being read, they are reported to the callback instead.
+     *
+     * @param source    The archive to read.
+     * @param options   Options that change how the archive is read.
+     * @param callback  Called once for each LNK file, in the order they appear in the archive.
+     *
+     * @throws LnkFileInfo::IoError if reading the archive failed, if the archive isn't in the given format or if its headers are corrupt.
+     */
+    static void readArchive(Source& source, const Options& options, const std::function<void(Result&&)>& callback){
+        ArchiveParser parser(source, options, callback);
+        Format format = options.format;
+        if(format == AutoDetect){
+            format = parser.detectFormat();
+        }
+        if(format == Zip){
+            parser.readZip();
+        }
+        else{
+            parser.readTar();
+        }
+    }
+
+    /**
+     * Same as above, but returns the results in a vector instead of passing them to a callback.
+     *
+     * @param source    The archive to read.
+     * @param options   Options that change how the archive is read.
+     *
+     * @return The results in the order they appear in the archive.
+     *
+     * @throws LnkFileInfo::IoError if reading the archive failed, if the archive isn't in the given format or if its headers are corrupt.
+     */
+    static std::vector<Result> readArchive(Source& source, const Options& options){
+        std::vector<Result> results;
+        readArchive(source, options, [&results](Result&& result){
+            results.push_back(std::move(result));
+        });
+        return results;
+    }
+
+    /**
+     * Equivalent to `readArchive(source, LnkFileArchiveReader::Options())`.
+     */
+    static std::vector<Result> readArchive(Source& source){
+        return readArchive(source, Options());
+    }
+
+private:
+    /**
+     * Throws an exception saying that the archive is invalid.
+     */
+    [[noreturn]] static void throwInvalidArchive(const char* message){
+        throw LnkFileInfo::IoError(std::filesystem::filesystem_error(message, std::make_error_code(std::errc::invalid_argument)));
+    }
+
+    /**
+     * Reads a source sequentially through a buffer, with the possibility to skip ahead. Reading the small headers of consecutive members this way needs one call to `Source::read()` per 64 KiB instead of one per header.
+     */
+    class BufferedReader {
+    public:
+        BufferedReader(Source& source, uint64_t begin, uint64_t end): _source(source), _bufferOffset(begin), _end(end) {}
+
+        uint64_t offset() const noexcept {
+            return this->_bufferOffset + this->_position;
+        }
+
+        uint64_t remaining() const noexcept {
+            return this->offset() < this->_end ? this->_end - this->offset() : 0;
+        }
+
+        void seek(uint64_t offset) noexcept {
+            if(offset >= this->_bufferOffset && offset - this->_bufferOffset <= this->_buffer.size()){
+                this->_position = static_cast<size_t>(offset - this->_bufferOffset);
+            }
+            else{
+                this->_buffer.clear();
+                this->_bufferOffset = offset;
+                this->_position = 0;
+            }
+        }
+
+        /**
+         * Returns a pointer to the next `size` bytes without advancing, or `nullptr` if there are fewer than `size` bytes left. The pointer is valid until the next call to `peek()`.
+         */
+        const uint8_t* peek(size_t size){
+            if(size > this->remaining()){
+                return nullptr;
+            }
+            if(this->_buffer.size() - this->_position < size){
+                this->_buffer.erase(this->_buffer.begin(), this->_buffer.begin() + static_cast<ptrdiff_t>(this->_position));
+                this->_bufferOffset += this->_position;
+                this->_position = 0;
+                const size_t kept = this->_buffer.size();
+                const size_t wanted = static_cast<size_t>(std::min<uint64_t>(std::max(size, windowSize), this->_end - this->_bufferOffset));
+                this->_buffer.resize(wanted);
+                const size_t bytesRead = this->_source.read(this->_bufferOffset + kept, this->_buffer.data() + kept, wanted - kept);
+                this->_buffer.resize(kept + bytesRead);
+                if(this->_buffer.size() < size){
+                    throwInvalidArchive("The archive is truncated");
+                }
+            }
+            return this->_buffer.data() + this->_position;
+        }
+
+        void skip(size_t size) noexcept {
+            this->_position += size;
+        }
+
+    private:
+        static constexpr size_t windowSize = 65536;
+
+        Source& _source;
+        std::vector<uint8_t> _buffer;
+        uint64_t _bufferOffset;    //The offset in the source of the first byte in the buffer
+        size_t _position = 0;      //The position of the current offset in the buffer
+        uint64_t _end;
+    };
+
+    /**
+     * Decompresses raw DEFLATE data (RFC 1951), which is how members are compressed in ZIP archives. The decoder works like zlib's puff, except that codes of up to 9 bits, which are almost all codes in practice, are decoded with a lookup table instead of one bit at a time.
+     */
+    class Inflater {
+    public:
+        /**
+         * Decompresses the given bytes.
+         *
+         * @return True if the bytes are valid DEFLATE data that decompresses to exactly `outputSize` bytes.
+         */
+        static bool inflate(const uint8_t* input, size_t inputSize, uint8_t* output, size_t outputSize){
+            Inflater inflater(input, inputSize, output, outputSize);
+            uint32_t last, type;
+            do{
+                if(!inflater.bits(1, last) || !inflater.bits(2, type)){
+                    return false;
+                }
+                const bool success = type == 0 ? inflater.storedBlock() : type == 1 ? inflater.fixedBlock() : type == 2 ? inflater.dynamicBlock() : false;
+                if(!success){
+                    return false;
+                }
+            }while(!last);
+            return inflater._outputPosition == outputSize;
+        }
+
+    private:
+        static constexpr int maxBits = 15;
+        static constexpr int fastBits = 9;
+
+        /**
+         * A canonical Huffman code, given by the number of codes of each length and the symbols ordered by code.
+         */
+        struct Huffman {
+            uint16_t counts[maxBits + 1];
+            uint16_t symbols[288];
+            uint16_t fast[1 << fastBits];    //The symbol and the code length times 512 for the next `fastBits` bits of input, or zero if the code is longer than that
+        };
+
+        Inflater(const uint8_t* input, size_t inputSize, uint8_t* output, size_t outputSize): _input(input), _inputSize(inputSize), _output(output), _outputSize(outputSize) {}
+
+        bool bits(int count, uint32_t &value) noexcept {
+            while(this->_bitCount < count){
+                if(this->_inputPosition == this->_inputSize){
+                    return false;
+                }
+                this->_bitBuffer |= static_cast<uint32_t>(this->_input[this->_inputPosition++]) << this->_bitCount;
+                this->_bitCount += 8;
+            }
+            value = this->_bitBuffer & ((uint32_t(1) << count) - 1);
+            this->_bitBuffer >>= count;
+            this->_bitCount -= count;
+            return true;
+        }
+
+        /**
+         * Decodes a symbol, or returns -1 if the input ends or contains an invalid code.
+         */
+        int decode(const Huffman &huffman) noexcept {
+            while(this->_bitCount <= 24 && this->_inputPosition < this->_inputSize){
+                this->_bitBuffer |= static_cast<uint32_t>(this->_input[this->_inputPosition++]) << this->_bitCount;
+                this->_bitCount += 8;
+            }
+            const uint16_t entry = huffman.fast[this->_bitBuffer & ((1 << fastBits) - 1)];
+            const int entryLength = entry >> 9;
+            if(entryLength != 0 && entryLength <= this->_bitCount){
+                this->_bitBuffer >>= entryLength;
+                this->_bitCount -= entryLength;
+                return entry & 0x1ff;
+            }
+
+            //Codes that are longer than `fastBits` are decoded one bit at a time
+            int code = 0, first = 0, index = 0;
+            for(int length = 1; length <= maxBits; length++){
+                uint32_t bit;
+                if(!this->bits(1, bit)){
+                    return -1;
+                }
+                code |= static_cast<int>(bit);
+                const int count = huffman.counts[length];
+                if(code - count < first){
+                    return huffman.symbols[index + (code - first)];
+                }
+                index += count;
+                first = (first + count) << 1;
+                code <<= 1;
+            }
+            return -1;
+        }
+
+        /**
+         * Builds a Huffman code from the code length of each symbol.
+         *
+         * @return Zero if the code is complete, a negative number if it's over-subscribed and a positive number if it's incomplete.
+         */
+        static int construct(Huffman &huffman, const uint16_t* lengths, int symbolCount) noexcept {
+            std::fill(std::begin(huffman.counts), std::end(huffman.counts), 0);
+            std::fill(std::begin(huffman.fast), std::end(huffman.fast), 0);
+            for(int symbol = 0; symbol < symbolCount; symbol++){
+                huffman.counts[lengths[symbol]]++;
+            }
+            if(huffman.counts[0] == symbolCount){
+                return 0;
+            }
+            int left = 1;
+            for(int length = 1; length <= maxBits; length++){
+                left = (left << 1) - huffman.counts[length];
+                if(left < 0){
+                    return left;
+                }
+            }
+            uint16_t offsets[maxBits + 1] = {};
+            for(int length = 1; length < maxBits; length++){
+                offsets[length + 1] = offsets[length] + huffman.counts[length];
+            }
+            for(int symbol = 0; symbol < symbolCount; symbol++){
+                if(lengths[symbol] != 0){
+                    huffman.symbols[offsets[lengths[symbol]]++] = static_cast<uint16_t>(symbol);
+                }
+            }
+
+            //Codes are stored starting with their most significant bit, so the table is indexed by the reversed code
+            uint16_t nextCode[maxBits + 1] = {};
+            for(int length = 2; length <= maxBits; length++){
+                nextCode[length] = static_cast<uint16_t>((nextCode[length - 1] + huffman.counts[length - 1]) << 1);
+            }
+            for(int symbol = 0; symbol < symbolCount; symbol++){
+                const int length = lengths[symbol];
+                if(length == 0){
+                    continue;
+                }
+                const uint16_t code = nextCode[length]++;
+                if(length <= fastBits){
+                    size_t reversed = 0;
+                    for(int bit = 0; bit < length; bit++){
+                        reversed |= static_cast<size_t>(code >> bit & 1) << (length - 1 - bit);
+                    }
+                    for(size_t i = reversed; i < std::size(huffman.fast); i += size_t(1) << length){
+                        huffman.fast[i] = static_cast<uint16_t>(symbol | length << 9);
+                    }
+                }
+            }
+            return left;
+        }
+
+        bool storedBlock() noexcept {
+            //Stored blocks start at a byte boundary, so the partial byte in the bit buffer is skipped and the whole bytes are read again
+            this->_inputPosition -= static_cast<size_t>(this->_bitCount / 8);
+            this->_bitBuffer = 0;
+            this->_bitCount = 0;
+            if(this->_inputSize - this->_inputPosition < 4){
+                return false;
+            }
+            const uint8_t* header = this->_input + this->_inputPosition;
+            const size_t length = header[0] | header[1] << 8;
+            if(static_cast<size_t>(header[2] | header[3] << 8) != (~length & 0xffff)){
+                return false;
+            }
+            this->_inputPosition += 4;
+            if(this->_inputSize - this->_inputPosition < length || this->_outputSize - this->_outputPosition < length){
+                return false;
+            }
+            std::memcpy(this->_output + this->_outputPosition, this->_input + this->_inputPosition, length);
+            this->_inputPosition += length;
+            this->_outputPosition += length;
+            return true;
+        }
+
+        bool fixedBlock() noexcept {
+            //The fixed codes are the same for all blocks, so they're only built once
+            static const std::pair<Huffman, Huffman> fixedCodes = [](){
+                std::pair<Huffman, Huffman> result;
+                uint16_t lengths[288];
+                std::fill(lengths, lengths + 144, 8);
+                std::fill(lengths + 144, lengths + 256, 9);
+                std::fill(lengths + 256, lengths + 280, 7);
+                std::fill(lengths + 280, lengths + 288, 8);
+                construct(result.first, lengths, 288);
+                std::fill(lengths, lengths + 30, 5);
+                construct(result.second, lengths, 30);
+                return result;
+            }();
+            return this->codes(fixedCodes.first, fixedCodes.second);
+        }
+
+        bool dynamicBlock() noexcept {
+            static constexpr uint8_t order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+            uint32_t lengthCount, distanceCount, codeLengthCount;
+            if(!this->bits(5, lengthCount) || !this->bits(5, distanceCount) || !this->bits(4, codeLengthCount)){
+                return false;
+            }
+            lengthCount += 257;
+            distanceCount += 1;
+            codeLengthCount += 4;
+            if(lengthCount > 286 || distanceCount > 30){
+                return false;
+            }
+
+            //Read the code that the code lengths are encoded with
+            uint16_t lengths[286 + 30] = {};
+            for(uint32_t i = 0; i < codeLengthCount; i++){
+                uint32_t length;
+                if(!this->bits(3, length)){
+                    return false;
+                }
+                lengths[order[i]] = static_cast<uint16_t>(length);
+            }
+            Huffman lengthCode, distanceCode;
+            if(construct(lengthCode, lengths, 19) != 0){
+                return false;
+            }
+
+            //Read the code lengths of the literal/length and distance codes
+            uint32_t index = 0;
+            while(index < lengthCount + distanceCount){
+                const int symbol = this->decode(lengthCode);
+                if(symbol < 0){
+                    return false;
+                }
+                if(symbol < 16){
+                    lengths[index++] = static_cast<uint16_t>(symbol);
+                    continue;
+                }
+                uint16_t length = 0;
+                uint32_t repeat;
+                if(symbol == 16){
+                    if(index == 0 || !this->bits(2, repeat)){
+                        return false;
+                    }
+                    length = lengths[index - 1];
+                    repeat += 3;
+                }
+                else if(symbol == 17){
+                    if(!this->bits(3, repeat)){
+                        return false;
+                    }
+                    repeat += 3;
+                }
+                else{
+                    if(!this->bits(7, repeat)){
+                        return false;
+                    }
+                    repeat += 11;
+                }
+                if(index + repeat > lengthCount + distanceCount){
+                    return false;
+                }
+                std::fill(lengths + index, lengths + index + repeat, length);
+                index += repeat;
+            }
+
+            //The end of block code must exist, and incomplete codes are only allowed if they contain a single code
+            if(lengths[256] == 0){
+                return false;
+            }
+            int error = construct(lengthCode, lengths, static_cast<int>(lengthCount));
+            if(error < 0 || (error > 0 && lengthCount != static_cast<uint32_t>(lengthCode.counts[0] + lengthCode.counts[1]))){
+                return false;
+            }
+            error = construct(distanceCode, lengths + lengthCount, static_cast<int>(distanceCount));
+            if(error < 0 || (error > 0 && distanceCount != static_cast<uint32_t>(distanceCode.counts[0] + distanceCode.counts[1]))){
+                return false;
+            }
+            return this->codes(lengthCode, distanceCode);
+        }
+
+        /**
+         * Decodes the literals and length/distance pairs of a compressed block.
+         */
+        bool codes(const Huffman &lengthCode, const Huffman &distanceCode) noexcept {
+            static constexpr uint16_t lengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+            static constexpr uint8_t lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+            static constexpr uint16_t distanceBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+            static constexpr uint8_t distanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+            for(;;){
+                int symbol = this->decode(lengthCode);
+                if(symbol < 0){
+                    return false;
+                }
+                if(symbol == 256){
+                    return true;
+                }
+                if(symbol < 256){
+                    if(this->_outputPosition == this->_outputSize){
+                        return false;
+                    }
+                    this->_output[this->_outputPosition++] = static_cast<uint8_t>(symbol);
+                    continue;
+                }
+                symbol -= 257;
+                uint32_t extra;
+                if(symbol >= 29 || !this->bits(lengthExtra[symbol], extra)){
+                    return false;
+                }
+                const size_t length = lengthBase[symbol] + extra;
+                symbol = this->decode(distanceCode);
+                if(symbol < 0 || symbol >= 30 || !this->bits(distanceExtra[symbol], extra)){
+                    return false;
+                }
+                const size_t distance = distanceBase[symbol] + extra;
+                if(distance > this->_outputPosition || length > this->_outputSize - this->_outputPosition){
+                    return false;
+                }
+                //The source and destination can overlap, so the bytes are copied one at a time
+                for(size_t i = 0; i < length; i++){
+                    this->_output[this->_outputPosition] = this->_output[this->_outputPosition - distance];
+                    this->_outputPosition++;
+                }
+            }
+        }
+
+        const uint8_t* _input;
+        size_t _inputSize;
+        size_t _inputPosition = 0;
+        uint8_t* _output;
+        size_t _outputSize;
+        size_t _outputPosition = 0;
+        uint32_t _bitBuffer = 0;
+        int _bitCount = 0;
+    };
+
+    /**
+     * Reads the members of an archive and passes the LNK files to the callback. The buffers are reused for all members.
+     */
+    class ArchiveParser {
+    public:
+        ArchiveParser(Source& source, const Options& options, const std::function<void(Result&&)>& callback):
+            _options(options), _callback(callback), _size(source.size()), _reader(source, 0, _size), _source(source) {}
+
+        Format detectFormat(){
+            const uint8_t* header = this->_reader.peek(static_cast<size_t>(std::min<uint64_t>(this->_size, 512)));
+            if(this->_size >= 4 && header[0] == 'P' && header[1] == 'K' && ((header[2] == 3 && header[3] == 4) || (header[2] == 5 && header[3] == 6))){
+                return Zip;
+            }
+            if(this->_size >= 512 && isTarHeader(header)){
+                return Tar;
+            }
+            throwInvalidArchive("The archive isn't a ZIP or TAR archive");
+        }
+
+        void readZip(){
+            //Find the end of central directory record, which can be followed by a comment of up to 65535 bytes
+            const uint64_t tailOffset = this->_size - std::min<uint64_t>(this->_size, 22 + 0xffff);
+            this->_reader.seek(tailOffset);
+            const size_t tailSize = static_cast<size_t>(this->_size - tailOffset);
+            const LnkFileInfo::ByteView tail{this->_reader.peek(tailSize), tailSize};
+            size_t endRecord = tailSize;
+            for(size_t i = tailSize >= 22 ? tailSize - 22 + 1 : 0; i-- > 0;){
+                if(integer<uint32_t>(tail, i) == 0x06054b50 && 22 + static_cast<size_t>(integer<uint16_t>(tail, i + 20)) <= tailSize - i){
+                    endRecord = i;
+                    break;
+                }
+            }
+            if(endRecord == tailSize){
+                throwInvalidArchive("The archive isn't a ZIP archive");
+            }
+            uint64_t entryCount = integer<uint16_t>(tail, endRecord + 10);
+            uint64_t directorySize = integer<uint32_t>(tail, endRecord + 12);
+            uint64_t directoryOffset = integer<uint32_t>(tail, endRecord + 16);
+
+            //ZIP64 archives have a ZIP64 end of central directory record, whose location is given by a locator just before the end of central directory record
+            if((entryCount == 0xffff || directorySize == 0xffffffff || directoryOffset == 0xffffffff) && endRecord >= 20 && integer<uint32_t>(tail, endRecord - 20) == 0x07064b50){
+                const uint64_t zip64EndRecordOffset = integer<uint64_t>(tail, endRecord - 20 + 8);
+                this->_reader.seek(zip64EndRecordOffset);
+                const uint8_t* zip64EndRecord = this->_reader.peek(56);
+                if(zip64EndRecord == nullptr || integer<uint32_t>(LnkFileInfo::ByteView{zip64EndRecord, 56}, 0) != 0x06064b50){
+                    throwInvalidArchive("The ZIP64 end of central directory record is invalid");
+                }
+                entryCount = integer<uint64_t>(LnkFileInfo::ByteView{zip64EndRecord, 56}, 32);
+                directorySize = integer<uint64_t>(LnkFileInfo::ByteView{zip64EndRecord, 56}, 40);
+                directoryOffset = integer<uint64_t>(LnkFileInfo::ByteView{zip64EndRecord, 56}, 48);
+            }
+            if(directoryOffset > this->_size || directorySize > this->_size - directoryOffset){
+                throwInvalidArchive("The ZIP central directory is outside of the archive");
+            }
+
+            BufferedReader directory(this->_source, directoryOffset, directoryOffset + directorySize);
+            for(uint64_t entry = 0; entry < entryCount; entry++){
+                const uint8_t* fixedFields = directory.peek(46);
+                if(fixedFields == nullptr || integer<uint32_t>(LnkFileInfo::ByteView{fixedFields, 46}, 0) != 0x02014b50){
+                    throwInvalidArchive("The ZIP central directory is corrupt");
+                }
+                const size_t nameLength = integer<uint16_t>(LnkFileInfo::ByteView{fixedFields, 46}, 28);
+                const size_t extraLength = integer<uint16_t>(LnkFileInfo::ByteView{fixedFields, 46}, 30);
+                const size_t commentLength = integer<uint16_t>(LnkFileInfo::ByteView{fixedFields, 46}, 32);
+                const size_t headerSize = 46 + nameLength + extraLength + commentLength;
+                const uint8_t* data = directory.peek(headerSize);
+                if(data == nullptr){
+                    throwInvalidArchive("The ZIP central directory is corrupt");
+                }
+                const LnkFileInfo::ByteView header{data, headerSize};
+                directory.skip(headerSize);
+                const std::string_view name(reinterpret_cast<const char*>(data + 46), nameLength);
+                if(!isLnkFile(name)){
+                    continue;
+                }
+
+                ZipEntry zipEntry;
+                zipEntry.flags = integer<uint16_t>(header, 8);
+                zipEntry.method = integer<uint16_t>(header, 10);
+                zipEntry.crc = integer<uint32_t>(header, 16);
+                zipEntry.compressedSize = integer<uint32_t>(header, 20);
+                zipEntry.uncompressedSize = integer<uint32_t>(header, 24);
+                zipEntry.localHeaderOffset = integer<uint32_t>(header, 42);
+
+                //Sizes and offsets that don't fit in 32 bits are in the ZIP64 extended information extra field, in this order
+                for(size_t extra = 46 + nameLength; extra + 4 <= 46 + nameLength + extraLength;){
+                    const uint16_t extraId = integer<uint16_t>(header, extra);
+                    const size_t extraSize = integer<uint16_t>(header, extra + 2);
+                    if(extraId == 0x0001){
+                        size_t field = extra + 4;
+                        for(uint64_t* value: {&zipEntry.uncompressedSize, &zipEntry.compressedSize, &zipEntry.localHeaderOffset}){
+                            if(*value == 0xffffffff && field + 8 <= extra + 4 + extraSize){
+                                *value = integer<uint64_t>(header, field);
+                                field += 8;
+                            }
+                        }
+                    }
+                    extra += 4 + extraSize;
+                }
+
+                //Names are encoded in UTF-8 if bit 11 is set, otherwise in code page 437
+                this->readZipEntry(zipEntry, zipEntry.flags & 0x0800 ? std::string(name) : cp437ToUtf8(name));
+            }
+        }
+
+        void readTar(){
+            std::string longName;
+            std::optional<uint64_t> longSize;
+            bool hasLongName = false;
+            this->_reader.seek(0);
+            while(this->_reader.remaining() > 0){
+                const uint8_t* header = this->_reader.peek(512);
+                if(header == nullptr){
+                    throwInvalidArchive("The TAR archive is truncated");
+                }
+
+                //The archive ends with two zero blocks
+                if(std::all_of(header, header + 512, [](uint8_t byte){return byte == 0;})){
+                    break;
+                }
+                uint64_t size;
+                if(!isTarHeader(header) || !readTarNumber(header + 124, 12, size)){
+                    throwInvalidArchive("The TAR archive contains an invalid header");
+                }
+                if(longSize.has_value()){
+                    size = *longSize;
+                }
+                const char type = static_cast<char>(header[156]);
+                std::string name;
+                if(hasLongName){
+                    name = std::move(longName);
+                }
+                else if(std::memcmp(header + 257, "ustar", 5) == 0 && header[345] != 0){
+                    name = fieldToString(header + 345, 155) + "/" + fieldToString(header, 100);
+                }
+                else{
+                    name = fieldToString(header, 100);
+                }
+                const uint64_t dataOffset = this->_reader.offset() + 512;
+                if(size > this->_size - std::min(this->_size, dataOffset)){
+                    throwInvalidArchive("The TAR archive is truncated");
+                }
+                const uint64_t nextHeader = dataOffset + (size + 511) / 512 * 512;
+
+                hasLongName = false;
+                longSize.reset();
+                if(type == 'L' || type == 'x'){
+                    //A GNU long name or a pax extended header that applies to the next member
+                    if(size > this->_options.maxEntrySize){
+                        throwInvalidArchive("The TAR archive contains an invalid header");
+                    }
+                    this->_reader.seek(dataOffset);
+                    const std::string_view data(reinterpret_cast<const char*>(this->_reader.peek(static_cast<size_t>(size))), static_cast<size_t>(size));
+                    if(type == 'L'){
+                        longName = std::string(data.substr(0, data.find('\0')));
+                        hasLongName = true;
+                    }
+                    else{
+                        hasLongName = readPaxHeader(data, longName, longSize);
+                    }
+                }
+                else if((type == '0' || type == '\0' || type == '7') && isLnkFile(name)){
+                    Result result{std::move(name), std::nullopt, LnkFileInfo::Success};
+                    if(size > this->_options.maxEntrySize){
+                        result.error = LnkFileInfo::ReadFailed;
+                    }
+                    else{
+                        this->_reader.seek(dataOffset);
+                        this->parse(result, this->_reader.peek(static_cast<size_t>(size)), static_cast<size_t>(size));
+                    }
+                    this->deliver(std::move(result));
+                }
+                this->_reader.seek(nextHeader);
+            }
+        }
+
+    private:
+        /**
+         * The fields of a ZIP central directory header that are needed to read the member.
+         */
+        struct ZipEntry {
+            uint16_t flags;
+            uint16_t method;
+            uint32_t crc;
+            uint64_t compressedSize;
+            uint64_t uncompressedSize;
+            uint64_t localHeaderOffset;
+        };
+
+        void readZipEntry(const ZipEntry &entry, std::string name){
+            Result result{std::move(name), std::nullopt, LnkFileInfo::ReadFailed};
+
+            //Encrypted members and compression methods other than stored (0) and DEFLATE (8) aren't supported
+            const bool supported = !(entry.flags & 0x0001) && (entry.method == 0 || entry.method == 8)
+                && entry.compressedSize <= this->_options.maxEntrySize && entry.uncompressedSize <= this->_options.maxEntrySize
+                && (entry.method == 8 || entry.compressedSize == entry.uncompressedSize)
+                && entry.localHeaderOffset < this->_size;
+            if(supported){
+                this->_reader.seek(entry.localHeaderOffset);
+                const uint8_t* localHeader = this->_reader.peek(30);
+                if(localHeader != nullptr && integer<uint32_t>(LnkFileInfo::ByteView{localHeader, 30}, 0) == 0x04034b50){
+                    const uint64_t dataOffset = entry.localHeaderOffset + 30 + integer<uint16_t>(LnkFileInfo::ByteView{localHeader, 30}, 26) + integer<uint16_t>(LnkFileInfo::ByteView{localHeader, 30}, 28);
+                    const size_t compressedSize = static_cast<size_t>(entry.compressedSize);
+                    const size_t uncompressedSize = static_cast<size_t>(entry.uncompressedSize);
+                    this->_reader.seek(dataOffset);
+                    const uint8_t* data = this->_reader.peek(compressedSize);
+                    if(data != nullptr && entry.method == 8){
+                        this->_inflated.resize(uncompressedSize);
+                        data = Inflater::inflate(data, compressedSize, this->_inflated.data(), uncompressedSize) ? this->_inflated.data() : nullptr;
+                    }
+                    if(data != nullptr && crc32(data, uncompressedSize) == entry.crc){
+                        this->parse(result, data, uncompressedSize);
+                    }
+                }
+            }
+            this->deliver(std::move(result));
+        }
+
+        void parse(Result &result, const uint8_t* data, size_t size){
+            const LnkFileInfo::ParseStats before = LnkFileInfo::threadStats();
+            result.lnkFileInfo = LnkFileInfo::tryParse(data, size, result.error, result.filePath, this->_options.parseOptions & ~LnkFileInfo::MemoryMapped, nullptr, this->_options.contentCache.get());
+            if(this->_options.stats != nullptr){
+                *this->_options.stats += LnkFileInfo::threadStats() - before;
+                if constexpr(LnkFileInfo::ParseStats::enabled){
+                    this->_options.stats->bytesRead += size;
+                }
+            }
+        }
+
+        void deliver(Result&& result){
+            //Parsing never fails with ReadFailed, so this is a member that couldn't be read
+            if constexpr(LnkFileInfo::ParseStats::enabled){
+                if(this->_options.stats != nullptr && result.error == LnkFileInfo::ReadFailed){
+                    this->_options.stats->errors[LnkFileInfo::ReadFailed]++;
+                }
+            }
+            this->_callback(std::move(result));
+        }
+
+        template<typename T>
+        static T integer(const LnkFileInfo::ByteView &bytes, size_t i) noexcept {
+            LnkFileInfo::ErrorCode error = LnkFileInfo::Success;
+            return LnkFileInfo::readInteger<T>(bytes, i, error);
+        }
+
+        /**
+         * Returns true if the given name has the `.lnk` extension, case insensitive.
+         */
+        static bool isLnkFile(std::string_view name) noexcept {
+            return name.size() > 4 && name[name.size() - 4] == '.'
+                && (name[name.size() - 3] == 'l' || name[name.size() - 3] == 'L')
+                && (name[name.size() - 2] == 'n' || name[name.size() - 2] == 'N')
+                && (name[name.size() - 1] == 'k' || name[name.size() - 1] == 'K');
+        }
+
+        static std::string fieldToString(const uint8_t* field, size_t size){
+            const void* terminator = std::memchr(field, 0, size);
+            return std::string(reinterpret_cast<const char*>(field), terminator != nullptr ? static_cast<const uint8_t*>(terminator) - field : size);
+        }
+
+        /**
+         * Reads a number in a TAR header, which is either in octal or, as a GNU extension, in big-endian base 256 if the high bit of the first byte is set.
+         */
+        static bool readTarNumber(const uint8_t* field, size_t size, uint64_t &value) noexcept {
+            value = 0;
+            if(field[0] & 0x80){
+                if(field[0] != 0x80){
+                    return false;
+                }
+                for(size_t i = 1; i < size; i++){
+                    if(value >> 56){
+                        return false;
+                    }
+                    value = value << 8 | field[i];
+                }
+                return true;
+            }
+            size_t i = 0;
+            while(i < size && field[i] == ' '){
+                i++;
+            }
+            for(; i < size && field[i] >= '0' && field[i] <= '7'; i++){
+                if(value >> 61){
+                    return false;
+                }
+                value = value << 3 | static_cast<uint64_t>(field[i] - '0');
+            }
+            return i == size || field[i] == ' ' || field[i] == '\0';
+        }
+
+        /**
+         * Returns true if the given 512 bytes are a TAR header with a valid checksum. The checksum is the sum of all bytes in the header, with the checksum field itself counted as spaces.
+         */
+        static bool isTarHeader(const uint8_t* header) noexcept {
+            uint64_t sum = 0;
+            for(size_t i = 0; i < 512; i++){
+                sum += i >= 148 && i < 156 ? ' ' : header[i];
+            }
+            uint64_t checksum;
+            return readTarNumber(header + 148, 8, checksum) && checksum == sum;
+        }
+
+        /**
+         * Reads the path and size from a pax extended header, which consists of records of the form `<length> <key>=<value>\n`.
+         *
+         * @return True if the header contains a path.
+         */
+        static bool readPaxHeader(std::string_view data, std::string &path, std::optional<uint64_t> &size){
+            bool hasPath = false;
+            while(!data.empty()){
+                size_t length = 0;
+                size_t i = 0;
+                for(; i < data.size() && data[i] >= '0' && data[i] <= '9' && length <= data.size(); i++){
+                    length = length * 10 + static_cast<size_t>(data[i] - '0');
+                }
+                if(i == 0 || i >= data.size() || data[i] != ' ' || length <= i + 1 || length > data.size() || data[length - 1] != '\n'){
+                    throwInvalidArchive("The TAR archive contains an invalid pax header");
+                }
+                const std::string_view record = data.substr(i + 1, length - i - 2);
+                const size_t equals = record.find('=');
+                if(equals != std::string_view::npos){
+                    const std::string_view key = record.substr(0, equals);
+                    const std::string_view value = record.substr(equals + 1);
+                    if(key == "path"){
+                        path = std::string(value);
+                        hasPath = true;
+                    }
+                    else if(key == "size"){
+                        uint64_t number = 0;
+                        for(const char digit: value){
+                            if(digit < '0' || digit > '9' || number > (UINT64_MAX - 9) / 10){
+                                throwInvalidArchive("The TAR archive contains an invalid pax header");
+                            }
+                            number = number * 10 + static_cast<uint64_t>(digit - '0');
+                        }
+                        size = number;
+                    }
+                }
+                data.remove_prefix(length);
+            }
+            return hasPath;
+        }
+
+        /**
+         * Converts a name encoded in code page 437, which ZIP archives use for names that aren't flagged as UTF-8, to UTF-8.
+         */
+        static std::string cp437ToUtf8(std::string_view name){
+            static constexpr char16_t upperHalf[128] = {
+                0x00c7, 0x00fc, 0x00e9, 0x00e2, 0x00e4, 0x00e0, 0x00e5, 0x00e7, 0x00ea, 0x00eb, 0x00e8, 0x00ef, 0x00ee, 0x00ec, 0x00c4, 0x00c5,
+                0x00c9, 0x00e6, 0x00c6, 0x00f4, 0x00f6, 0x00f2, 0x00fb, 0x00f9, 0x00ff, 0x00d6, 0x00dc, 0x00a2, 0x00a3, 0x00a5, 0x20a7, 0x0192,
+                0x00e1, 0x00ed, 0x00f3, 0x00fa, 0x00f1, 0x00d1, 0x00aa, 0x00ba, 0x00bf, 0x2310, 0x00ac, 0x00bd, 0x00bc, 0x00a1, 0x00ab, 0x00bb,
+                0x2591, 0x2592, 0x2593, 0x2502, 0x2524, 0x2561, 0x2562, 0x2556, 0x2555, 0x2563, 0x2551, 0x2557, 0x255d, 0x255c, 0x255b, 0x2510,
+                0x2514, 0x2534, 0x252c, 0x251c, 0x2500, 0x253c, 0x255e, 0x255f, 0x255a, 0x2554, 0x2569, 0x2566, 0x2560, 0x2550, 0x256c, 0x2567,
+                0x2568, 0x2564, 0x2565, 0x2559, 0x2558, 0x2552, 0x2553, 0x256b, 0x256a, 0x2518, 0x250c, 0x2588, 0x2584, 0x258c, 0x2590, 0x2580,
+                0x03b1, 0x00df, 0x0393, 0x03c0, 0x03a3, 0x03c3, 0x00b5, 0x03c4, 0x03a6, 0x0398, 0x03a9, 0x03b4, 0x221e, 0x03c6, 0x03b5, 0x2229,
+                0x2261, 0x00b1, 0x2265, 0x2264, 0x2320, 0x2321, 0x00f7, 0x2248, 0x00b0, 0x2219, 0x00b7, 0x221a, 0x207f, 0x00b2, 0x25a0, 0x00a0
+            };
+            std::string result;
+            result.reserve(name.size());
+            for(const char character: name){
+                const uint8_t byte = static_cast<uint8_t>(character);
+                if(byte < 0x80){
+                    result += character;
+                    continue;
+                }
+                const char16_t codepoint = upperHalf[byte - 0x80];
+                if(codepoint < 0x800){
+                    result += static_cast<char>(0xc0 | codepoint >> 6);
+                }
+                else{
+                    result += static_cast<char>(0xe0 | codepoint >> 12);
+                    result += static_cast<char>(0x80 | (codepoint >> 6 & 0x3f));
+                }
+                result += static_cast<char>(0x80 | (codepoint & 0x3f));
+            }
+            return result;
+        }
+
+        /**
+         * Computes the CRC-32 of the given bytes, which ZIP archives use to detect corrupt members. Eight bytes are processed at a time with the slicing-by-8 algorithm.
+         */
+        static uint32_t crc32(const uint8_t* data, size_t size) noexcept {
+            static const std::array<std::array<uint32_t, 256>, 8> tables = [](){
+                std::array<std::array<uint32_t, 256>, 8> result = {};
+                for(uint32_t i = 0; i < 256; i++){
+                    uint32_t value = i;
+                    for(int bit = 0; bit < 8; bit++){
+                        value = value & 1 ? 0xedb88320 ^ (value >> 1) : value >> 1;
+                    }
+                    result[0][i] = value;
+                }
+                for(size_t i = 0; i < 256; i++){
+                    for(size_t table = 1; table < 8; table++){
+                        result[table][i] = (result[table - 1][i] >> 8) ^ result[0][result[table - 1][i] & 0xff];
+                    }
+                }
+                return result;
+            }();
+            uint32_t crc = 0xffffffff;
+            for(; size >= 8; data += 8, size -= 8){
+                const uint32_t low = crc ^ (data[0] | data[1] << 8 | data[2] << 16 | static_cast<uint32_t>(data[3]) << 24);
+                const uint32_t high = data[4] | data[5] << 8 | data[6] << 16 | static_cast<uint32_t>(data[7]) << 24;
+                crc = tables[7][low & 0xff] ^ tables[6][low >> 8 & 0xff] ^ tables[5][low >> 16 & 0xff] ^ tables[4][low >> 24]
+                    ^ tables[3][high & 0xff] ^ tables[2][high >> 8 & 0xff] ^ tables[1][high >> 16 & 0xff] ^ tables[0][high >> 24];
+            }
+            for(; size > 0; data++, size--){
+                crc = tables[0][(crc ^ *data) & 0xff] ^ (crc >> 8);
+            }
+            return ~crc;
+        }
+
+        const Options& _options;
+        const std::function<void(Result&&)>& _callback;
+        uint64_t _size;
+        BufferedReader _reader;
+        Source& _source;
+        std::vector<uint8_t> _inflated;    //Reused for all compressed members
+    };
+};
+
+#endif // LNKFILEARCHIVEREADER_HPP
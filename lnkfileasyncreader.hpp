@@ -0,0 +1,460 @@
+/*
+ * Asynchronous LNK file reader, part of the LnkFileInfo library
+ * By Gustav Lindberg
+ * https://github.com/GustavLindberg99/LnkFileInfo
+ */
+
+#ifndef LNKFILEASYNCREADER_HPP
+#define LNKFILEASYNCREADER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lnkfileinfo.hpp"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+    #define LNKFILEINFO_IO_URING
+    #include <fcntl.h>
+    #include <linux/io_uring.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+/**
+ * The LnkFileAsyncReader class reads many LNK files with many reads in flight at the same time, which is much faster than reading them one after the other when each read has a high latency, for example on network shares.
+ *
+ * On Linux, the files are opened, read and closed with io_uring, and parsed on the calling thread as the reads complete. If io_uring isn't available (on Linux versions before 5.6, if it's disabled, and on other operating systems), the files are read with blocking I/O on as many threads as there can be reads in flight. On Windows, `CreateFileW` can't open files asynchronously, so overlapped I/O wouldn't help with the latency of opening files and threads are always used.
+ */
+class LnkFileAsyncReader final {
+public:
+    /**
+     * Options that change how the files are read.
+     */
+    struct Options {
+        unsigned int maxInFlight = 64;                                   //The maximum number of files that are read at the same time. Limited to the size of the largest io_uring the kernel allows (32768 entries on current kernels), and to `maxThreadCount` when threads are used.
+        LnkFileInfo::ParseOptions parseOptions = LnkFileInfo::NoOptions;    //The options to parse the LNK files with. `LnkFileInfo::MemoryMapped` is ignored with io_uring.
+        LnkFileInfo::ParseStats* stats = nullptr;                           //If not null, the statistics of reading and parsing the LNK files are added to this object, not including the time spent in the callback. With io_uring, the time spent waiting for reads to complete is counted as `readNanoseconds`. Only recorded if `LNKFILEINFO_STATS` is defined.
+        std::shared_ptr<LnkFileInfo::ContentCache> contentCache;           //If not null, LNK files with the same contents as one that was already parsed are copied from this cache instead of being parsed again.
+    };
+
+    /**
+     * The result of reading a single LNK file.
+     */
+    struct Result {
+        std::string filePath;                       //The path of the LNK file.
+        std::optional<LnkFileInfo> lnkFileInfo;     //The parsed LNK file, or `std::nullopt` if reading it failed.
+        LnkFileInfo::ErrorCode error;               //Why reading the LNK file failed, or `LnkFileInfo::Success` if it succeeded.
+    };
+
+    /**
+     * Reads and parses the given LNK files with up to `options.maxInFlight` reads in flight at the same time. Errors in individual files don't stop the other files from being read, they are reported to the callback instead.
+     *
+     * @param filePaths The paths of the LNK files, encoded in UTF-8.
+     * @param options   Options that change how the files are read.
+     * @param callback  Called once for each LNK file as soon as it has been read. The callback is called on the calling thread with io_uring and on worker threads otherwise, but never from more than one thread at a time. Results are delivered in no particular order. If the callback throws an exception, no more results are delivered and the exception is rethrown by this function once the reads in flight have completed.
+     */
+    static void readFiles(const std::vector<std::string>& filePaths, const Options& options, const std::function<void(Result&&)>& callback){
+        #ifdef LNKFILEINFO_IO_URING
+            IoUring ring(std::max(1u, options.maxInFlight));
+            if(ring.isAvailable()){
+                return ring.readFiles(filePaths, options, callback);
+            }
+        #endif
+        readFilesOnThreads(filePaths, options, callback);
+    }
+
+    /**
+     * Same as above, but returns the results in a vector instead of passing them to a callback.
+     *
+     * @param filePaths The paths of the LNK files, encoded in UTF-8.
+     * @param options   Options that change how the files are read.
+     *
+     * @return The results in no particular order.
+     */
+    static std::vector<Result> readFiles(const std::vector<std::string>& filePaths, const Options& options){
+        std::vector<Result> results;
+        results.reserve(filePaths.size());
+        readFiles(filePaths, options, [&results](Result&& result){
+            results.push_back(std::move(result));
+        });
+        return results;
+    }
+
+    /**
+     * Equivalent to `readFiles(filePaths, LnkFileAsyncReader::Options())`.
+     */
+    static std::vector<Result> readFiles(const std::vector<std::string>& filePaths){
+        return readFiles(filePaths, Options());
+    }
+
+    /**
+     * Returns true if files are read with io_uring, and false if they're read with blocking I/O on several threads.
+     */
+    static bool usesIoUring(){
+        #ifdef LNKFILEINFO_IO_URING
+            return IoUring(1).isAvailable();
+        #else
+            return false;
+        #endif
+    }
+
+    /**
+     * The maximum number of threads that are started when io_uring isn't available, regardless of `Options::maxInFlight`. Each thread has its own stack, so one thread per read in flight only makes sense up to a point.
+     */
+    static constexpr unsigned int maxThreadCount = 256;
+
+private:
+    /**
+     * Reads the files with blocking I/O on as many threads as there can be reads in flight.
+     */
+    static void readFilesOnThreads(const std::vector<std::string>& filePaths, const Options& options, const std::function<void(Result&&)>& callback){
+        std::atomic<size_t> nextFile{0};
+        std::mutex callbackMutex;
+        std::exception_ptr callbackError;
+        const auto worker = [&](){
+            //The statistics are collected locally and only added to the shared ones once this thread is done
+            LnkFileInfo::ParseStats stats;
+            for(size_t i = nextFile++; i < filePaths.size(); i = nextFile++){
+                const LnkFileInfo::ParseStats before = LnkFileInfo::threadStats();
+                Result result{filePaths[i], std::nullopt, LnkFileInfo::Success};
+                result.lnkFileInfo = LnkFileInfo::tryOpen(result.filePath, result.error, options.parseOptions, nullptr, options.contentCache.get());
+                stats += LnkFileInfo::threadStats() - before;
+                const std::lock_guard lock(callbackMutex);
+                if(callbackError){
+                    break;
+                }
+                try{
+                    callback(std::move(result));
+                }
+                catch(...){
+                    callbackError = std::current_exception();
+                    break;
+                }
+            }
+            if(options.stats != nullptr){
+                const std::lock_guard lock(callbackMutex);
+                *options.stats += stats;
+            }
+        };
+        const size_t threadCount = std::min<size_t>(std::clamp(options.maxInFlight, 1u, maxThreadCount), filePaths.size());
+        std::vector<std::thread> workers;
+        workers.reserve(threadCount);
+        try{
+            for(size_t i = 0; i < threadCount; i++){
+                workers.emplace_back(worker);
+            }
+        }
+        catch(...){
+            //Destroying a joinable thread terminates the program, so the threads that were started are told to stop and joined before the exception is propagated
+            nextFile = filePaths.size();
+            for(std::thread& thread: workers){
+                thread.join();
+            }
+            throw;
+        }
+        for(std::thread& thread: workers){
+            thread.join();
+        }
+        if(callbackError){
+            std::rethrow_exception(callbackError);
+        }
+    }
+
+    #ifdef LNKFILEINFO_IO_URING
+        /**
+         * A minimal io_uring wrapper that uses the system calls directly so that liburing isn't needed. Each file goes through three operations (open, one or more reads, close), and there's at most one operation in flight per file, so the submission queue can never overflow.
+         */
+        class IoUring {
+        public:
+            explicit IoUring(unsigned int maxInFlight){
+                //Without IORING_SETUP_CLAMP, asking for more entries than the kernel allows fails instead of giving the largest allowed ring
+                io_uring_params params = {};
+                params.flags = IORING_SETUP_CLAMP;
+                this->_fd = static_cast<int>(syscall(__NR_io_uring_setup, maxInFlight, &params));
+                if(this->_fd < 0){
+                    return;
+                }
+                //There's at most one operation in flight per slot, so there can't be more slots than submission queue entries
+                this->_slots.resize(std::min(maxInFlight, params.sq_entries));
+
+                //Map the submission and completion rings and the submission queue entries
+                this->_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+                this->_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+                if(params.features & IORING_FEAT_SINGLE_MMAP){
+                    this->_sqRingSize = this->_cqRingSize = std::max(this->_sqRingSize, this->_cqRingSize);
+                }
+                this->_sqRing = mmap(nullptr, this->_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->_fd, IORING_OFF_SQ_RING);
+                this->_cqRing = params.features & IORING_FEAT_SINGLE_MMAP ? this->_sqRing : mmap(nullptr, this->_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->_fd, IORING_OFF_CQ_RING);
+                this->_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+                void* const sqes = mmap(nullptr, this->_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->_fd, IORING_OFF_SQES);
+                if(this->_sqRing == MAP_FAILED || this->_cqRing == MAP_FAILED || sqes == MAP_FAILED){
+                    if(sqes != MAP_FAILED){
+                        munmap(sqes, this->_sqesSize);
+                    }
+                    this->close();
+                    return;
+                }
+                this->_sqes = static_cast<io_uring_sqe*>(sqes);
+                char* const sqRing = static_cast<char*>(this->_sqRing);
+                char* const cqRing = static_cast<char*>(this->_cqRing);
+                this->_sqTail = reinterpret_cast<unsigned int*>(sqRing + params.sq_off.tail);
+                this->_sqMask = *reinterpret_cast<unsigned int*>(sqRing + params.sq_off.ring_mask);
+                this->_sqArray = reinterpret_cast<unsigned int*>(sqRing + params.sq_off.array);
+                this->_cqHead = reinterpret_cast<unsigned int*>(cqRing + params.cq_off.head);
+                this->_cqTail = reinterpret_cast<unsigned int*>(cqRing + params.cq_off.tail);
+                this->_cqMask = *reinterpret_cast<unsigned int*>(cqRing + params.cq_off.ring_mask);
+                this->_cqes = reinterpret_cast<io_uring_cqe*>(cqRing + params.cq_off.cqes);
+
+                //Check that the kernel supports the needed operations, which were added in Linux 5.6
+                constexpr unsigned int probeOperations = 256;
+                std::vector<uint8_t> probeBuffer(sizeof(io_uring_probe) + probeOperations * sizeof(io_uring_probe_op));
+                io_uring_probe* const probe = reinterpret_cast<io_uring_probe*>(probeBuffer.data());
+                const bool supported = syscall(__NR_io_uring_register, this->_fd, IORING_REGISTER_PROBE, probe, probeOperations) >= 0 && std::all_of(std::begin(requiredOperations), std::end(requiredOperations), [probe](uint8_t operation){
+                    return operation <= probe->last_op && probe->ops[operation].flags & IO_URING_OP_SUPPORTED;
+                });
+                if(!supported){
+                    this->close();
+                }
+            }
+
+            IoUring(const IoUring&) = delete;
+            IoUring& operator=(const IoUring&) = delete;
+
+            ~IoUring(){
+                this->close();
+            }
+
+            bool isAvailable() const noexcept {
+                return this->_fd >= 0;
+            }
+
+            void readFiles(const std::vector<std::string>& filePaths, const Options& options, const std::function<void(Result&&)>& callback){
+                const LnkFileInfo::ParseOptions parseOptions = options.parseOptions;
+                LnkFileInfo::ContentCache* const cache = options.contentCache.get();
+                std::exception_ptr callbackError;
+                //Everything is recorded in the statistics of this thread, and the changes are added to `stats` except while the callback is running
+                LnkFileInfo::ParseStats stats;
+                LnkFileInfo::ParseStats before = LnkFileInfo::threadStats();
+                size_t nextFile = 0;
+                size_t inFlight = 0;
+                unsigned int toSubmit = 0;
+                const auto startNextFile = [&](size_t slotIndex){
+                    if(nextFile == filePaths.size() || callbackError){
+                        return;
+                    }
+                    Slot &slot = this->_slots[slotIndex];
+                    slot.filePath = filePaths[nextFile++];
+                    slot.size = 0;
+                    slot.stage = Slot::Opening;
+                    io_uring_sqe &sqe = this->nextSqe(slotIndex, IORING_OP_OPENAT);
+                    sqe.fd = AT_FDCWD;
+                    sqe.addr = reinterpret_cast<uintptr_t>(slot.filePath.c_str());
+                    sqe.open_flags = O_RDONLY | O_CLOEXEC;
+                    inFlight++;
+                    toSubmit++;
+                };
+                const auto readNextChunk = [&](size_t slotIndex){
+                    Slot &slot = this->_slots[slotIndex];
+                    if(slot.buffer.size() == slot.size){
+                        slot.buffer.resize(std::max<size_t>(initialBufferSize, slot.size * 2));
+                    }
+                    slot.stage = Slot::Reading;
+                    io_uring_sqe &sqe = this->nextSqe(slotIndex, IORING_OP_READ);
+                    sqe.fd = slot.fd;
+                    sqe.addr = reinterpret_cast<uintptr_t>(slot.buffer.data() + slot.size);
+                    sqe.len = static_cast<unsigned int>(std::min<size_t>(slot.buffer.size() - slot.size, 0x40000000));
+                    sqe.off = slot.size;
+                    toSubmit++;
+                };
+                const auto closeFile = [&](size_t slotIndex){
+                    Slot &slot = this->_slots[slotIndex];
+                    slot.stage = Slot::Closing;
+                    io_uring_sqe &sqe = this->nextSqe(slotIndex, IORING_OP_CLOSE);
+                    sqe.fd = slot.fd;
+                    toSubmit++;
+                };
+                const auto deliver = [&](Slot &slot, LnkFileInfo::ErrorCode error){
+                    Result result{slot.filePath, std::nullopt, error};
+                    if(error != LnkFileInfo::Success){
+                        LnkFileInfo::recordError(error);
+                    }
+                    else{
+                        LnkFileInfo::recordBytesRead(slot.size);
+                        LnkFileInfo lnkFileInfo;
+                        lnkFileInfo._filePath = slot.filePath;
+                        lnkFileInfo._options = parseOptions & ~LnkFileInfo::MemoryMapped;
+                        const LnkFileInfo::ByteView bytes{slot.buffer.data(), slot.size};
+                        result.error = cache != nullptr ? lnkFileInfo.parse(bytes, nullptr, *cache, LnkFileInfo::hashContents(bytes)) : lnkFileInfo.parse(bytes);
+                        if(result.error == LnkFileInfo::Success && !lnkFileInfo.updateAbsoluteFilePath()){
+                            result.error = LnkFileInfo::OpenFailed;
+                        }
+                        if(result.error == LnkFileInfo::Success){
+                            result.lnkFileInfo = std::move(lnkFileInfo);
+                        }
+                    }
+                    if(!callbackError){
+                        stats += LnkFileInfo::threadStats() - before;
+                        try{
+                            callback(std::move(result));
+                        }
+                        catch(...){
+                            callbackError = std::current_exception();
+                        }
+                        before = LnkFileInfo::threadStats();
+                    }
+                };
+
+                for(size_t i = 0; i < this->_slots.size(); i++){
+                    startNextFile(i);
+                }
+                while(inFlight > 0){
+                    //Submit the queued operations and wait for at least one of them to complete
+                    LnkFileInfo::PhaseTimer timer(&LnkFileInfo::ParseStats::readNanoseconds);
+                    const long entered = syscall(__NR_io_uring_enter, this->_fd, toSubmit, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+                    timer.stop();
+                    if(entered < 0){
+                        if(errno == EINTR || errno == EAGAIN || errno == EBUSY){
+                            continue;
+                        }
+                        throw LnkFileInfo::IoError(std::filesystem::filesystem_error("io_uring_enter failed", std::error_code(errno, std::generic_category())));
+                    }
+                    toSubmit -= static_cast<unsigned int>(entered);
+
+                    unsigned int head = *this->_cqHead;
+                    const unsigned int tail = __atomic_load_n(this->_cqTail, __ATOMIC_ACQUIRE);
+                    for(; head != tail; head++){
+                        const io_uring_cqe &cqe = this->_cqes[head & this->_cqMask];
+                        const size_t slotIndex = static_cast<size_t>(cqe.user_data);
+                        Slot &slot = this->_slots[slotIndex];
+                        switch(slot.stage){
+                        case Slot::Opening:
+                            if(cqe.res < 0){
+                                deliver(slot, LnkFileInfo::OpenFailed);
+                                inFlight--;
+                                startNextFile(slotIndex);
+                            }
+                            else{
+                                slot.fd = cqe.res;
+                                readNextChunk(slotIndex);
+                            }
+                            break;
+                        case Slot::Reading:
+                            if(cqe.res == -EINTR || cqe.res == -EAGAIN){
+                                readNextChunk(slotIndex);
+                            }
+                            else if(cqe.res < 0){
+                                deliver(slot, LnkFileInfo::ReadFailed);
+                                closeFile(slotIndex);
+                            }
+                            else{
+                                //Regular files only return fewer bytes than requested at the end of the file
+                                const size_t requested = std::min<size_t>(slot.buffer.size() - slot.size, 0x40000000);
+                                slot.size += static_cast<size_t>(cqe.res);
+                                if(static_cast<size_t>(cqe.res) == requested){
+                                    readNextChunk(slotIndex);
+                                }
+                                else{
+                                    //Parse the file while it's being closed
+                                    closeFile(slotIndex);
+                                    deliver(slot, LnkFileInfo::Success);
+                                }
+                            }
+                            break;
+                        case Slot::Closing:
+                            inFlight--;
+                            startNextFile(slotIndex);
+                            break;
+                        }
+                    }
+                    __atomic_store_n(this->_cqHead, head, __ATOMIC_RELEASE);
+                }
+                stats += LnkFileInfo::threadStats() - before;
+                if(options.stats != nullptr){
+                    *options.stats += stats;
+                }
+                if(callbackError){
+                    std::rethrow_exception(callbackError);
+                }
+            }
+
+        private:
+            static constexpr uint8_t requiredOperations[] = {IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_CLOSE};
+            static constexpr size_t initialBufferSize = 16384;
+
+            /**
+             * The state of a file that is being read.
+             */
+            struct Slot {
+                enum Stage {Opening, Reading, Closing};
+
+                std::string filePath;
+                std::vector<uint8_t> buffer;    //Reused for all the files read in this slot
+                size_t size = 0;                //The number of bytes read so far
+                int fd = -1;
+                Stage stage = Opening;
+            };
+
+            /**
+             * Adds a zeroed submission queue entry for the given slot to the submission queue. The entry is submitted by the next call to `io_uring_enter`.
+             */
+            io_uring_sqe& nextSqe(size_t slotIndex, uint8_t operation) noexcept {
+                const unsigned int tail = *this->_sqTail;
+                const unsigned int index = tail & this->_sqMask;
+                io_uring_sqe &sqe = this->_sqes[index];
+                std::memset(&sqe, 0, sizeof(sqe));
+                sqe.opcode = operation;
+                sqe.user_data = slotIndex;
+                this->_sqArray[index] = index;
+                __atomic_store_n(this->_sqTail, tail + 1, __ATOMIC_RELEASE);
+                return sqe;
+            }
+
+            void close() noexcept {
+                if(this->_sqes != nullptr){
+                    munmap(this->_sqes, this->_sqesSize);
+                    this->_sqes = nullptr;
+                }
+                if(this->_cqRing != MAP_FAILED && this->_cqRing != this->_sqRing){
+                    munmap(this->_cqRing, this->_cqRingSize);
+                }
+                if(this->_sqRing != MAP_FAILED){
+                    munmap(this->_sqRing, this->_sqRingSize);
+                }
+                this->_sqRing = this->_cqRing = MAP_FAILED;
+                if(this->_fd >= 0){
+                    ::close(this->_fd);
+                    this->_fd = -1;
+                }
+            }
+
+            int _fd = -1;
+            void* _sqRing = MAP_FAILED;
+            void* _cqRing = MAP_FAILED;
+            size_t _sqRingSize = 0;
+            size_t _cqRingSize = 0;
+            size_t _sqesSize = 0;
+            io_uring_sqe* _sqes = nullptr;
+            unsigned int* _sqTail = nullptr;
+            unsigned int _sqMask = 0;
+            unsigned int* _sqArray = nullptr;
+            unsigned int* _cqHead = nullptr;
+            unsigned int* _cqTail = nullptr;
+            unsigned int _cqMask = 0;
+            io_uring_cqe* _cqes = nullptr;
+            std::vector<Slot> _slots;
+        };
+    #endif
+};
+
+#endif // LNKFILEASYNCREADER_HPP
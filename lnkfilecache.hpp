@@ -0,0 +1,385 @@
+/*
+ * LNK file cache, part of the LnkFileInfo library
+ * By Gustav Lindberg
+ * https://github.com/GustavLindberg99/LnkFileInfo
+ */
+
+#ifndef LNKFILECACHE_HPP
+#define LNKFILECACHE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "lnkfileinfo.hpp"
+
+/**
+ * The LnkFileCache class keeps the information parsed from LNK files in a cache file, so that LNK files that haven't changed since the cache was saved don't need to be parsed again. Entries are keyed by the absolute path of the LNK file, and are only used if the last write time and size of the file are the same as when it was parsed.
+ *
+ * The cache file is memory mapped and entries are looked up with a binary search directly in the mapped file, so loading the cache takes the same time regardless of how many entries it contains. All methods can be called from several threads at the same time.
+ */
+class LnkFileCache final {
+public:
+    /**
+     * Constructs a new cache and loads the entries from the given cache file. If the cache file doesn't exist or isn't a valid cache file (for example if it was written by an incompatible version of this library), the cache is empty. The cache file isn't written until `save()` is called.
+     *
+     * @param cacheFilePath The path of the cache file, encoded in UTF-8.
+     */
+    explicit LnkFileCache(std::string cacheFilePath): _cacheFilePath(std::move(cacheFilePath)) {
+        this->load();
+    }
+
+    LnkFileCache(const LnkFileCache&) = delete;
+    LnkFileCache& operator=(const LnkFileCache&) = delete;
+
+    /**
+     * Gets the information about an LNK file from the cache if the file hasn't changed since it was cached, and reads and parses it otherwise. Checking whether the file has changed only needs a single `stat` call. Files that are parsed are added to the cache.
+     *
+     * @param filePath  The path of the LNK file. Can be an absolute or a relative path.
+     *
+     * @return The information about the LNK file, which is the same as what `LnkFileInfo(filePath)` would give.
+     *
+     * @throws LnkFileInfo::IoError if opening the file failed.
+     * @throws LnkFileInfo::InvalidLnkFile if the file is not a valid LNK file.
+     */
+    LnkFileInfo open(const std::string& filePath){
+        if(std::optional<LnkFileInfo> cached = this->find(filePath)){
+            return std::move(*cached);
+        }
+        LnkFileInfo result(filePath);
+        this->insert(result);
+        return result;
+    }
+
+    /**
+     * Same as `open()`, but doesn't throw an exception if reading the LNK file fails.
+     *
+     * @param filePath  The path of the LNK file. Can be an absolute or a relative path.
+     * @param error     Set to `LnkFileInfo::Success` if getting the information succeeded, and to the reason it failed otherwise.
+     *
+     * @return The information about the LNK file, or `std::nullopt` if reading the LNK file failed.
+     */
+    std::optional<LnkFileInfo> tryOpen(const std::string& filePath, LnkFileInfo::ErrorCode &error){
+        error = LnkFileInfo::Success;
+        if(std::optional<LnkFileInfo> cached = this->find(filePath)){
+            return cached;
+        }
+        std::optional<LnkFileInfo> result = LnkFileInfo::tryOpen(filePath, error);
+        if(result){
+            this->insert(*result);
+        }
+        return result;
+    }
+
+    /**
+     * Writes all entries to the cache file, including the ones loaded from the cache file that haven't been used. The cache file is written to a temporary file first and then renamed, so the cache file is never left half-written.
+     *
+     * @throws LnkFileInfo::IoError if writing the cache file failed.
+     */
+    void save(){
+        const std::unique_lock lock(this->_mutex);
+
+        //Merge the entries from the cache file with the new entries. Both are already sorted by path, and new entries replace old entries with the same path.
+        std::vector<std::string_view> entries;
+        entries.reserve(this->_entryCount + this->_newEntries.size());
+        auto newEntry = this->_newEntries.begin();
+        for(uint32_t i = 0; i < this->_entryCount; i++){
+            const std::optional<std::pair<std::string_view, std::string_view>> entry = this->mappedEntry(i);
+            if(!entry){
+                continue;
+            }
+            for(; newEntry != this->_newEntries.end() && newEntry->first < entry->first; ++newEntry){
+                entries.push_back(newEntry->second);
+            }
+            if(newEntry != this->_newEntries.end() && newEntry->first == entry->first){
+                entries.push_back(newEntry->second);
+                ++newEntry;
+            }
+            else{
+                entries.push_back(entry->second);
+            }
+        }
+        for(; newEntry != this->_newEntries.end(); ++newEntry){
+            entries.push_back(newEntry->second);
+        }
+
+        //Write the header, then the offset of each entry, then the entries themselves
+        std::string header(signature, sizeof(signature));
+        appendInteger<uint32_t>(header, version);
+        appendInteger<uint32_t>(header, static_cast<uint32_t>(entries.size()));
+        uint64_t offset = header.size() + entries.size() * sizeof(uint64_t);
+        for(const std::string_view entry: entries){
+            appendInteger<uint64_t>(header, offset);
+            offset += entry.size();
+        }
+        const std::string temporaryFilePath = this->_cacheFilePath + ".tmp";
+        {
+            std::ofstream file(LnkFileInfo::utf8ToNativeEncoding(temporaryFilePath), std::ios::binary | std::ios::trunc);
+            file.write(header.data(), static_cast<std::streamsize>(header.size()));
+            for(const std::string_view entry: entries){
+                file.write(entry.data(), static_cast<std::streamsize>(entry.size()));
+            }
+            file.close();
+            if(!file){
+                throw LnkFileInfo::IoError(std::filesystem::filesystem_error("Failed to write cache file", std::filesystem::path(LnkFileInfo::utf8ToNativeEncoding(temporaryFilePath)), std::make_error_code(std::errc::io_error)));
+            }
+        }
+
+        //The old cache file must be unmapped before it's replaced since Windows doesn't allow replacing mapped files. This invalidates the entries from the cache file, so they can't be used after this.
+        this->_mappedFile.reset();
+        std::error_code error;
+        std::filesystem::rename(std::filesystem::path(LnkFileInfo::utf8ToNativeEncoding(temporaryFilePath)), std::filesystem::path(LnkFileInfo::utf8ToNativeEncoding(this->_cacheFilePath)), error);
+        this->load();
+        if(error){
+            throw LnkFileInfo::IoError(std::filesystem::filesystem_error("Failed to write cache file", std::filesystem::path(LnkFileInfo::utf8ToNativeEncoding(this->_cacheFilePath)), error));
+        }
+        this->_newEntries.clear();
+    }
+
+    /**
+     * Returns the number of entries in the cache, including the ones that haven't been saved yet.
+     */
+    size_t size() const {
+        const std::shared_lock lock(this->_mutex);
+        size_t result = this->_newEntries.size();
+        for(uint32_t i = 0; i < this->_entryCount; i++){
+            const std::optional<std::pair<std::string_view, std::string_view>> entry = this->mappedEntry(i);
+            if(entry && this->_newEntries.count(entry->first) == 0){
+                result++;
+            }
+        }
+        return result;
+    }
+
+private:
+    using ByteView = LnkFileInfo::ByteView;
+    using FileStamp = LnkFileInfo::FileStamp;
+
+    static constexpr char signature[8] = {'L', 'N', 'K', 'C', 'A', 'C', 'H', 'E'};
+    static constexpr uint32_t version = 1;
+    static constexpr size_t headerSize = sizeof(signature) + 2 * sizeof(uint32_t);
+
+    /**
+     * Maps the cache file and checks that its header is valid. If it isn't, the cache is empty.
+     */
+    void load(){
+        this->_mappedFile.emplace(this->_cacheFilePath);
+        this->_entryCount = 0;
+        const ByteView bytes = this->_mappedFile->bytes();
+        LnkFileInfo::ErrorCode error = LnkFileInfo::Success;
+        if(bytes.size < headerSize || std::memcmp(bytes.data, signature, sizeof(signature)) != 0 || LnkFileInfo::readInteger<uint32_t>(bytes, sizeof(signature), error) != version){
+            return;
+        }
+        const uint32_t entryCount = LnkFileInfo::readInteger<uint32_t>(bytes, sizeof(signature) + sizeof(uint32_t), error);
+        if(entryCount <= (bytes.size - headerSize) / sizeof(uint64_t)){
+            this->_entryCount = entryCount;
+        }
+    }
+
+    /**
+     * Gets the information about an LNK file from the cache if the file hasn't changed since it was cached.
+     *
+     * @param filePath  The path of the LNK file. Can be an absolute or a relative path.
+     *
+     * @return The information about the LNK file, or `std::nullopt` if it isn't in the cache or if it has changed.
+     */
+    std::optional<LnkFileInfo> find(const std::string& filePath) const {
+        LnkFileInfo result;
+        result._filePath = filePath;
+        FileStamp fileStamp;
+        if(!result.updateAbsoluteFilePath() || !LnkFileInfo::statFile(filePath, fileStamp) || !fileStamp.isKnown()){
+            return std::nullopt;
+        }
+
+        const std::shared_lock lock(this->_mutex);
+        std::string_view entry;
+        const auto newEntry = this->_newEntries.find(result._absoluteFilePath);
+        if(newEntry != this->_newEntries.end()){
+            entry = newEntry->second;
+        }
+        else{
+            //Binary search in the cache file, whose entries are sorted by path
+            uint32_t begin = 0, end = this->_entryCount;
+            while(begin < end){
+                const uint32_t middle = begin + (end - begin) / 2;
+                const std::optional<std::pair<std::string_view, std::string_view>> mappedEntry = this->mappedEntry(middle);
+                if(!mappedEntry){
+                    return std::nullopt;
+                }
+                const int comparison = mappedEntry->first.compare(result._absoluteFilePath);
+                if(comparison == 0){
+                    entry = mappedEntry->second;
+                    break;
+                }
+                else if(comparison < 0){
+                    begin = middle + 1;
+                }
+                else{
+                    end = middle;
+                }
+            }
+        }
+        if(entry.empty() || !decodeEntry(entry, result) || !(result._fileStamp == fileStamp)){
+            return std::nullopt;
+        }
+        return std::optional<LnkFileInfo>(std::move(result));
+    }
+
+    /**
+     * Adds a parsed LNK file to the cache. Does nothing if the last write time and size of the LNK file are unknown, for example if it isn't a regular file.
+     */
+    void insert(const LnkFileInfo& lnkFileInfo){
+        if(!lnkFileInfo._fileStamp.isKnown()){
+            return;
+        }
+        std::string entry = encodeEntry(lnkFileInfo);
+        const std::unique_lock lock(this->_mutex);
+        this->_newEntries[lnkFileInfo._absoluteFilePath] = std::move(entry);
+    }
+
+    /**
+     * Gets an entry from the cache file.
+     *
+     * @param index The index of the entry in the offset table.
+     *
+     * @return Pair containing the path of the LNK file and the whole encoded entry, or `std::nullopt` if the entry isn't within the bounds of the cache file.
+     */
+    std::optional<std::pair<std::string_view, std::string_view>> mappedEntry(uint32_t index) const {
+        const ByteView bytes = this->_mappedFile->bytes();
+        LnkFileInfo::ErrorCode error = LnkFileInfo::Success;
+        const uint64_t offset = LnkFileInfo::readInteger<uint64_t>(bytes, headerSize + index * sizeof(uint64_t), error);
+        const uint32_t entrySize = LnkFileInfo::readInteger<uint32_t>(bytes, offset, error);
+        const uint32_t pathSize = LnkFileInfo::readInteger<uint32_t>(bytes, offset + sizeof(uint32_t), error);
+        if(error != LnkFileInfo::Success || entrySize > bytes.size - offset || entrySize < 2 * sizeof(uint32_t) || pathSize > entrySize - 2 * sizeof(uint32_t)){
+            return std::nullopt;
+        }
+        const char* const entry = reinterpret_cast<const char*>(bytes.data + offset);
+        return std::make_pair(std::string_view(entry + 2 * sizeof(uint32_t), pathSize), std::string_view(entry, entrySize));
+    }
+
+    /**
+     * Encodes the information about an LNK file as a cache entry. All integers are little endian, and all strings are UTF-8 encoded and prepended by their size as a 32-bit integer. Each entry consists of its whole size as a 32-bit integer, the absolute path of the LNK file, the last write time and size of the LNK file as 64-bit integers, the numeric fields, and finally the strings.
+     */
+    static std::string encodeEntry(const LnkFileInfo& lnkFileInfo){
+        std::string entry;
+        appendInteger<uint32_t>(entry, 0);    //The size of the entry, filled in at the end
+        appendString(entry, lnkFileInfo._absoluteFilePath);
+        appendInteger<uint64_t>(entry, lnkFileInfo._fileStamp.lastWriteTime);
+        appendInteger<uint64_t>(entry, lnkFileInfo._fileStamp.size);
+        appendInteger<uint32_t>(entry, lnkFileInfo._targetSize);
+        appendInteger<uint32_t>(entry, lnkFileInfo._iconIndex);
+        appendInteger<uint32_t>(entry, lnkFileInfo._targetVolumeSerial);
+        appendInteger<uint16_t>(entry, lnkFileInfo._targetAttributes);
+        appendInteger<uint8_t>(entry, lnkFileInfo._targetVolumeType);
+        appendInteger<uint8_t>(entry, lnkFileInfo._targetIsOnNetwork | lnkFileInfo._hasCustomIcon << 1);
+        appendInteger<uint64_t>(entry, lnkFileInfo._targetCreationTime);
+        appendInteger<uint64_t>(entry, lnkFileInfo._targetAccessTime);
+        appendInteger<uint64_t>(entry, lnkFileInfo._targetWriteTime);
+        appendInteger<uint16_t>(entry, lnkFileInfo._hotkey);
+        appendInteger<uint8_t>(entry, lnkFileInfo._showCommand);
+        appendString(entry, lnkFileInfo.absoluteTargetPath());
+        appendString(entry, lnkFileInfo.targetVolumeName());
+        appendString(entry, lnkFileInfo.description());
+        appendString(entry, lnkFileInfo.relativeTargetPath());
+        appendString(entry, lnkFileInfo.workingDirectory());
+        appendString(entry, lnkFileInfo.commandLineArgs());
+        appendString(entry, lnkFileInfo.iconPath());
+        const uint32_t entrySize = static_cast<uint32_t>(entry.size());
+        for(size_t i = 0; i < sizeof(uint32_t); i++){
+            entry[i] = static_cast<char>(entrySize >> (i * 8));
+        }
+        return entry;
+    }
+
+    /**
+     * Decodes a cache entry encoded by `encodeEntry()`.
+     *
+     * @param entry     The encoded entry.
+     * @param result    The object to store the information in. The file path and absolute file path must already be set.
+     *
+     * @return True if decoding the entry succeeded, false if it isn't a valid entry.
+     */
+    static bool decodeEntry(std::string_view entry, LnkFileInfo &result){
+        const ByteView bytes{reinterpret_cast<const uint8_t*>(entry.data()), entry.size()};
+        LnkFileInfo::ErrorCode error = LnkFileInfo::Success;
+        size_t i = readString(bytes, sizeof(uint32_t), nullptr, error);
+        result._fileStamp.lastWriteTime = LnkFileInfo::readInteger<uint64_t>(bytes, i, error);
+        result._fileStamp.size = LnkFileInfo::readInteger<uint64_t>(bytes, i + 8, error);
+        result._targetSize = LnkFileInfo::readInteger<uint32_t>(bytes, i + 16, error);
+        result._iconIndex = LnkFileInfo::readInteger<uint32_t>(bytes, i + 20, error);
+        result._targetVolumeSerial = LnkFileInfo::readInteger<uint32_t>(bytes, i + 24, error);
+        result._targetAttributes = LnkFileInfo::readInteger<uint16_t>(bytes, i + 28, error);
+        result._targetVolumeType = static_cast<LnkFileInfo::VolumeType>(LnkFileInfo::readInteger<uint8_t>(bytes, i + 30, error));
+        const uint8_t flags = LnkFileInfo::readInteger<uint8_t>(bytes, i + 31, error);
+        result._targetIsOnNetwork = flags & 0x01;
+        result._hasCustomIcon = flags & 0x02;
+        result._targetCreationTime = LnkFileInfo::readInteger<uint64_t>(bytes, i + 32, error);
+        result._targetAccessTime = LnkFileInfo::readInteger<uint64_t>(bytes, i + 40, error);
+        result._targetWriteTime = LnkFileInfo::readInteger<uint64_t>(bytes, i + 48, error);
+        result._hotkey = LnkFileInfo::readInteger<uint16_t>(bytes, i + 56, error);
+        result._showCommand = static_cast<LnkFileInfo::ShowCommand>(LnkFileInfo::readInteger<uint8_t>(bytes, i + 58, error));
+        i += 59;
+        for(std::string* string: {&result._targetPath, &result._targetVolumeName, &result._stringData.description, &result._stringData.relativeTargetPath, &result._stringData.workingDirectory, &result._stringData.commandLineArgs, &result._stringData.iconPath}){
+            i = readString(bytes, i, string, error);
+        }
+        return error == LnkFileInfo::Success;
+    }
+
+    /**
+     * Appends a little endian integer to a string.
+     */
+    template<typename T>
+    static void appendInteger(std::string &bytes, T value){
+        for(size_t i = 0; i < sizeof(T); i++){
+            bytes += static_cast<char>(static_cast<uint64_t>(value) >> (i * 8));
+        }
+    }
+
+    /**
+     * Appends a string prepended by its size as a 32-bit integer to a string.
+     */
+    static void appendString(std::string &bytes, const std::string& string){
+        appendInteger<uint32_t>(bytes, static_cast<uint32_t>(string.size()));
+        bytes += string;
+    }
+
+    /**
+     * Reads a string prepended by its size as a 32-bit integer.
+     *
+     * @param bytes     The bytes to read the string from.
+     * @param i         The offset of the size of the string.
+     * @param result    Set to the string, or nullptr to skip the string.
+     * @param error     Set to `IndexOutOfRange` if the string isn't within the bounds of the bytes, left unchanged otherwise.
+     *
+     * @return The offset after the end of the string.
+     */
+    static size_t readString(const ByteView &bytes, size_t i, std::string* result, LnkFileInfo::ErrorCode &error){
+        const uint32_t size = LnkFileInfo::readInteger<uint32_t>(bytes, i, error);
+        if(error != LnkFileInfo::Success || size > bytes.size - i - sizeof(uint32_t)){
+            error = LnkFileInfo::IndexOutOfRange;
+            return bytes.size;
+        }
+        if(result != nullptr){
+            result->assign(reinterpret_cast<const char*>(bytes.data + i + sizeof(uint32_t)), size);
+        }
+        return i + sizeof(uint32_t) + size;
+    }
+
+    const std::string _cacheFilePath;
+    mutable std::shared_mutex _mutex;
+    std::optional<LnkFileInfo::MappedFile> _mappedFile;
+    uint32_t _entryCount = 0;
+    std::map<std::string, std::string, std::less<>> _newEntries;    //The entries that have been added since the cache file was loaded, by absolute path
+};
+
+#endif // LNKFILECACHE_HPP
@@ -0,0 +1,291 @@
+/*
+ * LNK file carver, part of the LnkFileInfo library
+ * By Gustav Lindberg
+ * https://github.com/GustavLindberg99/LnkFileInfo
+ */
+
+#ifndef LNKFILECARVER_HPP
+#define LNKFILECARVER_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "lnkfileinfo.hpp"
+
+/**
+ * The LnkFileCarver class finds LNK files in raw bytes that don't have a file system structure, such as unallocated space, memory dumps or raw disk images.
+ *
+ * LNK files are found by searching for the signature they all start with (the header size 0x4C followed by the LinkCLSID). The search uses SSE2 or NEON when available to compare 64 positions at a time, so it runs at several gigabytes per second on data that doesn't contain the signature. Each candidate is then parsed with the same bounds-checked parser as `LnkFileInfo`, and candidates that aren't valid LNK files are skipped.
+ */
+class LnkFileCarver final {
+public:
+    /**
+     * Options that change how LNK files are carved.
+     */
+    struct Options {
+        size_t maxSize = 1024 * 1024;                                    //The maximum size of a carved LNK file. Extra data blocks that would make an LNK file larger than this are treated as missing.
+        LnkFileInfo::ParseOptions parseOptions = LnkFileInfo::NoOptions;    //The options to parse the LNK files with. `LnkFileInfo::MemoryMapped` has no effect.
+    };
+
+    /**
+     * An LNK file found in the carved bytes.
+     */
+    struct Match {
+        size_t offset;              //The offset of the first byte of the LNK file in the carved bytes.
+        size_t size;                //The size of the LNK file in bytes, computed from the sizes of its sections.
+        bool complete;              //False if the extra data at the end of the LNK file is truncated or doesn't end with a terminal block, in which case `size` only includes the complete blocks.
+        LnkFileInfo lnkFileInfo;    //The parsed LNK file. Its `filePath()` and `absoluteFilePath()` are empty.
+    };
+
+    /**
+     * Returns the offset of the next LNK header signature in the given bytes, or `size` if there is none.
+     *
+     * @param data      A pointer to the bytes to search.
+     * @param size      The number of bytes pointed to by `data`.
+     * @param offset    The offset to start searching at.
+     */
+    static size_t findSignature(const uint8_t* data, size_t size, size_t offset = 0) noexcept {
+        constexpr size_t signatureSize = sizeof(LnkFileInfo::headerSignature);
+        if(size < signatureSize){
+            return size;
+        }
+        const size_t lastOffset = size - signatureSize;
+
+        //Compare the first and the last byte of the signature at 16 positions at a time, and only compare the whole signature where both match
+        #if defined(LNKFILEINFO_SSE2)
+            const __m128i firstByte = _mm_set1_epi8(static_cast<char>(LnkFileInfo::headerSignature[0]));
+            const __m128i lastByte = _mm_set1_epi8(static_cast<char>(LnkFileInfo::headerSignature[signatureSize - 1]));
+            const auto candidates = [&](size_t position){
+                const __m128i first = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position)), firstByte);
+                const __m128i last = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position + signatureSize - 1)), lastByte);
+                return _mm_and_si128(first, last);
+            };
+            for(; offset + 16 <= lastOffset + 1; offset += 16){
+                //Blocks of 64 positions where the bytes don't match anywhere are skipped with a single test
+                while(offset + 64 <= lastOffset + 1 && _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(candidates(offset), candidates(offset + 16)), _mm_or_si128(candidates(offset + 32), candidates(offset + 48)))) == 0){
+                    offset += 64;
+                }
+                if(offset + 16 > lastOffset + 1){
+                    break;
+                }
+                for(uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(candidates(offset))); mask != 0; mask &= mask - 1){
+                    const size_t candidate = offset + countTrailingZeros(mask);
+                    if(std::memcmp(data + candidate, LnkFileInfo::headerSignature, signatureSize) == 0){
+                        return candidate;
+                    }
+                }
+            }
+        #elif defined(LNKFILEINFO_NEON)
+            const uint8x16_t firstByte = vdupq_n_u8(LnkFileInfo::headerSignature[0]);
+            const uint8x16_t lastByte = vdupq_n_u8(LnkFileInfo::headerSignature[signatureSize - 1]);
+            const auto candidates = [&](size_t position){
+                return vandq_u8(vceqq_u8(vld1q_u8(data + position), firstByte), vceqq_u8(vld1q_u8(data + position + signatureSize - 1), lastByte));
+            };
+            for(; offset + 16 <= lastOffset + 1; offset += 16){
+                //Blocks of 64 positions where the bytes don't match anywhere are skipped with a single test
+                while(offset + 64 <= lastOffset + 1 && vmaxvq_u8(vorrq_u8(vorrq_u8(candidates(offset), candidates(offset + 16)), vorrq_u8(candidates(offset + 32), candidates(offset + 48)))) == 0){
+                    offset += 64;
+                }
+                if(offset + 16 > lastOffset + 1){
+                    break;
+                }
+                //Narrowing each 16-bit lane by four bits gives a 64-bit mask with four bits per byte
+                for(uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(candidates(offset)), 4)), 0); mask != 0; mask &= ~(uint64_t(0xF) << (countTrailingZeros(mask) & ~3u))){
+                    const size_t candidate = offset + countTrailingZeros(mask) / 4;
+                    if(std::memcmp(data + candidate, LnkFileInfo::headerSignature, signatureSize) == 0){
+                        return candidate;
+                    }
+                }
+            }
+        #endif
+        for(; offset <= lastOffset; offset++){
+            if(data[offset] == LnkFileInfo::headerSignature[0] && std::memcmp(data + offset, LnkFileInfo::headerSignature, signatureSize) == 0){
+                return offset;
+            }
+        }
+        return size;
+    }
+
+    /**
+     * Finds and parses all LNK files in the given bytes. LNK files can't overlap, so the search continues after the end of each LNK file that is found.
+     *
+     * @param data      A pointer to the bytes to carve.
+     * @param size      The number of bytes pointed to by `data`.
+     * @param options   Options that change how LNK files are carved.
+     * @param callback  Called once for each LNK file that is found, in increasing order of offset.
+     */
+    static void carve(const uint8_t* data, size_t size, const Options& options, const std::function<void(Match&&)>& callback){
+        const LnkFileInfo::ParseOptions parseOptions = options.parseOptions & ~LnkFileInfo::MemoryMapped;
+        for(size_t offset = findSignature(data, size); offset < size; offset = findSignature(data, size, offset)){
+            bool complete = false;
+            const size_t linkSize = computeLinkSize(LnkFileInfo::ByteView{data + offset, std::min(size - offset, options.maxSize)}, complete);
+            if(linkSize != 0){
+                LnkFileInfo::ErrorCode error;
+                std::optional<LnkFileInfo> lnkFileInfo = LnkFileInfo::tryParse(data + offset, linkSize, error, "", parseOptions);
+                if(lnkFileInfo.has_value()){
+                    callback(Match{offset, linkSize, complete, std::move(*lnkFileInfo)});
+                    offset += linkSize;
+                    continue;
+                }
+            }
+            offset++;
+        }
+    }
+
+    /**
+     * Same as above, but returns the LNK files in a vector instead of passing them to a callback.
+     *
+     * @param data      A pointer to the bytes to carve.
+     * @param size      The number of bytes pointed to by `data`.
+     * @param options   Options that change how LNK files are carved.
+     *
+     * @return The LNK files in increasing order of offset.
+     */
+    static std::vector<Match> carve(const uint8_t* data, size_t size, const Options& options){
+        std::vector<Match> matches;
+        carve(data, size, options, [&matches](Match&& match){
+            matches.push_back(std::move(match));
+        });
+        return matches;
+    }
+
+    /**
+     * Equivalent to `carve(data, size, LnkFileCarver::Options())`.
+     */
+    static std::vector<Match> carve(const uint8_t* data, size_t size){
+        return carve(data, size, Options());
+    }
+
+    /**
+     * Maps the given file into memory and finds and parses all LNK files in it. The offsets in the matches are offsets in the file. Files that can't be mapped into memory are read instead.
+     *
+     * @param filePath  The path of the file to carve, such as a raw disk image, encoded in UTF-8.
+     * @param options   Options that change how LNK files are carved.
+     * @param callback  Called once for each LNK file that is found, in increasing order of offset.
+     *
+     * @throws LnkFileInfo::IoError if the file can't be opened or read.
+     */
+    static void carveFile(const std::string& filePath, const Options& options, const std::function<void(Match&&)>& callback){
+        const LnkFileInfo::MappedFile mappedFile(filePath);
+        if(mappedFile.isMapped()){
+            carve(mappedFile.bytes().data, mappedFile.bytes().size, options, callback);
+            return;
+        }
+
+        //Files that can't be mapped, such as empty files and pipes, are read into memory instead
+        std::vector<uint8_t> buffer;
+        LnkFileInfo::FileStamp fileStamp;
+        const LnkFileInfo::ErrorCode error = LnkFileInfo::readFile(filePath, buffer, fileStamp);
+        if(error != LnkFileInfo::Success){
+            throw LnkFileInfo::IoError(std::filesystem::filesystem_error(error == LnkFileInfo::OpenFailed ? "Could not open file" : "Could not read file", std::filesystem::path(filePath), std::make_error_code(std::errc::io_error)));
+        }
+        carve(buffer.data(), buffer.size(), options, callback);
+    }
+
+    /**
+     * Same as above, but returns the LNK files in a vector instead of passing them to a callback.
+     *
+     * @param filePath  The path of the file to carve, encoded in UTF-8.
+     * @param options   Options that change how LNK files are carved.
+     *
+     * @return The LNK files in increasing order of offset.
+     *
+     * @throws LnkFileInfo::IoError if the file can't be opened or read.
+     */
+    static std::vector<Match> carveFile(const std::string& filePath, const Options& options){
+        std::vector<Match> matches;
+        carveFile(filePath, options, [&matches](Match&& match){
+            matches.push_back(std::move(match));
+        });
+        return matches;
+    }
+
+    /**
+     * Equivalent to `carveFile(filePath, LnkFileCarver::Options())`.
+     */
+    static std::vector<Match> carveFile(const std::string& filePath){
+        return carveFile(filePath, Options());
+    }
+
+private:
+    static unsigned int countTrailingZeros(uint64_t value) noexcept {
+        #if defined(__GNUC__) || defined(__clang__)
+            return static_cast<unsigned int>(__builtin_ctzll(value));
+        #else
+            //Candidates are rare, so a loop is fast enough
+            unsigned int result = 0;
+            while(!(value & 1)){
+                value >>= 1;
+                result++;
+            }
+            return result;
+        #endif
+    }
+
+    /**
+     * Computes the size of the LNK file at the start of the given bytes from the sizes of its sections: the header, the optional LinkTargetIDList, LinkInfo and StringData sections, and the extra data blocks, which end with a terminal block whose size is less than 4.
+     *
+     * @param bytes     The bytes starting at the LNK header.
+     * @param complete  Set to true if the extra data ends with a terminal block within `bytes`, and to false otherwise.
+     *
+     * @return The size of the LNK file, or zero if the sections before the extra data don't fit in `bytes`.
+     */
+    static size_t computeLinkSize(const LnkFileInfo::ByteView &bytes, bool &complete) noexcept {
+        constexpr uint32_t isUnicode = 0x80;
+        if(bytes.size < 0x4C){
+            return 0;
+        }
+        LnkFileInfo::ErrorCode error = LnkFileInfo::Success;
+        const uint32_t flags = LnkFileInfo::readInteger<uint32_t>(bytes, 20, error);
+        size_t offset = 0x4C;
+        bool inBounds = true;
+        const auto skip = [&bytes, &offset, &inBounds](size_t sectionSize){
+            if(sectionSize > bytes.size - offset){
+                inBounds = false;
+            }
+            else{
+                offset += sectionSize;
+            }
+        };
+        if(flags & LnkFileInfo::HasShellIdList){
+            skip(2 + static_cast<size_t>(LnkFileInfo::readInteger<uint16_t>(bytes, offset, error)));
+        }
+        //This flag means that the LinkInfo section is present
+        if(inBounds && flags & LnkFileInfo::PointsToFileDir){
+            skip(LnkFileInfo::readInteger<uint32_t>(bytes, offset, error));
+        }
+        for(const LnkFileInfo::Flag flag: {LnkFileInfo::HasDescription, LnkFileInfo::HasRelativePath, LnkFileInfo::HasWorkingDirectory, LnkFileInfo::HasCommandLineArgs, LnkFileInfo::HasCustomIcon}){
+            if(inBounds && flags & flag){
+                skip(2 + static_cast<size_t>(LnkFileInfo::readInteger<uint16_t>(bytes, offset, error)) * (flags & isUnicode ? 2 : 1));
+            }
+        }
+        if(!inBounds || error != LnkFileInfo::Success){
+            return 0;
+        }
+
+        complete = false;
+        for(;;){
+            const uint32_t blockSize = LnkFileInfo::readInteger<uint32_t>(bytes, offset, error);
+            if(error != LnkFileInfo::Success){
+                return offset;
+            }
+            if(blockSize < 4){
+                complete = true;
+                return offset + 4;
+            }
+            if(blockSize > bytes.size - offset){
+                return offset;
+            }
+            offset += blockSize;
+        }
+    }
+};
+
+#endif // LNKFILECARVER_HPP
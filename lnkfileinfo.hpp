@@ -9,14 +9,41 @@
 #ifndef LNKFILEINFO_HPP
 #define LNKFILEINFO_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
 #include <cstdint>
+#include <cstring>
+#include <deque>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LNKFILEINFO_SSE2
+#include <emmintrin.h>
+#elif (defined(__ARM_NEON) && defined(__aarch64__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || defined(_M_ARM64)
+#define LNKFILEINFO_NEON
+#include <arm_neon.h>
+#endif
+
 #ifdef _WIN32
 #include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
 /**
@@ -56,6 +83,342 @@ public:
         RamDrive        = 6
     };
 
+    /**
+     * This enum is used to change how the constructor and `refresh()` read and parse the LNK file. Several options can be combined using the `|` operator.
+     */
+    enum ParseOption: uint32_t {
+        NoOptions    = 0x00,
+        MemoryMapped = 0x01,   //Map the file into memory instead of reading it. Falls back to reading the file if mapping it fails.
+        LazyStrings  = 0x02,   //Keep the bytes of the LNK file in memory and only decode the description, relative target path, working directory, command line arguments and icon path the first time they're needed. The strings can be decoded from several threads at the same time.
+        TargetOnly   = 0x04,   //Stop parsing after the target and volume information. The description, relative target path, working directory, command line arguments, icon path and extra data are left empty.
+        IdList       = 0x08,   //Copy the items of the LinkTargetIDList so that they can be read with `idList()`. A malformed item ends the list, it doesn't make the LNK file invalid.
+        ExtraData    = 0x10,   //Decode the TrackerDataBlock, EnvironmentVariableDataBlock and KnownFolderDataBlock at the end of the LNK file. A malformed block ends the extra data, it doesn't make the LNK file invalid. Has no effect with `TargetOnly`.
+        AbsolutePath = 0x20    //The file path is already absolute, for example because it comes from a directory iterator, so `absoluteFilePath()` returns it as is instead of calling `std::filesystem::absolute`.
+    };
+
+    /**
+     * A combination of zero or more `LnkFileInfo::ParseOption` values.
+     */
+    using ParseOptions = uint32_t;
+
+    /**
+     * This enum is used together with the `showCommand` method to indicate how the target's window is shown when the LNK file is opened.
+     */
+    enum ShowCommand: uint8_t {
+        ShowNormal    = 1,
+        ShowMaximized = 3,
+        ShowMinimized = 7
+    };
+
+    /**
+     * This enum is used together with the `hotkeyModifiers` method to check which modifier keys are part of the hotkey of the LNK file.
+     */
+    enum HotkeyModifier: uint8_t {
+        HotkeyShift   = 0x01,
+        HotkeyControl = 0x02,
+        HotkeyAlt     = 0x04
+    };
+
+    /**
+     * A GUID, such as the identifiers in the TrackerDataBlock and KnownFolderDataBlock of an LNK file.
+     */
+    struct Guid {
+        uint8_t bytes[16] = {};    //In the order they're stored in the LNK file, i.e. with the first three groups in little endian
+
+        /**
+         * Returns the GUID in the registry format, for example `{F3CE0F7C-4901-4ACC-8648-D5D44B04EF8F}`.
+         */
+        std::string toString() const {
+            constexpr char hexDigits[] = "0123456789ABCDEF";
+            constexpr int order[16] = {3, 2, 1, 0, 5, 4, 7, 6, 8, 9, 10, 11, 12, 13, 14, 15};
+            std::string result = "{";
+            for(int i = 0; i < 16; i++){
+                if(i == 4 || i == 6 || i == 8 || i == 10){
+                    result += '-';
+                }
+                result += hexDigits[this->bytes[order[i]] >> 4];
+                result += hexDigits[this->bytes[order[i]] & 0x0F];
+            }
+            return result + '}';
+        }
+
+        /**
+         * Returns `true` if all bytes of the GUID are zero, which is the case if the LNK file doesn't contain it.
+         */
+        bool isNull() const noexcept {
+            return *this == Guid();
+        }
+
+        bool operator==(const Guid &other) const noexcept {
+            return std::memcmp(this->bytes, other.bytes, sizeof(this->bytes)) == 0;
+        }
+
+        bool operator!=(const Guid &other) const noexcept {
+            return !(*this == other);
+        }
+    };
+
+    /**
+     * A pool of strings that several LnkFileInfo objects can share with `internStrings()`, so that strings that appear in many LNK files, such as common target paths, volume names, working directories and icon paths, are only stored once. This class is thread safe.
+     */
+    class StringPool final {
+    public:
+        /**
+         * Returns the string in the pool that is equal to the given string, adding it to the pool if it isn't there yet. The returned reference remains valid as long as the pool exists, so two strings that were interned in the same pool are equal if and only if they have the same address.
+         */
+        const std::string& intern(std::string_view string){
+            const std::lock_guard lock(this->_mutex);
+            const auto existing = this->_index.find(string);
+            if(existing != this->_index.end()){
+                return *existing->second;
+            }
+            const std::string &result = this->_strings.emplace_back(string);
+            this->_index.emplace(result, &result);
+            return result;
+        }
+
+        /**
+         * Returns the number of distinct strings in the pool.
+         */
+        size_t size() const {
+            const std::lock_guard lock(this->_mutex);
+            return this->_strings.size();
+        }
+
+    private:
+        mutable std::mutex _mutex;
+        std::deque<std::string> _strings;    //A deque is used since adding elements to it doesn't move the existing ones
+        std::unordered_map<std::string_view, const std::string*> _index;
+    };
+
+    /**
+     * A condition that LNK files must match, which can be checked while parsing them so that LNK files that don't match are rejected as early as possible. The attributes are checked right after the header, before anything else is parsed, and the other conditions are checked once the target and volume information has been decoded. The ID list and the StringData and ExtraData sections of LNK files that don't match are never decoded.
+     */
+    struct Filter {
+        uint16_t requiredAttributes = 0;                    //A combination of `LnkFileInfo::Attribute` values that the target must all have.
+        uint16_t excludedAttributes = 0;                    //A combination of `LnkFileInfo::Attribute` values that the target must not have any of.
+        uint8_t volumeTypes = 0;                            //If not zero, the target volume type must be one of these, as a combination of `LnkFileInfo::volumeTypeMask()` values.
+        std::optional<bool> targetIsOnNetwork;              //If not `std::nullopt`, the value that `targetIsOnNetwork()` must have.
+        std::string targetPathPattern;                      //If not empty, a pattern that `absoluteTargetPath()` must match, where `*` matches any sequence of characters and `?` matches any single character. ASCII letters are compared case insensitively, like paths on Windows.
+        std::function<bool(const LnkFileInfo&)> predicate;  //If not null, called after the other conditions have matched, and the LNK file only matches if it returns true. When parsing, it's called before the StringData section is decoded, so only the header fields and the target and volume information can be used in it.
+
+        /**
+         * Returns true if the given LNK file matches all conditions of this filter.
+         */
+        bool matches(const LnkFileInfo &lnkFileInfo) const {
+            return this->matchesAttributes(lnkFileInfo._targetAttributes) && this->matchesTarget(lnkFileInfo);
+        }
+
+    private:
+        friend class LnkFileInfo;
+
+        bool matchesAttributes(uint16_t attributes) const noexcept {
+            return (attributes & this->requiredAttributes) == this->requiredAttributes && !(attributes & this->excludedAttributes);
+        }
+
+        bool matchesTarget(const LnkFileInfo &lnkFileInfo) const {
+            return (this->volumeTypes == 0 || this->volumeTypes & volumeTypeMask(lnkFileInfo._targetVolumeType))
+                && (!this->targetIsOnNetwork.has_value() || *this->targetIsOnNetwork == lnkFileInfo._targetIsOnNetwork)
+                && (this->targetPathPattern.empty() || matchesPattern(lnkFileInfo.absoluteTargetPath(), this->targetPathPattern))
+                && (!this->predicate || this->predicate(lnkFileInfo));
+        }
+
+        /**
+         * Matches a UTF-8 string against a pattern containing `*` and `?` wildcards. This is done in constant space by only remembering the position after the last `*`, since once a `*` has been reached, letting an earlier `*` match more characters can never make the rest of the pattern match where it didn't already.
+         */
+        static bool matchesPattern(std::string_view string, std::string_view pattern) noexcept {
+            const auto lower = [](char c){
+                return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+            };
+            const auto characterEnd = [&string](size_t i){
+                //Skip the continuation bytes of a multi-byte character
+                for(i++; i < string.size() && (static_cast<uint8_t>(string[i]) & 0xC0) == 0x80; i++);
+                return i;
+            };
+            size_t s = 0, p = 0;
+            size_t starPattern = std::string_view::npos, starString = 0;
+            while(s < string.size()){
+                if(p < pattern.size() && pattern[p] == '*'){
+                    if(++p == pattern.size()){
+                        //A trailing `*` matches the rest of the string
+                        return true;
+                    }
+                    starPattern = p;
+                    starString = s;
+                }
+                else if(p < pattern.size() && pattern[p] == '?'){
+                    s = characterEnd(s);
+                    p++;
+                }
+                else if(p < pattern.size() && lower(pattern[p]) == lower(string[s])){
+                    s++;
+                    p++;
+                }
+                else if(starPattern != std::string_view::npos){
+                    //Let the last `*` match one more character and try the rest of the pattern again. If the rest of the pattern starts with a literal character, the `*` can directly match everything up to the next occurrence of it.
+                    p = starPattern;
+                    starString = characterEnd(starString);
+                    if(pattern[p] != '?'){
+                        const char next = lower(pattern[p]);
+                        for(; starString < string.size() && lower(string[starString]) != next; starString++);
+                    }
+                    s = starString;
+                }
+                else{
+                    return false;
+                }
+            }
+            while(p < pattern.size() && pattern[p] == '*'){
+                p++;
+            }
+            return p == pattern.size();
+        }
+    };
+
+    /**
+     * Returns the bit corresponding to the given volume type in `LnkFileInfo::Filter::volumeTypes`, for example `LnkFileInfo::volumeTypeMask(LnkFileInfo::Removable) | LnkFileInfo::volumeTypeMask(LnkFileInfo::CdRom)`.
+     */
+    static constexpr uint8_t volumeTypeMask(VolumeType volumeType) noexcept {
+        return volumeType < 8 ? static_cast<uint8_t>(1 << volumeType) : 0;
+    }
+
+    /**
+     * This enum is used by the non-throwing `tryOpen`, `tryParse`, `tryRefresh` and `tryRefreshIfChanged` methods to indicate why reading an LNK file failed.
+     */
+    enum ErrorCode: uint8_t {
+        Success               = 0,
+        OpenFailed            = 1,    //Opening the file or getting its absolute path failed. Corresponds to LnkFileInfo::IoError.
+        ReadFailed            = 2,    //Reading the file failed after it was opened. Corresponds to LnkFileInfo::IoError.
+        InvalidHeader         = 3,    //The file doesn't start with an LNK header. Corresponds to LnkFileInfo::InvalidLnkFile.
+        InvalidFileinfoHeader = 4,    //The LinkInfo section has an unknown header. Corresponds to LnkFileInfo::InvalidLnkFile.
+        IndexOutOfRange       = 5     //The file is truncated or contains an offset pointing outside of the file. Corresponds to LnkFileInfo::InvalidLnkFile.
+    };
+
+    /**
+     * A cache of parsed LNK files indexed by their contents, so that LNK files with the same contents are only parsed once, for example the many identical copies of the same Start Menu shortcuts in roaming profiles and VDI images. When an LNK file has the same contents as one that is already in the cache and is parsed with the same options, its information is copied from the cache instead of being parsed, and only its path differs. The strings of the cached LNK files are interned in a pool owned by the cache, so most strings aren't copied either, and the LnkFileInfo objects whose information comes from the cache keep that pool alive. The entries are split into shards by the hash of the contents, each with its own lock, and no lock is held while an LNK file is parsed. So threads looking up different contents rarely wait for each other, but threads that miss on the same contents at the same time each parse it, and only the first result is kept.
+     */
+    class ContentCache final {
+    public:
+        /**
+         * Same as `LnkFileInfo::tryOpen()`, but uses the information in the cache if an LNK file with the same contents has already been parsed, and adds the information to the cache otherwise.
+         */
+        std::optional<LnkFileInfo> tryOpen(std::string filePath, ErrorCode &error, ParseOptions options = NoOptions){
+            return LnkFileInfo::tryOpen(std::move(filePath), error, options, nullptr, this);
+        }
+
+        /**
+         * Same as `LnkFileInfo::tryParse()`, but uses the information in the cache if an LNK file with the same contents has already been parsed, and adds the information to the cache otherwise.
+         */
+        std::optional<LnkFileInfo> tryParse(const uint8_t* data, size_t size, ErrorCode &error, std::string filePath = "", ParseOptions options = NoOptions){
+            return LnkFileInfo::tryParse(data, size, error, std::move(filePath), options, nullptr, this);
+        }
+
+        /**
+         * Returns the number of distinct LNK files in the cache.
+         */
+        size_t size() const {
+            size_t result = 0;
+            for(const Shard &shard: this->_shards){
+                const std::lock_guard lock(shard.mutex);
+                result += shard.entries.size();
+            }
+            return result;
+        }
+
+        /**
+         * Returns the number of times the information about an LNK file was found in the cache.
+         */
+        uint64_t hits() const {
+            uint64_t result = 0;
+            for(const Shard &shard: this->_shards){
+                const std::lock_guard lock(shard.mutex);
+                result += shard.hits;
+            }
+            return result;
+        }
+
+    private:
+        friend class LnkFileInfo;
+
+        struct Entry {
+            std::vector<uint8_t> bytes;                     //The contents of the LNK file, compared on lookup so that hash collisions can't give wrong results
+            ParseOptions options;                           //The options that change what is decoded
+            std::shared_ptr<const LnkFileInfo> lnkFileInfo; //With all strings decoded and interned, and without a path
+        };
+
+        /**
+         * The cache is split into shards with their own lock by the hash of the contents, so that threads only wait for each other when they look up LNK files in the same shard.
+         */
+        struct Shard {
+            mutable std::mutex mutex;
+            std::unordered_multimap<uint64_t, Entry> entries;
+            uint64_t hits = 0;
+        };
+
+        static constexpr size_t shardCount = 16;
+
+        /**
+         * The options that change the information that is decoded from an LNK file, which must be the same for the cached information to be used.
+         */
+        static ParseOptions decodingOptions(ParseOptions options) noexcept {
+            return options & (ParseOption::TargetOnly | ParseOption::IdList | ParseOption::ExtraData);
+        }
+
+        /**
+         * If an LNK file with the given contents is in the cache, copies its information into the given LnkFileInfo object and returns true.
+         */
+        bool copyTo(LnkFileInfo &lnkFileInfo, const uint8_t* data, size_t size, uint64_t contentHash){
+            std::shared_ptr<const LnkFileInfo> cached;
+            {
+                Shard &shard = this->_shards[contentHash % shardCount];
+                const std::lock_guard lock(shard.mutex);
+                const Entry* entry = find(shard, data, size, contentHash, decodingOptions(lnkFileInfo._options));
+                if(entry == nullptr){
+                    return false;
+                }
+                cached = entry->lnkFileInfo;
+                shard.hits++;
+            }
+            lnkFileInfo.copyContents(*cached);
+            return true;
+        }
+
+        /**
+         * Adds the information about an LNK file that was just parsed from the given contents to the cache.
+         */
+        void add(const LnkFileInfo &lnkFileInfo, const uint8_t* data, size_t size, uint64_t contentHash){
+            //The strings are decoded and interned before taking the lock since they're the same no matter which thread adds them
+            std::shared_ptr<LnkFileInfo> cached = std::make_shared<LnkFileInfo>(lnkFileInfo);
+            cached->description();
+            cached->commandLineArgs();
+            cached->internStrings(this->_pool);
+            cached->_stringData.retained.reset();
+            std::string().swap(cached->_filePath);
+            std::string().swap(cached->_absoluteFilePath);
+
+            const ParseOptions options = decodingOptions(lnkFileInfo._options);
+            Shard &shard = this->_shards[contentHash % shardCount];
+            const std::lock_guard lock(shard.mutex);
+            if(find(shard, data, size, contentHash, options) == nullptr){
+                shard.entries.emplace(contentHash, Entry{std::vector<uint8_t>(data, data + size), options, std::move(cached)});
+            }
+        }
+
+        static const Entry* find(const Shard &shard, const uint8_t* data, size_t size, uint64_t contentHash, ParseOptions options) noexcept {
+            const auto [begin, end] = shard.entries.equal_range(contentHash);
+            for(auto it = begin; it != end; ++it){
+                const Entry &entry = it->second;
+                if(entry.options == options && entry.bytes.size() == size && std::equal(entry.bytes.begin(), entry.bytes.end(), data)){
+                    return &entry;
+                }
+            }
+            return nullptr;
+        }
+
+        Shard _shards[shardCount];
+        std::shared_ptr<StringPool> _pool = std::make_shared<StringPool>();
+    };
+
     /**
      * Base class of any exception that is thrown from this library.
      */
@@ -79,56 +442,261 @@ public:
         using Exception::Exception;
     };
 
+    /**
+     * Statistics about reading and parsing LNK files, used to find out whether reading many LNK files is slow because of the storage or because of the CPU. They are only recorded if `LNKFILEINFO_STATS` is defined before including this header, otherwise they're always zero and recording them has no overhead.
+     */
+    struct ParseStats {
+        #ifdef LNKFILEINFO_STATS
+            static constexpr bool enabled = true;
+        #else
+            static constexpr bool enabled = false;
+        #endif
+
+        uint64_t filesParsed = 0;                       //The number of times the contents of an LNK file were parsed, whether parsing succeeded or not.
+        uint64_t bytesRead = 0;                         //The number of bytes read or memory mapped from files.
+        uint64_t readNanoseconds = 0;                   //Time spent opening, reading and memory mapping files.
+        uint64_t absolutePathNanoseconds = 0;           //Time spent making file paths absolute.
+        uint64_t validateNanoseconds = 0;               //Time spent checking the header and the offsets of the sections.
+        uint64_t linkInfoNanoseconds = 0;               //Time spent decoding the header, the ID list and the LinkInfo section.
+        uint64_t stringDataNanoseconds = 0;             //Time spent decoding the StringData and ExtraData sections, including strings decoded later with `LnkFileInfo::LazyStrings`.
+        uint64_t stringAllocations = 0;                 //The number of times a decoded string needed a larger buffer.
+        uint64_t errors[ErrorCode::IndexOutOfRange + 1] = {};    //The number of times each error occurred, indexed by error code. `errors[LnkFileInfo::Success]` is always zero.
+
+        /**
+         * Returns the time spent waiting for the file system.
+         */
+        uint64_t ioNanoseconds() const noexcept {
+            return this->readNanoseconds + this->absolutePathNanoseconds;
+        }
+
+        /**
+         * Returns the time spent parsing bytes that are already in memory.
+         */
+        uint64_t cpuNanoseconds() const noexcept {
+            return this->validateNanoseconds + this->linkInfoNanoseconds + this->stringDataNanoseconds;
+        }
+
+        /**
+         * Returns the total number of errors of any kind.
+         */
+        uint64_t errorCount() const noexcept {
+            uint64_t result = 0;
+            for(const uint64_t count: this->errors){
+                result += count;
+            }
+            return result;
+        }
+
+        ParseStats& operator+=(const ParseStats &other) noexcept {
+            this->filesParsed += other.filesParsed;
+            this->bytesRead += other.bytesRead;
+            this->readNanoseconds += other.readNanoseconds;
+            this->absolutePathNanoseconds += other.absolutePathNanoseconds;
+            this->validateNanoseconds += other.validateNanoseconds;
+            this->linkInfoNanoseconds += other.linkInfoNanoseconds;
+            this->stringDataNanoseconds += other.stringDataNanoseconds;
+            this->stringAllocations += other.stringAllocations;
+            for(size_t i = 0; i < std::size(this->errors); i++){
+                this->errors[i] += other.errors[i];
+            }
+            return *this;
+        }
+
+        /**
+         * Returns the statistics that were recorded between an earlier snapshot and this one.
+         */
+        ParseStats operator-(const ParseStats &earlier) const noexcept {
+            ParseStats result = *this;
+            result.filesParsed -= earlier.filesParsed;
+            result.bytesRead -= earlier.bytesRead;
+            result.readNanoseconds -= earlier.readNanoseconds;
+            result.absolutePathNanoseconds -= earlier.absolutePathNanoseconds;
+            result.validateNanoseconds -= earlier.validateNanoseconds;
+            result.linkInfoNanoseconds -= earlier.linkInfoNanoseconds;
+            result.stringDataNanoseconds -= earlier.stringDataNanoseconds;
+            result.stringAllocations -= earlier.stringAllocations;
+            for(size_t i = 0; i < std::size(result.errors); i++){
+                result.errors[i] -= earlier.errors[i];
+            }
+            return result;
+        }
+    };
+
+    /**
+     * Returns the statistics recorded on the calling thread since it started or since they were last reset, for example with `LnkFileInfo::threadStats() = LnkFileInfo::ParseStats()`. The batch classes such as LnkFileScanner can also add up the statistics of their worker threads with their `stats` option. If `LNKFILEINFO_STATS` isn't defined, nothing is ever recorded.
+     */
+    static ParseStats& threadStats() noexcept {
+        thread_local ParseStats stats;
+        return stats;
+    }
+
     /**
      * Constructs a new LnkFileInfo object that gives information about the given LNK file.
      *
      * @param filePath  The path of the LNK file. Can be an absolute or a relative path.
+     * @param options   How to read and parse the LNK file, as a combination of `LnkFileInfo::ParseOption` values. These options are also used by `refresh()`.
      *
      * @throws LnkFileInfo::IoError if opening the file failed.
      * @throws LnkFileInfo::InvalidLnkFile if the file is not a valid LNK file. Does *not* throw if the LNK file is valid but the target doesn't exist, use `std::filesystem::exists(lnkFileInfo.absoluteTargetPath())` to check for that.
      */
-    explicit LnkFileInfo(std::string filePath): _filePath(std::move(filePath)) {
+    explicit LnkFileInfo(std::string filePath, ParseOptions options = NoOptions): _filePath(std::move(filePath)), _options(options) {
         this->refresh();
-        try{
-            this->_absoluteFilePath = std::filesystem::absolute(this->filePath()).string();
-        }
-        catch(const std::filesystem::filesystem_error& e){
-            throw IoError(e);
+        this->updateAbsoluteFilePathOrThrow();
+    }
+
+    /**
+     * Constructs a new LnkFileInfo object that gives information about an LNK file whose contents have already been loaded into memory, for example from a disk image, an archive or a network stream. The bytes are parsed directly without accessing the file system, and are not retained after the constructor returns.
+     *
+     * @param data      A pointer to the bytes of the LNK file.
+     * @param size      The number of bytes pointed to by `data`.
+     * @param filePath  The path the bytes were read from, if any. This is returned as is by `filePath()` and `absoluteFilePath()` and is used in exception messages, but the file system is never accessed.
+     * @param options   How to parse the LNK file, as a combination of `LnkFileInfo::ParseOption` values. If `LnkFileInfo::LazyStrings` is given, a copy of the bytes is retained.
+     *
+     * @throws LnkFileInfo::InvalidLnkFile if the bytes are not a valid LNK file.
+     */
+    LnkFileInfo(const uint8_t* data, size_t size, std::string filePath = "", ParseOptions options = NoOptions): _filePath(std::move(filePath)), _options(options) {
+        this->throwIfError(this->parse(ByteView{data, size}));
+        this->setAbsoluteFilePath(this->_filePath);
+    }
+
+    /**
+     * Constructs a new LnkFileInfo object that gives information about an LNK file whose contents have already been loaded into memory. Equivalent to `LnkFileInfo(bytes.data(), bytes.size(), filePath, options)`.
+     *
+     * @throws LnkFileInfo::InvalidLnkFile if the bytes are not a valid LNK file.
+     */
+    explicit LnkFileInfo(const std::vector<uint8_t>& bytes, std::string filePath = "", ParseOptions options = NoOptions): LnkFileInfo(bytes.data(), bytes.size(), std::move(filePath), options) {}
+
+    /**
+     * Same as the `LnkFileInfo(std::string, ParseOptions)` constructor, but doesn't throw an exception if reading the LNK file fails. This is faster than catching the exception when many of the files being read may not be valid LNK files.
+     *
+     * @param filePath  The path of the LNK file. Can be an absolute or a relative path.
+     * @param error     Set to `LnkFileInfo::Success` if reading the LNK file succeeded, and to the reason it failed otherwise.
+     * @param options   How to read and parse the LNK file, as a combination of `LnkFileInfo::ParseOption` values.
+     *
+     * @return The LnkFileInfo object, or `std::nullopt` if reading the LNK file failed.
+     */
+    static std::optional<LnkFileInfo> tryOpen(std::string filePath, ErrorCode &error, ParseOptions options = NoOptions){
+        return tryOpen(std::move(filePath), error, options, nullptr, nullptr);
+    }
+
+    /**
+     * Same as `tryOpen(std::string, ErrorCode&, ParseOptions)`, but only returns the LnkFileInfo object if the LNK file matches the given filter. The parts of the LNK file that are needed to check the filter are parsed first, and the rest is only parsed if it matches.
+     *
+     * @return The LnkFileInfo object, or `std::nullopt` if reading the LNK file failed or if it doesn't match the filter. If it doesn't match, `error` is set to `LnkFileInfo::Success`.
+     */
+    static std::optional<LnkFileInfo> tryOpen(std::string filePath, ErrorCode &error, ParseOptions options, const Filter &filter){
+        return tryOpen(std::move(filePath), error, options, &filter, nullptr);
+    }
+
+    /**
+     * Same as the `LnkFileInfo(const uint8_t*, size_t, std::string, ParseOptions)` constructor, but doesn't throw an exception if the bytes are not a valid LNK file.
+     *
+     * @param data      A pointer to the bytes of the LNK file.
+     * @param size      The number of bytes pointed to by `data`.
+     * @param error     Set to `LnkFileInfo::Success` if the bytes are a valid LNK file, and to the reason they aren't otherwise.
+     * @param filePath  The path the bytes were read from, if any.
+     * @param options   How to parse the LNK file, as a combination of `LnkFileInfo::ParseOption` values.
+     *
+     * @return The LnkFileInfo object, or `std::nullopt` if the bytes are not a valid LNK file.
+     */
+    static std::optional<LnkFileInfo> tryParse(const uint8_t* data, size_t size, ErrorCode &error, std::string filePath = "", ParseOptions options = NoOptions){
+        return tryParse(data, size, error, std::move(filePath), options, nullptr, nullptr);
+    }
+
+    /**
+     * Same as `tryParse(const uint8_t*, size_t, ErrorCode&, std::string, ParseOptions)`, but only returns the LnkFileInfo object if the LNK file matches the given filter.
+     *
+     * @return The LnkFileInfo object, or `std::nullopt` if the bytes are not a valid LNK file or if they don't match the filter. If they don't match, `error` is set to `LnkFileInfo::Success`.
+     */
+    static std::optional<LnkFileInfo> tryParse(const uint8_t* data, size_t size, ErrorCode &error, std::string filePath, ParseOptions options, const Filter &filter){
+        return tryParse(data, size, error, std::move(filePath), options, &filter, nullptr);
+    }
+
+    /**
+     * Checks whether the given file starts with a valid LNK header (the header size followed by the LinkCLSID), without parsing the rest of it. Only the first 76 bytes of the file are read. This is much faster than parsing the file, but a file for which this returns `true` can still be invalid.
+     *
+     * @param filePath  The path of the file to check. Can be an absolute or a relative path.
+     *
+     * @return `true` if the file starts with a valid LNK header, `false` if it doesn't or if it can't be read.
+     */
+    static bool probe(const std::string& filePath){
+        uint8_t header[headerSize];
+        std::ifstream file(utf8ToNativeEncoding(filePath), std::ios::binary);
+        return file.read(reinterpret_cast<char*>(header), headerSize) && probe(header, headerSize);
+    }
+
+    /**
+     * Checks whether the given bytes start with a valid LNK header (the header size followed by the LinkCLSID), without parsing the rest of them.
+     *
+     * @param data  A pointer to the bytes to check.
+     * @param size  The number of bytes pointed to by `data`.
+     *
+     * @return `true` if the bytes start with a valid LNK header, `false` otherwise.
+     */
+    static bool probe(const uint8_t* data, size_t size) noexcept {
+        return size >= headerSize && std::memcmp(data, headerSignature, sizeof(headerSignature)) == 0;
+    }
+
+    /**
+     * Returns a human-readable description of an error code, which is the same as the message of the corresponding exception.
+     */
+    static const char* errorMessage(ErrorCode error) noexcept {
+        switch(error){
+        case ErrorCode::Success:
+            return "Success";
+        case ErrorCode::OpenFailed:
+            return "Failed to open file";
+        case ErrorCode::ReadFailed:
+            return "Failed to read file";
+        case ErrorCode::InvalidHeader:
+            return "Invalid header";
+        case ErrorCode::InvalidFileinfoHeader:
+            return "Invalid fileinfo header";
+        case ErrorCode::IndexOutOfRange:
+            return "Index out of range";
         }
+        return "Unknown error";
     }
 
     /**
      * Returns the absolute path of the LNK file itself, including the file name.
      */
-    std::string absoluteFilePath() const {
+    const std::string& absoluteFilePath() const {
         return this->_absoluteFilePath;
     }
 
     /**
      * Returns the absolute path of the target file. If the LNK file points to a nonexistent file, returns the absolute path of that nonexistent file.
      */
-    std::string absoluteTargetPath() const {
-        return this->_targetPath;
+    const std::string& absoluteTargetPath() const {
+        return this->internedString(InternedString::InternedTargetPath, this->_targetPath);
     }
 
     /**
      * Returns the command line arguments of the LNK file, if any, not including the target. For example, if the LNK file points to `cmd.exe /v /c python.exe`, this method will return `/v /c python.exe`.
      */
-    std::string commandLineArgs() const {
-        return this->_commandLineArgs;
+    const std::string& commandLineArgs() const {
+        return this->stringData(StringDataEntry::CommandLineArgs);
     }
 
     /**
      * Returns the description of the LNK file. The description is the custom text that appears when hovering over the LNK file in Windows Explorer, and can be edited in Windows Explorer by going to Properties -> Comment. If the LNK file has no custom description, this method returns an empty string.
      */
-    std::string description() const {
-        return this->_description;
+    const std::string& description() const {
+        return this->stringData(StringDataEntry::Description);
+    }
+
+    /**
+     * If the LNK file contains an EnvironmentVariableDataBlock, returns the path of the target as specified in that block, which can contain environment variables such as `%windir%`. Returns an empty string otherwise, or if the LNK file wasn't parsed with `LnkFileInfo::ExtraData`.
+     */
+    const std::string& environmentTargetPath() const {
+        return this->_environmentTargetPath;
     }
 
     /**
      * Returns the path of the LNK file itself as specified in the constructor, including the file name. Can be absolute or relative.
      */
-    std::string filePath() const {
+    const std::string& filePath() const {
         return this->_filePath;
     }
 
@@ -136,14 +704,28 @@ public:
      * Returns `true` if the LNK file has a custom icon (including if the icon was manually set to be the same as its target), and `false` if it doesn't (meaning the icon shown in Windows Explorer is the same as the target's icon). See also `iconPath()` and `iconIndex()`.
      */
     bool hasCustomIcon() const noexcept {
-        return !this->_iconPath.empty();
+        return this->_hasCustomIcon;
+    }
+
+    /**
+     * Returns the virtual key code of the key that opens the LNK file together with `hotkeyModifiers()` (for example 0x41 for A or 0x70 for F1), or zero if the LNK file has no hotkey. This can be edited in Windows Explorer by going to Properties -> Shortcut key.
+     */
+    uint8_t hotkeyKey() const noexcept {
+        return this->_hotkey & 0xFF;
+    }
+
+    /**
+     * Returns the modifier keys that are part of the hotkey of the LNK file, as a combination of `LnkFileInfo::HotkeyModifier` values. See also `hotkeyKey()`.
+     */
+    uint8_t hotkeyModifiers() const noexcept {
+        return this->_hotkey >> 8;
     }
 
     /**
      * If the LNK file has a custom icon, returns the path to the file containing that icon. Returns an empty string if the LNK file has no custom icon. See also `hasCustomIcon()` and `iconIndex()`.
      */
-    std::string iconPath() const {
-        return this->_iconPath;
+    const std::string& iconPath() const {
+        return this->internedString(InternedString::InternedIconPath, this->stringData(StringDataEntry::IconPath));
     }
 
     /**
@@ -154,95 +736,89 @@ public:
     }
 
     /**
-     * Re-reads all the information about the LNK file from the file system.
-     *
-     * @throws LnkFileInfo::IoError if opening the file failed.
-     * @throws LnkFileInfo::InvalidLnkFile if the file is not a valid LNK file.
+     * Returns the items of the LinkTargetIDList of the LNK file, which identify the target in the shell namespace, without their size fields. The format of each item depends on the shell folder that contains it and isn't decoded by this library. Returns an empty vector if the LNK file has no LinkTargetIDList, or if it wasn't parsed with `LnkFileInfo::IdList`.
      */
-    void refresh(){
-        //Open the file
-        std::ifstream file(utf8ToNativeEncoding(this->_filePath), std::ios::binary);
-        if(!file.good()){
-            throw IoError("Failed to open file", this);
-        }
-        const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), (std::istreambuf_iterator<char>()));
-        file.close();
+    const std::vector<std::vector<uint8_t>>& idList() const noexcept {
+        return this->_idList;
+    }
 
-        //Check the headers
-        if(this->readInteger<uint8_t>(bytes, 0) != 0x4C){
-            throw InvalidLnkFile("Invalid header", this);
+    /**
+     * Replaces this object's copies of the target path, target volume name, relative target path, working directory and icon path with the equal strings in the given pool, adding them to the pool if they aren't there yet, and frees the copies. When many LNK files share the same strings, this means that each string is only stored once, and the references returned by the corresponding methods of objects that use the same pool are equal if and only if the strings are equal.
+     *
+     * The pool is kept alive by this object and its copies. The strings are interned again in the same pool whenever the LNK file is read again by `refresh()` or `refreshIfChanged()`. With `LnkFileInfo::LazyStrings`, the relative target path, working directory and icon path are decoded by this method.
+     *
+     * @param pool  The pool to intern the strings in.
+     */
+    void internStrings(std::shared_ptr<StringPool> pool){
+        const std::string* const values[InternedStringCount] = {&this->absoluteTargetPath(), &this->targetVolumeName(), &this->relativeTargetPath(), &this->workingDirectory(), &this->iconPath()};
+        for(int i = 0; i < InternedStringCount; i++){
+            this->_internedStrings[i] = &pool->intern(*values[i]);
         }
-        const uint16_t start = 78 + this->readInteger<uint16_t>(bytes, 76);
-        const uint8_t fileinfoHeader = this->readInteger<uint8_t>(bytes, start + 4);
-        if(fileinfoHeader != 0x1C && fileinfoHeader != 0x24){
-            throw InvalidLnkFile("Invalid fileinfo header: " + std::to_string(fileinfoHeader), this);
+        for(std::string* string: {&this->_targetPath, &this->_targetVolumeName, &this->_stringData.relativeTargetPath, &this->_stringData.workingDirectory, &this->_stringData.iconPath}){
+            std::string().swap(*string);
         }
+        this->_stringPool = std::move(pool);
+    }
 
-        //Target info
-        this->_targetAttributes = this->readInteger<uint16_t>(bytes, 24);
-        this->_targetSize = this->readInteger<uint32_t>(bytes, 52);
-        this->_targetIsOnNetwork = this->readInteger<uint8_t>(bytes, start + 8) & 0x02;
+    /**
+     * If the LNK file contains a KnownFolderDataBlock, returns the identifier of the known folder that contains the target, such as `{F3CE0F7C-4901-4ACC-8648-D5D44B04EF8F}` for the user's profile folder. Returns a null GUID otherwise, or if the LNK file wasn't parsed with `LnkFileInfo::ExtraData`.
+     */
+    const Guid& knownFolderId() const noexcept {
+        return this->_knownFolderId;
+    }
 
-        //Path and volume info
-        if(this->_targetIsOnNetwork){
-            const uint32_t volumeOffset = start + this->readInteger<uint32_t>(bytes, start + 20);
-            this->_targetVolumeType = VolumeType::NetworkDrive;
-            this->_targetVolumeSerial = 0;
-            const std::string volumeName = this->readNullTerminatedString(bytes, volumeOffset + 20);
-            this->_targetVolumeName = volumeName;
-            const size_t pathOffset = volumeOffset + 21 + volumeName.size();
-            const std::string targetDrive = this->readNullTerminatedString(bytes, pathOffset);
-            this->_targetPath = targetDrive + "\\" + this->readNullTerminatedString(bytes, pathOffset + targetDrive.size() + 1);
+    /**
+     * Re-reads all the information about the LNK file from the file system. If this object was constructed from bytes in memory, this reads the file at `filePath()`.
+     *
+     * @throws LnkFileInfo::IoError if opening the file failed.
+     * @throws LnkFileInfo::InvalidLnkFile if the file is not a valid LNK file.
+     */
+    void refresh(){
+        this->throwIfError(this->tryRefresh());
+    }
 
-            if(fileinfoHeader == 0x24){
-                this->_targetPath = targetDrive + "\\" + this->readFixedLengthString(bytes,
-                                                                                     pathOffset + this->_targetPath.size() - this->_targetPath.size() % 2,
-                                                                                     (this->_targetPath.size() - targetDrive.size() - 1) * 2);
-            }
-        }
-        else{
-            const uint32_t volumeOffset = start + this->readInteger<uint32_t>(bytes, start + 12);
-            this->_targetVolumeType = static_cast<VolumeType>(this->readInteger<uint32_t>(bytes, volumeOffset + 4));
-            this->_targetVolumeSerial = this->readInteger<uint32_t>(bytes, volumeOffset + 8);
-            this->_targetVolumeName = this->readNullTerminatedString(bytes, volumeOffset + 16);
-            const size_t pathOffset = start + this->readInteger<uint32_t>(bytes, start + 16);
-            this->_targetPath = this->readNullTerminatedString(bytes, pathOffset);
+    /**
+     * Same as `refresh()`, but returns an error code instead of throwing an exception if reading the LNK file fails. If it fails, the information in this object is unspecified until the next successful call to `refresh()` or `tryRefresh()`, but it is still safe to call any method on it.
+     *
+     * @return `LnkFileInfo::Success` if reading the LNK file succeeded, and the reason it failed otherwise.
+     */
+    ErrorCode tryRefresh(){
+        std::vector<uint8_t> buffer;
+        return this->tryRefresh(buffer, nullptr);
+    }
 
-            //Non-Latin1 target path, in this case the Latin1 target path contains question marks instead of Unicode characters (needed to determine the length of the target path), and is followed by the actual target path encoded in UTF-16.
-            if(fileinfoHeader == 0x24){
-                this->_targetPath = this->readFixedLengthString(bytes,
-                                                                pathOffset + this->_targetPath.size() - this->_targetPath.size() % 2,
-                                                                this->_targetPath.size() * 2);
-            }
-        }
+    /**
+     * Re-reads the information about the LNK file from the file system only if the file has changed since it was last read. Checking whether the file has changed only needs a single `stat` call, which compares the last write time and the size of the file with the ones from the last time it was read. If they differ, the file is read again, but it's only parsed again if its contents have actually changed.
+     *
+     * A change is only detected if it changes the size or the last write time of the file, so changes within the resolution of the file system's timestamps that don't change the size can be missed. If this object was constructed from bytes in memory, or if the last refresh failed, the file at `filePath()` is always read.
+     *
+     * @return True if the information in this object was updated, false if the file hasn't changed.
+     *
+     * @throws LnkFileInfo::IoError if opening the file failed.
+     * @throws LnkFileInfo::InvalidLnkFile if the file is not a valid LNK file.
+     */
+    bool refreshIfChanged(){
+        bool changed;
+        this->throwIfError(this->tryRefreshIfChanged(changed));
+        return changed;
+    }
 
-        //Additional info
-        const uint8_t flags = this->readInteger<uint8_t>(bytes, 20);
-        size_t nextLocation = start + this->readInteger<uint32_t>(bytes, start);
-        if(flags & Flag::HasDescription){
-            const std::pair data = this->readStringWithPrependedLength(bytes, nextLocation);
-            this->_description = data.first;
-            nextLocation = data.second;
-        }
-        if(flags & Flag::HasRelativePath){
-            const std::pair data = this->readStringWithPrependedLength(bytes, nextLocation);
-            this->_relativeTargetPath = data.first;
-            nextLocation = data.second;
-        }
-        if(flags & Flag::HasWorkingDirectory){
-            const std::pair data = this->readStringWithPrependedLength(bytes, nextLocation);
-            this->_workingDirectory = data.first;
-            nextLocation = data.second;
-        }
-        if(flags & Flag::HasCommandLineArgs){
-            const std::pair data = this->readStringWithPrependedLength(bytes, nextLocation);
-            this->_commandLineArgs = data.first;
-            nextLocation = data.second;
-        }
-        if(flags & Flag::HasCustomIcon){
-            this->_iconPath = this->readStringWithPrependedLength(bytes, nextLocation).first;
-            this->_iconIndex = this->readInteger<uint32_t>(bytes, 56);
+    /**
+     * Same as `refreshIfChanged()`, but returns an error code instead of throwing an exception if reading the LNK file fails. If it fails, the information in this object is unspecified until the next successful call to `refresh()`, `tryRefresh()`, `refreshIfChanged()` or `tryRefreshIfChanged()`.
+     *
+     * @param changed   Set to true if the information in this object was updated, and to false if the file hasn't changed or if reading it failed.
+     *
+     * @return `LnkFileInfo::Success` if the file hasn't changed or if reading it succeeded, and the reason it failed otherwise.
+     */
+    ErrorCode tryRefreshIfChanged(bool &changed){
+        changed = false;
+        FileStamp fileStamp;
+        if(this->_fileStamp.isKnown() && statFile(this->_filePath, fileStamp) && fileStamp == this->_fileStamp){
+            return ErrorCode::Success;
         }
+        //If the file can't be stat'ed, refreshing it normally gives the appropriate error code
+        std::vector<uint8_t> buffer;
+        return this->tryRefresh(buffer, &changed);
     }
 
     /**
@@ -250,8 +826,29 @@ public:
      *
      * This method only reads the information present in the LNK file, so the information might not be up to date.
      */
-    std::string relativeTargetPath() const {
-        return this->_relativeTargetPath;
+    const std::string& relativeTargetPath() const {
+        return this->internedString(InternedString::InternedRelativeTargetPath, this->stringData(StringDataEntry::RelativeTargetPath));
+    }
+
+    /**
+     * Returns how the target's window is shown when the LNK file is opened. This can be edited in Windows Explorer by going to Properties -> Run.
+     */
+    ShowCommand showCommand() const noexcept {
+        return this->_showCommand;
+    }
+
+    /**
+     * Returns the last access time of the target as a FILETIME, i.e. the number of 100 nanosecond intervals since January 1, 1601 (UTC), or zero if it isn't set. This method only reads the information present in the LNK file, so the information might not be up to date.
+     */
+    uint64_t targetAccessTime() const noexcept {
+        return this->_targetAccessTime;
+    }
+
+    /**
+     * Returns the creation time of the target as a FILETIME, or zero if it isn't set. See also `targetAccessTime()`.
+     */
+    uint64_t targetCreationTime() const noexcept {
+        return this->_targetCreationTime;
     }
 
     /**
@@ -294,75 +891,373 @@ public:
     /**
      * Returns the name of the drive the target is on as shown in the This PC folder if that drive has a custom name, and an empty string otherwise. Note that on most Windows computers, while the hard drive is called "Local Disk" by default, this is not a custom name so an empty string will be returnd in that case.
      */
-    std::string targetVolumeName() const {
-        return this->_targetVolumeName;
+    const std::string& targetVolumeName() const {
+        return this->internedString(InternedString::InternedTargetVolumeName, this->_targetVolumeName);
     }
 
     /**
-     * Returns the working directory specified in the LNK file. This can be edited in Windows Explorer by going to Properties -> Start in.
+     * Returns the last write time of the target as a FILETIME, or zero if it isn't set. See also `targetAccessTime()`.
      */
-    std::string workingDirectory() const {
-        return this->_workingDirectory;
+    uint64_t targetWriteTime() const noexcept {
+        return this->_targetWriteTime;
     }
 
     /**
-     * Returns `true` if this LnkFileInfo object refers to the same LNK file as `other`, and `false` otherwise.
+     * Returns the NetBIOS name of the machine the target was last on according to the TrackerDataBlock of the LNK file, or an empty string if the LNK file has no TrackerDataBlock or wasn't parsed with `LnkFileInfo::ExtraData`.
      */
-    bool operator==(const LnkFileInfo &other) const noexcept {
-        return this->_absoluteFilePath == other._absoluteFilePath;
+    const std::string& trackerMachineId() const {
+        return this->_trackerMachineId;
     }
 
     /**
-     * Returns `false` if this LnkFileInfo object refers to the same LNK file as `other`, and `true` otherwise.
+     * Returns the identifier of the volume the target was on when the LNK file was created or last updated according to the TrackerDataBlock, which is used by the Distributed Link Tracking service to find the target if it's moved. Returns a null GUID if the LNK file has no TrackerDataBlock or wasn't parsed with `LnkFileInfo::ExtraData`.
      */
-    bool operator!=(const LnkFileInfo &other) const noexcept {
-        return !(*this == other);
+    const Guid& trackerVolumeId() const noexcept {
+        return this->_trackerVolumeId;
     }
 
-private:
-    enum Flag{
-        HasShellIdList      = 0x01,
-        PointsToFileDir     = 0x02,
-        HasDescription      = 0x04,
-        HasRelativePath     = 0x08,
+    /**
+     * Returns the identifier of the target file according to the TrackerDataBlock. See also `trackerVolumeId()`.
+     */
+    const Guid& trackerObjectId() const noexcept {
+        return this->_trackerObjectId;
+    }
+
+    /**
+     * Returns the identifier of the volume the target was on when it was created according to the TrackerDataBlock. See also `trackerVolumeId()`.
+     */
+    const Guid& trackerBirthVolumeId() const noexcept {
+        return this->_trackerBirthVolumeId;
+    }
+
+    /**
+     * Returns the identifier the target file had when it was created according to the TrackerDataBlock. See also `trackerVolumeId()`.
+     */
+    const Guid& trackerBirthObjectId() const noexcept {
+        return this->_trackerBirthObjectId;
+    }
+
+    /**
+     * Returns the working directory specified in the LNK file. This can be edited in Windows Explorer by going to Properties -> Start in.
+     */
+    const std::string& workingDirectory() const {
+        return this->internedString(InternedString::InternedWorkingDirectory, this->stringData(StringDataEntry::WorkingDirectory));
+    }
+
+    /**
+     * Returns a hash of `absoluteFilePath()`. The hash is computed once when the LNK file is read, so calling this is cheap. This is the hash used by `std::hash<LnkFileInfo>`.
+     */
+    size_t hash() const noexcept {
+        return static_cast<size_t>(this->_absoluteFilePathHash);
+    }
+
+    /**
+     * Returns `true` if this LnkFileInfo object refers to the same LNK file as `other`, and `false` otherwise. The hashes of the absolute paths are compared first, so LnkFileInfo objects referring to different LNK files are usually told apart without comparing the paths.
+     */
+    bool operator==(const LnkFileInfo &other) const noexcept {
+        return this->_absoluteFilePathHash == other._absoluteFilePathHash && this->_absoluteFilePath == other._absoluteFilePath;
+    }
+
+    /**
+     * Returns `false` if this LnkFileInfo object refers to the same LNK file as `other`, and `true` otherwise.
+     */
+    bool operator!=(const LnkFileInfo &other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    friend class LnkFileArchiveReader;
+    friend class LnkFileAsyncReader;
+    friend class LnkFileCache;
+    friend class LnkFileCarver;
+    friend class LnkFileDecoder;
+    friend class LnkFileEncoder;
+    friend class LnkFileInfoBatch;
+    friend struct LnkFileInfoHeaderLayoutTest;
+    friend class LnkFileRecordStrings;
+    friend class LnkFileScanner;
+    friend class LnkFileTargetChecker;
+    friend class LnkFileWatcher;
+    friend class LnkParser;
+
+    enum Flag{
+        HasShellIdList      = 0x01,
+        PointsToFileDir     = 0x02,
+        HasDescription      = 0x04,
+        HasRelativePath     = 0x08,
         HasWorkingDirectory = 0x10,
         HasCommandLineArgs  = 0x20,
         HasCustomIcon       = 0x40
     };
 
+    /**
+     * The signatures of the ExtraData blocks that are decoded with `LnkFileInfo::ExtraData`.
+     */
+    enum ExtraDataSignature: uint32_t {
+        EnvironmentVariableDataBlock = 0xA0000001,
+        TrackerDataBlock             = 0xA0000003,
+        KnownFolderDataBlock         = 0xA000000B
+    };
+
+    /**
+     * The strings in the StringData section of the LNK file, in the order they appear in the file. Used as bit indices in `StringDataValues::pending` and as indices in `StringDataValues::offsets`.
+     */
+    enum StringDataEntry{
+        Description,
+        RelativeTargetPath,
+        WorkingDirectory,
+        CommandLineArgs,
+        IconPath,
+        StringDataEntryCount
+    };
+
+    /**
+     * The strings that can be replaced with strings from a StringPool by `internStrings()`.
+     */
+    enum InternedString{
+        InternedTargetPath,
+        InternedTargetVolumeName,
+        InternedRelativeTargetPath,
+        InternedWorkingDirectory,
+        InternedIconPath,
+        InternedStringCount
+    };
+
+    /**
+     * Non-owning view of the bytes of an LNK file, so that the same parsing code can be used regardless of whether the bytes were read from a file or passed directly by the caller.
+     */
+    struct ByteView {
+        const uint8_t* data;
+        size_t size;
+
+        uint8_t operator[](size_t i) const noexcept {
+            return this->data[i];
+        }
+    };
+
+    /**
+     * The size of the ShellLinkHeader structure at the start of every LNK file.
+     */
+    static constexpr size_t headerSize = 76;
+
+    /**
+     * A field of the ShellLinkHeader structure, described by the integer type it's read as and its offset from the start of the LNK file.
+     */
+    template<typename T, size_t Offset>
+    struct HeaderField {
+        using Type = T;
+        static constexpr size_t offset = Offset;
+        static constexpr size_t end = Offset + sizeof(T);
+    };
+
+    /**
+     * A list of fields of the ShellLinkHeader structure, used to check all of them at compile time.
+     */
+    template<typename... Fields>
+    struct HeaderFieldList {};
+
+    /**
+     * The layout of the fields of the ShellLinkHeader structure that are read when parsing. LinkFlags and FileAttributes are 32 bits, but only their lower bits are used. The size of the ID list that directly follows the header is included since it's always needed to find the link info.
+     */
+    struct HeaderLayout {
+        using HeaderSize     = HeaderField<uint8_t, 0>;
+        using LinkFlags      = HeaderField<uint8_t, 20>;
+        using FileAttributes = HeaderField<uint16_t, 24>;
+        using CreationTime   = HeaderField<uint64_t, 28>;
+        using AccessTime     = HeaderField<uint64_t, 36>;
+        using WriteTime      = HeaderField<uint64_t, 44>;
+        using FileSize       = HeaderField<uint32_t, 52>;
+        using IconIndex      = HeaderField<uint32_t, 56>;
+        using ShowCommand    = HeaderField<uint32_t, 60>;
+        using HotKey         = HeaderField<uint16_t, 64>;
+        using IdListSize     = HeaderField<uint16_t, headerSize>;
+
+        static constexpr size_t minimumSize = IdListSize::end;    //The number of bytes needed to read all the fields, checked once before reading them
+
+        using Fields = HeaderFieldList<HeaderSize, LinkFlags, FileAttributes, CreationTime, AccessTime, WriteTime, FileSize, IconIndex, ShowCommand, HotKey, IdListSize>;
+    };
+
+    /**
+     * The last write time and size of a file, used to check whether a file has changed without reading it.
+     */
+    struct FileStamp {
+        uint64_t lastWriteTime = 0;    //In nanoseconds since 1970 on Linux and macOS, and in 100 nanosecond intervals since 1601 on Windows
+        uint64_t size = 0;
+
+        //Empty files are never valid LNK files, so a size of zero means that the stamp is unknown
+        bool isKnown() const noexcept {
+            return this->size != 0;
+        }
+
+        bool operator==(const FileStamp &other) const noexcept {
+            return this->lastWriteTime == other.lastWriteTime && this->size == other.size;
+        }
+    };
+
+    /**
+     * The first bytes of every LNK file: the header size (0x4C) as a 32-bit integer followed by the LinkCLSID 00021401-0000-0000-C000-000000000046.
+     */
+    static constexpr uint8_t headerSignature[20] = {0x4C, 0x00, 0x00, 0x00, 0x01, 0x14, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x46};
+
+    /**
+     * Constructs an empty LnkFileInfo object. Only used by the non-throwing factory methods, which fill it in before returning it.
+     */
+    LnkFileInfo() = default;
+
+    /**
+     * Throws the exception corresponding to an error code, or does nothing if the error code is `LnkFileInfo::Success`.
+     *
+     * @throws LnkFileInfo::IoError if `error` is `OpenFailed` or `ReadFailed`.
+     * @throws LnkFileInfo::InvalidLnkFile if `error` indicates that the LNK file is invalid.
+     */
+    void throwIfError(ErrorCode error) const {
+        switch(error){
+        case ErrorCode::Success:
+            return;
+        case ErrorCode::OpenFailed:
+        case ErrorCode::ReadFailed:
+            throw IoError(errorMessage(error), this);
+        case ErrorCode::InvalidFileinfoHeader:
+            throw InvalidLnkFile(std::string(errorMessage(error)) + ": " + std::to_string(this->_fileinfoHeader), this);
+        default:
+            throw InvalidLnkFile(errorMessage(error), this);
+        }
+    }
+
     /**
      * Reads an integer of a given length from the LNK file.
      *
      * @param bytes The bytes contained in the LNK file.
      * @param i     The offset to start reading at at.
+     * @param error Set to `IndexOutOfRange` if the integer isn't within the bounds of the LNK file, left unchanged otherwise.
      *
      * @tparam T    The integer type to read.
      *
-     * @return The integer.
+     * @return The integer, or zero if it isn't within the bounds of the LNK file.
+     */
+    template<typename T>
+    static T readInteger(const ByteView &bytes, size_t i, ErrorCode &error) noexcept {
+        if(i + sizeof(T) > bytes.size || i + sizeof(T) < i){
+            error = ErrorCode::IndexOutOfRange;
+            return 0;
+        }
+        return loadLittleEndian<T>(bytes.data + i);
+    }
+
+    /**
+     * Reads a little endian integer without any bounds checks. The bytes are combined in a single expression rather than in a loop since compilers reliably turn that into a single unaligned load on little endian platforms.
+     *
+     * @param data  A pointer to at least `sizeof(T)` bytes.
+     *
+     * @tparam T    The integer type to read.
      */
     template<typename T>
-    T readInteger(const std::vector<uint8_t> &bytes, size_t i) const {
-        if(i + sizeof(T) > bytes.size()){
-            throw InvalidLnkFile("Index out of range", this);
+    static constexpr T loadLittleEndian(const uint8_t* data) noexcept {
+        return loadLittleEndian<T>(data, std::make_index_sequence<sizeof(T)>());
+    }
+
+    template<typename T, size_t... I>
+    static constexpr T loadLittleEndian(const uint8_t* data, std::index_sequence<I...>) noexcept {
+        return static_cast<T>(((static_cast<T>(data[I]) << (I * 8)) | ...));
+    }
+
+    /**
+     * Reads a field of the header described by `HeaderLayout` without any bounds checks.
+     *
+     * @param data  A pointer to at least `HeaderLayout::minimumSize` bytes.
+     *
+     * @tparam Field    One of the fields of `HeaderLayout`.
+     */
+    template<typename Field>
+    static constexpr typename Field::Type readHeaderField(const uint8_t* data) noexcept {
+        static_assert(Field::end <= HeaderLayout::minimumSize, "Header fields must be within the bytes checked by HeaderLayout::minimumSize");
+        return loadLittleEndian<typename Field::Type>(data + Field::offset);
+    }
+
+    /**
+     * Returns true if the given fields are in increasing order without overlapping and end at `HeaderLayout::minimumSize`. Only used by the compile-time tests after the class.
+     */
+    template<typename... Fields>
+    static constexpr bool headerFieldsAreOrdered(HeaderFieldList<Fields...>) noexcept {
+        const size_t offsets[] = {Fields::offset...};
+        const size_t ends[] = {Fields::end...};
+        for(size_t i = 1; i < std::size(offsets); i++){
+            if(offsets[i] < ends[i - 1]){
+                return false;
+            }
+        }
+        return ends[std::size(ends) - 1] == HeaderLayout::minimumSize;
+    }
+
+    /**
+     * Returns true if `readHeaderField()` reads each of the given fields correctly from a header whose bytes are their offsets. The expected values are built byte by byte so that they don't depend on `loadLittleEndian()`. Only used by the compile-time tests after the class.
+     */
+    template<typename... Fields>
+    static constexpr bool headerFieldsReadSampleHeader(HeaderFieldList<Fields...>) noexcept {
+        uint8_t sampleHeader[HeaderLayout::minimumSize] = {};
+        for(size_t i = 0; i < HeaderLayout::minimumSize; i++){
+            sampleHeader[i] = static_cast<uint8_t>(i);
         }
-        T result = 0;
-        for(size_t j = 0; j < sizeof(T); j++){
-            result += bytes.at(i + j) * (T(1) << (j * 8));
+        return ((readHeaderField<Fields>(sampleHeader) == sampleHeaderValue<Fields>()) && ...);
+    }
+
+    template<typename Field>
+    static constexpr typename Field::Type sampleHeaderValue() noexcept {
+        uint64_t result = 0;
+        for(size_t i = sizeof(typename Field::Type); i > 0; i--){
+            result = (result << 8) | static_cast<uint8_t>(Field::offset + i - 1);
         }
-        return result;
+        return static_cast<typename Field::Type>(result);
     }
 
     /**
-     * Reads a null-terminated Latin1-encoded string from the LNK file.
+     * Reads a null-terminated Latin1-encoded string from the LNK file and appends it to a string.
      *
-     * @param bytes The bytes contained in the LNK file.
-     * @param i     The offset to start reading at at.
+     * @param bytes     The bytes contained in the LNK file.
+     * @param i         The offset to start reading at at.
+     * @param result    The string to append the string encoded as UTF-8 to. Left unchanged if the string isn't terminated within the bounds of the LNK file.
+     * @param error     Set to `IndexOutOfRange` if the string isn't terminated within the bounds of the LNK file, left unchanged otherwise.
+     *
+     * @return The length of the string in the LNK file in bytes, not including the null terminator. This can be different from the number of bytes appended to `result` since non-ASCII characters take two bytes in UTF-8.
+     */
+    static size_t readNullTerminatedString(const ByteView &bytes, size_t i, std::string &result, ErrorCode &error){
+        size_t length = 0;
+        if(!findTerminator(bytes, i, length)){
+            error = ErrorCode::IndexOutOfRange;
+            return 0;
+        }
+        appendLatin1AsUtf8(bytes.data + i, length, result);
+        return length;
+    }
+
+    /**
+     * Finds the end of a null-terminated string in the LNK file.
+     *
+     * @param bytes     The bytes contained in the LNK file.
+     * @param i         The offset of the string.
+     * @param length    Set to the length of the string in bytes, not including the null terminator, if it's terminated within the bounds of the LNK file. Left unchanged otherwise.
+     *
+     * @return True if the string is terminated within the bounds of the LNK file, false otherwise.
+     */
+    static bool findTerminator(const ByteView &bytes, size_t i, size_t &length) noexcept {
+        const void* terminator = i < bytes.size ? std::memchr(bytes.data + i, 0, bytes.size - i) : nullptr;
+        if(terminator == nullptr){
+            return false;
+        }
+        length = static_cast<size_t>(static_cast<const uint8_t*>(terminator) - (bytes.data + i));
+        return true;
+    }
+
+    /**
+     * Converts Latin1 encoded characters to UTF-8 and appends them to a string.
      *
-     * @return The string encoded as UTF-8.
+     * @param data      A pointer to the first character.
+     * @param length    The number of characters to convert.
+     * @param result    The string to append the converted characters to.
      */
-    std::string readNullTerminatedString(const std::vector<uint8_t> &bytes, size_t i) const {
-        std::string result;
-        while(uint8_t currentCharacter = this->readInteger<uint8_t>(bytes, i++)){
+    static void appendLatin1AsUtf8(const uint8_t* data, size_t length, std::string &result){
+        for(size_t j = 0; j < length; j++){
+            const uint8_t currentCharacter = data[j];
             //If it's an ASCII character, Latin1 and UTF-8 are the same.
             if(currentCharacter < 0x80){
                 result += currentCharacter;
@@ -373,21 +1268,18 @@ private:
                 result += 0x80 | (currentCharacter & 0x3f);
             }
         }
-        return result;
     }
 
     /**
-     * Reads a UTF-16 codepoint from the LNK file.
+     * Converts UTF-16LE encoded code units to UTF-8 and appends them to a string. Runs of ASCII characters are converted eight at a time using SSE2 or NEON when available, other characters are converted one at a time. Unpaired surrogates are replaced with U+FFFD.
      *
      * Code for UTF16 to UTF8 conversion from https://github.com/Davipb/utf8-utf16-converter
      *
-     * @param bytes The bytes contained in the LNK file.
-     * @param i     The offset to start reading at at.
-     * @param end   The maximum offset to read at.
-     *
-     * @return A pair containing the codepoint encoded as UTF-8 and the number of bytes read.
+     * @param data      A pointer to the first code unit. Doesn't need to be aligned.
+     * @param units     The number of code units to convert.
+     * @param result    The string to append the converted characters to.
      */
-    std::pair<std::string, size_t> readUtf16Codepoint(const std::vector<uint8_t> &bytes, size_t i, size_t end) const {
+    static void appendUtf16AsUtf8(const uint8_t* data, size_t units, std::string &result){
         constexpr uint32_t GENERIC_SURROGATE_MASK = 0xF800;
         constexpr uint32_t GENERIC_SURROGATE_VALUE = 0xD800;
         constexpr uint32_t HIGH_SURROGATE_VALUE = 0xD800;
@@ -398,130 +1290,1351 @@ private:
         constexpr uint32_t SURROGATE_CODEPOINT_OFFSET = 0x10000;
         constexpr uint32_t INVALID_CODEPOINT = 0xFFFD;
 
-        const uint16_t high = this->readInteger<uint16_t>(bytes, i);
-        size_t bytesRead = 2;
-        uint32_t codepoint;
-        if((high & GENERIC_SURROGATE_MASK) != GENERIC_SURROGATE_VALUE){
-            codepoint = high;
-        }
-        else if((high & SURROGATE_MASK) != HIGH_SURROGATE_VALUE || end < i + 4){
-            codepoint = INVALID_CODEPOINT;
-        }
-        else{
-            const uint16_t low = this->readInteger<uint16_t>(bytes, i + 2);
-            if((low & SURROGATE_MASK) != LOW_SURROGATE_VALUE){
+        //Each code unit takes at most three bytes in UTF-8 (surrogate pairs take four bytes for two code units), so allocate that much once and shrink it at the end.
+        const size_t oldSize = result.size();
+        result.resize(oldSize + units * 3);
+        char* const begin = &result[0] + oldSize;
+        char* out = begin;
+
+        size_t i = 0;
+        while(i < units){
+            #if defined(LNKFILEINFO_SSE2)
+                //ASCII code units have their nine high bits cleared, so if they are all cleared in all eight code units, they can be narrowed to bytes directly.
+                while(i + 8 <= units){
+                    const __m128i codeUnits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 2));
+                    if(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(codeUnits, _mm_set1_epi16(static_cast<short>(0xFF80))), _mm_setzero_si128())) != 0xFFFF){
+                        break;
+                    }
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(codeUnits, codeUnits));
+                    out += 8;
+                    i += 8;
+                }
+            #elif defined(LNKFILEINFO_NEON)
+                while(i + 8 <= units){
+                    const uint16x8_t codeUnits = vld1q_u16(reinterpret_cast<const uint16_t*>(data + i * 2));
+                    if(vmaxvq_u16(codeUnits) >= 0x80){
+                        break;
+                    }
+                    vst1_u8(reinterpret_cast<uint8_t*>(out), vmovn_u16(codeUnits));
+                    out += 8;
+                    i += 8;
+                }
+            #endif
+            #if defined(LNKFILEINFO_SSE2) || defined(LNKFILEINFO_NEON)
+                if(i == units){
+                    break;
+                }
+            #endif
+
+            //Convert the next character, either because no SIMD instructions are available, because there are less than eight code units left or because the next eight code units contain a non-ASCII character
+            const uint16_t high = data[i * 2] | data[i * 2 + 1] << 8;
+            i++;
+            if(high < 0x80){
+                *out++ = static_cast<char>(high);
+                continue;
+            }
+            uint32_t codepoint;
+            if((high & GENERIC_SURROGATE_MASK) != GENERIC_SURROGATE_VALUE){
+                codepoint = high;
+            }
+            else if((high & SURROGATE_MASK) != HIGH_SURROGATE_VALUE || i >= units){
                 codepoint = INVALID_CODEPOINT;
             }
             else{
-                codepoint = (((high & SURROGATE_CODEPOINT_MASK) << SURROGATE_CODEPOINT_BITS) | (low & SURROGATE_CODEPOINT_MASK)) + SURROGATE_CODEPOINT_OFFSET;
-                bytesRead += 2;
+                const uint16_t low = data[i * 2] | data[i * 2 + 1] << 8;
+                if((low & SURROGATE_MASK) != LOW_SURROGATE_VALUE){
+                    codepoint = INVALID_CODEPOINT;
+                }
+                else{
+                    codepoint = (((high & SURROGATE_CODEPOINT_MASK) << SURROGATE_CODEPOINT_BITS) | (low & SURROGATE_CODEPOINT_MASK)) + SURROGATE_CODEPOINT_OFFSET;
+                    i++;
+                }
             }
-        }
 
-        const int numberOfBytes = codepoint > 0xFFFF ? 4 : codepoint > 0x7FF ? 3 : codepoint > 0x7F ? 2 : 1;
-        int continuationMask = 0x3F;
-        int continuationValue = 0x80;
-        std::string result;
-        for(int j = numberOfBytes; j > 0; j--){
-            if(j == 1){
-                switch(numberOfBytes){
-                case 1:
-                    continuationMask = 0x7F;
-                    continuationValue = 0x00;
-                    break;
-                case 2:
-                    continuationMask = 0x1F;
-                    continuationValue = 0xC0;
-                    break;
-                case 3:
-                    continuationMask = 0x0F;
-                    continuationValue = 0xE0;
-                    break;
-                case 4:
-                    continuationMask = 0x07;
-                    continuationValue = 0xF0;
-                    break;
-                }
+            if(codepoint <= 0x7FF){
+                *out++ = static_cast<char>(0xC0 | codepoint >> 6);
+                *out++ = static_cast<char>(0x80 | (codepoint & 0x3F));
+            }
+            else if(codepoint <= 0xFFFF){
+                *out++ = static_cast<char>(0xE0 | codepoint >> 12);
+                *out++ = static_cast<char>(0x80 | (codepoint >> 6 & 0x3F));
+                *out++ = static_cast<char>(0x80 | (codepoint & 0x3F));
+            }
+            else{
+                *out++ = static_cast<char>(0xF0 | codepoint >> 18);
+                *out++ = static_cast<char>(0x80 | (codepoint >> 12 & 0x3F));
+                *out++ = static_cast<char>(0x80 | (codepoint >> 6 & 0x3F));
+                *out++ = static_cast<char>(0x80 | (codepoint & 0x3F));
             }
-            const char cont = (codepoint & continuationMask) | continuationValue;
-            result = cont + result;
-            codepoint >>= 6;
         }
-        return std::make_pair(result, bytesRead);
+        result.resize(oldSize + (out - begin));
     }
 
     /**
-     * Reads a string for which the first two bytes indicate the length, then the rest is the string itself encoded in UTF-16.
+     * Reads a string for which the first two bytes indicate the number of UTF-16 code units, then the rest is the string itself encoded in UTF-16, and appends it to a string.
      *
-     * @param bytes The bytes contained in the LNK file.
-     * @param i     The offset to start reading at at (i.e. the offset containing the length of the string).
+     * @param bytes     The bytes contained in the LNK file.
+     * @param i         The offset to start reading at at (i.e. the offset containing the length of the string).
+     * @param result    The string to append the string encoded as UTF-8 to. Left unchanged if the string isn't within the bounds of the LNK file.
+     * @param error     Set to `IndexOutOfRange` if the string isn't within the bounds of the LNK file, left unchanged otherwise.
      *
-     * @return Pair containing the string encoded as UTF-8 and the offset after the end of the string.
+     * @return The offset after the end of the string.
      */
-    std::pair<std::string, size_t> readStringWithPrependedLength(const std::vector<uint8_t> &bytes, size_t i) const {
-        const size_t end = i + this->readInteger<uint16_t>(bytes, i) * 2;
-        i += 2;
-        std::string result;
-        while(i <= end){
-            const auto [codepoint, bytesRead] = this->readUtf16Codepoint(bytes, i, end);
-            result += codepoint;
-            i += bytesRead;
+    static size_t readStringWithPrependedLength(const ByteView &bytes, size_t i, std::string &result, ErrorCode &error){
+        const size_t units = readInteger<uint16_t>(bytes, i, error);
+        const size_t end = i + 2 + units * 2;
+        if(end > bytes.size || end < i){
+            error = ErrorCode::IndexOutOfRange;
+            return end;
         }
-        return std::make_pair(result, end + 2);
+        appendUtf16AsUtf8(bytes.data + i + 2, units, result);
+        return end;
     }
 
     /**
-     * Reads a UTF-16 encoded string with a fixed length.
+     * Same as the public `tryRefresh()`, but reads the file into the given buffer instead of a temporary one so that the capacity of the buffer can be reused for the next file. With lazy strings, the file is read directly into the bytes retained by this object instead, and the buffer is unused.
      *
-     * @param bytes     The bytes contained in the LNK file.
-     * @param i         The offset to start reading at.
-     * @param length    The number of bytes to read.
+     * @param buffer    The buffer to read the file into.
+     * @param changed   If not null, the contents of the file are hashed and only parsed if they're different from the last time, and this is set to whether they were parsed.
+     * @param filter    If not null, parsing stops with `NotMatched` as soon as it's known that the LNK file doesn't match this filter.
+     * @param cache     If not null, the information is copied from this cache if it contains an LNK file with the same contents, and added to it otherwise.
+     */
+    ErrorCode tryRefresh(std::vector<uint8_t> &buffer, bool *changed, const Filter* filter = nullptr, ContentCache* cache = nullptr){
+        if(this->_options & ParseOption::MemoryMapped){
+            PhaseTimer timer(&ParseStats::readNanoseconds);
+            const MappedFile mappedFile(this->_filePath);
+            if(mappedFile.isMapped()){
+                timer.stop();
+                recordBytesRead(mappedFile.bytes().size);
+                return this->parseFile(mappedFile.bytes(), mappedFile.fileStamp(), changed, filter, cache);
+            }
+        }
+
+        std::vector<uint8_t> &bytes = this->_options & ParseOption::LazyStrings ? this->_stringData.retainedBytes() : buffer;
+        FileStamp fileStamp;
+        PhaseTimer timer(&ParseStats::readNanoseconds);
+        const ErrorCode error = readFile(this->_filePath, bytes, fileStamp);
+        timer.stop();
+        if(error != ErrorCode::Success){
+            //The retained bytes may have been overwritten, so they must no longer be used to decode strings
+            this->_stringData.pending = 0;
+            this->_fileStamp = FileStamp();
+            recordError(error);
+            return error;
+        }
+        recordBytesRead(bytes.size());
+        return this->parseFile(ByteView{bytes.data(), bytes.size()}, fileStamp, changed, filter, cache);
+    }
+
+    /**
+     * Measures the time spent in a phase of reading or parsing LNK files, and adds it to a counter of `threadStats()` when the phase ends. Does nothing if `LNKFILEINFO_STATS` isn't defined.
+     */
+    class PhaseTimer {
+    public:
+        explicit PhaseTimer([[maybe_unused]] uint64_t ParseStats::* counter) noexcept
+        #ifdef LNKFILEINFO_STATS
+            : _counter(counter), _start(std::chrono::steady_clock::now())
+        #endif
+        {}
+
+        PhaseTimer(const PhaseTimer&) = delete;
+        PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+        ~PhaseTimer(){
+            this->stop();
+        }
+
+        /**
+         * Ends the current phase and starts measuring the given one.
+         */
+        void next([[maybe_unused]] uint64_t ParseStats::* counter) noexcept {
+            #ifdef LNKFILEINFO_STATS
+                const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                if(this->_counter != nullptr){
+                    threadStats().*this->_counter += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - this->_start).count());
+                }
+                this->_counter = counter;
+                this->_start = now;
+            #endif
+        }
+
+        /**
+         * Ends the current phase without starting another one.
+         */
+        void stop() noexcept {
+            this->next(nullptr);
+        }
+
+    private:
+        #ifdef LNKFILEINFO_STATS
+            uint64_t ParseStats::* _counter;
+            std::chrono::steady_clock::time_point _start;
+        #endif
+    };
+
+    static void recordBytesRead([[maybe_unused]] size_t size) noexcept {
+        #ifdef LNKFILEINFO_STATS
+            threadStats().bytesRead += size;
+        #endif
+    }
+
+    static void recordError([[maybe_unused]] ErrorCode error) noexcept {
+        #ifdef LNKFILEINFO_STATS
+            threadStats().errors[error]++;
+        #endif
+    }
+
+    /**
+     * Parses the contents of an LNK file that was read from the file system, and remembers its stamp so that `refreshIfChanged()` can check whether it has changed.
      *
-     * @return The string encoded as UTF-8.
+     * @param bytes     The bytes contained in the LNK file.
+     * @param fileStamp The stamp of the file when it was read.
+     * @param changed   If not null, the bytes are hashed and only parsed if they're different from the bytes that were parsed last time, and this is set to whether they were parsed.
+     * @param filter    If not null, the filter that the LNK file must match.
+     * @param cache     If not null, the cache to copy the information from or add it to.
+     */
+    ErrorCode parseFile(const ByteView &bytes, const FileStamp &fileStamp, bool *changed, const Filter* filter = nullptr, ContentCache* cache = nullptr){
+        const uint64_t contentHash = changed != nullptr || cache != nullptr ? hashContents(bytes) : 0;
+        if(changed != nullptr){
+            //If the contents are the same, the lazily parsed strings (if any) can still be decoded from the retained bytes since they're identical
+            *changed = !(this->_hasContentHash && contentHash == this->_contentHash);
+            if(!*changed){
+                this->_fileStamp = fileStamp;
+                return ErrorCode::Success;
+            }
+        }
+        //When parsing with the cache, the strings have already been interned
+        const bool internStrings = this->_stringPool && cache == nullptr;
+        const ErrorCode error = cache != nullptr ? this->parse(bytes, filter, *cache, contentHash) : this->parse(bytes, filter);
+        if(error == ErrorCode::Success){
+            this->_fileStamp = fileStamp;
+            this->_contentHash = contentHash;
+            this->_hasContentHash = changed != nullptr;
+            if(internStrings){
+                this->internStrings(this->_stringPool);
+            }
+        }
+        return error;
+    }
+
+    /**
+     * Computes a 64-bit hash of the contents of a file. Like the accumulation loop of XXH3, this reads 64 bytes at a time into eight independent lanes that only add products of 32-bit halves, which is done with vector multiplications when SIMD instructions are available and is several times faster than `hashBytes()` for whole files. Like in XXH3, the keys are taken from a different position of the secret for each 64-byte stripe of a 1024-byte block and the lanes are scrambled after each block, so moving a stripe to another position changes the hash. The hash depends on the byte order of the platform, so it must not be stored.
      */
-    std::string readFixedLengthString(const std::vector<uint8_t> &bytes, size_t offset, size_t length) const {
-        std::string result;
+    static uint64_t hashContents(const ByteView &bytes) noexcept {
+        constexpr uint64_t multiplier = 0x9E3779B97F4A7C15;
+        constexpr size_t stripesPerBlock = 16;
+        //Stripe `n` of a block uses the eight keys starting at `secret[n]`, and the last incomplete stripe uses the last eight keys
+        constexpr uint64_t secret[stripesPerBlock + 8] = {
+            0x243F6A8885A308D3, 0x13198A2E03707344, 0xA4093822299F31D0, 0x082EFA98EC4E6C89, 0x452821E638D01377, 0xBE5466CF34E90C6C, 0xC0AC29B7C97C50DD, 0x3F84D5B5B5470917,
+            0x9216D5D98979FB1B, 0xD1310BA698DFB5AC, 0x2FFD72DBD01ADFB7, 0xB8E1AFED6A267E96, 0xBA7C9045F12C7F99, 0x24A19947B3916CF7, 0x0801F2E2858EFC16, 0x636920D871574E69,
+            0xA458FEA3F4933D7E, 0x0D95748F728EB658, 0x718BCD5882154AEE, 0x7B54A41DC25A59B5, 0x9C30D5392AF26013, 0xC5D1B023286085F0, 0xCA417918B8DB38EF, 0x8E79DCB0603A180E
+        };
+        const auto mix = [](uint64_t hash, uint64_t word){
+            hash = (hash ^ word) * multiplier;
+            return hash ^ (hash >> 29);
+        };
+        const auto load = [&bytes](size_t i){
+            uint64_t word;
+            std::memcpy(&word, bytes.data + i, sizeof(word));
+            return word;
+        };
+        uint64_t lanes[8] = {};
+        const auto accumulate = [&](size_t offset, size_t stripe){
+            const uint64_t* const keys = secret + stripe;
+            //Each vector contains two lanes, and swapping its halves adds each word to the other lane like the scalar version does
+            #if defined(LNKFILEINFO_SSE2)
+                for(size_t lane = 0; lane < 8; lane += 2){
+                    const __m128i word = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes.data + offset + lane * 8));
+                    const __m128i keyed = _mm_xor_si128(word, _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + lane)));
+                    const __m128i product = _mm_mul_epu32(keyed, _mm_srli_epi64(keyed, 32));
+                    __m128i* const accumulator = reinterpret_cast<__m128i*>(lanes + lane);
+                    _mm_storeu_si128(accumulator, _mm_add_epi64(_mm_loadu_si128(accumulator), _mm_add_epi64(_mm_shuffle_epi32(word, _MM_SHUFFLE(1, 0, 3, 2)), product)));
+                }
+            #elif defined(LNKFILEINFO_NEON)
+                for(size_t lane = 0; lane < 8; lane += 2){
+                    const uint64x2_t word = vreinterpretq_u64_u8(vld1q_u8(bytes.data + offset + lane * 8));
+                    const uint64x2_t keyed = veorq_u64(word, vld1q_u64(keys + lane));
+                    const uint64x2_t product = vmull_u32(vmovn_u64(keyed), vshrn_n_u64(keyed, 32));
+                    vst1q_u64(lanes + lane, vaddq_u64(vld1q_u64(lanes + lane), vaddq_u64(vextq_u64(word, word, 1), product)));
+                }
+            #else
+                for(size_t lane = 0; lane < 8; lane++){
+                    const uint64_t word = load(offset + lane * 8);
+                    const uint64_t keyed = word ^ keys[lane];
+                    lanes[lane ^ 1] += word;    //So that words whose keyed low or high half is zero still change the hash
+                    lanes[lane] += (keyed & 0xFFFFFFFF) * (keyed >> 32);
+                }
+            #endif
+        };
+        //Like the scrambling step of XXH3, this makes the lanes depend on the order of the blocks
+        const auto scramble = [&](){
+            for(size_t lane = 0; lane < 8; lane++){
+                lanes[lane] = (lanes[lane] ^ (lanes[lane] >> 47) ^ secret[stripesPerBlock + lane]) * 0x9E3779B1;
+            }
+        };
         size_t i = 0;
-        while(i < length){
-            const auto [codepoint, bytesRead] = this->readUtf16Codepoint(bytes, i + offset + 2, bytes.size());
-            result += codepoint;
-            i += bytesRead;
+        size_t stripe = 0;
+        for(; i + 64 <= bytes.size; i += 64){
+            accumulate(i, stripe);
+            if(++stripe == stripesPerBlock){
+                scramble();
+                stripe = 0;
+            }
         }
-        return result;
+        //The last incomplete stripe overlaps the previous one so that it doesn't need to be hashed one word at a time
+        if(i < bytes.size && bytes.size >= 64){
+            accumulate(bytes.size - 64, stripesPerBlock);
+            i = bytes.size;
+        }
+        uint64_t hash = bytes.size;
+        for(const uint64_t lane: lanes){
+            hash = mix(hash, lane);
+        }
+        for(; i + 8 <= bytes.size; i += 8){
+            hash = mix(hash, load(i));
+        }
+        for(; i < bytes.size; i++){
+            hash = mix(hash, bytes.data[i]);
+        }
+        //Final avalanche from SplitMix64 so that every input bit affects the low bits, which select the shard in ContentCache
+        hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9;
+        hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EB;
+        return hash ^ (hash >> 31);
     }
 
-    #ifdef _WIN32
-        static std::wstring utf8ToNativeEncoding(const std::string& utf8){
-            //Since converting to UTF16 is only needed on Windows, it's OK to use the Windows API for this (on other OSes std::ifstream takes UTF8 directly).
-            if(utf8.empty()){
-                return L"";
+    /**
+     * Computes the 64-bit FNV-1a hash of some bytes.
+     */
+    static uint64_t hashBytes(const ByteView &bytes) noexcept {
+        uint64_t hash = 0xcbf29ce484222325;
+        for(size_t i = 0; i < bytes.size; i++){
+            hash = (hash ^ bytes.data[i]) * 0x100000001b3;
+        }
+        return hash;
+    }
+
+    /**
+     * Gets the last write time and size of a file without opening it.
+     *
+     * @param filePath  The path of the file, encoded in UTF-8.
+     * @param fileStamp Set to the stamp of the file if getting it succeeded, left unchanged otherwise.
+     *
+     * @return True if getting the stamp succeeded, false otherwise.
+     */
+    static bool statFile(const std::string &filePath, FileStamp &fileStamp){
+        #ifdef _WIN32
+            WIN32_FILE_ATTRIBUTE_DATA attributes;
+            if(!GetFileAttributesExW(utf8ToNativeEncoding(filePath).c_str(), GetFileExInfoStandard, &attributes)){
+                return false;
             }
-            const int sizeNeeded = MultiByteToWideChar(CP_UTF8, 0, utf8.data(), static_cast<int>(utf8.size()), nullptr, 0);
-            std::wstring utf16(sizeNeeded, 0);
-            MultiByteToWideChar(CP_UTF8, 0, utf8.data(), static_cast<int>(utf8.size()), utf16.data(), sizeNeeded);
-            return utf16;
+            fileStamp = makeFileStamp(attributes.ftLastWriteTime, attributes.nFileSizeHigh, attributes.nFileSizeLow);
+        #else
+            struct stat status;
+            if(::stat(filePath.c_str(), &status) != 0){
+                return false;
+            }
+            fileStamp = makeFileStamp(status);
+        #endif
+        return true;
+    }
+
+    #ifdef _WIN32
+        static FileStamp makeFileStamp(const FILETIME &lastWriteTime, DWORD sizeHigh, DWORD sizeLow) noexcept {
+            return FileStamp{static_cast<uint64_t>(lastWriteTime.dwHighDateTime) << 32 | lastWriteTime.dwLowDateTime, static_cast<uint64_t>(sizeHigh) << 32 | sizeLow};
         }
     #else
-        static std::string utf8ToNativeEncoding(const std::string& utf8){
-            return utf8;
+        static FileStamp makeFileStamp(const struct stat &status) noexcept {
+            //Only regular files have a meaningful size
+            if(!S_ISREG(status.st_mode)){
+                return FileStamp();
+            }
+            #ifdef __APPLE__
+                const struct timespec &lastWriteTime = status.st_mtimespec;
+            #else
+                const struct timespec &lastWriteTime = status.st_mtim;
+            #endif
+            return FileStamp{static_cast<uint64_t>(lastWriteTime.tv_sec) * 1000000000 + static_cast<uint64_t>(lastWriteTime.tv_nsec), static_cast<uint64_t>(status.st_size)};
         }
     #endif
 
-    std::string _filePath;
-    std::string _absoluteFilePath;
-    std::string _targetPath;
-    std::string _targetVolumeName;
-    std::string _description;
-    std::string _relativeTargetPath;
-    std::string _workingDirectory;
-    std::string _commandLineArgs;
-    std::string _iconPath;
-    uint32_t _targetSize = 0;
-    uint32_t _iconIndex = 0;
-    uint32_t _targetVolumeSerial = 0;
-    uint16_t _targetAttributes = 0;
-    VolumeType _targetVolumeType = VolumeType::Unknown;
-    bool _targetIsOnNetwork = false;
+    /**
+     * Sets the absolute file path from the file path. With `AbsolutePath`, and on Linux and macOS for paths that are already absolute, the file path is copied as it is, which reuses the capacity of the absolute file path instead of allocating a new string. Otherwise `std::filesystem::absolute` is used, which on Windows also normalizes the path.
+     *
+     * @param error   Set to the error from `std::filesystem::absolute` if the absolute path couldn't be determined, left unchanged otherwise.
+     *
+     * @return False if the absolute path couldn't be determined, true otherwise.
+     */
+    bool updateAbsoluteFilePath(std::error_code &error){
+        const PhaseTimer timer(&ParseStats::absolutePathNanoseconds);
+        bool isAbsolute = this->_options & ParseOption::AbsolutePath;
+        #ifndef _WIN32
+            isAbsolute = isAbsolute || (!this->_filePath.empty() && this->_filePath[0] == '/');
+        #endif
+        if(isAbsolute){
+            this->setAbsoluteFilePath(this->_filePath);
+            return true;
+        }
+        this->setAbsoluteFilePath(std::filesystem::absolute(this->_filePath, error).string());
+        if(error){
+            recordError(ErrorCode::OpenFailed);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Same as `updateAbsoluteFilePath(std::error_code&)`, but without the error.
+     */
+    bool updateAbsoluteFilePath(){
+        std::error_code error;
+        return this->updateAbsoluteFilePath(error);
+    }
+
+    /**
+     * Same as `updateAbsoluteFilePath()`, but throws an exception if the absolute path couldn't be determined.
+     *
+     * @throws LnkFileInfo::IoError containing the path and the error code from `std::filesystem::absolute`.
+     */
+    void updateAbsoluteFilePathOrThrow(){
+        std::error_code error;
+        if(!this->updateAbsoluteFilePath(error)){
+            throw IoError(std::filesystem::filesystem_error("cannot make absolute path", std::filesystem::path(this->_filePath), error));
+        }
+    }
+
+    /**
+     * Sets the absolute file path and the hash used by `hash()` and `operator==`. This must be used instead of assigning `_absoluteFilePath` directly.
+     */
+    void setAbsoluteFilePath(std::string_view absoluteFilePath){
+        this->_absoluteFilePath = absoluteFilePath;
+        this->_absoluteFilePathHash = hashBytes(ByteView{reinterpret_cast<const uint8_t*>(absoluteFilePath.data()), absoluteFilePath.size()});
+    }
+
+    /**
+     * Reads the whole contents of a file. The size of the file is used to read it all at once if it's known, otherwise (for example for pipes) it's read in chunks until the end.
+     *
+     * @param filePath  The path of the file, encoded in UTF-8.
+     * @param buffer    Replaced with the contents of the file. Its capacity is reused, so no memory is allocated if it's already large enough.
+     * @param fileStamp Set to the stamp of the file when it was opened, or to an unknown stamp if it isn't a regular file.
+     *
+     * @return `LnkFileInfo::Success` if reading the file succeeded, `LnkFileInfo::OpenFailed` if the file couldn't be opened, and `LnkFileInfo::ReadFailed` if it couldn't be read.
+     */
+    static ErrorCode readFile(const std::string &filePath, std::vector<uint8_t> &buffer, FileStamp &fileStamp){
+        //One byte more than the size of the file is requested so that the end of the file is detected without growing the buffer.
+        constexpr size_t unknownSizeChunk = 4096;
+        size_t size = 0;
+        bool success = true;
+        #ifdef _WIN32
+            const HANDLE file = CreateFileW(utf8ToNativeEncoding(filePath).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if(file == INVALID_HANDLE_VALUE){
+                return ErrorCode::OpenFailed;
+            }
+            BY_HANDLE_FILE_INFORMATION information;
+            fileStamp = GetFileInformationByHandle(file, &information) ? makeFileStamp(information.ftLastWriteTime, information.nFileSizeHigh, information.nFileSizeLow) : FileStamp();
+            buffer.resize(fileStamp.isKnown() ? static_cast<size_t>(fileStamp.size) + 1 : unknownSizeChunk);
+            for(;;){
+                DWORD bytesRead = 0;
+                if(!ReadFile(file, buffer.data() + size, static_cast<DWORD>(std::min<size_t>(buffer.size() - size, 0x40000000)), &bytesRead, nullptr)){
+                    success = GetLastError() == ERROR_BROKEN_PIPE;    //The end of a pipe
+                    break;
+                }
+                if(bytesRead == 0){
+                    break;
+                }
+                size += bytesRead;
+                if(size == buffer.size()){
+                    buffer.resize(size * 2);
+                }
+            }
+            CloseHandle(file);
+        #else
+            const int file = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+            if(file < 0){
+                return ErrorCode::OpenFailed;
+            }
+            struct stat status;
+            fileStamp = fstat(file, &status) == 0 ? makeFileStamp(status) : FileStamp();
+            buffer.resize(fileStamp.isKnown() ? static_cast<size_t>(fileStamp.size) + 1 : unknownSizeChunk);
+            for(;;){
+                const ssize_t bytesRead = ::read(file, buffer.data() + size, buffer.size() - size);
+                if(bytesRead < 0){
+                    if(errno == EINTR){
+                        continue;
+                    }
+                    success = false;
+                    break;
+                }
+                if(bytesRead == 0){
+                    break;
+                }
+                size += static_cast<size_t>(bytesRead);
+                if(size == buffer.size()){
+                    buffer.resize(size * 2);
+                }
+            }
+            ::close(file);
+        #endif
+        buffer.resize(size);
+        return success ? ErrorCode::Success : ErrorCode::ReadFailed;
+    }
+
+    /**
+     * RAII wrapper around a read-only memory mapping of a file. If mapping the file fails for any reason (including if the file is empty or isn't a regular file), `isMapped()` returns false and the caller should read the file normally instead.
+     */
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string& filePath){
+            #ifdef _WIN32
+                const HANDLE file = CreateFileW(utf8ToNativeEncoding(filePath).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+                if(file == INVALID_HANDLE_VALUE){
+                    return;
+                }
+                BY_HANDLE_FILE_INFORMATION information;
+                if(GetFileInformationByHandle(file, &information) && (information.nFileSizeHigh != 0 || information.nFileSizeLow != 0)){
+                    const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                    if(mapping != nullptr){
+                        //The view keeps the mapping alive, so the handles can be closed immediately.
+                        this->_data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                        if(this->_data != nullptr){
+                            this->_fileStamp = makeFileStamp(information.ftLastWriteTime, information.nFileSizeHigh, information.nFileSizeLow);
+                            this->_size = static_cast<size_t>(this->_fileStamp.size);
+                        }
+                        CloseHandle(mapping);
+                    }
+                }
+                CloseHandle(file);
+            #else
+                const int file = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+                if(file < 0){
+                    return;
+                }
+                struct stat status;
+                if(fstat(file, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0){
+                    void* data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+                    if(data != MAP_FAILED){
+                        this->_data = static_cast<const uint8_t*>(data);
+                        this->_size = static_cast<size_t>(status.st_size);
+                        this->_fileStamp = makeFileStamp(status);
+                    }
+                }
+                ::close(file);
+            #endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile(){
+            if(this->_data != nullptr){
+                #ifdef _WIN32
+                    UnmapViewOfFile(this->_data);
+                #else
+                    munmap(const_cast<uint8_t*>(this->_data), this->_size);
+                #endif
+            }
+        }
+
+        bool isMapped() const noexcept {
+            return this->_data != nullptr;
+        }
+
+        ByteView bytes() const noexcept {
+            return ByteView{this->_data, this->_size};
+        }
+
+        const FileStamp& fileStamp() const noexcept {
+            return this->_fileStamp;
+        }
+
+    private:
+        const uint8_t* _data = nullptr;
+        size_t _size = 0;
+        FileStamp _fileStamp;
+    };
+
+    /**
+     * The locations of the parts of the LinkInfo and StringData sections that are decoded, as found by `validateSections()`. All of them are within the bounds of the LNK file, so `decodeSections()` can read them without any bounds checks.
+     */
+    struct Sections {
+        size_t start = 0;                                   //The offset of the LinkInfo structure
+        uint8_t fileinfoHeader = 0;                         //The size of the LinkInfo header, 0x24 if there is a Unicode target path and 0x1C otherwise
+        bool isOnNetwork = false;
+        size_t volumeInfo = 0;                              //The offset of the VolumeID structure, or of the CommonNetworkRelativeLink structure if the target is on the network
+        size_t volumeName = 0;                              //The offsets of the Latin1 strings and their lengths in bytes, not including the null terminators
+        size_t volumeNameLength = 0;
+        size_t targetDrive = 0;                             //Only used if the target is on the network
+        size_t targetDriveLength = 0;
+        size_t targetPath = 0;
+        size_t targetPathLength = 0;
+        size_t unicodeTargetPath = 0;                       //The offset two bytes before the Unicode target path and its length in code units, only used if `fileinfoHeader` is 0x24
+        size_t unicodeTargetPathUnits = 0;
+        uint8_t stringDataEntries = 0;                      //A bit mask of the `StringDataEntry` values that are present
+        size_t stringDataOffsets[StringDataEntryCount] = {};    //The offsets of the lengths preceding the strings that are present
+        uint16_t stringDataUnits[StringDataEntryCount] = {};
+        size_t end = 0;                                     //The end of the StringData section, where the ExtraData section starts
+    };
+
+    /**
+     * Adds an offset read from the LNK file to an offset within the LNK file, without overflowing even if the offset read from the LNK file is arbitrarily large.
+     *
+     * @param bytes     The bytes contained in the LNK file.
+     * @param base      An offset that is at most `bytes.size`.
+     * @param offset    The offset to add to `base`.
+     * @param size      The number of bytes that must be within bounds after `base + offset`.
+     * @param result    Set to `base + offset` if it's within bounds, left unchanged otherwise.
+     *
+     * @return True if the `size` bytes starting at `base + offset` are within the bounds of the LNK file, false otherwise.
+     */
+    static bool addOffset(const ByteView &bytes, size_t base, uint64_t offset, size_t size, size_t &result) noexcept {
+        if(offset > bytes.size - base || size > bytes.size - base - offset){
+            return false;
+        }
+        result = base + static_cast<size_t>(offset);
+        return true;
+    }
+
+    /**
+     * Checks that all offsets and lengths in the LinkInfo and StringData sections are within the bounds of the LNK file, and computes the locations of the strings in them. This doesn't modify this object, and the header must already have been checked to be at least `HeaderLayout::minimumSize` bytes.
+     *
+     * @param bytes             The bytes contained in the LNK file.
+     * @param flags             The LinkFlags field of the header.
+     * @param withStringData    Whether to check the StringData section, false with `ParseOption::TargetOnly`.
+     * @param sections          Set to the locations of the decoded parts of the sections. If the result is `InvalidFileinfoHeader`, only `fileinfoHeader` is set.
+     *
+     * @return `LnkFileInfo::Success` if the sections are within bounds, and the reason they aren't otherwise.
+     */
+    static ErrorCode validateSections(const ByteView &bytes, uint8_t flags, bool withStringData, Sections &sections) noexcept {
+        //LinkInfo header. The offset is computed as a size_t so that large ID lists can't make it wrap around.
+        const size_t start = HeaderLayout::IdListSize::end + readHeaderField<HeaderLayout::IdListSize>(bytes.data);
+        if(start > bytes.size || bytes.size - start < 5){
+            return ErrorCode::IndexOutOfRange;
+        }
+        sections.start = start;
+        sections.fileinfoHeader = bytes[start + 4];
+        if(sections.fileinfoHeader != 0x1C && sections.fileinfoHeader != 0x24){
+            return ErrorCode::InvalidFileinfoHeader;
+        }
+        if(bytes.size - start < sections.fileinfoHeader){
+            return ErrorCode::IndexOutOfRange;
+        }
+        sections.isOnNetwork = bytes[start + 8] & 0x02;
+
+        //Path and volume info. The Latin1 target path is needed even if there is a Unicode target path, since it determines where the Unicode target path is and how long it is.
+        size_t latin1PathLength;
+        if(sections.isOnNetwork){
+            if(!addOffset(bytes, start, loadLittleEndian<uint32_t>(bytes.data + start + 20), 20, sections.volumeInfo)
+                || !findTerminator(bytes, sections.volumeInfo + 20, sections.volumeNameLength)){
+                return ErrorCode::IndexOutOfRange;
+            }
+            sections.volumeName = sections.volumeInfo + 20;
+            sections.targetDrive = sections.volumeName + sections.volumeNameLength + 1;
+            if(!findTerminator(bytes, sections.targetDrive, sections.targetDriveLength)){
+                return ErrorCode::IndexOutOfRange;
+            }
+            sections.targetPath = sections.targetDrive + sections.targetDriveLength + 1;
+            if(!findTerminator(bytes, sections.targetPath, sections.targetPathLength)){
+                return ErrorCode::IndexOutOfRange;
+            }
+            latin1PathLength = sections.targetDriveLength + 1 + sections.targetPathLength;
+            sections.unicodeTargetPath = sections.targetDrive + latin1PathLength - latin1PathLength % 2;
+            sections.unicodeTargetPathUnits = sections.targetPathLength;
+        }
+        else{
+            if(!addOffset(bytes, start, loadLittleEndian<uint32_t>(bytes.data + start + 12), 16, sections.volumeInfo)
+                || !findTerminator(bytes, sections.volumeInfo + 16, sections.volumeNameLength)
+                || !addOffset(bytes, start, loadLittleEndian<uint32_t>(bytes.data + start + 16), 0, sections.targetPath)
+                || !findTerminator(bytes, sections.targetPath, sections.targetPathLength)){
+                return ErrorCode::IndexOutOfRange;
+            }
+            sections.volumeName = sections.volumeInfo + 16;
+            latin1PathLength = sections.targetPathLength;
+            sections.unicodeTargetPath = sections.targetPath + latin1PathLength - latin1PathLength % 2;
+            sections.unicodeTargetPathUnits = latin1PathLength;
+        }
+        if(sections.fileinfoHeader == 0x24 && (bytes.size - sections.unicodeTargetPath < 2 || sections.unicodeTargetPathUnits > (bytes.size - sections.unicodeTargetPath - 2) / 2)){
+            return ErrorCode::IndexOutOfRange;
+        }
+        if(!withStringData){
+            return ErrorCode::Success;
+        }
+
+        //Additional info. A StringData section that starts past the end of the file is only invalid if it contains any strings.
+        constexpr Flag stringDataFlags[StringDataEntryCount] = {HasDescription, HasRelativePath, HasWorkingDirectory, HasCommandLineArgs, HasCustomIcon};
+        size_t nextLocation = bytes.size;
+        const bool stringDataInBounds = addOffset(bytes, start, loadLittleEndian<uint32_t>(bytes.data + start), 0, nextLocation);
+        sections.stringDataEntries = 0;
+        for(int entry = 0; entry < StringDataEntryCount; entry++){
+            if(flags & stringDataFlags[entry]){
+                if(!stringDataInBounds || bytes.size - nextLocation < 2){
+                    return ErrorCode::IndexOutOfRange;
+                }
+                const uint16_t units = loadLittleEndian<uint16_t>(bytes.data + nextLocation);
+                if(units > (bytes.size - nextLocation - 2) / 2){
+                    return ErrorCode::IndexOutOfRange;
+                }
+                sections.stringDataEntries |= 1 << entry;
+                sections.stringDataOffsets[entry] = nextLocation;
+                sections.stringDataUnits[entry] = units;
+                nextLocation += 2 + static_cast<size_t>(units) * 2;
+            }
+        }
+        sections.end = nextLocation;
+        return ErrorCode::Success;
+    }
+
+    /**
+     * Decodes the LinkInfo section into this object. The locations of the strings must have been checked by `validateSections()`, so no bounds are checked here.
+     *
+     * @param bytes     The bytes contained in the LNK file.
+     * @param sections  The locations computed by `validateSections()`.
+     */
+    void decodeSections(const ByteView &bytes, const Sections &sections){
+        //Path and volume info. The strings are decoded directly into the member variables so that their capacity is reused when refreshing.
+        this->_targetIsOnNetwork = sections.isOnNetwork;
+        this->_targetVolumeName.clear();
+        appendLatin1AsUtf8(bytes.data + sections.volumeName, sections.volumeNameLength, this->_targetVolumeName);
+        this->_targetPath.clear();
+        if(sections.isOnNetwork){
+            this->_targetVolumeType = VolumeType::NetworkDrive;
+            this->_targetVolumeSerial = 0;
+            appendLatin1AsUtf8(bytes.data + sections.targetDrive, sections.targetDriveLength, this->_targetPath);
+            this->_targetPath += '\\';
+        }
+        else{
+            this->_targetVolumeType = static_cast<VolumeType>(loadLittleEndian<uint32_t>(bytes.data + sections.volumeInfo + 4));
+            this->_targetVolumeSerial = loadLittleEndian<uint32_t>(bytes.data + sections.volumeInfo + 8);
+        }
+        //Non-Latin1 target path, in this case the Latin1 target path contains question marks instead of Unicode characters (needed to determine the length of the target path), and is followed by the actual target path encoded in UTF-16.
+        if(sections.fileinfoHeader == 0x24){
+            appendUtf16AsUtf8(bytes.data + sections.unicodeTargetPath + 2, sections.unicodeTargetPathUnits, this->_targetPath);
+        }
+        else{
+            appendLatin1AsUtf8(bytes.data + sections.targetPath, sections.targetPathLength, this->_targetPath);
+        }
+    }
+
+    /**
+     * Decodes the StringData section into this object, or with lazy strings only remembers where the strings are. The locations of the strings must have been checked by `validateSections()`.
+     *
+     * @param bytes     The bytes contained in the LNK file.
+     * @param sections  The locations computed by `validateSections()`.
+     */
+    void decodeStringData(const ByteView &bytes, const Sections &sections){
+        this->_hasCustomIcon = false;
+        uint8_t pending = 0;
+        for(int entry = 0; entry < StringDataEntryCount; entry++){
+            std::string &value = this->_stringData.*stringDataMembers[entry];
+            value.clear();
+            if(sections.stringDataEntries & (1 << entry)){
+                if(this->_options & ParseOption::LazyStrings){
+                    this->_stringData.offsets[entry] = sections.stringDataOffsets[entry];
+                    pending |= 1 << entry;
+                }
+                else{
+                    appendUtf16AsUtf8(bytes.data + sections.stringDataOffsets[entry] + 2, sections.stringDataUnits[entry], value);
+                }
+                if(entry == StringDataEntry::IconPath){
+                    this->_hasCustomIcon = sections.stringDataUnits[entry] > 0;
+                }
+            }
+        }
+        this->_stringData.pending = pending;
+    }
+
+    /**
+     * Returned by the private parsing methods if the LNK file doesn't match the filter that was given to them. This is never returned by any public method.
+     */
+    static constexpr ErrorCode NotMatched = static_cast<ErrorCode>(0x80);
+
+    /**
+     * Same as the public `tryOpen()` methods, with an optional filter and an optional cache.
+     */
+    static std::optional<LnkFileInfo> tryOpen(std::string filePath, ErrorCode &error, ParseOptions options, const Filter* filter, ContentCache* cache){
+        LnkFileInfo result;
+        result._filePath = std::move(filePath);
+        result._options = options;
+        std::vector<uint8_t> buffer;
+        error = result.tryRefresh(buffer, nullptr, filter, cache);
+        if(error == NotMatched){
+            error = ErrorCode::Success;
+            return std::nullopt;
+        }
+        if(error != ErrorCode::Success){
+            return std::nullopt;
+        }
+        if(!result.updateAbsoluteFilePath()){
+            error = ErrorCode::OpenFailed;
+            return std::nullopt;
+        }
+        return std::optional<LnkFileInfo>(std::move(result));
+    }
+
+    /**
+     * Same as the public `tryParse()` methods, with an optional filter and an optional cache.
+     */
+    static std::optional<LnkFileInfo> tryParse(const uint8_t* data, size_t size, ErrorCode &error, std::string filePath, ParseOptions options, const Filter* filter, ContentCache* cache){
+        LnkFileInfo result;
+        result._filePath = std::move(filePath);
+        result._options = options;
+        const ByteView bytes{data, size};
+        error = cache != nullptr ? result.parse(bytes, filter, *cache, hashContents(bytes)) : result.parse(bytes, filter);
+        if(error == NotMatched){
+            error = ErrorCode::Success;
+            return std::nullopt;
+        }
+        if(error != ErrorCode::Success){
+            return std::nullopt;
+        }
+        result.setAbsoluteFilePath(result._filePath);
+        return std::optional<LnkFileInfo>(std::move(result));
+    }
+
+    /**
+     * Parses the contents of an LNK file and stores the information in this object. This is done in two phases: first all offsets and lengths are checked against the size of the LNK file by `validateSections()`, and then everything is decoded without any further bounds checks.
+     *
+     * @param bytes   The bytes contained in the LNK file.
+     * @param filter  If not null, parsing stops as soon as it's known that the LNK file doesn't match this filter.
+     *
+     * @return `LnkFileInfo::Success` if the bytes are a valid LNK file, `NotMatched` if they don't match the filter, and the reason they aren't a valid LNK file otherwise.
+     */
+    ErrorCode parse(const ByteView &bytes, const Filter* filter = nullptr){
+        #ifdef LNKFILEINFO_STATS
+            ParseStats &stats = threadStats();
+            const std::string* const strings[] = {&this->_targetPath, &this->_targetVolumeName, &this->_stringData.description, &this->_stringData.relativeTargetPath, &this->_stringData.workingDirectory, &this->_stringData.commandLineArgs, &this->_stringData.iconPath};
+            size_t capacities[std::size(strings)];
+            for(size_t i = 0; i < std::size(strings); i++){
+                capacities[i] = strings[i]->capacity();
+            }
+            PhaseTimer timer(&ParseStats::validateNanoseconds);
+            const ErrorCode error = this->parse(bytes, timer, filter);
+            timer.stop();
+            stats.filesParsed++;
+            if(error != ErrorCode::Success && error != NotMatched){
+                stats.errors[error]++;
+            }
+            for(size_t i = 0; i < std::size(strings); i++){
+                stats.stringAllocations += strings[i]->capacity() > capacities[i];
+            }
+            return error;
+        #else
+            PhaseTimer timer(&ParseStats::validateNanoseconds);
+            return this->parse(bytes, timer, filter);
+        #endif
+    }
+
+    /**
+     * Same as `parse(const ByteView&, const Filter*)`, but copies the information from the cache if it contains an LNK file with the same contents, and adds the information to the cache otherwise. Either way, the strings are interned in the pool of this object if it has one.
+     *
+     * @param contentHash   The hash of the bytes computed by `hashContents()`.
+     */
+    ErrorCode parse(const ByteView &bytes, const Filter* filter, ContentCache &cache, uint64_t contentHash){
+        if(cache.copyTo(*this, bytes.data, bytes.size, contentHash)){
+            return filter == nullptr || filter->matches(*this) ? ErrorCode::Success : NotMatched;
+        }
+        const ErrorCode error = this->parse(bytes, filter);
+        if(error == ErrorCode::Success){
+            cache.add(*this, bytes.data, bytes.size, contentHash);
+            if(this->_stringPool){
+                this->internStrings(this->_stringPool);
+            }
+        }
+        return error;
+    }
+
+    /**
+     * Copies all information from another LnkFileInfo object that was parsed from the same contents, except the path and the options, which are kept. The strings are interned again in the pool of this object, if any.
+     */
+    void copyContents(const LnkFileInfo &other){
+        std::string filePath = std::move(this->_filePath);
+        std::string absoluteFilePath = std::move(this->_absoluteFilePath);
+        const uint64_t absoluteFilePathHash = this->_absoluteFilePathHash;
+        const ParseOptions options = this->_options;
+        std::shared_ptr<StringPool> stringPool = std::move(this->_stringPool);
+        *this = other;
+        this->_filePath = std::move(filePath);
+        this->_absoluteFilePath = std::move(absoluteFilePath);
+        this->_absoluteFilePathHash = absoluteFilePathHash;
+        this->_options = options;
+        if(stringPool){
+            this->internStrings(std::move(stringPool));
+        }
+    }
+
+    /**
+     * Same as `parse(const ByteView&, const Filter*)`, but also moves the given timer to the next phase whenever a phase of parsing ends.
+     */
+    ErrorCode parse(const ByteView &bytes, PhaseTimer &timer, const Filter* filter){
+        std::fill(std::begin(this->_internedStrings), std::end(this->_internedStrings), nullptr);
+        this->_stringData.pending = 0;
+        this->_fileStamp = FileStamp();
+        this->_hasContentHash = false;
+        if(this->_options & ParseOption::LazyStrings && (this->_stringData.retained == nullptr || bytes.data != this->_stringData.retained->bytes.data())){
+            this->_stringData.retainedBytes().assign(bytes.data, bytes.data + bytes.size);
+        }
+
+        //Check the headers. All fields of the header are read without bounds checks after checking the size once.
+        if(bytes.size == 0){
+            return ErrorCode::IndexOutOfRange;
+        }
+        if(readHeaderField<HeaderLayout::HeaderSize>(bytes.data) != 0x4C){
+            return ErrorCode::InvalidHeader;
+        }
+        if(bytes.size < HeaderLayout::minimumSize){
+            return ErrorCode::IndexOutOfRange;
+        }
+        if(filter != nullptr && !filter->matchesAttributes(readHeaderField<HeaderLayout::FileAttributes>(bytes.data))){
+            return NotMatched;
+        }
+
+        //Check all offsets in the LinkInfo and StringData sections before decoding anything from them. The flags are read here since they're also needed to know which strings there are.
+        const uint8_t flags = readHeaderField<HeaderLayout::LinkFlags>(bytes.data);
+        const bool withStringData = !(this->_options & ParseOption::TargetOnly);
+        Sections sections;
+        ErrorCode error = validateSections(bytes, flags, withStringData, sections);
+        if(error == ErrorCode::InvalidFileinfoHeader){
+            this->_fileinfoHeader = sections.fileinfoHeader;
+        }
+        if(error != ErrorCode::Success){
+            return error;
+        }
+
+        //Header info
+        timer.next(&ParseStats::linkInfoNanoseconds);
+        this->_targetCreationTime = readHeaderField<HeaderLayout::CreationTime>(bytes.data);
+        this->_targetAccessTime = readHeaderField<HeaderLayout::AccessTime>(bytes.data);
+        this->_targetWriteTime = readHeaderField<HeaderLayout::WriteTime>(bytes.data);
+        const uint32_t showCommand = readHeaderField<HeaderLayout::ShowCommand>(bytes.data);
+        this->_showCommand = showCommand == ShowCommand::ShowMaximized || showCommand == ShowCommand::ShowMinimized ? static_cast<ShowCommand>(showCommand) : ShowCommand::ShowNormal;
+        this->_hotkey = readHeaderField<HeaderLayout::HotKey>(bytes.data);
+
+        //Target info, which is decoded before the ID list so that LNK files that don't match the filter are rejected before copying it
+        this->_targetAttributes = readHeaderField<HeaderLayout::FileAttributes>(bytes.data);
+        this->_targetSize = readHeaderField<HeaderLayout::FileSize>(bytes.data);
+        this->decodeSections(bytes, sections);
+        if(filter != nullptr && !filter->matchesTarget(*this)){
+            return NotMatched;
+        }
+
+        if(this->_options & ParseOption::IdList && flags & Flag::HasShellIdList){
+            this->parseIdList(bytes, sections.start);
+        }
+        else{
+            this->_idList.clear();
+        }
+        this->clearExtraData();
+
+        if(!withStringData){
+            for(std::string StringDataValues::* value: stringDataMembers){
+                (this->_stringData.*value).clear();
+            }
+            this->_hasCustomIcon = false;
+            this->_iconIndex = 0;
+            return ErrorCode::Success;
+        }
+
+        //Additional info
+        timer.next(&ParseStats::stringDataNanoseconds);
+        this->decodeStringData(bytes, sections);
+        this->_iconIndex = flags & Flag::HasCustomIcon ? readHeaderField<HeaderLayout::IconIndex>(bytes.data) : 0;
+        if(this->_options & ParseOption::ExtraData){
+            this->parseExtraData(bytes, sections.end);
+        }
+        return ErrorCode::Success;
+    }
+
+    /**
+     * Copies the items of the LinkTargetIDList into `_idList`, reusing the capacity of the items from the previous file. An item that extends past the end of the LinkTargetIDList is treated as its end, like `LnkFileCarver` does with the extra data, so that asking for the items never makes an LNK file invalid.
+     *
+     * @param bytes The bytes contained in the LNK file.
+     * @param end   The offset after the end of the LinkTargetIDList.
+     */
+    void parseIdList(const ByteView &bytes, size_t end){
+        //The items are read from a view that ends at the end of the ID list, so that an item can't extend past it
+        const ByteView idList{bytes.data, std::min(end, bytes.size)};
+        ErrorCode error = ErrorCode::Success;
+        size_t count = 0;
+        for(size_t offset = headerSize + 2;; count++){
+            const uint16_t itemSize = readInteger<uint16_t>(idList, offset, error);
+            //A size of zero is the terminal item
+            if(error != ErrorCode::Success || itemSize < 2 || offset + itemSize > idList.size){
+                break;
+            }
+            if(count == this->_idList.size()){
+                this->_idList.emplace_back();
+            }
+            this->_idList[count].assign(bytes.data + offset + 2, bytes.data + offset + itemSize);
+            offset += itemSize;
+        }
+        this->_idList.resize(count);
+    }
+
+    /**
+     * Decodes the ExtraData blocks that have a corresponding method. Other blocks are skipped, and so are blocks whose signature has already been seen, since Windows only uses the first block with each signature. A block that is too small or that extends past the end of the file is treated as the end of the extra data, like `LnkFileCarver` does, so that asking for the extra data never makes an LNK file invalid.
+     *
+     * @param bytes     The bytes contained in the LNK file.
+     * @param offset    The offset of the first ExtraData block.
+     */
+    void parseExtraData(const ByteView &bytes, size_t offset){
+        ErrorCode error = ErrorCode::Success;
+        bool foundEnvironment = false, foundTracker = false, foundKnownFolder = false;
+        //Files that end right after a block without the terminal block are accepted, since the block sizes are enough to know where the blocks end
+        while(offset + 4 <= bytes.size){
+            const uint32_t blockSize = readInteger<uint32_t>(bytes, offset, error);
+            //A size less than 4 is the terminal block, and a block that doesn't fit is treated the same way
+            if(blockSize < 8 || blockSize > bytes.size - offset){
+                break;
+            }
+            const ByteView block{bytes.data + offset, blockSize};
+            switch(readInteger<uint32_t>(block, 4, error)){
+            case ExtraDataSignature::EnvironmentVariableDataBlock:
+                if(!std::exchange(foundEnvironment, true) && blockSize >= 0x314){
+                    //The Unicode path is preferred since the ANSI path is in the code page of the computer that created the LNK file, which is assumed to be Latin1 like elsewhere in LNK files
+                    size_t units = 0;
+                    while(units < 260 && (block[268 + units * 2] != 0 || block[269 + units * 2] != 0)){
+                        units++;
+                    }
+                    appendUtf16AsUtf8(block.data + 268, units, this->_environmentTargetPath);
+                    if(units == 0){
+                        ErrorCode ansiError = ErrorCode::Success;    //An unterminated path is left empty
+                        readNullTerminatedString(ByteView{block.data + 8, 260}, 0, this->_environmentTargetPath, ansiError);
+                    }
+                }
+                break;
+            case ExtraDataSignature::TrackerDataBlock:
+                if(!std::exchange(foundTracker, true) && blockSize >= 0x60){
+                    ErrorCode machineIdError = ErrorCode::Success;    //An unterminated machine ID is left empty
+                    readNullTerminatedString(ByteView{block.data + 16, 16}, 0, this->_trackerMachineId, machineIdError);
+                    std::memcpy(this->_trackerVolumeId.bytes, block.data + 32, sizeof(Guid::bytes));
+                    std::memcpy(this->_trackerObjectId.bytes, block.data + 48, sizeof(Guid::bytes));
+                    std::memcpy(this->_trackerBirthVolumeId.bytes, block.data + 64, sizeof(Guid::bytes));
+                    std::memcpy(this->_trackerBirthObjectId.bytes, block.data + 80, sizeof(Guid::bytes));
+                }
+                break;
+            case ExtraDataSignature::KnownFolderDataBlock:
+                if(!std::exchange(foundKnownFolder, true) && blockSize >= 0x1C){
+                    std::memcpy(this->_knownFolderId.bytes, block.data + 8, sizeof(Guid::bytes));
+                }
+                break;
+            }
+            offset += blockSize;
+        }
+    }
+
+    /**
+     * Resets the information that is decoded from the ExtraData blocks.
+     */
+    void clearExtraData() noexcept {
+        this->_environmentTargetPath.clear();
+        this->_trackerMachineId.clear();
+        this->_trackerVolumeId = Guid();
+        this->_trackerObjectId = Guid();
+        this->_trackerBirthVolumeId = Guid();
+        this->_trackerBirthObjectId = Guid();
+        this->_knownFolderId = Guid();
+    }
+
+    /**
+     * Returns the given string from the StringData section, decoding it first if it was parsed lazily and hasn't been decoded yet.
+     *
+     * @param entry The string to get.
+     *
+     * @return A reference to the member variable containing the decoded string.
+     */
+    const std::string& stringData(StringDataEntry entry) const {
+        std::string &value = this->_stringData.*stringDataMembers[entry];
+        if(this->_stringData.pending.load(std::memory_order_acquire) & (1 << entry)){
+            //Another thread may be decoding the same string, so check again once no other thread can be decoding
+            const std::lock_guard lock(this->_stringData.retained->mutex);
+            if(this->_stringData.pending.load(std::memory_order_relaxed) & (1 << entry)){
+                const PhaseTimer timer(&ParseStats::stringDataNanoseconds);
+                //The bounds were checked when parsing, so this can't fail
+                ErrorCode error = ErrorCode::Success;
+                value.clear();
+                const std::vector<uint8_t> &bytes = this->_stringData.retained->bytes;
+                readStringWithPrependedLength(ByteView{bytes.data(), bytes.size()}, this->_stringData.offsets[entry], value, error);
+                this->_stringData.pending.fetch_and(static_cast<uint8_t>(~(1 << entry)), std::memory_order_release);
+            }
+        }
+        return value;
+    }
+
+    /**
+     * Returns the interned copy of a string if `internStrings()` has been called since the LNK file was last parsed, and the string itself otherwise.
+     */
+    const std::string& internedString(InternedString which, const std::string &value) const noexcept {
+        return this->_internedStrings[which] != nullptr ? *this->_internedStrings[which] : value;
+    }
+
+    #ifdef _WIN32
+        static std::wstring utf8ToNativeEncoding(const std::string& utf8){
+            //Since converting to UTF16 is only needed on Windows, it's OK to use the Windows API for this (on other OSes std::ifstream takes UTF8 directly).
+            if(utf8.empty()){
+                return L"";
+            }
+            const int sizeNeeded = MultiByteToWideChar(CP_UTF8, 0, utf8.data(), static_cast<int>(utf8.size()), nullptr, 0);
+            std::wstring utf16(sizeNeeded, 0);
+            MultiByteToWideChar(CP_UTF8, 0, utf8.data(), static_cast<int>(utf8.size()), utf16.data(), sizeNeeded);
+            return utf16;
+        }
+    #else
+        static const std::string& utf8ToNativeEncoding(const std::string& utf8){
+            return utf8;
+        }
+    #endif
+
+    /**
+     * The bytes of an LNK file retained with `LnkFileInfo::LazyStrings`. They're shared by the copies of the object that retained them, and the mutex is locked while strings are decoded from them.
+     */
+    struct RetainedBytes {
+        std::vector<uint8_t> bytes;
+        std::mutex mutex;
+    };
+
+    /**
+     * The strings in the StringData section. With `LnkFileInfo::LazyStrings`, a string is only decoded the first time it's needed, so a string whose bit is set in `pending` may be written by any thread holding the mutex of `retained`, and copying locks that mutex until the strings have been copied.
+     */
+    struct StringDataValues {
+        std::string description;
+        std::string relativeTargetPath;
+        std::string workingDirectory;
+        std::string commandLineArgs;
+        std::string iconPath;
+        size_t offsets[StringDataEntryCount] = {};
+        std::shared_ptr<RetainedBytes> retained;    //Only used with LazyStrings
+        std::atomic<uint8_t> pending = 0;           //Bit mask of StringDataEntry values that haven't been decoded yet
+
+        StringDataValues() = default;
+
+        StringDataValues(const StringDataValues& other){
+            *this = other;
+        }
+
+        StringDataValues(StringDataValues&& other) noexcept {
+            *this = std::move(other);
+        }
+
+        StringDataValues& operator=(const StringDataValues& other){
+            std::unique_lock<std::mutex> lock;
+            if(other.pending.load(std::memory_order_acquire) != 0){
+                lock = std::unique_lock(other.retained->mutex);
+            }
+            for(std::string StringDataValues::* value: stringDataMembers){
+                this->*value = other.*value;
+            }
+            std::copy(std::begin(other.offsets), std::end(other.offsets), std::begin(this->offsets));
+            this->retained = other.retained;
+            this->pending.store(other.pending.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            return *this;
+        }
+
+        StringDataValues& operator=(StringDataValues&& other) noexcept {
+            for(std::string StringDataValues::* value: stringDataMembers){
+                this->*value = std::move(other.*value);
+            }
+            std::copy(std::begin(other.offsets), std::end(other.offsets), std::begin(this->offsets));
+            this->retained = std::move(other.retained);
+            this->pending.store(other.pending.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+            return *this;
+        }
+
+        /**
+         * Returns the retained bytes so that they can be overwritten, first replacing them with new ones if they're shared with other objects.
+         */
+        std::vector<uint8_t>& retainedBytes(){
+            if(this->retained.use_count() != 1){
+                this->retained = std::make_shared<RetainedBytes>();
+            }
+            return this->retained->bytes;
+        }
+    };
+    static constexpr std::string StringDataValues::* stringDataMembers[StringDataEntryCount] = {&StringDataValues::description, &StringDataValues::relativeTargetPath, &StringDataValues::workingDirectory, &StringDataValues::commandLineArgs, &StringDataValues::iconPath};    //The members of StringDataValues by StringDataEntry
+
+    std::string _filePath;
+    std::string _absoluteFilePath;
+    uint64_t _absoluteFilePathHash = hashBytes(ByteView{nullptr, 0});    //The hash of _absoluteFilePath, kept up to date by setAbsoluteFilePath()
+    std::string _targetPath;
+    std::string _targetVolumeName;
+    mutable StringDataValues _stringData;
+    std::string _environmentTargetPath;
+    std::string _trackerMachineId;
+    std::vector<std::vector<uint8_t>> _idList;    //Only filled in with IdList
+    std::shared_ptr<StringPool> _stringPool;                                //The pool given to internStrings(), if any
+    const std::string* _internedStrings[InternedStringCount] = {};          //The interned strings, or null if the strings haven't been interned since the LNK file was last parsed
+    FileStamp _fileStamp;                   //The stamp of the file when it was last read, unknown if it was parsed from memory
+    uint64_t _contentHash = 0;              //The hash of the bytes that were last parsed computed by `hashContents()`, only computed by refreshIfChanged()
+    bool _hasContentHash = false;
+    uint64_t _targetCreationTime = 0;
+    uint64_t _targetAccessTime = 0;
+    uint64_t _targetWriteTime = 0;
+    Guid _trackerVolumeId;
+    Guid _trackerObjectId;
+    Guid _trackerBirthVolumeId;
+    Guid _trackerBirthObjectId;
+    Guid _knownFolderId;
+    uint32_t _targetSize = 0;
+    uint32_t _iconIndex = 0;
+    uint32_t _targetVolumeSerial = 0;
+    uint16_t _targetAttributes = 0;
+    VolumeType _targetVolumeType = VolumeType::Unknown;
+    bool _targetIsOnNetwork = false;
+    bool _hasCustomIcon = false;
+    ShowCommand _showCommand = ShowCommand::ShowNormal;
+    uint16_t _hotkey = 0;
+    ParseOptions _options = NoOptions;
+    uint8_t _fileinfoHeader = 0;    //Only used for the error message if the fileinfo header is invalid
+};
+
+/**
+ * Compile-time tests of `LnkFileInfo::HeaderLayout`. Every field is checked through `HeaderLayout::Fields`, so a field added there is tested automatically.
+ */
+struct LnkFileInfoHeaderLayoutTest {
+    using Layout = LnkFileInfo::HeaderLayout;
+
+    static constexpr bool fieldsAreOrdered = LnkFileInfo::headerFieldsAreOrdered(Layout::Fields());
+    static constexpr bool fieldsReadSampleHeader = LnkFileInfo::headerFieldsReadSampleHeader(Layout::Fields());
+    static constexpr bool signatureHasHeaderSize = LnkFileInfo::readHeaderField<Layout::HeaderSize>(LnkFileInfo::headerSignature) == 0x4C;
+};
+static_assert(LnkFileInfoHeaderLayoutTest::fieldsAreOrdered, "Header fields must not overlap");
+static_assert(LnkFileInfoHeaderLayoutTest::fieldsReadSampleHeader, "Header fields must be read as little endian integers at their offsets");
+static_assert(LnkFileInfoHeaderLayoutTest::signatureHasHeaderSize, "The header signature must start with the header size");
+
+/**
+ * Hashes LnkFileInfo objects by their absolute file path so that they can be stored in `std::unordered_set` and used as keys of `std::unordered_map`. This returns the hash that was computed when the LNK file was read, so the path isn't hashed again.
+ */
+namespace std {
+    template<>
+    struct hash<LnkFileInfo> {
+        size_t operator()(const LnkFileInfo &lnkFileInfo) const noexcept {
+            return lnkFileInfo.hash();
+        }
+    };
+}
+
+/**
+ * The LnkParser class parses many LNK files one after the other while reusing the memory allocated for the previous files. Once it has parsed files at least as large as the current one, with strings at least as long, parsing an LNK file with an absolute path from the file system or from memory doesn't allocate any memory (except on Windows, where the path needs to be converted to UTF-16).
+ *
+ * The LnkFileInfo object returned by the methods of this class is owned by the parser and is overwritten by the next call to any of them, so it should be copied if it needs to be kept.
+ */
+class LnkParser final {
+public:
+    /**
+     * Constructs a new parser.
+     *
+     * @param options   How to read and parse the LNK files, as a combination of `LnkFileInfo::ParseOption` values.
+     */
+    explicit LnkParser(LnkFileInfo::ParseOptions options = LnkFileInfo::NoOptions){
+        this->_lnkFileInfo._options = options;
+    }
+
+    /**
+     * Reads and parses an LNK file from the file system.
+     *
+     * @param filePath  The path of the LNK file. Can be an absolute or a relative path.
+     *
+     * @return A reference to the parsed LNK file, which is valid until the next call to a method of this parser.
+     *
+     * @throws LnkFileInfo::IoError if opening the file failed.
+     * @throws LnkFileInfo::InvalidLnkFile if the file is not a valid LNK file.
+     */
+    const LnkFileInfo& open(const std::string& filePath){
+        this->_lnkFileInfo._filePath = filePath;
+        this->_lnkFileInfo.throwIfError(this->_lnkFileInfo.tryRefresh(this->_buffer, nullptr));
+        this->_lnkFileInfo.updateAbsoluteFilePathOrThrow();
+        return this->_lnkFileInfo;
+    }
+
+    /**
+     * Same as `open()`, but doesn't throw an exception if reading the LNK file fails.
+     *
+     * @param filePath  The path of the LNK file. Can be an absolute or a relative path.
+     * @param error     Set to `LnkFileInfo::Success` if reading the LNK file succeeded, and to the reason it failed otherwise.
+     *
+     * @return A pointer to the parsed LNK file, which is valid until the next call to a method of this parser, or a null pointer if reading the LNK file failed.
+     */
+    const LnkFileInfo* tryOpen(const std::string& filePath, LnkFileInfo::ErrorCode &error){
+        return this->tryOpen(filePath, error, nullptr);
+    }
+
+    /**
+     * Same as `tryOpen(const std::string&, LnkFileInfo::ErrorCode&)`, but only returns the parsed LNK file if it matches the given filter. LNK files that don't match are only parsed as far as needed to check the filter.
+     *
+     * @return A pointer to the parsed LNK file, or a null pointer if reading the LNK file failed or if it doesn't match the filter. If it doesn't match, `error` is set to `LnkFileInfo::Success`.
+     */
+    const LnkFileInfo* tryOpen(const std::string& filePath, LnkFileInfo::ErrorCode &error, const LnkFileInfo::Filter &filter){
+        return this->tryOpen(filePath, error, &filter);
+    }
+
+    /**
+     * Parses an LNK file whose contents have already been loaded into memory. The bytes don't need to remain valid after this method returns.
+     *
+     * @param data      A pointer to the bytes of the LNK file.
+     * @param size      The number of bytes pointed to by `data`.
+     * @param filePath  The path the bytes were read from, if any. This is only used as the return value of `filePath()` and `absoluteFilePath()`.
+     *
+     * @return A reference to the parsed LNK file, which is valid until the next call to a method of this parser.
+     *
+     * @throws LnkFileInfo::InvalidLnkFile if the bytes are not a valid LNK file.
+     */
+    const LnkFileInfo& parse(const uint8_t* data, size_t size, const std::string& filePath = ""){
+        LnkFileInfo::ErrorCode error;
+        this->tryParse(data, size, error, filePath);
+        this->_lnkFileInfo.throwIfError(error);
+        return this->_lnkFileInfo;
+    }
+
+    /**
+     * Same as `parse()`, but doesn't throw an exception if the bytes are not a valid LNK file.
+     *
+     * @param data      A pointer to the bytes of the LNK file.
+     * @param size      The number of bytes pointed to by `data`.
+     * @param error     Set to `LnkFileInfo::Success` if the bytes are a valid LNK file, and to the reason they aren't otherwise.
+     * @param filePath  The path the bytes were read from, if any.
+     *
+     * @return A pointer to the parsed LNK file, which is valid until the next call to a method of this parser, or a null pointer if the bytes are not a valid LNK file.
+     */
+    const LnkFileInfo* tryParse(const uint8_t* data, size_t size, LnkFileInfo::ErrorCode &error, const std::string& filePath = ""){
+        return this->tryParse(data, size, error, filePath, nullptr);
+    }
+
+    /**
+     * Same as `tryParse(const uint8_t*, size_t, LnkFileInfo::ErrorCode&, const std::string&)`, but only returns the parsed LNK file if it matches the given filter.
+     *
+     * @return A pointer to the parsed LNK file, or a null pointer if the bytes are not a valid LNK file or if they don't match the filter. If they don't match, `error` is set to `LnkFileInfo::Success`.
+     */
+    const LnkFileInfo* tryParse(const uint8_t* data, size_t size, LnkFileInfo::ErrorCode &error, const std::string& filePath, const LnkFileInfo::Filter &filter){
+        return this->tryParse(data, size, error, filePath, &filter);
+    }
+
+private:
+    const LnkFileInfo* tryOpen(const std::string& filePath, LnkFileInfo::ErrorCode &error, const LnkFileInfo::Filter* filter){
+        this->_lnkFileInfo._filePath = filePath;
+        error = this->_lnkFileInfo.tryRefresh(this->_buffer, nullptr, filter);
+        if(error == LnkFileInfo::Success && !this->_lnkFileInfo.updateAbsoluteFilePath()){
+            error = LnkFileInfo::OpenFailed;
+        }
+        return this->result(error);
+    }
+
+    const LnkFileInfo* tryParse(const uint8_t* data, size_t size, LnkFileInfo::ErrorCode &error, const std::string& filePath, const LnkFileInfo::Filter* filter){
+        this->_lnkFileInfo._filePath = filePath;
+        this->_lnkFileInfo.setAbsoluteFilePath(filePath);
+        error = this->_lnkFileInfo.parse(LnkFileInfo::ByteView{data, size}, filter);
+        return this->result(error);
+    }
+
+    /**
+     * Returns the parsed LNK file if parsing it succeeded, and a null pointer otherwise. LNK files that don't match the filter aren't an error.
+     */
+    const LnkFileInfo* result(LnkFileInfo::ErrorCode &error){
+        if(error == LnkFileInfo::NotMatched){
+            error = LnkFileInfo::Success;
+            return nullptr;
+        }
+        return error == LnkFileInfo::Success ? &this->_lnkFileInfo : nullptr;
+    }
+
+    LnkFileInfo _lnkFileInfo;
+    std::vector<uint8_t> _buffer;
 };
 
 #endif // LNKFILEINFO_HPP
@@ -0,0 +1,492 @@
+/*
+ * Columnar LNK file batches, part of the LnkFileInfo library
+ * By Gustav Lindberg
+ * https://github.com/GustavLindberg99/LnkFileInfo
+ */
+
+#ifndef LNKFILEINFOBATCH_HPP
+#define LNKFILEINFOBATCH_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "lnkfileinfo.hpp"
+
+//The Arrow C data interface, see https://arrow.apache.org/docs/format/CDataInterface.html. These definitions are ABI stable and are guarded by the same macro as in Arrow's own headers so that they can be included together.
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+    void (*release)(struct ArrowSchema*);
+    void* private_data;
+};
+
+struct ArrowArray {
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+    void (*release)(struct ArrowArray*);
+    void* private_data;
+};
+
+#endif // ARROW_C_DATA_INTERFACE
+
+/**
+ * The LnkFileInfoBatch class stores the information about many LNK files in a columnar layout: each field is stored in its own contiguous array, and each string field is stored as an array of offsets into a single character buffer. This makes loops that only look at a few fields of many LNK files much faster than looping over a vector of LnkFileInfo objects, and allows exporting the batch to Apache Arrow without copying.
+ */
+class LnkFileInfoBatch final {
+public:
+    /**
+     * A column of UTF-8 encoded strings, stored as the concatenation of all strings and the offset of each string in the concatenation. The layout is the same as the Arrow `utf8` type: the offsets are 32-bit and there is one more offset than there are strings.
+     */
+    class StringColumn {
+    public:
+        StringColumn(): _offsets{0} {}
+
+        /**
+         * Returns the string at the given index. The returned view is valid until the column is modified.
+         */
+        std::string_view operator[](size_t index) const noexcept {
+            return std::string_view(this->_data.data() + this->_offsets[index], static_cast<size_t>(this->_offsets[index + 1] - this->_offsets[index]));
+        }
+
+        size_t size() const noexcept {
+            return this->_offsets.size() - 1;
+        }
+
+        /**
+         * Returns the offsets of the strings, which contain `size() + 1` elements. The string at index `i` consists of the characters between `offsets()[i]` inclusive and `offsets()[i + 1]` exclusive.
+         */
+        const int32_t* offsets() const noexcept {
+            return this->_offsets.data();
+        }
+
+        /**
+         * Returns the concatenation of all strings.
+         */
+        const char* data() const noexcept {
+            return this->_data.data();
+        }
+
+    private:
+        friend class LnkFileInfoBatch;
+
+        void push_back(std::string_view string){
+            if(string.size() > static_cast<size_t>(std::numeric_limits<int32_t>::max()) - this->_data.size()){
+                throw std::length_error("LnkFileInfoBatch string column exceeds 2 GiB");
+            }
+            this->_data += string;
+            this->_offsets.push_back(static_cast<int32_t>(this->_data.size()));
+        }
+
+        void pop_back(){
+            this->_offsets.pop_back();
+            this->_data.resize(static_cast<size_t>(this->_offsets.back()));
+        }
+
+        void clear(){
+            this->_offsets.assign(1, 0);
+            this->_data.clear();
+        }
+
+        std::vector<int32_t> _offsets;
+        std::string _data;
+    };
+
+    /**
+     * Adds the information about an LNK file to the end of the batch.
+     *
+     * @throws std::length_error if the total length of one of the string fields or of the ID list items would exceed 2 GiB, which is the limit of the Arrow `utf8` and `binary` types, or if there would be more than 2^31 ID list items. In this case the batch is left unchanged.
+     */
+    void add(const LnkFileInfo& lnkFileInfo){
+        if(lnkFileInfo._idList.size() > static_cast<size_t>(std::numeric_limits<int32_t>::max() - this->_idListOffsets.back())){
+            throw std::length_error("LnkFileInfoBatch ID list column exceeds 2^31 items");
+        }
+        StringColumn* const stringColumns[] = {&this->_filePaths, &this->_absoluteFilePaths, &this->_absoluteTargetPaths, &this->_targetVolumeNames, &this->_descriptions, &this->_relativeTargetPaths, &this->_workingDirectories, &this->_commandLineArgs, &this->_iconPaths, &this->_environmentTargetPaths, &this->_trackerMachineIds};
+        const std::string* const strings[] = {&lnkFileInfo.filePath(), &lnkFileInfo.absoluteFilePath(), &lnkFileInfo.absoluteTargetPath(), &lnkFileInfo.targetVolumeName(), &lnkFileInfo.description(), &lnkFileInfo.relativeTargetPath(), &lnkFileInfo.workingDirectory(), &lnkFileInfo.commandLineArgs(), &lnkFileInfo.iconPath(), &lnkFileInfo.environmentTargetPath(), &lnkFileInfo.trackerMachineId()};
+        size_t added = 0;
+        size_t addedItems = 0;
+        try{
+            for(; added < std::size(stringColumns); added++){
+                stringColumns[added]->push_back(*strings[added]);
+            }
+            for(; addedItems < lnkFileInfo._idList.size(); addedItems++){
+                const std::vector<uint8_t>& item = lnkFileInfo._idList[addedItems];
+                this->_idListItems.push_back(std::string_view(reinterpret_cast<const char*>(item.data()), item.size()));
+            }
+            this->_idListOffsets.push_back(static_cast<int32_t>(this->_idListItems.size()));
+        }
+        catch(...){
+            for(size_t i = 0; i < added; i++){
+                stringColumns[i]->pop_back();
+            }
+            for(size_t i = 0; i < addedItems; i++){
+                this->_idListItems.pop_back();
+            }
+            throw;
+        }
+        this->_targetAttributes.push_back(lnkFileInfo._targetAttributes);
+        this->_targetSizes.push_back(lnkFileInfo._targetSize);
+        this->_targetVolumeSerials.push_back(lnkFileInfo._targetVolumeSerial);
+        this->_iconIndices.push_back(lnkFileInfo._iconIndex);
+        this->_targetVolumeTypes.push_back(lnkFileInfo._targetVolumeType);
+        this->_targetIsOnNetwork.push_back(lnkFileInfo._targetIsOnNetwork);
+        this->_hasCustomIcon.push_back(lnkFileInfo._hasCustomIcon);
+        this->_targetCreationTimes.push_back(lnkFileInfo._targetCreationTime);
+        this->_targetAccessTimes.push_back(lnkFileInfo._targetAccessTime);
+        this->_targetWriteTimes.push_back(lnkFileInfo._targetWriteTime);
+        this->_hotkeys.push_back(lnkFileInfo._hotkey);
+        this->_showCommands.push_back(lnkFileInfo._showCommand);
+        this->_trackerVolumeIds.push_back(lnkFileInfo._trackerVolumeId);
+        this->_trackerObjectIds.push_back(lnkFileInfo._trackerObjectId);
+        this->_trackerBirthVolumeIds.push_back(lnkFileInfo._trackerBirthVolumeId);
+        this->_trackerBirthObjectIds.push_back(lnkFileInfo._trackerBirthObjectId);
+        this->_knownFolderIds.push_back(lnkFileInfo._knownFolderId);
+    }
+
+    /**
+     * Returns the information about the LNK file at the given index as an LnkFileInfo object, which behaves as if it had been parsed from the LNK file except that `refresh()` and `refreshIfChanged()` always re-read the file.
+     *
+     * @param index         The index of the LNK file in the batch.
+     * @param stringPool    If not null, the strings that `LnkFileInfo::internStrings()` interns are taken directly from this pool instead of being copied, as if `internStrings(stringPool)` had been called on the result.
+     */
+    LnkFileInfo at(size_t index, std::shared_ptr<LnkFileInfo::StringPool> stringPool) const {
+        LnkFileInfo result;
+        result._filePath = this->_filePaths[index];
+        result.setAbsoluteFilePath(this->_absoluteFilePaths[index]);
+        result._stringData.description = this->_descriptions[index];
+        result._stringData.commandLineArgs = this->_commandLineArgs[index];
+        if(stringPool){
+            const StringColumn* const internedColumns[LnkFileInfo::InternedStringCount] = {&this->_absoluteTargetPaths, &this->_targetVolumeNames, &this->_relativeTargetPaths, &this->_workingDirectories, &this->_iconPaths};
+            for(int i = 0; i < LnkFileInfo::InternedStringCount; i++){
+                result._internedStrings[i] = &stringPool->intern((*internedColumns[i])[index]);
+            }
+            result._stringPool = std::move(stringPool);
+        }
+        else{
+            result._targetPath = this->_absoluteTargetPaths[index];
+            result._targetVolumeName = this->_targetVolumeNames[index];
+            result._stringData.relativeTargetPath = this->_relativeTargetPaths[index];
+            result._stringData.workingDirectory = this->_workingDirectories[index];
+            result._stringData.iconPath = this->_iconPaths[index];
+        }
+        result._targetAttributes = this->_targetAttributes[index];
+        result._targetSize = this->_targetSizes[index];
+        result._targetVolumeSerial = this->_targetVolumeSerials[index];
+        result._iconIndex = this->_iconIndices[index];
+        result._targetVolumeType = this->_targetVolumeTypes[index];
+        result._targetIsOnNetwork = this->_targetIsOnNetwork[index];
+        result._hasCustomIcon = this->_hasCustomIcon[index];
+        result._targetCreationTime = this->_targetCreationTimes[index];
+        result._targetAccessTime = this->_targetAccessTimes[index];
+        result._targetWriteTime = this->_targetWriteTimes[index];
+        result._hotkey = this->_hotkeys[index];
+        result._showCommand = this->_showCommands[index];
+        result._environmentTargetPath = this->_environmentTargetPaths[index];
+        result._trackerMachineId = this->_trackerMachineIds[index];
+        result._trackerVolumeId = this->_trackerVolumeIds[index];
+        result._trackerObjectId = this->_trackerObjectIds[index];
+        result._trackerBirthVolumeId = this->_trackerBirthVolumeIds[index];
+        result._trackerBirthObjectId = this->_trackerBirthObjectIds[index];
+        result._knownFolderId = this->_knownFolderIds[index];
+        result._idList.reserve(static_cast<size_t>(this->_idListOffsets[index + 1] - this->_idListOffsets[index]));
+        for(int32_t item = this->_idListOffsets[index]; item < this->_idListOffsets[index + 1]; item++){
+            const std::string_view bytes = this->_idListItems[static_cast<size_t>(item)];
+            result._idList.emplace_back(bytes.begin(), bytes.end());
+        }
+        return result;
+    }
+
+    /**
+     * Equivalent to `at(index, nullptr)`.
+     */
+    LnkFileInfo at(size_t index) const {
+        return this->at(index, nullptr);
+    }
+
+    /**
+     * Returns the number of LNK files in the batch.
+     */
+    size_t size() const noexcept {
+        return this->_targetSizes.size();
+    }
+
+    /**
+     * Removes all LNK files from the batch.
+     */
+    void clear() noexcept {
+        for(StringColumn* column: {&this->_filePaths, &this->_absoluteFilePaths, &this->_absoluteTargetPaths, &this->_targetVolumeNames, &this->_descriptions, &this->_relativeTargetPaths, &this->_workingDirectories, &this->_commandLineArgs, &this->_iconPaths, &this->_environmentTargetPaths, &this->_trackerMachineIds, &this->_idListItems}){
+            column->clear();
+        }
+        this->_targetAttributes.clear();
+        this->_targetSizes.clear();
+        this->_targetVolumeSerials.clear();
+        this->_iconIndices.clear();
+        this->_targetVolumeTypes.clear();
+        this->_targetIsOnNetwork.clear();
+        this->_hasCustomIcon.clear();
+        this->_targetCreationTimes.clear();
+        this->_targetAccessTimes.clear();
+        this->_targetWriteTimes.clear();
+        this->_hotkeys.clear();
+        this->_showCommands.clear();
+        for(std::vector<LnkFileInfo::Guid>* column: {&this->_trackerVolumeIds, &this->_trackerObjectIds, &this->_trackerBirthVolumeIds, &this->_trackerBirthObjectIds, &this->_knownFolderIds}){
+            column->clear();
+        }
+        this->_idListOffsets.assign(1, 0);
+    }
+
+    /**
+     * Returns true if the target of the LNK file at the given index has the given attribute, see `LnkFileInfo::targetHasAttribute()`.
+     */
+    bool targetHasAttribute(size_t index, LnkFileInfo::Attribute attribute) const noexcept {
+        return this->_targetAttributes[index] & attribute;
+    }
+
+    //Columns. Each column contains one element per LNK file, and the fields have the same meaning as the methods with the corresponding names in the LnkFileInfo class.
+    const StringColumn& filePaths() const noexcept {return this->_filePaths;}
+    const StringColumn& absoluteFilePaths() const noexcept {return this->_absoluteFilePaths;}
+    const StringColumn& absoluteTargetPaths() const noexcept {return this->_absoluteTargetPaths;}
+    const StringColumn& targetVolumeNames() const noexcept {return this->_targetVolumeNames;}
+    const StringColumn& descriptions() const noexcept {return this->_descriptions;}
+    const StringColumn& relativeTargetPaths() const noexcept {return this->_relativeTargetPaths;}
+    const StringColumn& workingDirectories() const noexcept {return this->_workingDirectories;}
+    const StringColumn& commandLineArgs() const noexcept {return this->_commandLineArgs;}
+    const StringColumn& iconPaths() const noexcept {return this->_iconPaths;}
+    const std::vector<uint16_t>& targetAttributes() const noexcept {return this->_targetAttributes;}    //Combinations of `LnkFileInfo::Attribute` values
+    const std::vector<uint32_t>& targetSizes() const noexcept {return this->_targetSizes;}
+    const std::vector<uint32_t>& targetVolumeSerials() const noexcept {return this->_targetVolumeSerials;}
+    const std::vector<uint32_t>& iconIndices() const noexcept {return this->_iconIndices;}
+    const std::vector<LnkFileInfo::VolumeType>& targetVolumeTypes() const noexcept {return this->_targetVolumeTypes;}
+    const std::vector<uint8_t>& targetIsOnNetwork() const noexcept {return this->_targetIsOnNetwork;}    //Zero or one
+    const std::vector<uint8_t>& hasCustomIcon() const noexcept {return this->_hasCustomIcon;}    //Zero or one
+    const StringColumn& environmentTargetPaths() const noexcept {return this->_environmentTargetPaths;}
+    const StringColumn& trackerMachineIds() const noexcept {return this->_trackerMachineIds;}
+    const std::vector<uint64_t>& targetCreationTimes() const noexcept {return this->_targetCreationTimes;}
+    const std::vector<uint64_t>& targetAccessTimes() const noexcept {return this->_targetAccessTimes;}
+    const std::vector<uint64_t>& targetWriteTimes() const noexcept {return this->_targetWriteTimes;}
+    const std::vector<uint16_t>& hotkeys() const noexcept {return this->_hotkeys;}    //The key in the low byte and the modifiers in the high byte, see `LnkFileInfo::hotkeyKey()` and `LnkFileInfo::hotkeyModifiers()`
+    const std::vector<LnkFileInfo::ShowCommand>& showCommands() const noexcept {return this->_showCommands;}
+    const std::vector<LnkFileInfo::Guid>& trackerVolumeIds() const noexcept {return this->_trackerVolumeIds;}
+    const std::vector<LnkFileInfo::Guid>& trackerObjectIds() const noexcept {return this->_trackerObjectIds;}
+    const std::vector<LnkFileInfo::Guid>& trackerBirthVolumeIds() const noexcept {return this->_trackerBirthVolumeIds;}
+    const std::vector<LnkFileInfo::Guid>& trackerBirthObjectIds() const noexcept {return this->_trackerBirthObjectIds;}
+    const std::vector<LnkFileInfo::Guid>& knownFolderIds() const noexcept {return this->_knownFolderIds;}
+
+    //The ID lists. The items of the ID list of the LNK file at index `i` are the elements of `idListItems()` from `idListOffsets()[i]` inclusive to `idListOffsets()[i + 1]` exclusive, so `idListOffsets()` contains `size() + 1` elements. The layout is the same as the Arrow `list<binary>` type.
+    const std::vector<int32_t>& idListOffsets() const noexcept {return this->_idListOffsets;}
+    const StringColumn& idListItems() const noexcept {return this->_idListItems;}    //The bytes of each item
+
+    /**
+     * Exports the batch using the Arrow C data interface, as a struct array with one child array per column. The string columns are exported as `utf8` arrays, the integer columns as unsigned integer arrays of the same width, the boolean columns as `bool` arrays, the GUID columns as 16-byte `fixed_size_binary` arrays and the ID lists as a `list<binary>` array. The exported arrays don't contain any nulls.
+     *
+     * This overload copies the batch so that the exported arrays stay valid regardless of what happens to this object, use `std::move(batch).exportToArrow(array, schema)` to avoid the copy. The columns are not copied again, so the exported arrays refer to the same memory as the columns of the copied or moved batch.
+     *
+     * @param array     Set to the exported data. Must be released by calling its `release` callback.
+     * @param schema    Set to the schema of the exported data, or ignored if null. Must be released by calling its `release` callback.
+     */
+    void exportToArrow(ArrowArray* array, ArrowSchema* schema = nullptr) const & {
+        LnkFileInfoBatch(*this).exportToArrow(array, schema);
+    }
+
+    /**
+     * Same as above, but moves the batch into the exported arrays instead of copying it. This object is empty afterwards.
+     */
+    void exportToArrow(ArrowArray* array, ArrowSchema* schema = nullptr) && {
+        if(schema != nullptr){
+            exportSchema(schema);
+        }
+        const auto exported = std::make_shared<ExportedBatch>(std::move(*this));
+        this->clear();
+        const LnkFileInfoBatch &batch = *exported->batch;
+        const int64_t length = static_cast<int64_t>(batch.size());
+        const auto exportColumn = [&](size_t column, std::initializer_list<const void*> buffers){
+            std::copy(buffers.begin(), buffers.end(), exported->buffers[column].begin());
+            exported->children[column] = ArrowArray{length, 0, 0, static_cast<int64_t>(buffers.size()), 0, exported->buffers[column].data(), nullptr, nullptr, &releaseArray, new std::shared_ptr<ExportedBatch>(exported)};
+            exported->childPointers[column] = &exported->children[column];
+        };
+
+        //In the same order as in exportSchema(). There is no validity bitmap since there are no nulls.
+        size_t column = 0;
+        for(const StringColumn* stringColumn: {&batch._filePaths, &batch._absoluteFilePaths, &batch._absoluteTargetPaths, &batch._targetVolumeNames, &batch._descriptions, &batch._relativeTargetPaths, &batch._workingDirectories, &batch._commandLineArgs, &batch._iconPaths}){
+            exportColumn(column++, {nullptr, stringColumn->offsets(), stringColumn->data()});
+        }
+        for(const void* primitiveColumn: std::initializer_list<const void*>{batch._targetSizes.data(), batch._iconIndices.data(), batch._targetVolumeSerials.data(), batch._targetAttributes.data(), batch._targetVolumeTypes.data(), exported->targetIsOnNetworkBitmap.data(), exported->hasCustomIconBitmap.data()}){
+            exportColumn(column++, {nullptr, primitiveColumn});
+        }
+        for(const StringColumn* stringColumn: {&batch._environmentTargetPaths, &batch._trackerMachineIds}){
+            exportColumn(column++, {nullptr, stringColumn->offsets(), stringColumn->data()});
+        }
+        for(const void* primitiveColumn: std::initializer_list<const void*>{batch._targetCreationTimes.data(), batch._targetAccessTimes.data(), batch._targetWriteTimes.data(), batch._hotkeys.data(), batch._showCommands.data(), batch._trackerVolumeIds.data(), batch._trackerObjectIds.data(), batch._trackerBirthVolumeIds.data(), batch._trackerBirthObjectIds.data(), batch._knownFolderIds.data()}){
+            exportColumn(column++, {nullptr, primitiveColumn});
+        }
+
+        //The ID lists are a list array whose only child contains the items
+        exported->idListItemBuffers = {nullptr, batch._idListItems.offsets(), batch._idListItems.data()};
+        exported->idListItems = ArrowArray{static_cast<int64_t>(batch._idListItems.size()), 0, 0, 3, 0, exported->idListItemBuffers.data(), nullptr, nullptr, &releaseArray, new std::shared_ptr<ExportedBatch>(exported)};
+        exported->idListItemsPointer = &exported->idListItems;
+        exportColumn(column, {nullptr, batch._idListOffsets.data()});
+        exported->children[column].n_children = 1;
+        exported->children[column].children = &exported->idListItemsPointer;
+
+        *array = ArrowArray{length, 0, 0, 1, static_cast<int64_t>(columnCount), exported->parentBuffers, exported->childPointers, nullptr, &releaseArray, new std::shared_ptr<ExportedBatch>(exported)};
+    }
+
+private:
+    static constexpr size_t columnCount = 29;
+
+    static_assert(sizeof(LnkFileInfo::Guid) == 16, "GUID columns must be exportable as 16-byte fixed size binary arrays");
+
+    /**
+     * A batch that has been exported to Arrow, together with the Arrow structures that refer to its columns. It's deleted when all exported arrays referring to it have been released.
+     */
+    struct ExportedBatch {
+        using Buffers = std::array<const void*, 3>;
+
+        explicit ExportedBatch(LnkFileInfoBatch&& batch):
+            batch(std::make_unique<const LnkFileInfoBatch>(std::move(batch))),
+            targetIsOnNetworkBitmap(toBitmap(this->batch->_targetIsOnNetwork)),
+            hasCustomIconBitmap(toBitmap(this->batch->_hasCustomIcon)) {}
+
+        const std::unique_ptr<const LnkFileInfoBatch> batch;    //A pointer since LnkFileInfoBatch isn't a complete type here
+        const std::vector<uint8_t> targetIsOnNetworkBitmap;
+        const std::vector<uint8_t> hasCustomIconBitmap;
+        ArrowArray children[columnCount];
+        ArrowArray* childPointers[columnCount];
+        Buffers buffers[columnCount];
+        ArrowArray idListItems;
+        ArrowArray* idListItemsPointer;
+        Buffers idListItemBuffers;
+        const void* parentBuffers[1] = {nullptr};
+    };
+
+    /**
+     * The schema of an exported batch. It's deleted when the schema and all child schemas that were moved elsewhere by the consumer have been released.
+     */
+    struct ExportedSchema {
+        ArrowSchema children[columnCount];
+        ArrowSchema* childPointers[columnCount];
+        ArrowSchema idListItem;
+        ArrowSchema* idListItemPointer;
+    };
+
+    /**
+     * Converts a column of zeros and ones to an Arrow bitmap, in which element `i` is bit `i % 8` of byte `i / 8`.
+     */
+    static std::vector<uint8_t> toBitmap(const std::vector<uint8_t>& values){
+        std::vector<uint8_t> bitmap((values.size() + 7) / 8, 0);
+        for(size_t i = 0; i < values.size(); i++){
+            bitmap[i / 8] |= values[i] << (i % 8);
+        }
+        return bitmap;
+    }
+
+    /**
+     * Sets a schema to the schema of exported batches. The names and formats are string literals, so the only thing that needs to be freed when releasing it is the structure containing the child schemas.
+     */
+    static void exportSchema(ArrowSchema* schema){
+        static constexpr std::pair<const char*, const char*> columns[columnCount] = {
+            {"filePath", "u"}, {"absoluteFilePath", "u"}, {"absoluteTargetPath", "u"}, {"targetVolumeName", "u"}, {"description", "u"}, {"relativeTargetPath", "u"}, {"workingDirectory", "u"}, {"commandLineArgs", "u"}, {"iconPath", "u"},
+            {"targetSize", "I"}, {"iconIndex", "I"}, {"targetVolumeSerial", "I"}, {"targetAttributes", "S"}, {"targetVolumeType", "C"}, {"targetIsOnNetwork", "b"}, {"hasCustomIcon", "b"},
+            {"environmentTargetPath", "u"}, {"trackerMachineId", "u"},
+            {"targetCreationTime", "L"}, {"targetAccessTime", "L"}, {"targetWriteTime", "L"}, {"hotkey", "S"}, {"showCommand", "C"},
+            {"trackerVolumeId", "w:16"}, {"trackerObjectId", "w:16"}, {"trackerBirthVolumeId", "w:16"}, {"trackerBirthObjectId", "w:16"}, {"knownFolderId", "w:16"},
+            {"idList", "+l"}
+        };
+        const auto exported = std::make_shared<ExportedSchema>();
+        for(size_t i = 0; i < columnCount; i++){
+            exported->children[i] = ArrowSchema{columns[i].second, columns[i].first, nullptr, 0, 0, nullptr, nullptr, &releaseSchema, new std::shared_ptr<ExportedSchema>(exported)};
+            exported->childPointers[i] = &exported->children[i];
+        }
+        exported->idListItem = ArrowSchema{"z", "item", nullptr, 0, 0, nullptr, nullptr, &releaseSchema, new std::shared_ptr<ExportedSchema>(exported)};
+        exported->idListItemPointer = &exported->idListItem;
+        exported->children[columnCount - 1].n_children = 1;
+        exported->children[columnCount - 1].children = &exported->idListItemPointer;
+        *schema = ArrowSchema{"+s", "", nullptr, 0, static_cast<int64_t>(columnCount), exported->childPointers, nullptr, &releaseSchema, new std::shared_ptr<ExportedSchema>(exported)};
+    }
+
+    /**
+     * The release callback of the exported schemas. Like the exported arrays, each exported schema (including each child schema) holds a reference to the structure containing the child schemas.
+     */
+    static void releaseSchema(ArrowSchema* schema){
+        for(int64_t i = 0; i < schema->n_children; i++){
+            if(schema->children[i]->release != nullptr){
+                schema->children[i]->release(schema->children[i]);
+            }
+        }
+        delete static_cast<std::shared_ptr<ExportedSchema>*>(schema->private_data);
+        schema->release = nullptr;
+    }
+
+    /**
+     * The release callback of the exported arrays. Each exported array (including each child array, which can be moved elsewhere by the consumer) holds a reference to the exported batch.
+     */
+    static void releaseArray(ArrowArray* array){
+        for(int64_t i = 0; i < array->n_children; i++){
+            if(array->children[i]->release != nullptr){
+                array->children[i]->release(array->children[i]);
+            }
+        }
+        delete static_cast<std::shared_ptr<ExportedBatch>*>(array->private_data);
+        array->release = nullptr;
+    }
+
+    StringColumn _filePaths;
+    StringColumn _absoluteFilePaths;
+    StringColumn _absoluteTargetPaths;
+    StringColumn _targetVolumeNames;
+    StringColumn _descriptions;
+    StringColumn _relativeTargetPaths;
+    StringColumn _workingDirectories;
+    StringColumn _commandLineArgs;
+    StringColumn _iconPaths;
+    std::vector<uint16_t> _targetAttributes;
+    std::vector<uint32_t> _targetSizes;
+    std::vector<uint32_t> _targetVolumeSerials;
+    std::vector<uint32_t> _iconIndices;
+    std::vector<LnkFileInfo::VolumeType> _targetVolumeTypes;
+    std::vector<uint8_t> _targetIsOnNetwork;
+    std::vector<uint8_t> _hasCustomIcon;
+    StringColumn _environmentTargetPaths;
+    StringColumn _trackerMachineIds;
+    std::vector<uint64_t> _targetCreationTimes;
+    std::vector<uint64_t> _targetAccessTimes;
+    std::vector<uint64_t> _targetWriteTimes;
+    std::vector<uint16_t> _hotkeys;
+    std::vector<LnkFileInfo::ShowCommand> _showCommands;
+    std::vector<LnkFileInfo::Guid> _trackerVolumeIds;
+    std::vector<LnkFileInfo::Guid> _trackerObjectIds;
+    std::vector<LnkFileInfo::Guid> _trackerBirthVolumeIds;
+    std::vector<LnkFileInfo::Guid> _trackerBirthObjectIds;
+    std::vector<LnkFileInfo::Guid> _knownFolderIds;
+    std::vector<int32_t> _idListOffsets{0};
+    StringColumn _idListItems;
+};
+
+#endif // LNKFILEINFOBATCH_HPP
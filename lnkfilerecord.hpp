@@ -0,0 +1,226 @@
+/*
+ * Compact LNK file records, part of the LnkFileInfo library
+ * By Gustav Lindberg
+ * https://github.com/GustavLindberg99/LnkFileInfo
+ */
+
+#ifndef LNKFILERECORD_HPP
+#define LNKFILERECORD_HPP
+
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_set>
+
+#include "lnkfileinfo.hpp"
+
+/**
+ * A compact, trivially copyable representation of the information about an LNK file, meant for storing the information about very many LNK files. The fixed size fields are stored directly in the record, and the strings are stored as offsets into an LnkFileRecordStrings buffer, so vectors of records can be copied with `memcpy`, and sorted or partitioned without moving any strings.
+ */
+struct LnkFileRecord {
+    /**
+     * A string stored in an LnkFileRecordStrings buffer, as an offset into the buffer and a length in bytes.
+     */
+    struct String {
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    /**
+     * The bits of `flags`.
+     */
+    enum Flag: uint8_t {
+        TargetIsOnNetwork = 0x01,
+        HasCustomIcon     = 0x02
+    };
+
+    uint32_t targetSize;                        //Same as `LnkFileInfo::targetSize()`.
+    uint32_t iconIndex;                         //Same as `LnkFileInfo::iconIndex()`.
+    uint32_t targetVolumeSerial;                //Same as `LnkFileInfo::targetVolumeSerial()`.
+    uint16_t targetAttributes;                  //The attributes of the target as a combination of `LnkFileInfo::Attribute` values.
+    LnkFileInfo::VolumeType targetVolumeType;   //Same as `LnkFileInfo::targetVolumeType()`.
+    uint8_t flags;                              //A combination of `LnkFileRecord::Flag` values.
+    String filePath;
+    String absoluteFilePath;
+    String absoluteTargetPath;
+    String targetVolumeName;
+    String description;
+    String relativeTargetPath;
+    String workingDirectory;
+    String commandLineArgs;
+    String iconPath;
+
+    bool targetHasAttribute(LnkFileInfo::Attribute attribute) const noexcept {
+        return this->targetAttributes & attribute;
+    }
+
+    bool targetIsOnNetwork() const noexcept {
+        return this->flags & Flag::TargetIsOnNetwork;
+    }
+
+    bool hasCustomIcon() const noexcept {
+        return this->flags & Flag::HasCustomIcon;
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<LnkFileRecord> && std::is_standard_layout_v<LnkFileRecord>, "LnkFileRecord must be copyable with memcpy");
+static_assert(sizeof(LnkFileRecord) == 88, "LnkFileRecord must not contain padding");
+
+/**
+ * The LnkFileRecordStrings class stores the strings of LnkFileRecord objects in a single character buffer. Since a record only refers to its strings by offset, the records can be stored, copied and sorted independently of the buffer, but the buffer must be kept to read their strings.
+ */
+class LnkFileRecordStrings final {
+public:
+    /**
+     * Constructs an empty buffer.
+     *
+     * @param internStrings Whether strings that are already in the buffer are reused instead of being added again. This makes repeated volume names, working directories, icon paths and targets take no additional space.
+     */
+    explicit LnkFileRecordStrings(bool internStrings = true): _interned(0, StringHash{this}, StringEqual{this}), _internStrings(internStrings) {}
+
+    LnkFileRecordStrings(const LnkFileRecordStrings&) = delete;
+    LnkFileRecordStrings& operator=(const LnkFileRecordStrings&) = delete;
+
+    /**
+     * Adds the strings of an LNK file to the buffer and returns a record containing the information about it.
+     *
+     * @throws std::length_error if the buffer would exceed 4 GiB. In this case the buffer is left unchanged.
+     */
+    LnkFileRecord add(const LnkFileInfo& lnkFileInfo){
+        LnkFileRecord result;
+        result.targetSize = lnkFileInfo._targetSize;
+        result.iconIndex = lnkFileInfo._iconIndex;
+        result.targetVolumeSerial = lnkFileInfo._targetVolumeSerial;
+        result.targetAttributes = lnkFileInfo._targetAttributes;
+        result.targetVolumeType = lnkFileInfo._targetVolumeType;
+        result.flags = (lnkFileInfo._targetIsOnNetwork ? LnkFileRecord::TargetIsOnNetwork : 0) | (lnkFileInfo._hasCustomIcon ? LnkFileRecord::HasCustomIcon : 0);
+
+        LnkFileRecord::String* const strings[] = {&result.filePath, &result.absoluteFilePath, &result.absoluteTargetPath, &result.targetVolumeName, &result.description, &result.relativeTargetPath, &result.workingDirectory, &result.commandLineArgs, &result.iconPath};
+        const std::string* const values[] = {&lnkFileInfo.filePath(), &lnkFileInfo.absoluteFilePath(), &lnkFileInfo.absoluteTargetPath(), &lnkFileInfo.targetVolumeName(), &lnkFileInfo.description(), &lnkFileInfo.relativeTargetPath(), &lnkFileInfo.workingDirectory(), &lnkFileInfo.commandLineArgs(), &lnkFileInfo.iconPath()};
+        const size_t previousSize = this->_data.size();
+        size_t added = 0;
+        try{
+            for(; added < std::size(strings); added++){
+                *strings[added] = this->addString(*values[added]);
+            }
+        }
+        catch(...){
+            //Remove the strings that were already added so that the buffer is left unchanged
+            if(this->_internStrings){
+                for(size_t i = 0; i < added; i++){
+                    if(strings[i]->offset >= previousSize && strings[i]->size > 0){
+                        this->_interned.erase(*strings[i]);
+                    }
+                }
+            }
+            this->_data.resize(previousSize);
+            throw;
+        }
+        return result;
+    }
+
+    /**
+     * Returns a string of a record that was returned by `add()`. The returned view is valid until the buffer is modified.
+     */
+    std::string_view view(LnkFileRecord::String string) const noexcept {
+        return std::string_view(this->_data.data() + string.offset, string.size);
+    }
+
+    /**
+     * Returns the information in a record that was returned by `add()` as an LnkFileInfo object, which behaves as if it had been parsed from the LNK file except that `refresh()` and `refreshIfChanged()` always re-read the file.
+     */
+    LnkFileInfo toLnkFileInfo(const LnkFileRecord& record) const {
+        LnkFileInfo result;
+        result._filePath = this->view(record.filePath);
+        result.setAbsoluteFilePath(this->view(record.absoluteFilePath));
+        result._targetPath = this->view(record.absoluteTargetPath);
+        result._targetVolumeName = this->view(record.targetVolumeName);
+        result._stringData.description = this->view(record.description);
+        result._stringData.relativeTargetPath = this->view(record.relativeTargetPath);
+        result._stringData.workingDirectory = this->view(record.workingDirectory);
+        result._stringData.commandLineArgs = this->view(record.commandLineArgs);
+        result._stringData.iconPath = this->view(record.iconPath);
+        result._targetSize = record.targetSize;
+        result._iconIndex = record.iconIndex;
+        result._targetVolumeSerial = record.targetVolumeSerial;
+        result._targetAttributes = record.targetAttributes;
+        result._targetVolumeType = record.targetVolumeType;
+        result._targetIsOnNetwork = record.targetIsOnNetwork();
+        result._hasCustomIcon = record.hasCustomIcon();
+        return result;
+    }
+
+    /**
+     * Returns the concatenation of all strings in the buffer, which contains `size()` characters. With string interning, each distinct string only appears once.
+     */
+    const char* data() const noexcept {
+        return this->_data.data();
+    }
+
+    size_t size() const noexcept {
+        return this->_data.size();
+    }
+
+    /**
+     * Removes all strings from the buffer. Records that were returned by `add()` before this must no longer be used with this buffer.
+     */
+    void clear() noexcept {
+        this->_data.clear();
+        this->_interned.clear();
+    }
+
+private:
+    /**
+     * Hashes a string in the buffer by its contents.
+     */
+    struct StringHash {
+        const LnkFileRecordStrings* strings;
+
+        size_t operator()(LnkFileRecord::String string) const noexcept {
+            return std::hash<std::string_view>()(this->strings->view(string));
+        }
+    };
+
+    /**
+     * Compares strings in the buffer by their contents.
+     */
+    struct StringEqual {
+        const LnkFileRecordStrings* strings;
+
+        bool operator()(LnkFileRecord::String a, LnkFileRecord::String b) const noexcept {
+            return this->strings->view(a) == this->strings->view(b);
+        }
+    };
+
+    /**
+     * Adds a string to the buffer, or finds it in the buffer with string interning. The string is always appended first so that it can be looked up by its offset, and is removed again if it was already there.
+     */
+    LnkFileRecord::String addString(const std::string& string){
+        if(string.empty()){
+            return LnkFileRecord::String{0, 0};
+        }
+        if(string.size() > std::numeric_limits<uint32_t>::max() - this->_data.size()){
+            throw std::length_error("LnkFileRecordStrings buffer exceeds 4 GiB");
+        }
+        const LnkFileRecord::String result{static_cast<uint32_t>(this->_data.size()), static_cast<uint32_t>(string.size())};
+        this->_data += string;
+        if(this->_internStrings){
+            const auto [existing, inserted] = this->_interned.insert(result);
+            if(!inserted){
+                this->_data.resize(result.offset);
+                return *existing;
+            }
+        }
+        return result;
+    }
+
+    std::string _data;
+    std::unordered_set<LnkFileRecord::String, StringHash, StringEqual> _interned;    //The distinct non-empty strings in the buffer, only used with string interning
+    bool _internStrings;
+};
+
+#endif // LNKFILERECORD_HPP
@@ -0,0 +1,351 @@
+/*
+ * LNK file scanner, part of the LnkFileInfo library
+ * By Gustav Lindberg
+ * https://github.com/GustavLindberg99/LnkFileInfo
+ */
+
+#ifndef LNKFILESCANNER_HPP
+#define LNKFILESCANNER_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "lnkfileinfo.hpp"
+
+/**
+ * The LnkFileScanner class finds all LNK files in a directory tree and parses them on several threads.
+ */
+class LnkFileScanner final {
+public:
+    /**
+     * How the LNK files are split into shards, see `Options::shardCount`.
+     */
+    enum ShardBy: uint8_t {
+        PathHash = 0,    //Each LNK file belongs to the shard given by the hash of its path relative to the scanned directory. The shards are balanced, but every shard lists the whole directory tree.
+        Subtree  = 1     //Each subdirectory of the scanned directory, and everything in it, belongs to the shard given by the hash of its name. Each shard only lists its own subtrees, but the shards are only balanced if there are many subdirectories of similar sizes.
+    };
+
+    /**
+     * Options that change how a directory is scanned.
+     */
+    struct Options {
+        bool recursive = true;                                          //Whether to scan subdirectories.
+        unsigned int threads = 0;                                       //The number of threads to parse LNK files on. Zero means one thread per hardware thread.
+        LnkFileInfo::ParseOptions parseOptions = LnkFileInfo::NoOptions;    //The options to pass to the LnkFileInfo constructor.
+        std::shared_ptr<LnkFileInfo::StringPool> stringPool;               //If not null, the strings of the parsed LNK files are interned in this pool with `LnkFileInfo::internStrings()`.
+        LnkFileInfo::ParseStats* stats = nullptr;                           //If not null, the statistics of reading and parsing the LNK files on all threads are added to this object, not including the time spent in the callback. Directories that couldn't be listed are counted as `LnkFileInfo::OpenFailed` errors. Only recorded if `LNKFILEINFO_STATS` is defined.
+        unsigned int shardCount = 1;                                    //The number of shards to split the LNK files into. Every LNK file and every directory that can't be listed belongs to exactly one shard, and only those in shard `shardIndex` are reported, so that several processes or hosts can scan the same directory tree with the same options and different shard indices. The shards only depend on the paths relative to the scanned directory, so the directory can be mounted at different places on different hosts.
+        unsigned int shardIndex = 0;                                    //The shard to scan, less than `shardCount`.
+        ShardBy shardBy = PathHash;                                     //How the LNK files are split into shards.
+        std::optional<LnkFileInfo::Filter> filter;                      //If not `std::nullopt`, only the LNK files that match this filter are reported, and the others are only parsed as far as needed to check it. The predicate of the filter, if any, may be called from several threads at the same time.
+        std::shared_ptr<LnkFileInfo::ContentCache> contentCache;       //If not null, LNK files with the same contents as one that was already parsed are copied from this cache instead of being parsed again.
+    };
+
+    /**
+     * The result of parsing a single LNK file.
+     */
+    struct Result {
+        std::string filePath;                       //The path of the LNK file, or of the directory if listing a directory failed.
+        std::optional<LnkFileInfo> lnkFileInfo;     //The parsed LNK file, or `std::nullopt` if parsing it failed.
+        LnkFileInfo::ErrorCode error;               //Why parsing the LNK file or listing the directory failed, or `LnkFileInfo::Success` if it succeeded.
+    };
+
+    /**
+     * Finds all files with the `.lnk` extension (case insensitive) in the given directory and parses them on several threads. Errors in individual files or subdirectories don't stop the scan, they are reported to the callback instead.
+     *
+     * @param directoryPath The path of the directory to scan, encoded in UTF-8.
+     * @param options       Options that change how the directory is scanned.
+     * @param callback      Called once for each LNK file (that matches `options.filter`, if any), and once for each directory that couldn't be listed. The callback is called from the worker threads, but never from more than one thread at a time. Results are delivered in no particular order. If the callback throws an exception, the scan is stopped and the exception is rethrown by this function.
+     *
+     * @throws LnkFileInfo::IoError if `directoryPath` isn't a directory or can't be opened.
+     * @throws std::invalid_argument if `options.shardIndex` isn't less than `options.shardCount`.
+     */
+    static void scanDirectory(const std::string& directoryPath, const Options& options, const std::function<void(Result&&)>& callback){
+        if(options.shardIndex >= options.shardCount){
+            throw std::invalid_argument("The shard index must be less than the shard count");
+        }
+        const std::filesystem::path root = utf8ToPath(directoryPath);
+        std::error_code error;
+        if(!std::filesystem::is_directory(root, error)){
+            throw LnkFileInfo::IoError(std::filesystem::filesystem_error("Not a directory", root, error ? error : std::make_error_code(std::errc::not_a_directory)));
+        }
+
+        //Paths found by iterating over an absolute root are absolute, so there's no need to make them absolute again.
+        const LnkFileInfo::ParseOptions parseOptions = root.is_absolute() ? options.parseOptions | LnkFileInfo::AbsolutePath : options.parseOptions;
+        const unsigned int threadCount = options.threads != 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+        WorkQueue queue(threadCount * 64);
+        std::mutex callbackMutex;
+        std::exception_ptr callbackError;
+        std::mutex statsMutex;
+        const auto addStats = [&](const LnkFileInfo::ParseStats& stats){
+            if(options.stats != nullptr){
+                const std::lock_guard lock(statsMutex);
+                *options.stats += stats;
+            }
+        };
+        const auto deliver = [&](Result&& result){
+            const std::lock_guard lock(callbackMutex);
+            if(callbackError){
+                return;
+            }
+            try{
+                callback(std::move(result));
+            }
+            catch(...){
+                callbackError = std::current_exception();
+                queue.stop();
+            }
+        };
+
+        std::vector<std::thread> workers;
+        LnkFileInfo::ParseStats directoryStats;
+        try{
+            workers.reserve(threadCount);
+            for(unsigned int i = 0; i < threadCount; i++){
+                workers.emplace_back([&](){
+                    //The statistics are collected locally and only added to the shared ones once this thread is done
+                    LnkFileInfo::ParseStats stats;
+                    while(std::optional<std::string> filePath = queue.pop()){
+                        const LnkFileInfo::ParseStats before = LnkFileInfo::threadStats();
+                        Result result{std::move(*filePath), std::nullopt, LnkFileInfo::Success};
+                        result.lnkFileInfo = LnkFileInfo::tryOpen(result.filePath, result.error, parseOptions, options.filter ? &*options.filter : nullptr, options.contentCache.get());
+                        if(result.lnkFileInfo && options.stringPool){
+                            result.lnkFileInfo->internStrings(options.stringPool);
+                        }
+                        stats += LnkFileInfo::threadStats() - before;
+                        //Files that were read successfully but didn't match the filter aren't reported
+                        if(result.lnkFileInfo || result.error != LnkFileInfo::Success){
+                            deliver(std::move(result));
+                        }
+                    }
+                    addStats(stats);
+                });
+            }
+
+            //Walk the directory tree on this thread while the workers parse the files that have already been found. Each directory is listed separately so that a directory that can't be listed doesn't stop the rest of the scan.
+            const size_t rootLength = pathToUtf8(root).size();
+            const auto isInShard = [&](const std::string& path){
+                return options.shardCount == 1 || shardOf(relativePath(path, rootLength), options.shardCount) == options.shardIndex;
+            };
+            std::vector<std::filesystem::path> directories{root};
+            bool listingRoot = true;
+            while(!directories.empty() && !queue.isStopped()){
+                const std::filesystem::path directory = std::move(directories.back());
+                directories.pop_back();
+                //With subtree sharding, the subdirectories of the root that belong to other shards are never pushed, so everything below the root belongs to this shard
+                const bool checkShard = options.shardBy == ShardBy::PathHash || listingRoot;
+                std::filesystem::directory_iterator it(directory, std::filesystem::directory_options::skip_permission_denied, error);
+                for(; !error && it != std::filesystem::directory_iterator() && !queue.isStopped(); it.increment(error)){
+                    std::error_code typeError;
+                    if(options.recursive && it->is_directory(typeError) && !it->is_symlink(typeError)){
+                        if(options.shardBy == ShardBy::PathHash || !listingRoot || isInShard(pathToUtf8(it->path()))){
+                            directories.push_back(it->path());
+                        }
+                    }
+                    else if(isLnkFile(it->path()) && it->is_regular_file(typeError)){
+                        std::string filePath = pathToUtf8(it->path());
+                        if(!checkShard || isInShard(filePath)){
+                            queue.push(std::move(filePath));
+                        }
+                    }
+                }
+                listingRoot = false;
+                if(error && (!checkShard || isInShard(pathToUtf8(directory)))){
+                    if constexpr(LnkFileInfo::ParseStats::enabled){
+                        directoryStats.errors[LnkFileInfo::OpenFailed]++;
+                    }
+                    deliver(Result{pathToUtf8(directory), std::nullopt, LnkFileInfo::OpenFailed});
+                }
+                error.clear();
+            }
+        }
+        catch(...){
+            //Destroying a joinable thread terminates the program, so the workers are stopped and joined before the exception is propagated
+            queue.stop();
+            queue.close();
+            for(std::thread& worker: workers){
+                worker.join();
+            }
+            throw;
+        }
+
+        queue.close();
+        for(std::thread& worker: workers){
+            worker.join();
+        }
+        addStats(directoryStats);
+        if(callbackError){
+            std::rethrow_exception(callbackError);
+        }
+    }
+
+    /**
+     * Finds all files with the `.lnk` extension (case insensitive) in the given directory and parses them on several threads. Equivalent to calling the overload taking a callback with a callback that adds each result to a vector.
+     *
+     * @param directoryPath The path of the directory to scan, encoded in UTF-8.
+     * @param options       Options that change how the directory is scanned.
+     *
+     * @return The results in no particular order.
+     *
+     * @throws LnkFileInfo::IoError if `directoryPath` isn't a directory or can't be opened.
+     */
+    static std::vector<Result> scanDirectory(const std::string& directoryPath, const Options& options){
+        std::vector<Result> results;
+        scanDirectory(directoryPath, options, [&results](Result&& result){
+            results.push_back(std::move(result));
+        });
+        return results;
+    }
+
+    /**
+     * Equivalent to `scanDirectory(directoryPath, LnkFileScanner::Options())`.
+     */
+    static std::vector<Result> scanDirectory(const std::string& directoryPath){
+        return scanDirectory(directoryPath, Options());
+    }
+
+private:
+    /**
+     * A bounded multi-producer multi-consumer queue of file paths. Producers block when the queue is full so that walking a huge directory tree doesn't use an unbounded amount of memory.
+     */
+    class WorkQueue {
+    public:
+        explicit WorkQueue(size_t capacity): _capacity(capacity) {}
+
+        /**
+         * Adds a path to the queue, blocking while the queue is full. Does nothing if the queue has been stopped.
+         */
+        void push(std::string filePath){
+            std::unique_lock lock(this->_mutex);
+            this->_notFull.wait(lock, [this](){
+                return this->_paths.size() < this->_capacity || this->_stopped;
+            });
+            if(!this->_stopped){
+                this->_paths.push_back(std::move(filePath));
+                this->_notEmpty.notify_one();
+            }
+        }
+
+        /**
+         * Removes a path from the queue, blocking while the queue is empty.
+         *
+         * @return The path, or `std::nullopt` if the queue has been closed and is empty, or if it has been stopped.
+         */
+        std::optional<std::string> pop(){
+            std::unique_lock lock(this->_mutex);
+            this->_notEmpty.wait(lock, [this](){
+                return !this->_paths.empty() || this->_closed || this->_stopped;
+            });
+            if(this->_stopped || this->_paths.empty()){
+                return std::nullopt;
+            }
+            std::string filePath = std::move(this->_paths.front());
+            this->_paths.pop_front();
+            this->_notFull.notify_one();
+            return filePath;
+        }
+
+        /**
+         * Indicates that no more paths will be added. Consumers will still receive the paths that are already in the queue.
+         */
+        void close(){
+            const std::lock_guard lock(this->_mutex);
+            this->_closed = true;
+            this->_notEmpty.notify_all();
+        }
+
+        /**
+         * Discards all paths in the queue and wakes up all producers and consumers.
+         */
+        void stop(){
+            const std::lock_guard lock(this->_mutex);
+            this->_stopped = true;
+            this->_paths.clear();
+            this->_notEmpty.notify_all();
+            this->_notFull.notify_all();
+        }
+
+        bool isStopped(){
+            const std::lock_guard lock(this->_mutex);
+            return this->_stopped;
+        }
+
+    private:
+        std::mutex _mutex;
+        std::condition_variable _notEmpty;
+        std::condition_variable _notFull;
+        std::deque<std::string> _paths;
+        const size_t _capacity;
+        bool _closed = false;
+        bool _stopped = false;
+    };
+
+    /**
+     * Returns the shard that a path relative to the scanned directory belongs to, using the 64-bit FNV-1a hash of the path with `/` as separator. This must never change so that scans with different versions of this library on different operating systems split the LNK files in the same way.
+     */
+    static unsigned int shardOf(std::string_view relativePath, unsigned int shardCount) noexcept {
+        uint64_t hash = 0xcbf29ce484222325;
+        for(const char c: relativePath){
+            hash = (hash ^ static_cast<uint8_t>(c == '\\' ? '/' : c)) * 0x100000001b3;
+        }
+        return static_cast<unsigned int>(hash % shardCount);
+    }
+
+    /**
+     * Returns the part of a path found when walking the scanned directory that is relative to it. The path of the scanned directory itself is relative to it as the empty string.
+     *
+     * @param path          A path found when walking the scanned directory, encoded in UTF-8.
+     * @param rootLength    The length of the path of the scanned directory encoded in UTF-8.
+     */
+    static std::string_view relativePath(std::string_view path, size_t rootLength) noexcept {
+        path.remove_prefix(std::min(rootLength, path.size()));
+        while(!path.empty() && (path[0] == '/' || path[0] == std::filesystem::path::preferred_separator)){
+            path.remove_prefix(1);
+        }
+        return path;
+    }
+
+    /**
+     * Returns true if the given path has the `.lnk` extension, case insensitive.
+     */
+    static bool isLnkFile(const std::filesystem::path& path){
+        const std::string extension = pathToUtf8(path.extension());
+        return extension.size() == 4 && extension[0] == '.'
+            && (extension[1] == 'l' || extension[1] == 'L')
+            && (extension[2] == 'n' || extension[2] == 'N')
+            && (extension[3] == 'k' || extension[3] == 'K');
+    }
+
+    /**
+     * Converts a path to a UTF-8 encoded string. `std::filesystem::path::string()` isn't used since it uses the ANSI code page on Windows.
+     */
+    static std::string pathToUtf8(const std::filesystem::path& path){
+        const auto utf8 = path.u8string();    //std::string in C++17, std::u8string in C++20
+        return std::string(utf8.begin(), utf8.end());
+    }
+
+    /**
+     * Converts a UTF-8 encoded string to a path.
+     */
+    static std::filesystem::path utf8ToPath(const std::string& utf8){
+        #if defined(__cpp_char8_t)
+            return std::filesystem::path(std::u8string(utf8.begin(), utf8.end()));
+        #else
+            return std::filesystem::u8path(utf8);
+        #endif
+    }
+};
+
+#endif // LNKFILESCANNER_HPP
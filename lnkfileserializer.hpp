@@ -0,0 +1,406 @@
+/*
+ * LNK file serializer, part of the LnkFileInfo library
+ * By Gustav Lindberg
+ * https://github.com/GustavLindberg99/LnkFileInfo
+ */
+
+#ifndef LNKFILESERIALIZER_HPP
+#define LNKFILESERIALIZER_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "lnkfileinfo.hpp"
+
+/**
+ * The LnkFileEncoder class encodes the information about LNK files in a compact, versioned binary format that can be decoded with LnkFileDecoder.
+ *
+ * The encoded bytes start with a six byte header containing the signature `LNKR`, the version of the format and whether strings are interned. The rest consists of one record per LNK file. Integers are encoded as LEB128 varints, except for the volume serial number which is always four bytes. The boolean fields are packed in a single varint after the volume type, which is written as is since it's read from the LNK file without being validated. Strings are encoded in UTF-8 and prepended by their length. With string interning, strings that have already appeared earlier in the encoded bytes are replaced with a reference to the earlier string, which typically makes repeated volume names, working directories, icon paths and targets take one or two bytes. The GUIDs of the extra data are preceded by a byte telling which of them aren't null, and only those are written. The ID list is written as the number of items followed by each item prepended by its size.
+ */
+class LnkFileEncoder final {
+public:
+    static constexpr uint8_t version = 1;    //The version of the format written by this encoder
+
+    /**
+     * Constructs a new encoder containing no records.
+     *
+     * @param internStrings Whether to replace strings that have already been encoded with references to them.
+     */
+    explicit LnkFileEncoder(bool internStrings = true): _internStrings(internStrings) {
+        this->clear();
+    }
+
+    /**
+     * Encodes the information about an LNK file and appends it to the encoded bytes.
+     *
+     * @param lnkFileInfo   The LNK file to encode.
+     */
+    void add(const LnkFileInfo& lnkFileInfo){
+        this->appendVarint(lnkFileInfo._targetVolumeType);
+        this->appendVarint(lnkFileInfo._targetIsOnNetwork | lnkFileInfo._hasCustomIcon << 1);
+        this->appendVarint(lnkFileInfo._targetAttributes);
+        this->appendVarint(lnkFileInfo._targetSize);
+        for(size_t i = 0; i < sizeof(uint32_t); i++){
+            this->_bytes.push_back(static_cast<uint8_t>(lnkFileInfo._targetVolumeSerial >> (i * 8)));
+        }
+        this->appendVarint(lnkFileInfo._iconIndex);
+        this->appendVarint(lnkFileInfo._showCommand);
+        this->appendVarint(lnkFileInfo._hotkey);
+        this->appendVarint(lnkFileInfo._targetCreationTime);
+        this->appendVarint(lnkFileInfo._targetAccessTime);
+        this->appendVarint(lnkFileInfo._targetWriteTime);
+        this->appendString(lnkFileInfo.filePath());
+        this->appendString(lnkFileInfo.absoluteFilePath());
+        this->appendString(lnkFileInfo.absoluteTargetPath());
+        this->appendString(lnkFileInfo.targetVolumeName());
+        this->appendString(lnkFileInfo.description());
+        this->appendString(lnkFileInfo.relativeTargetPath());
+        this->appendString(lnkFileInfo.workingDirectory());
+        this->appendString(lnkFileInfo.commandLineArgs());
+        this->appendString(lnkFileInfo.iconPath());
+        this->appendString(lnkFileInfo._environmentTargetPath);
+        this->appendString(lnkFileInfo._trackerMachineId);
+        const LnkFileInfo::Guid* const guids[] = {&lnkFileInfo._trackerVolumeId, &lnkFileInfo._trackerObjectId, &lnkFileInfo._trackerBirthVolumeId, &lnkFileInfo._trackerBirthObjectId, &lnkFileInfo._knownFolderId};
+        uint8_t presentGuids = 0;
+        for(size_t i = 0; i < std::size(guids); i++){
+            presentGuids |= !guids[i]->isNull() << i;
+        }
+        this->_bytes.push_back(presentGuids);
+        for(const LnkFileInfo::Guid* guid: guids){
+            if(!guid->isNull()){
+                this->_bytes.insert(this->_bytes.end(), std::begin(guid->bytes), std::end(guid->bytes));
+            }
+        }
+        this->appendVarint(lnkFileInfo._idList.size());
+        for(const std::vector<uint8_t>& item: lnkFileInfo._idList){
+            this->appendVarint(item.size());
+            this->_bytes.insert(this->_bytes.end(), item.begin(), item.end());
+        }
+        this->_recordCount++;
+    }
+
+    /**
+     * Returns the encoded bytes, including the header and all the records that have been added so far.
+     */
+    const std::vector<uint8_t>& bytes() const noexcept {
+        return this->_bytes;
+    }
+
+    /**
+     * Returns the number of records that have been added since this encoder was constructed or cleared.
+     */
+    size_t recordCount() const noexcept {
+        return this->_recordCount;
+    }
+
+    /**
+     * Removes all records, so that the encoder can be reused for a new set of records. Strings in the new records aren't replaced with references to strings in the removed records.
+     */
+    void clear(){
+        this->_bytes.assign({'L', 'N', 'K', 'R', version, static_cast<uint8_t>(this->_internStrings)});
+        this->_internedStrings.clear();
+        this->_recordCount = 0;
+    }
+
+private:
+    void appendVarint(uint64_t value){
+        while(value >= 0x80){
+            this->_bytes.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        this->_bytes.push_back(static_cast<uint8_t>(value));
+    }
+
+    /**
+     * Appends a string. Without string interning, a string is its length followed by its contents. With string interning, a string is either its length times two followed by its contents, or its index among the previous non-empty strings that were written with their contents times two plus one.
+     */
+    void appendString(const std::string& string){
+        if(!this->_internStrings){
+            this->appendVarint(string.size());
+        }
+        else if(!string.empty()){
+            const auto interned = this->_internedStrings.find(string);
+            if(interned != this->_internedStrings.end()){
+                this->appendVarint(interned->second << 1 | 1);
+                return;
+            }
+            this->appendVarint(string.size() << 1);
+            const uint64_t index = this->_internedStrings.size();
+            this->_internedStrings.emplace(string, index);
+        }
+        else{
+            this->appendVarint(0);
+        }
+        this->_bytes.insert(this->_bytes.end(), string.begin(), string.end());
+    }
+
+    std::vector<uint8_t> _bytes;
+    std::unordered_map<std::string, uint64_t> _internedStrings;    //The index of each string that has been written with its contents
+    size_t _recordCount = 0;
+    bool _internStrings;
+};
+
+/**
+ * The LnkFileDecoder class decodes LNK file records encoded with LnkFileEncoder. Decoding doesn't copy any strings: the strings in the decoded records refer directly to the encoded bytes, which must outlive the records.
+ */
+class LnkFileDecoder final {
+public:
+    /**
+     * The information about an LNK file decoded from an encoded record. The strings refer to the encoded bytes. The fields have the same meaning as the methods with the same names in the LnkFileInfo class.
+     */
+    struct Record {
+        std::string_view filePath;
+        std::string_view absoluteFilePath;
+        std::string_view absoluteTargetPath;
+        std::string_view targetVolumeName;
+        std::string_view description;
+        std::string_view relativeTargetPath;
+        std::string_view workingDirectory;
+        std::string_view commandLineArgs;
+        std::string_view iconPath;
+        std::string_view environmentTargetPath;
+        std::string_view trackerMachineId;
+        std::vector<std::string_view> idList;    //The bytes of each item
+        uint64_t targetCreationTime = 0;
+        uint64_t targetAccessTime = 0;
+        uint64_t targetWriteTime = 0;
+        LnkFileInfo::Guid trackerVolumeId;
+        LnkFileInfo::Guid trackerObjectId;
+        LnkFileInfo::Guid trackerBirthVolumeId;
+        LnkFileInfo::Guid trackerBirthObjectId;
+        LnkFileInfo::Guid knownFolderId;
+        uint32_t targetSize = 0;
+        uint32_t iconIndex = 0;
+        uint32_t targetVolumeSerial = 0;
+        uint16_t targetAttributes = 0;    //Combination of `LnkFileInfo::Attribute` values
+        uint16_t hotkey = 0;              //The key in the low byte and the modifiers in the high byte, see `hotkeyKey()` and `hotkeyModifiers()`
+        LnkFileInfo::VolumeType targetVolumeType = LnkFileInfo::Unknown;
+        LnkFileInfo::ShowCommand showCommand = LnkFileInfo::ShowNormal;
+        bool targetIsOnNetwork = false;
+        bool hasCustomIcon = false;
+
+        /**
+         * Returns true if the target has the given attribute, see `LnkFileInfo::targetHasAttribute()`.
+         */
+        bool targetHasAttribute(LnkFileInfo::Attribute attribute) const noexcept {
+            return this->targetAttributes & attribute;
+        }
+
+        /**
+         * Same as `LnkFileInfo::hotkeyKey()`.
+         */
+        uint8_t hotkeyKey() const noexcept {
+            return this->hotkey & 0xFF;
+        }
+
+        /**
+         * Same as `LnkFileInfo::hotkeyModifiers()`.
+         */
+        uint8_t hotkeyModifiers() const noexcept {
+            return this->hotkey >> 8;
+        }
+
+        /**
+         * Copies the information into an LnkFileInfo object, which behaves as if it had been parsed from the LNK file except that `refresh()` and `refreshIfChanged()` always re-read the file.
+         */
+        LnkFileInfo toLnkFileInfo() const {
+            LnkFileInfo result;
+            result._filePath = this->filePath;
+            result.setAbsoluteFilePath(this->absoluteFilePath);
+            result._targetPath = this->absoluteTargetPath;
+            result._targetVolumeName = this->targetVolumeName;
+            result._stringData.description = this->description;
+            result._stringData.relativeTargetPath = this->relativeTargetPath;
+            result._stringData.workingDirectory = this->workingDirectory;
+            result._stringData.commandLineArgs = this->commandLineArgs;
+            result._stringData.iconPath = this->iconPath;
+            result._targetSize = this->targetSize;
+            result._iconIndex = this->iconIndex;
+            result._targetVolumeSerial = this->targetVolumeSerial;
+            result._targetAttributes = this->targetAttributes;
+            result._targetVolumeType = this->targetVolumeType;
+            result._targetIsOnNetwork = this->targetIsOnNetwork;
+            result._hasCustomIcon = this->hasCustomIcon;
+            result._showCommand = this->showCommand;
+            result._hotkey = this->hotkey;
+            result._targetCreationTime = this->targetCreationTime;
+            result._targetAccessTime = this->targetAccessTime;
+            result._targetWriteTime = this->targetWriteTime;
+            result._environmentTargetPath = this->environmentTargetPath;
+            result._trackerMachineId = this->trackerMachineId;
+            result._trackerVolumeId = this->trackerVolumeId;
+            result._trackerObjectId = this->trackerObjectId;
+            result._trackerBirthVolumeId = this->trackerBirthVolumeId;
+            result._trackerBirthObjectId = this->trackerBirthObjectId;
+            result._knownFolderId = this->knownFolderId;
+            result._idList.reserve(this->idList.size());
+            for(const std::string_view item: this->idList){
+                result._idList.emplace_back(item.begin(), item.end());
+            }
+            return result;
+        }
+    };
+
+    /**
+     * Constructs a new decoder that decodes the given bytes. The bytes aren't copied and must outlive the decoder and the records it decodes.
+     *
+     * @param data  A pointer to the encoded bytes, as returned by `LnkFileEncoder::bytes()`.
+     * @param size  The number of bytes pointed to by `data`.
+     */
+    LnkFileDecoder(const uint8_t* data, size_t size): _data(data), _size(size) {
+        if(size < 6 || std::memcmp(data, "LNKR", 4) != 0 || data[4] != LnkFileEncoder::version || data[5] > 1){
+            this->_error = LnkFileInfo::InvalidHeader;
+            return;
+        }
+        this->_internStrings = data[5];
+        this->_offset = 6;
+    }
+
+    /**
+     * Equivalent to `LnkFileDecoder(bytes.data(), bytes.size())`.
+     */
+    explicit LnkFileDecoder(const std::vector<uint8_t>& bytes): LnkFileDecoder(bytes.data(), bytes.size()) {}
+
+    /**
+     * Decodes the next record.
+     *
+     * @param record    Set to the decoded record if decoding it succeeded, unspecified otherwise.
+     *
+     * @return True if a record was decoded, false if there are no more records or if the bytes are invalid. Use `error()` to tell these cases apart.
+     */
+    bool next(Record& record){
+        if(this->_error != LnkFileInfo::Success || this->_offset == this->_size){
+            return false;
+        }
+        const uint64_t volumeType = this->readVarint();
+        const uint64_t flags = this->readVarint();
+        if(volumeType > 0xFF){
+            this->_error = LnkFileInfo::IndexOutOfRange;
+            return false;
+        }
+        record.targetVolumeType = static_cast<LnkFileInfo::VolumeType>(volumeType);
+        record.targetIsOnNetwork = flags & 0x01;
+        record.hasCustomIcon = flags & 0x02;
+        record.targetAttributes = static_cast<uint16_t>(this->readVarint());
+        record.targetSize = static_cast<uint32_t>(this->readVarint());
+        if(this->_size - this->_offset < sizeof(uint32_t)){
+            this->_error = LnkFileInfo::IndexOutOfRange;
+            return false;
+        }
+        record.targetVolumeSerial = 0;
+        for(size_t i = 0; i < sizeof(uint32_t); i++){
+            record.targetVolumeSerial |= static_cast<uint32_t>(this->_data[this->_offset++]) << (i * 8);
+        }
+        record.iconIndex = static_cast<uint32_t>(this->readVarint());
+        record.showCommand = static_cast<LnkFileInfo::ShowCommand>(this->readVarint());
+        record.hotkey = static_cast<uint16_t>(this->readVarint());
+        record.targetCreationTime = this->readVarint();
+        record.targetAccessTime = this->readVarint();
+        record.targetWriteTime = this->readVarint();
+        for(std::string_view* string: {&record.filePath, &record.absoluteFilePath, &record.absoluteTargetPath, &record.targetVolumeName, &record.description, &record.relativeTargetPath, &record.workingDirectory, &record.commandLineArgs, &record.iconPath, &record.environmentTargetPath, &record.trackerMachineId}){
+            *string = this->readString();
+        }
+        if(this->_error != LnkFileInfo::Success || this->_offset == this->_size){
+            this->_error = LnkFileInfo::IndexOutOfRange;
+            return false;
+        }
+        const uint8_t presentGuids = this->_data[this->_offset++];
+        size_t guidIndex = 0;
+        for(LnkFileInfo::Guid* guid: {&record.trackerVolumeId, &record.trackerObjectId, &record.trackerBirthVolumeId, &record.trackerBirthObjectId, &record.knownFolderId}){
+            *guid = LnkFileInfo::Guid();
+            if(presentGuids & (1 << guidIndex++)){
+                const std::string_view bytes = this->readBytes(sizeof(guid->bytes));
+                std::copy(bytes.begin(), bytes.end(), guid->bytes);
+            }
+        }
+        //Each item takes at least one byte, so a larger count can only come from invalid bytes, and checking it avoids a huge allocation
+        const uint64_t itemCount = this->readVarint();
+        if(itemCount > this->_size - this->_offset){
+            this->_error = LnkFileInfo::IndexOutOfRange;
+            return false;
+        }
+        record.idList.resize(static_cast<size_t>(itemCount));
+        for(std::string_view &item: record.idList){
+            item = this->readBytes(this->readVarint());
+        }
+        return this->_error == LnkFileInfo::Success;
+    }
+
+    /**
+     * Returns `LnkFileInfo::Success` if all records decoded so far were valid, `LnkFileInfo::InvalidHeader` if the bytes don't start with a valid header (for example if they were encoded by an incompatible version of this library), or `LnkFileInfo::IndexOutOfRange` if a record is truncated or invalid.
+     */
+    LnkFileInfo::ErrorCode error() const noexcept {
+        return this->_error;
+    }
+
+private:
+    /**
+     * Reads a LEB128 varint. Sets the error to `IndexOutOfRange` and returns zero if the varint is truncated or longer than 64 bits.
+     */
+    uint64_t readVarint() noexcept {
+        uint64_t result = 0;
+        for(unsigned int shift = 0; shift < 64; shift += 7){
+            if(this->_offset == this->_size){
+                break;
+            }
+            const uint8_t byte = this->_data[this->_offset++];
+            result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if(!(byte & 0x80)){
+                return result;
+            }
+        }
+        this->_error = LnkFileInfo::IndexOutOfRange;
+        return 0;
+    }
+
+    /**
+     * Reads the given number of bytes. Sets the error to `IndexOutOfRange` and returns an empty view if there aren't that many bytes left.
+     */
+    std::string_view readBytes(uint64_t size) noexcept {
+        if(this->_error != LnkFileInfo::Success || size > this->_size - this->_offset){
+            this->_error = LnkFileInfo::IndexOutOfRange;
+            return std::string_view();
+        }
+        const std::string_view result(reinterpret_cast<const char*>(this->_data + this->_offset), static_cast<size_t>(size));
+        this->_offset += static_cast<size_t>(size);
+        return result;
+    }
+
+    /**
+     * Reads a string written by `LnkFileEncoder::appendString()`.
+     */
+    std::string_view readString(){
+        uint64_t length = this->readVarint();
+        if(this->_internStrings){
+            if(length & 1){
+                const uint64_t index = length >> 1;
+                if(index >= this->_internedStrings.size()){
+                    this->_error = LnkFileInfo::IndexOutOfRange;
+                    return std::string_view();
+                }
+                return this->_internedStrings[index];
+            }
+            length >>= 1;
+        }
+        const std::string_view result = this->readBytes(length);
+        if(this->_error == LnkFileInfo::Success && this->_internStrings && !result.empty()){
+            this->_internedStrings.push_back(result);
+        }
+        return result;
+    }
+
+    const uint8_t* _data;
+    size_t _size;
+    size_t _offset = 0;
+    std::vector<std::string_view> _internedStrings;    //The non-empty strings that have been read with their contents, in order
+    LnkFileInfo::ErrorCode _error = LnkFileInfo::Success;
+    bool _internStrings = false;
+};
+
+#endif // LNKFILESERIALIZER_HPP
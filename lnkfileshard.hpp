@@ -0,0 +1,489 @@
+/*
+ * Sharded LNK file scans, part of the LnkFileInfo library
+ * By Gustav Lindberg
+ * https://github.com/GustavLindberg99/LnkFileInfo
+ */
+
+#ifndef LNKFILESHARD_HPP
+#define LNKFILESHARD_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "lnkfileinfo.hpp"
+#include "lnkfilescanner.hpp"
+#include "lnkfileserializer.hpp"
+
+/**
+ * The LnkFileShardWriter class serializes the results of scanning one shard of a directory tree with LnkFileScanner (see `LnkFileScanner::Options::shardCount`), so that the shards scanned by different processes or hosts can be combined with LnkFileShardMerger.
+ *
+ * The serialized bytes start with the signature `LNKS` and the version of the format, followed by the index of the shard, the number of shards, the statistics, the paths and error codes of the LNK files that couldn't be parsed, the number of LNK files that could be parsed, and finally the records of those LNK files, encoded with LnkFileEncoder. Each path is preceded by the offset of the part of it that is relative to the scanned directory. All integers are encoded as LEB128 varints.
+ */
+class LnkFileShardWriter final {
+    friend class LnkFileShardMerger;
+
+public:
+    static constexpr uint8_t version = 1;    //The version of the format written by this writer
+
+    /**
+     * Constructs a new writer containing no results.
+     *
+     * @param shardIndex    The index of the shard whose results are written.
+     * @param shardCount    The number of shards the directory tree was split into.
+     * @param internStrings Whether to replace strings that have already been encoded with references to them, see LnkFileEncoder.
+     * @param rootPath      The path of the scanned directory encoded in UTF-8. LnkFileShardMerger uses the paths relative to it to find LNK files that appear in several shards, so that the directory can be mounted at different places on different hosts. If empty or if a path isn't in this directory, the whole path is used.
+     */
+    explicit LnkFileShardWriter(unsigned int shardIndex = 0, unsigned int shardCount = 1, bool internStrings = true, std::string rootPath = std::string()): _records(internStrings), _shardIndex(shardIndex), _shardCount(shardCount), _rootPath(std::move(rootPath)) {}
+
+    /**
+     * Adds the result of parsing an LNK file or of listing a directory. Successfully parsed LNK files are encoded with LnkFileEncoder, and for other results only the path and the error code are kept.
+     */
+    void add(const LnkFileScanner::Result& result){
+        if(result.lnkFileInfo.has_value()){
+            this->addRecord(*result.lnkFileInfo, this->relativePathOffset(result.lnkFileInfo->filePath()));
+        }
+        else{
+            this->addFailure(result.filePath, result.error);
+        }
+    }
+
+    /**
+     * Adds the path of an LNK file that couldn't be parsed or of a directory that couldn't be listed, and the reason why.
+     */
+    void addFailure(std::string_view filePath, LnkFileInfo::ErrorCode error){
+        this->addFailure(filePath, error, this->relativePathOffset(filePath));
+    }
+
+    /**
+     * Adds statistics to the statistics that are written with the results.
+     */
+    void addStats(const LnkFileInfo::ParseStats& stats) noexcept {
+        this->_stats += stats;
+    }
+
+    /**
+     * Returns the serialized results.
+     */
+    std::vector<uint8_t> bytes() const {
+        return this->serialize(this->_records.bytes(), this->_recordOffsets, this->_records.recordCount());
+    }
+
+    /**
+     * Returns the number of LNK files that have been added with `add()` and were successfully parsed.
+     */
+    size_t recordCount() const noexcept {
+        return this->_records.recordCount();
+    }
+
+    /**
+     * Returns the number of results that have been added with `add()` or `addFailure()` and weren't successfully parsed.
+     */
+    size_t failureCount() const noexcept {
+        return this->_failureCount;
+    }
+
+    /**
+     * Scans one shard of a directory tree with LnkFileScanner and returns the serialized results, including the statistics if `LNKFILEINFO_STATS` is defined.
+     *
+     * @param directoryPath The path of the directory to scan, encoded in UTF-8.
+     * @param options       Options that change how the directory is scanned, including which shard is scanned. If `options.stats` isn't null, the statistics are also added to it.
+     * @param internStrings Whether to replace strings that have already been encoded with references to them.
+     *
+     * @throws LnkFileInfo::IoError if `directoryPath` isn't a directory or can't be opened.
+     * @throws std::invalid_argument if `options.shardIndex` isn't less than `options.shardCount`.
+     */
+    static std::vector<uint8_t> scanShard(const std::string& directoryPath, LnkFileScanner::Options options, bool internStrings = true){
+        LnkFileShardWriter writer(options.shardIndex, options.shardCount, internStrings, directoryPath);
+        LnkFileInfo::ParseStats stats;
+        LnkFileInfo::ParseStats* const callerStats = options.stats;
+        options.stats = &stats;
+        LnkFileScanner::scanDirectory(directoryPath, options, [&writer](LnkFileScanner::Result&& result){
+            writer.add(result);
+        });
+        writer.addStats(stats);
+        if(callerStats != nullptr){
+            *callerStats += stats;
+        }
+        return writer.bytes();
+    }
+
+private:
+    static constexpr uint64_t counterCount = 8 + LnkFileInfo::IndexOutOfRange + 1;
+
+    /**
+     * Adds a successfully parsed LNK file whose path relative to the scanned directory starts at the given offset.
+     */
+    void addRecord(const LnkFileInfo& lnkFileInfo, uint64_t relativePathOffset){
+        this->_records.add(lnkFileInfo);
+        appendVarint(this->_recordOffsets, relativePathOffset);
+    }
+
+    /**
+     * Adds a failure whose path relative to the scanned directory starts at the given offset.
+     */
+    void addFailure(std::string_view filePath, LnkFileInfo::ErrorCode error, uint64_t relativePathOffset){
+        appendVarint(this->_failures, error);
+        appendVarint(this->_failures, relativePathOffset);
+        appendVarint(this->_failures, filePath.size());
+        this->_failures.insert(this->_failures.end(), filePath.begin(), filePath.end());
+        this->_failureCount++;
+    }
+
+    /**
+     * Returns the offset of the part of the given path that is relative to `_rootPath`, or zero if the path isn't in `_rootPath`.
+     */
+    size_t relativePathOffset(std::string_view filePath) const noexcept {
+        const auto isSeparator = [](char c){
+            return c == '/' || c == '\\';
+        };
+        if(this->_rootPath.empty() || filePath.substr(0, this->_rootPath.size()) != this->_rootPath){
+            return 0;
+        }
+        size_t offset = this->_rootPath.size();
+        if(offset < filePath.size() && !isSeparator(filePath[offset]) && !isSeparator(this->_rootPath.back())){
+            return 0;
+        }
+        while(offset < filePath.size() && isSeparator(filePath[offset])){
+            offset++;
+        }
+        return offset;
+    }
+
+    /**
+     * Serializes the shard index, the shard count, the statistics and the failures of this writer, followed by the given records.
+     *
+     * @param records       The records encoded with LnkFileEncoder, including the header of the encoded bytes.
+     * @param recordOffsets The offsets of the relative paths of the records, encoded as varints.
+     * @param recordCount   The number of records.
+     */
+    std::vector<uint8_t> serialize(const std::vector<uint8_t>& records, const std::vector<uint8_t>& recordOffsets, size_t recordCount) const {
+        std::vector<uint8_t> result{'L', 'N', 'K', 'S', version};
+        appendVarint(result, this->_shardIndex);
+        appendVarint(result, this->_shardCount);
+        appendVarint(result, counterCount);
+        forEachCounter(this->_stats, [&result](uint64_t counter){
+            appendVarint(result, counter);
+        });
+        appendVarint(result, this->_failureCount);
+        result.insert(result.end(), this->_failures.begin(), this->_failures.end());
+        appendVarint(result, recordCount);
+        result.insert(result.end(), recordOffsets.begin(), recordOffsets.end());
+        result.insert(result.end(), records.begin(), records.end());
+        return result;
+    }
+
+    /**
+     * Calls the given function with each counter of the given statistics, in the order they're serialized.
+     */
+    template<typename Stats, typename Function>
+    static void forEachCounter(Stats& stats, Function function){
+        function(stats.filesParsed);
+        function(stats.bytesRead);
+        function(stats.readNanoseconds);
+        function(stats.absolutePathNanoseconds);
+        function(stats.validateNanoseconds);
+        function(stats.linkInfoNanoseconds);
+        function(stats.stringDataNanoseconds);
+        function(stats.stringAllocations);
+        for(auto& count: stats.errors){
+            function(count);
+        }
+    }
+
+    static void appendVarint(std::vector<uint8_t>& bytes, uint64_t value){
+        while(value >= 0x80){
+            bytes.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        bytes.push_back(static_cast<uint8_t>(value));
+    }
+
+    LnkFileEncoder _records;
+    std::vector<uint8_t> _recordOffsets;    //The offsets of the relative paths of the records, in the format they're serialized in
+    std::vector<uint8_t> _failures;    //The failures that have been added, in the format they're serialized in
+    size_t _failureCount = 0;
+    LnkFileInfo::ParseStats _stats;
+    unsigned int _shardIndex;
+    unsigned int _shardCount;
+    std::string _rootPath;
+};
+
+/**
+ * The LnkFileShardMerger class combines the results of several shards written by LnkFileShardWriter. LNK files that appear in several shards, for example because a shard was scanned again after a host failed or because the same directory tree was scanned with different shard counts, are only kept once, and the statistics of all distinct shards are added up. LNK files are identified by their paths relative to the scanned directory, so shards scanned on hosts where the directory is mounted at different places can be merged.
+ */
+class LnkFileShardMerger final {
+public:
+    /**
+     * An LNK file that couldn't be parsed or a directory that couldn't be listed.
+     */
+    struct Failure {
+        std::string filePath;
+        LnkFileInfo::ErrorCode error;
+    };
+
+    /**
+     * Constructs a new merger containing no results.
+     *
+     * @param internStrings Whether to replace strings that have already been encoded with references to them in the merged records.
+     */
+    explicit LnkFileShardMerger(bool internStrings = true): _records(internStrings) {}
+
+    /**
+     * Adds the results of a shard. Records whose path relative to the scanned directory has already been added are skipped, and so are failures whose relative path has already been added or has been parsed successfully in another shard. Failures are removed once the same LNK file has been parsed successfully in another shard. The statistics of a shard are only added the first time a shard with the same index and count is added.
+     *
+     * @param data  A pointer to the bytes returned by `LnkFileShardWriter::bytes()`.
+     * @param size  The number of bytes pointed to by `data`.
+     *
+     * @return `LnkFileInfo::Success` if the shard was added, `LnkFileInfo::InvalidHeader` if the bytes don't start with a valid header (for example if they were written by an incompatible version of this library), or `LnkFileInfo::IndexOutOfRange` if they're truncated or invalid. If adding the shard fails, nothing is added.
+     */
+    LnkFileInfo::ErrorCode add(const uint8_t* data, size_t size){
+        if(size < 5 || std::memcmp(data, "LNKS", 4) != 0 || data[4] != LnkFileShardWriter::version){
+            return LnkFileInfo::InvalidHeader;
+        }
+
+        //Decode everything before adding anything so that nothing is added if the shard is invalid
+        Reader reader{data, size, 5};
+        const uint64_t shardIndex = reader.varint();
+        const uint64_t shardCount = reader.varint();
+        const uint64_t counterCount = reader.varint();
+        if(shardCount == 0 || shardIndex >= shardCount || shardCount > 0xFFFFFFFF){
+            return LnkFileInfo::IndexOutOfRange;
+        }
+        //Counters added by later versions are ignored
+        LnkFileInfo::ParseStats stats;
+        uint64_t counterIndex = 0;
+        LnkFileShardWriter::forEachCounter(stats, [&](uint64_t& counter){
+            if(counterIndex++ < counterCount){
+                counter = reader.varint();
+            }
+        });
+        for(; counterIndex < counterCount && !reader.failed; counterIndex++){
+            reader.varint();
+        }
+        const uint64_t failureCount = reader.varint();
+        std::vector<DecodedFailure> failures;
+        for(uint64_t i = 0; i < failureCount && !reader.failed; i++){
+            const uint64_t error = reader.varint();
+            const uint64_t relativePathOffset = reader.varint();
+            const std::string_view filePath = reader.string();
+            if(error == LnkFileInfo::Success || error > LnkFileInfo::IndexOutOfRange || relativePathOffset > filePath.size()){
+                return LnkFileInfo::IndexOutOfRange;
+            }
+            failures.push_back(DecodedFailure{static_cast<LnkFileInfo::ErrorCode>(error), static_cast<size_t>(relativePathOffset), filePath});
+        }
+        const uint64_t recordCount = reader.varint();
+        if(recordCount > size - reader.offset){
+            return LnkFileInfo::IndexOutOfRange;
+        }
+        std::vector<size_t> recordOffsets;
+        for(uint64_t i = 0; i < recordCount && !reader.failed; i++){
+            recordOffsets.push_back(static_cast<size_t>(reader.varint()));
+        }
+        if(reader.failed){
+            return LnkFileInfo::IndexOutOfRange;
+        }
+        LnkFileDecoder decoder(data + reader.offset, size - reader.offset);
+        std::vector<LnkFileDecoder::Record> records;
+        for(LnkFileDecoder::Record record; decoder.next(record);){
+            if(records.size() == recordOffsets.size() || recordOffsets[records.size()] > record.filePath.size()){
+                return LnkFileInfo::IndexOutOfRange;
+            }
+            records.push_back(record);
+        }
+        if(decoder.error() != LnkFileInfo::Success){
+            return decoder.error();
+        }
+        if(records.size() != recordOffsets.size()){
+            return LnkFileInfo::IndexOutOfRange;
+        }
+
+        //Add the decoded results
+        if(this->_mergedShards.emplace(static_cast<uint32_t>(shardCount), static_cast<uint32_t>(shardIndex)).second){
+            this->_stats += stats;
+        }
+        for(const DecodedFailure& failure: failures){
+            std::string key = relativePathKey(failure.filePath, failure.relativePathOffset);
+            if(this->_relativePaths.count(key) == 0 && this->_failureIndices.emplace(std::move(key), this->_failures.size()).second){
+                this->_failures.push_back(Failure{std::string(failure.filePath), failure.error});
+                this->_failureOffsets.push_back(failure.relativePathOffset);
+            }
+        }
+        for(size_t i = 0; i < records.size(); i++){
+            const LnkFileDecoder::Record& record = records[i];
+            std::string key = relativePathKey(record.filePath, recordOffsets[i]);
+            this->removeFailure(key);
+            if(!this->_relativePaths.emplace(std::move(key)).second){
+                this->_duplicateCount++;
+                continue;
+            }
+            this->_records.add(record.toLnkFileInfo());
+            LnkFileShardWriter::appendVarint(this->_recordOffsets, recordOffsets[i]);
+        }
+        return LnkFileInfo::Success;
+    }
+
+    /**
+     * Equivalent to `add(bytes.data(), bytes.size())`.
+     */
+    LnkFileInfo::ErrorCode add(const std::vector<uint8_t>& bytes){
+        return this->add(bytes.data(), bytes.size());
+    }
+
+    /**
+     * Returns true if all shards of a scan have been added, that is if for some shard count, the shards with all indices less than that count have been added.
+     */
+    bool isComplete() const noexcept {
+        //The shard indices are less than the shard count and each pair is only stored once, so the shards are complete if there are as many indices as the shard count
+        for(auto shard = this->_mergedShards.begin(); shard != this->_mergedShards.end();){
+            const uint32_t shardCount = shard->first;
+            const auto nextShardCount = this->_mergedShards.upper_bound({shardCount, UINT32_MAX});
+            if(static_cast<uint64_t>(std::distance(shard, nextShardCount)) == shardCount){
+                return true;
+            }
+            shard = nextShardCount;
+        }
+        return false;
+    }
+
+    /**
+     * Returns the records of the distinct LNK files that were successfully parsed in all shards added so far, in the format of LnkFileEncoder. They can be decoded with LnkFileDecoder.
+     */
+    const std::vector<uint8_t>& records() const noexcept {
+        return this->_records.bytes();
+    }
+
+    /**
+     * Returns the number of records in `records()`.
+     */
+    size_t recordCount() const noexcept {
+        return this->_records.recordCount();
+    }
+
+    /**
+     * Returns the number of records that were skipped because a record with the same path relative to the scanned directory had already been added.
+     */
+    size_t duplicateCount() const noexcept {
+        return this->_duplicateCount;
+    }
+
+    /**
+     * Returns the distinct LNK files that couldn't be parsed and directories that couldn't be listed in all shards added so far.
+     */
+    const std::vector<Failure>& failures() const noexcept {
+        return this->_failures;
+    }
+
+    /**
+     * Returns the sum of the statistics of all distinct shards added so far.
+     */
+    const LnkFileInfo::ParseStats& stats() const noexcept {
+        return this->_stats;
+    }
+
+    /**
+     * Returns the merged results in the same format as LnkFileShardWriter, as a scan with a single shard. This can be added to another merger, for example to merge the results of a large cluster in several steps.
+     */
+    std::vector<uint8_t> bytes() const {
+        LnkFileShardWriter writer(0, 1);
+        for(size_t i = 0; i < this->_failures.size(); i++){
+            writer.addFailure(this->_failures[i].filePath, this->_failures[i].error, this->_failureOffsets[i]);
+        }
+        writer.addStats(this->_stats);
+        return writer.serialize(this->_records.bytes(), this->_recordOffsets, this->_records.recordCount());
+    }
+
+private:
+    /**
+     * A failure that was decoded from a shard but hasn't been added yet.
+     */
+    struct DecodedFailure {
+        LnkFileInfo::ErrorCode error;
+        size_t relativePathOffset;
+        std::string_view filePath;
+    };
+
+    /**
+     * Returns the path relative to the scanned directory that identifies an LNK file or directory in all shards, with `/` as separator.
+     */
+    static std::string relativePathKey(std::string_view filePath, size_t relativePathOffset){
+        std::string result(filePath.substr(relativePathOffset));
+        std::replace(result.begin(), result.end(), '\\', '/');
+        return result;
+    }
+
+    /**
+     * Removes the failure with the given relative path if there is one, since the same LNK file was parsed successfully in another shard.
+     */
+    void removeFailure(const std::string& key){
+        const auto it = this->_failureIndices.find(key);
+        if(it == this->_failureIndices.end()){
+            return;
+        }
+        const size_t index = it->second;
+        this->_failureIndices.erase(it);
+        if(index != this->_failures.size() - 1){
+            this->_failures[index] = std::move(this->_failures.back());
+            this->_failureOffsets[index] = this->_failureOffsets.back();
+            this->_failureIndices[relativePathKey(this->_failures[index].filePath, this->_failureOffsets[index])] = index;
+        }
+        this->_failures.pop_back();
+        this->_failureOffsets.pop_back();
+    }
+
+    /**
+     * Reads the integers and strings before the records. Once anything is truncated or invalid, `failed` is set and everything that is read is zero or empty.
+     */
+    struct Reader {
+        const uint8_t* data;
+        size_t size;
+        size_t offset;
+        bool failed = false;
+
+        uint64_t varint() noexcept {
+            uint64_t result = 0;
+            for(unsigned int shift = 0; shift < 64 && !this->failed; shift += 7){
+                if(this->offset == this->size){
+                    break;
+                }
+                const uint8_t byte = this->data[this->offset++];
+                result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                if(!(byte & 0x80)){
+                    return result;
+                }
+            }
+            this->failed = true;
+            return 0;
+        }
+
+        std::string_view string() noexcept {
+            const uint64_t length = this->varint();
+            if(this->failed || length > this->size - this->offset){
+                this->failed = true;
+                return std::string_view();
+            }
+            const std::string_view result(reinterpret_cast<const char*>(this->data + this->offset), static_cast<size_t>(length));
+            this->offset += static_cast<size_t>(length);
+            return result;
+        }
+    };
+
+    LnkFileEncoder _records;
+    std::vector<uint8_t> _recordOffsets;    //The offsets of the relative paths of the records in `_records`, in the format they're serialized in
+    std::unordered_set<std::string> _relativePaths;    //The relative paths of the records in `_records`
+    std::unordered_map<std::string, size_t> _failureIndices;    //The indices in `_failures` by relative path
+    std::vector<Failure> _failures;
+    std::vector<size_t> _failureOffsets;    //The offsets of the relative paths of the elements of `_failures`
+    std::set<std::pair<uint32_t, uint32_t>> _mergedShards;    //The shard counts and indices of the shards that have been merged
+    size_t _duplicateCount = 0;
+    LnkFileInfo::ParseStats _stats;
+};
+
+#endif // LNKFILESHARD_HPP
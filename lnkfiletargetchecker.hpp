@@ -0,0 +1,482 @@
+/*
+ * LNK target checker, part of the LnkFileInfo library
+ * By Gustav Lindberg
+ * https://github.com/GustavLindberg99/LnkFileInfo
+ */
+
+#ifndef LNKFILETARGETCHECKER_HPP
+#define LNKFILETARGETCHECKER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "lnkfileinfo.hpp"
+
+#ifndef _WIN32
+    #include <dirent.h>
+#endif
+
+/**
+ * The LnkFileTargetChecker class checks whether the targets of many LNK files still exist and still have the size given in the LNK file, for example to find broken shortcuts.
+ *
+ * Checking each target with `std::filesystem::exists` makes one stat call per target, one after the other, so a sweep over many LNK files is bounded by the latency of each call, which is high on network volumes. Instead, the targets are grouped by volume and by directory. Each volume is looked up once, and if it isn't available none of its targets are checked. Each directory containing several targets is checked once, and directories containing many targets are listed once so that targets that are missing from the listing don't need to be checked separately. The remaining stat calls are made on several threads at the same time.
+ */
+class LnkFileTargetChecker final {
+public:
+    /**
+     * The result of checking a target.
+     */
+    enum Status: uint8_t {
+        Exists            = 0,    //The target exists and has the size given in the LNK file, or is a directory.
+        SizeChanged       = 1,    //The target exists but its size is different from the size given in the LNK file.
+        Missing           = 2,    //The target doesn't exist, but the volume it's on is available.
+        VolumeUnavailable = 3     //The volume the target is on isn't mounted or can't be accessed, or on Windows is a different volume than the one in the LNK file, so it's unknown whether the target exists.
+    };
+
+    /**
+     * Options that change how the targets are checked.
+     */
+    struct Options {
+        unsigned int threads = 16;                                      //The number of volume lookups and stat calls that are made at the same time. Using more threads than hardware threads helps when the targets are on network volumes.
+        size_t listDirectoryThreshold = 16;                             //Directories containing at least this many targets are listed instead of checking each target separately. Zero means that directories are never listed.
+        bool checkSize = true;                                          //Whether to compare the size of the targets with the size given in the LNK file. If false, targets that exist are always reported as `Exists`.
+        std::map<uint32_t, std::string> volumeMountPoints;              //The directories where local volumes are mounted, by volume serial number, for example `{0x1234ABCD, "/mnt/c"}`. The drive letter of targets on these volumes is replaced with the mount point.
+        std::map<std::string, std::string> networkShareMountPoints;     //The directories where network shares are mounted, by share name as returned by `targetVolumeName()` (case insensitive), for example `{"\\\\server\\share", "/mnt/share"}`. The drive letter of targets on these shares is replaced with the mount point.
+    };
+
+    /**
+     * The result of checking the target of a single LNK file.
+     */
+    struct Result {
+        std::string targetPath;     //The path that was checked, encoded in UTF-8. This is the target path with the drive letter replaced by the mount point or share name if there is one.
+        Status status;              //Whether the target exists.
+        uint64_t size;              //The current size of the target in bytes, or zero if it doesn't exist, if it's a directory or if its volume is unavailable.
+    };
+
+    /**
+     * Checks whether the targets of the given LNK files exist and have the size given in the LNK files.
+     *
+     * Targets on local volumes that aren't in `Options::volumeMountPoints` are checked at the path given in the LNK file, which only makes sense on Windows. Targets on network shares that aren't in `Options::networkShareMountPoints` are checked at their UNC path (for example `\\server\share\file.txt`) so that it doesn't matter which drive letter the share is mapped to.
+     *
+     * @param lnkFiles  The LNK files whose targets to check.
+     * @param options   Options that change how the targets are checked.
+     *
+     * @return One result per LNK file, in the same order as `lnkFiles`.
+     */
+    static std::vector<Result> checkTargets(const std::vector<LnkFileInfo>& lnkFiles, const Options& options){
+        std::vector<Result> results(lnkFiles.size());
+        std::vector<Target> targets(lnkFiles.size());
+        std::vector<Volume> volumes;
+        std::unordered_map<std::string, size_t> volumeIndices;
+        Volume volume;
+        std::string key;
+        for(size_t i = 0; i < lnkFiles.size(); i++){
+            const LnkFileInfo& lnkFileInfo = lnkFiles[i];
+            resolveTarget(lnkFileInfo, options, results[i].targetPath, volume);
+            //The volume and the key are reused for all targets so that they only allocate memory for new volumes
+            key.assign(volume.root);
+            key.append(reinterpret_cast<const char*>(&volume.expectedSerial), sizeof(volume.expectedSerial));
+            auto iterator = volumeIndices.find(key);
+            if(iterator == volumeIndices.end()){
+                iterator = volumeIndices.emplace(key, volumes.size()).first;
+                volumes.push_back(volume);
+            }
+            targets[i].volume = iterator->second;
+            targets[i].isDirectory = lnkFileInfo.targetHasAttribute(LnkFileInfo::Directory);
+            targets[i].expectedSize = lnkFileInfo.targetSize();
+            results[i].status = Status::VolumeUnavailable;
+            results[i].size = 0;
+        }
+
+        //Look up each volume once
+        parallelFor(volumes.size(), options.threads, [&volumes](size_t i){
+            volumes[i].isAvailable = isAvailable(volumes[i]);
+        });
+
+        //Group the targets on available volumes by directory
+        std::vector<Directory> directories;
+        std::unordered_map<std::string, size_t> directoryIndices;
+        std::vector<size_t> targetsToStat;
+        for(size_t i = 0; i < targets.size(); i++){
+            if(!volumes[targets[i].volume].isAvailable){
+                continue;
+            }
+            const std::string& path = results[i].targetPath;
+            const size_t separator = path.find_last_of(separators);
+            if(separator == std::string::npos || separator == 0){
+                targetsToStat.push_back(i);
+                continue;
+            }
+            targets[i].nameOffset = separator + 1;
+            //The separator is kept after drive letters, since `C:` is the current directory on drive C on Windows
+            const auto [iterator, inserted] = directoryIndices.emplace(path.substr(0, path[separator - 1] == ':' ? separator + 1 : separator), directories.size());
+            if(inserted){
+                directories.push_back(Directory{iterator->first, {}});
+            }
+            directories[iterator->second].targets.push_back(i);
+        }
+
+        //Check each directory containing several targets once, and list the ones containing many targets
+        std::vector<uint8_t> needsStat(targets.size(), false);
+        parallelFor(directories.size(), options.threads, [&](size_t i){
+            const Directory& directory = directories[i];
+            if(directory.targets.size() == 1){
+                needsStat[directory.targets[0]] = true;
+                return;
+            }
+            uint64_t size;
+            bool isDirectory;
+            if(!statPath(directory.path, size, isDirectory) || !isDirectory){
+                for(const size_t target: directory.targets){
+                    results[target].status = Status::Missing;
+                }
+                return;
+            }
+            if(options.listDirectoryThreshold == 0 || directory.targets.size() < options.listDirectoryThreshold){
+                for(const size_t target: directory.targets){
+                    needsStat[target] = true;
+                }
+                return;
+            }
+            listDirectory(directory, targets, options, results, needsStat);
+        });
+        for(size_t i = 0; i < targets.size(); i++){
+            if(needsStat[i]){
+                targetsToStat.push_back(i);
+            }
+        }
+
+        //Check the remaining targets separately
+        parallelFor(targetsToStat.size(), options.threads, [&](size_t i){
+            const size_t target = targetsToStat[i];
+            uint64_t size;
+            bool isDirectory;
+            if(statPath(results[target].targetPath, size, isDirectory)){
+                setFound(targets[target], options, isDirectory ? 0 : size, isDirectory, results[target]);
+            }
+            else{
+                results[target].status = Status::Missing;
+            }
+        });
+        return results;
+    }
+
+    /**
+     * Equivalent to `checkTargets(lnkFiles, LnkFileTargetChecker::Options())`.
+     */
+    static std::vector<Result> checkTargets(const std::vector<LnkFileInfo>& lnkFiles){
+        return checkTargets(lnkFiles, Options());
+    }
+
+private:
+    /**
+     * A volume that one or more targets are on.
+     */
+    struct Volume {
+        std::string root;               //The root directory of the volume, or an empty string if it's unknown, in which case the volume is assumed to be available.
+        uint32_t expectedSerial = 0;    //The serial number the volume should have, or zero if it isn't checked.
+        bool isAvailable = false;
+    };
+
+    /**
+     * Information about a target that isn't in its result.
+     */
+    struct Target {
+        size_t volume = 0;          //The index of the volume in the list of volumes.
+        size_t nameOffset = 0;      //The offset of the file name in the target path.
+        uint32_t expectedSize = 0;  //The size given in the LNK file.
+        bool isDirectory = false;   //Whether the LNK file says that the target is a directory.
+    };
+
+    /**
+     * A directory containing one or more targets.
+     */
+    struct Directory {
+        std::string path;
+        std::vector<size_t> targets;    //The indices of the targets in this directory.
+    };
+
+    #ifdef _WIN32
+        static constexpr const char* separators = "\\/";
+    #else
+        static constexpr const char* separators = "/";
+    #endif
+
+    /**
+     * Computes the path to check for the target of an LNK file and the volume it's on.
+     *
+     * @param lnkFileInfo   The LNK file.
+     * @param options       The options containing the mount points.
+     * @param path          Set to the path to check.
+     * @param volume        Set to the volume the target is on. Its availability is left unchanged.
+     */
+    static void resolveTarget(const LnkFileInfo& lnkFileInfo, const Options& options, std::string &path, Volume &volume){
+        const std::string& targetPath = lnkFileInfo.absoluteTargetPath();
+        const bool hasDriveLetter = targetPath.size() >= 2 && targetPath[1] == ':';
+        const std::string_view pathOnVolume = std::string_view(targetPath).substr(hasDriveLetter ? 2 : 0);
+        volume.root.clear();
+        volume.expectedSerial = 0;
+        const std::string* mountPoint = nullptr;
+        if(lnkFileInfo.targetIsOnNetwork()){
+            for(const auto& [shareName, shareMountPoint]: options.networkShareMountPoints){
+                if(equalsIgnoringCase(shareName, lnkFileInfo.targetVolumeName())){
+                    mountPoint = &shareMountPoint;
+                    break;
+                }
+            }
+            if(mountPoint == nullptr && lnkFileInfo.targetVolumeName().compare(0, 2, "\\\\") == 0){
+                mountPoint = &lnkFileInfo.targetVolumeName();
+            }
+        }
+        else{
+            const auto iterator = options.volumeMountPoints.find(static_cast<uint32_t>(lnkFileInfo.targetVolumeSerial()));
+            if(iterator != options.volumeMountPoints.end()){
+                mountPoint = &iterator->second;
+            }
+            else if(hasDriveLetter){
+                volume.expectedSerial = static_cast<uint32_t>(lnkFileInfo.targetVolumeSerial());
+            }
+        }
+
+        if(mountPoint != nullptr){
+            //Remove trailing separators so that the mount point can be followed by the path on the volume, which starts with a backslash
+            size_t rootSize = mountPoint->size();
+            while(rootSize > 1 && ((*mountPoint)[rootSize - 1] == '/' || (*mountPoint)[rootSize - 1] == '\\')){
+                rootSize--;
+            }
+            volume.root.assign(*mountPoint, 0, rootSize);
+            path = volume.root;
+            path += pathOnVolume;
+        }
+        else{
+            if(hasDriveLetter){
+                volume.root.assign(targetPath, 0, 2);
+                volume.root += '\\';
+            }
+            path = targetPath;
+        }
+
+        #ifndef _WIN32
+            std::replace(path.begin() + static_cast<std::ptrdiff_t>(std::min(path.size(), mountPoint != nullptr ? volume.root.size() : 0)), path.end(), '\\', '/');
+            if(mountPoint == nullptr){
+                std::replace(volume.root.begin(), volume.root.end(), '\\', '/');
+            }
+        #endif
+    }
+
+    /**
+     * Checks whether a volume is mounted and, on Windows, whether it has the expected serial number.
+     */
+    static bool isAvailable(const Volume& volume){
+        if(volume.root.empty()){
+            return true;
+        }
+        //The root of a network share can only be checked with a trailing separator on Windows
+        const char lastCharacter = volume.root.back();
+        const std::string root = lastCharacter == '/' || lastCharacter == '\\' ? volume.root : volume.root + separators[0];
+        uint64_t size;
+        bool isDirectory;
+        if(!statPath(root, size, isDirectory) || !isDirectory){
+            return false;
+        }
+        #ifdef _WIN32
+            if(volume.expectedSerial != 0){
+                DWORD serial;
+                if(!GetVolumeInformationW(LnkFileInfo::utf8ToNativeEncoding(root).c_str(), nullptr, 0, &serial, nullptr, nullptr, nullptr, 0)){
+                    return false;
+                }
+                return serial == volume.expectedSerial;
+            }
+        #endif
+        return true;
+    }
+
+    /**
+     * Lists a directory and checks its targets against the listing. Targets that aren't in the listing are missing, the others still need to be checked separately on operating systems where listing a directory doesn't give the sizes of the files. If listing the directory fails, all targets in it need to be checked separately.
+     */
+    static void listDirectory(const Directory& directory, const std::vector<Target>& targets, const Options& options, std::vector<Result>& results, std::vector<uint8_t>& needsStat){
+        //The names are compared case insensitively since the file system may be case insensitive, in which case the target can exist with a different case. Targets found this way are checked separately, which gives the right result on both case sensitive and case insensitive file systems.
+        struct Entry {
+            uint64_t size;
+            bool isDirectory;
+        };
+        std::unordered_map<std::string, Entry> entries;    //Only filled in on Windows, where the size and the type are part of the listing
+        std::unordered_set<std::string> lowercaseNames;
+        #ifdef _WIN32
+            const char lastCharacter = directory.path.back();
+            WIN32_FIND_DATAW data;
+            const std::unique_ptr<void, FindCloser> find(FindFirstFileExW(LnkFileInfo::utf8ToNativeEncoding(directory.path + (lastCharacter == '\\' || lastCharacter == '/' ? "*" : "\\*")).c_str(), FindExInfoBasic, &data, FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH));
+            const bool listed = find.get() != INVALID_HANDLE_VALUE;
+            if(listed){
+                do{
+                    std::string name = nativeToUtf8(data.cFileName);
+                    lowercaseNames.insert(toLowercase(name));
+                    const bool isDirectory = data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY;
+                    entries.emplace(std::move(name), Entry{isDirectory ? 0 : static_cast<uint64_t>(data.nFileSizeHigh) << 32 | data.nFileSizeLow, isDirectory});
+                } while(FindNextFileW(find.get(), &data));
+            }
+        #else
+            const std::unique_ptr<DIR, DirectoryCloser> dir(opendir(directory.path.c_str()));
+            const bool listed = dir != nullptr;
+            if(listed){
+                while(const dirent* entry = readdir(dir.get())){
+                    lowercaseNames.insert(toLowercase(entry->d_name));
+                }
+            }
+        #endif
+        for(const size_t target: directory.targets){
+            if(!listed){
+                needsStat[target] = true;
+                continue;
+            }
+            const std::string name = results[target].targetPath.substr(targets[target].nameOffset);
+            const auto entry = entries.find(name);
+            if(entry != entries.end()){
+                setFound(targets[target], options, entry->second.size, entry->second.isDirectory, results[target]);
+            }
+            else if(lowercaseNames.count(toLowercase(name)) != 0){
+                needsStat[target] = true;
+            }
+            else{
+                results[target].status = Status::Missing;
+            }
+        }
+    }
+
+    /**
+     * Sets the result of a target that exists.
+     */
+    static void setFound(const Target& target, const Options& options, uint64_t size, bool isDirectory, Result& result) noexcept {
+        result.size = size;
+        //The size in the LNK file only contains the lower 32 bits of the size, and is meaningless for directories
+        const bool sizeChanged = options.checkSize && !isDirectory && !target.isDirectory && static_cast<uint32_t>(size) != target.expectedSize;
+        result.status = sizeChanged ? Status::SizeChanged : Status::Exists;
+    }
+
+    /**
+     * Gets the size and the type of a file with a single system call.
+     *
+     * @return False if the file doesn't exist or can't be accessed.
+     */
+    static bool statPath(const std::string& path, uint64_t& size, bool& isDirectory){
+        #ifdef _WIN32
+            WIN32_FILE_ATTRIBUTE_DATA attributes;
+            if(!GetFileAttributesExW(LnkFileInfo::utf8ToNativeEncoding(path).c_str(), GetFileExInfoStandard, &attributes)){
+                return false;
+            }
+            size = static_cast<uint64_t>(attributes.nFileSizeHigh) << 32 | attributes.nFileSizeLow;
+            isDirectory = attributes.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY;
+        #else
+            struct stat status;
+            if(::stat(path.c_str(), &status) != 0){
+                return false;
+            }
+            size = static_cast<uint64_t>(status.st_size);
+            isDirectory = S_ISDIR(status.st_mode);
+        #endif
+        return true;
+    }
+
+    /**
+     * Calls a function for each index from zero to `count` on up to `threads` threads at the same time, including the calling thread. If the function throws an exception, the remaining indices are skipped and the exception is rethrown.
+     */
+    template<typename Function>
+    static void parallelFor(size_t count, unsigned int threads, const Function& function){
+        std::atomic<size_t> next{0};
+        std::mutex errorMutex;
+        std::exception_ptr error;
+        const auto worker = [&](){
+            try{
+                for(size_t i = next++; i < count; i = next++){
+                    function(i);
+                }
+            }
+            catch(...){
+                const std::lock_guard lock(errorMutex);
+                error = std::current_exception();
+                next = count;
+            }
+        };
+        const size_t threadCount = std::min<size_t>(std::max(1u, threads), count);
+        std::vector<std::thread> workers;
+        for(size_t i = 1; i < threadCount; i++){
+            workers.emplace_back(worker);
+        }
+        worker();
+        for(std::thread& thread: workers){
+            thread.join();
+        }
+        if(error){
+            std::rethrow_exception(error);
+        }
+    }
+
+    /**
+     * Returns true if the given strings are equal, ignoring the case of ASCII letters.
+     */
+    static bool equalsIgnoringCase(const std::string& a, const std::string& b) noexcept {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y){
+            return toLowercase(x) == toLowercase(y);
+        });
+    }
+
+    /**
+     * Converts the ASCII letters in a character or a string to lowercase. Other characters are left unchanged.
+     */
+    static char toLowercase(char c) noexcept {
+        return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    static std::string toLowercase(std::string string){
+        for(char &c: string){
+            c = toLowercase(c);
+        }
+        return string;
+    }
+
+    #ifndef _WIN32
+        /**
+         * Closes a directory opened with `opendir`. A function object is used instead of `closedir` itself since its attributes would be ignored as a template argument.
+         */
+        struct DirectoryCloser {
+            void operator()(DIR* directory) const noexcept {
+                closedir(directory);
+            }
+        };
+    #endif
+
+    #ifdef _WIN32
+        /**
+         * Closes a search handle opened with `FindFirstFileExW`. It returns `INVALID_HANDLE_VALUE` rather than a null pointer on failure, and `std::unique_ptr` calls its deleter for any non-null pointer, so that value is skipped here.
+         */
+        struct FindCloser {
+            void operator()(HANDLE find) const noexcept {
+                if(find != INVALID_HANDLE_VALUE){
+                    FindClose(find);
+                }
+            }
+        };
+
+        /**
+         * Converts a UTF-16 encoded file name from the Windows API to UTF-8.
+         */
+        static std::string nativeToUtf8(const wchar_t* utf16){
+            const int sizeNeeded = WideCharToMultiByte(CP_UTF8, 0, utf16, -1, nullptr, 0, nullptr, nullptr);
+            std::string utf8(sizeNeeded > 0 ? sizeNeeded - 1 : 0, '\0');
+            WideCharToMultiByte(CP_UTF8, 0, utf16, -1, utf8.data(), sizeNeeded, nullptr, nullptr);
+            return utf8;
+        }
+    #endif
+};
+
+#endif // LNKFILETARGETCHECKER_HPP
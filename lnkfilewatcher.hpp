@@ -0,0 +1,584 @@
+/*
+ * LNK file watcher, part of the LnkFileInfo library
+ * By Gustav Lindberg
+ * https://github.com/GustavLindberg99/LnkFileInfo
+ */
+
+#ifndef LNKFILEWATCHER_HPP
+#define LNKFILEWATCHER_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "lnkfileinfo.hpp"
+
+#if defined(_WIN32)
+    #include <Windows.h>
+#elif defined(__linux__)
+    #include <poll.h>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#endif
+
+/**
+ * The LnkFileWatcher class keeps an index of the LNK files in one or more directory trees up to date by watching the file system for changes, so that only the LNK files that were created, modified, renamed or deleted are read again instead of rescanning the whole tree.
+ *
+ * On Linux this uses inotify, and on Windows `ReadDirectoryChangesW`. Events are coalesced by path and debounced, so a burst of events (for example an installer creating many shortcuts, or a program writing a shortcut in several steps) is handled as a single change per file. While nothing changes, waiting for changes doesn't use any CPU. On other platforms, `waitForChanges()` falls back to calling `rescan()` after waiting for the timeout.
+ *
+ * This class isn't thread safe. The index may only be accessed from the thread that calls `waitForChanges()` and `rescan()`, or with external synchronization.
+ */
+class LnkFileWatcher final {
+public:
+    /**
+     * Options that change how the directories are watched.
+     */
+    struct Options {
+        bool recursive = true;                                              //Whether to watch subdirectories, including subdirectories that are created after the watcher. Symbolic links to directories are not followed.
+        std::chrono::milliseconds debounce{100};                            //How long to wait for more events after an event before reading the changed files.
+        std::chrono::milliseconds maxDelay{1000};                           //The maximum time to wait after the first event before reading the changed files, even if events keep arriving.
+        LnkFileInfo::ParseOptions parseOptions = LnkFileInfo::NoOptions;    //The options to parse the LNK files with.
+        std::shared_ptr<LnkFileInfo::StringPool> stringPool;               //If not null, the strings of the LNK files in the index are interned in this pool with `LnkFileInfo::internStrings()`.
+    };
+
+    /**
+     * What happened to an LNK file.
+     */
+    enum ChangeType: uint8_t {
+        Added    = 0,    //The LNK file was created or renamed to its current path, and is now in the index.
+        Modified = 1,    //The contents of the LNK file changed, and the index contains the new contents.
+        Removed  = 2,    //The LNK file was deleted or renamed to another path, and has been removed from the index.
+        Failed   = 3     //The LNK file exists but couldn't be read or isn't a valid LNK file. It isn't in the index, and has been removed from it if it was there.
+    };
+
+    /**
+     * A change to a single LNK file.
+     */
+    struct Change {
+        std::string filePath;            //The path of the LNK file, encoded in UTF-8. This is the key of the LNK file in `lnkFiles()`.
+        ChangeType type;                 //What happened to the LNK file.
+        LnkFileInfo::ErrorCode error;    //Why reading the LNK file failed if `type` is `Failed`, `LnkFileInfo::Success` otherwise.
+    };
+
+    /**
+     * Starts watching the given directories and reads all LNK files in them. Subdirectories that can't be listed or watched are skipped.
+     *
+     * @param directoryPaths    The paths of the directories to watch, encoded in UTF-8. The paths of the LNK files in the index start with these paths.
+     * @param options           Options that change how the directories are watched.
+     *
+     * @throws LnkFileInfo::IoError if one of the directories isn't a directory or can't be watched.
+     */
+    LnkFileWatcher(const std::vector<std::string>& directoryPaths, const Options& options): _options(options) {
+        try{
+            #if defined(__linux__)
+                this->_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+                if(this->_inotify == -1){
+                    throw LnkFileInfo::IoError(std::filesystem::filesystem_error("Creating an inotify instance failed", std::error_code(errno, std::generic_category())));
+                }
+            #endif
+            for(const std::string& directoryPath: directoryPaths){
+                this->addRoot(directoryPath);
+            }
+        }
+        catch(...){
+            this->close();
+            throw;
+        }
+        this->processPending();
+    }
+
+    /**
+     * Equivalent to `LnkFileWatcher(directoryPaths, LnkFileWatcher::Options())`.
+     */
+    explicit LnkFileWatcher(const std::vector<std::string>& directoryPaths): LnkFileWatcher(directoryPaths, Options()) {}
+
+    LnkFileWatcher(const LnkFileWatcher&) = delete;
+    LnkFileWatcher& operator=(const LnkFileWatcher&) = delete;
+
+    /**
+     * Stops watching the directories.
+     */
+    ~LnkFileWatcher(){
+        this->close();
+    }
+
+    /**
+     * Returns the LNK files in the watched directories by path. LNK files that couldn't be read aren't included.
+     */
+    const std::unordered_map<std::string, LnkFileInfo>& lnkFiles() const noexcept {
+        return this->_lnkFiles;
+    }
+
+    /**
+     * Waits until LNK files in the watched directories change, then updates the index. After the first event, this waits until no new events have arrived for `Options::debounce` (or at most for `Options::maxDelay`) so that bursts of events are handled at once. Only the LNK files that events were received for are read again, and LNK files whose contents didn't change aren't reported.
+     *
+     * @param timeout   The maximum time to wait for a change. This can be exceeded by up to `Options::maxDelay` plus the time it takes to read the changed files if events arrive just before the timeout.
+     *
+     * @return The changes sorted by path, or an empty vector if nothing changed before the timeout.
+     */
+    std::vector<Change> waitForChanges(std::chrono::milliseconds timeout){
+        #if defined(_WIN32) || defined(__linux__)
+            const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+            while(true){
+                //Wait for the first event that concerns an LNK file or a directory
+                while(this->_pending.empty() && !this->_overflow){
+                    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                    const std::chrono::milliseconds remaining = now < deadline ? std::chrono::ceil<std::chrono::milliseconds>(deadline - now) : std::chrono::milliseconds(0);
+                    if(!this->waitForEvents(remaining)){
+                        return {};
+                    }
+                    this->readEvents();
+                    if(this->_pending.empty() && !this->_overflow && now >= deadline){
+                        return {};
+                    }
+                }
+
+                //Wait for the burst of events to end
+                const std::chrono::steady_clock::time_point latest = std::chrono::steady_clock::now() + this->_options.maxDelay;
+                while(true){
+                    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                    if(now >= latest || !this->waitForEvents(std::min(this->_options.debounce, std::chrono::ceil<std::chrono::milliseconds>(latest - now)))){
+                        break;
+                    }
+                    this->readEvents();
+                }
+
+                std::vector<Change> changes = this->_overflow ? this->rescan() : this->processPending();
+                if(!changes.empty() || std::chrono::steady_clock::now() >= deadline){
+                    return changes;
+                }
+            }
+        #else
+            std::this_thread::sleep_for(timeout);
+            return this->rescan();
+        #endif
+    }
+
+    /**
+     * Lists all watched directories again and reads the LNK files that were added to them or changed since they were last read, regardless of which events were received. This is done automatically if events were lost, for example because the event queue of the operating system overflowed, and can be called to recover from other situations where events are missing, such as a watched directory that was deleted and created again.
+     *
+     * @return The changes sorted by path.
+     */
+    std::vector<Change> rescan(){
+        this->_overflow = false;
+        for(const auto& [filePath, lnkFileInfo]: this->_lnkFiles){
+            this->_pending.insert(filePath);
+        }
+        for(const std::string& root: this->_roots){
+            this->watchDirectory(root);
+        }
+        return this->processPending();
+    }
+
+private:
+    #ifdef _WIN32
+        /**
+         * A directory tree watched with `ReadDirectoryChangesW`. This isn't movable since the operating system writes to the buffer and to the OVERLAPPED structure while a read is pending.
+         */
+        struct WatchedRoot {
+            std::string path;
+            HANDLE directory = INVALID_HANDLE_VALUE;
+            OVERLAPPED overlapped = {};
+            std::vector<DWORD> buffer = std::vector<DWORD>(16384);    //DWORD aligned as required by ReadDirectoryChangesW
+            bool reading = false;
+        };
+    #endif
+
+    /**
+     * Starts watching a directory and adds the LNK files in it to the pending files.
+     *
+     * @throws LnkFileInfo::IoError if the path isn't a directory or can't be watched.
+     */
+    void addRoot(std::string directoryPath){
+        const std::filesystem::path path = utf8ToPath(directoryPath);
+        std::error_code error;
+        if(!std::filesystem::is_directory(path, error)){
+            throw LnkFileInfo::IoError(std::filesystem::filesystem_error("Not a directory", path, error ? error : std::make_error_code(std::errc::not_a_directory)));
+        }
+        while(directoryPath.size() > 1 && isSeparator(directoryPath.back())){
+            directoryPath.pop_back();
+        }
+
+        #if defined(_WIN32)
+            std::unique_ptr<WatchedRoot> root = std::make_unique<WatchedRoot>();
+            root->path = directoryPath;
+            root->directory = CreateFileW(utf8ToPath(directoryPath + separator).c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+            root->overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+            WatchedRoot* const rootPointer = root.get();
+            this->_watchedRoots.push_back(std::move(root));
+            if(rootPointer->directory == INVALID_HANDLE_VALUE || rootPointer->overlapped.hEvent == nullptr || this->_watchedRoots.size() > MAXIMUM_WAIT_OBJECTS || !this->startReading(*rootPointer)){
+                throw LnkFileInfo::IoError(std::filesystem::filesystem_error("Watching the directory failed", path, std::error_code(static_cast<int>(GetLastError()), std::system_category())));
+            }
+        #elif defined(__linux__)
+            const int watch = inotify_add_watch(this->_inotify, directoryPath.c_str(), watchMask);
+            if(watch == -1){
+                throw LnkFileInfo::IoError(std::filesystem::filesystem_error("Watching the directory failed", path, std::error_code(errno, std::generic_category())));
+            }
+            this->_watchedDirectories[watch] = directoryPath;
+        #endif
+
+        this->watchDirectory(directoryPath);
+        this->_roots.push_back(std::move(directoryPath));
+    }
+
+    /**
+     * Adds the LNK files in a directory and, if recursive, in its subdirectories to the pending files. On Linux, also starts watching the subdirectories, which is done before listing them so that files created in the meantime aren't missed. Directories that can't be listed or watched are skipped.
+     */
+    void watchDirectory(const std::string& directoryPath){
+        std::vector<std::string> directories{directoryPath};
+        while(!directories.empty()){
+            const std::string directory = std::move(directories.back());
+            directories.pop_back();
+            #ifdef __linux__
+                const int watch = inotify_add_watch(this->_inotify, directory.c_str(), watchMask);
+                if(watch == -1){
+                    continue;
+                }
+                this->_watchedDirectories[watch] = directory;
+            #endif
+            std::error_code error;
+            std::filesystem::directory_iterator it(utf8ToPath(directory), std::filesystem::directory_options::skip_permission_denied, error);
+            for(; !error && it != std::filesystem::directory_iterator(); it.increment(error)){
+                std::error_code typeError;
+                const std::string filePath = joinPath(directory, pathToUtf8(it->path().filename()));
+                if(this->_options.recursive && it->is_directory(typeError) && !it->is_symlink(typeError)){
+                    directories.push_back(filePath);
+                }
+                else if(isLnkFile(filePath) && it->is_regular_file(typeError)){
+                    this->_pending.insert(filePath);
+                }
+            }
+        }
+    }
+
+    /**
+     * Adds the LNK files in the index that are in the given directory or its subdirectories to the pending files, so that they're removed if they no longer exist. On Linux, also stops watching the directory and its subdirectories.
+     */
+    void forgetDirectory(const std::string& directoryPath){
+        const std::string prefix = joinPath(directoryPath, "");
+        #ifdef __linux__
+            for(auto it = this->_watchedDirectories.begin(); it != this->_watchedDirectories.end();){
+                if(it->second == directoryPath || it->second.compare(0, prefix.size(), prefix) == 0){
+                    inotify_rm_watch(this->_inotify, it->first);
+                    it = this->_watchedDirectories.erase(it);
+                }
+                else{
+                    ++it;
+                }
+            }
+        #endif
+        for(const auto& [filePath, lnkFileInfo]: this->_lnkFiles){
+            if(filePath.compare(0, prefix.size(), prefix) == 0){
+                this->_pending.insert(filePath);
+            }
+        }
+    }
+
+    /**
+     * Handles an event about a file or directory.
+     *
+     * @param filePath          The path of the file or directory, encoded in UTF-8.
+     * @param created           True if the file or directory was created or renamed to this path.
+     * @param removed           True if the file or directory was deleted or renamed from this path.
+     * @param mayBeDirectory    False if the path is known not to be a directory, in which case the index doesn't need to be searched for files in it when it's removed.
+     */
+    void handleEvent(std::string&& filePath, bool created, bool removed, bool mayBeDirectory){
+        if(mayBeDirectory && removed){
+            this->forgetDirectory(filePath);
+        }
+        else if(mayBeDirectory && created && this->_options.recursive){
+            std::error_code error;
+            if(std::filesystem::is_directory(std::filesystem::symlink_status(utf8ToPath(filePath), error))){
+                this->watchDirectory(filePath);
+            }
+        }
+        if(isLnkFile(filePath)){
+            this->_pending.insert(std::move(filePath));
+        }
+    }
+
+    /**
+     * Reads the pending files and updates the index.
+     *
+     * @return The changes sorted by path.
+     */
+    std::vector<Change> processPending(){
+        std::vector<Change> changes;
+        for(const std::string& filePath: this->_pending){
+            LnkFileInfo::ErrorCode error = LnkFileInfo::Success;
+            const auto it = this->_lnkFiles.find(filePath);
+            if(it != this->_lnkFiles.end()){
+                bool changed;
+                error = it->second.tryRefreshIfChanged(changed);
+                if(error == LnkFileInfo::Success){
+                    if(changed){
+                        changes.push_back(Change{filePath, ChangeType::Modified, LnkFileInfo::Success});
+                    }
+                    continue;
+                }
+                this->_lnkFiles.erase(it);
+                if(!exists(filePath)){
+                    changes.push_back(Change{filePath, ChangeType::Removed, LnkFileInfo::Success});
+                    continue;
+                }
+            }
+            else{
+                //The contents are hashed so that writing the same contents again isn't reported as a modification
+                LnkFileInfo lnkFileInfo;
+                lnkFileInfo._filePath = filePath;
+                lnkFileInfo._options = this->_options.parseOptions;
+                bool changed;
+                error = lnkFileInfo.tryRefresh(this->_buffer, &changed);
+                if(error == LnkFileInfo::Success && !lnkFileInfo.updateAbsoluteFilePath()){
+                    error = LnkFileInfo::OpenFailed;
+                }
+                if(error == LnkFileInfo::Success){
+                    if(this->_options.stringPool){
+                        lnkFileInfo.internStrings(this->_options.stringPool);
+                    }
+                    this->_lnkFiles.emplace(filePath, std::move(lnkFileInfo));
+                    changes.push_back(Change{filePath, ChangeType::Added, LnkFileInfo::Success});
+                    continue;
+                }
+                if(!exists(filePath)){
+                    continue;
+                }
+            }
+            changes.push_back(Change{filePath, ChangeType::Failed, error});
+        }
+        this->_pending.clear();
+        std::sort(changes.begin(), changes.end(), [](const Change& a, const Change& b){
+            return a.filePath < b.filePath;
+        });
+        return changes;
+    }
+
+    #if defined(_WIN32)
+        /**
+         * Starts an asynchronous read of the changes in a watched directory tree.
+         *
+         * @return True if starting the read succeeded, false otherwise.
+         */
+        bool startReading(WatchedRoot& root){
+            ResetEvent(root.overlapped.hEvent);
+            root.reading = ReadDirectoryChangesW(root.directory, root.buffer.data(), static_cast<DWORD>(root.buffer.size() * sizeof(DWORD)), this->_options.recursive, FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE, nullptr, &root.overlapped, nullptr);
+            return root.reading;
+        }
+
+        /**
+         * Waits until at least one of the watched directory trees has changes or the timeout expires.
+         *
+         * @return True if there are changes to read, false if the timeout expired.
+         */
+        bool waitForEvents(std::chrono::milliseconds timeout){
+            std::vector<HANDLE> events;
+            for(const std::unique_ptr<WatchedRoot>& root: this->_watchedRoots){
+                if(root->reading){
+                    events.push_back(root->overlapped.hEvent);
+                }
+            }
+            if(events.empty()){
+                std::this_thread::sleep_for(timeout);
+                return false;
+            }
+            return WaitForMultipleObjects(static_cast<DWORD>(events.size()), events.data(), FALSE, static_cast<DWORD>(std::min<std::chrono::milliseconds::rep>(timeout.count(), INFINITE - 1))) < WAIT_OBJECT_0 + events.size();
+        }
+
+        /**
+         * Reads the changes of all watched directory trees whose reads have completed, and starts reading them again.
+         */
+        void readEvents(){
+            for(const std::unique_ptr<WatchedRoot>& root: this->_watchedRoots){
+                DWORD size = 0;
+                if(!root->reading || !GetOverlappedResult(root->directory, &root->overlapped, &size, FALSE)){
+                    if(root->reading && GetLastError() != ERROR_IO_INCOMPLETE){
+                        root->reading = false;
+                        this->_overflow = true;
+                    }
+                    continue;
+                }
+                if(size == 0){
+                    //The buffer was too small for all the changes
+                    this->_overflow = true;
+                }
+                else{
+                    const uint8_t* entry = reinterpret_cast<const uint8_t*>(root->buffer.data());
+                    while(true){
+                        const FILE_NOTIFY_INFORMATION* const information = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(entry);
+                        const std::wstring name(information->FileName, information->FileNameLength / sizeof(WCHAR));
+                        const DWORD action = information->Action;
+                        this->handleEvent(joinPath(root->path, pathToUtf8(std::filesystem::path(name))), action == FILE_ACTION_ADDED || action == FILE_ACTION_RENAMED_NEW_NAME, action == FILE_ACTION_REMOVED || action == FILE_ACTION_RENAMED_OLD_NAME, true);
+                        if(information->NextEntryOffset == 0){
+                            break;
+                        }
+                        entry += information->NextEntryOffset;
+                    }
+                }
+                if(!this->startReading(*root)){
+                    this->_overflow = true;
+                }
+            }
+        }
+    #elif defined(__linux__)
+        /**
+         * Waits until the inotify instance has events or the timeout expires.
+         *
+         * @return True if there are events to read, false if the timeout expired.
+         */
+        bool waitForEvents(std::chrono::milliseconds timeout){
+            pollfd descriptor{this->_inotify, POLLIN, 0};
+            return poll(&descriptor, 1, static_cast<int>(std::min<std::chrono::milliseconds::rep>(timeout.count(), INT_MAX))) > 0;
+        }
+
+        /**
+         * Reads all available inotify events.
+         */
+        void readEvents(){
+            alignas(inotify_event) char buffer[65536];
+            ssize_t size;
+            while((size = read(this->_inotify, buffer, sizeof(buffer))) > 0){
+                for(const char* entry = buffer; entry < buffer + size;){
+                    const inotify_event* const event = reinterpret_cast<const inotify_event*>(entry);
+                    entry += sizeof(inotify_event) + event->len;
+                    if(event->mask & IN_Q_OVERFLOW){
+                        this->_overflow = true;
+                        continue;
+                    }
+                    const auto directory = this->_watchedDirectories.find(event->wd);
+                    if(directory == this->_watchedDirectories.end()){
+                        continue;
+                    }
+                    if(event->mask & IN_IGNORED){
+                        this->_watchedDirectories.erase(directory);
+                    }
+                    else if(event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)){
+                        this->forgetDirectory(std::string(directory->second));
+                    }
+                    else if(event->len > 0){
+                        this->handleEvent(joinPath(directory->second, event->name), event->mask & (IN_CREATE | IN_MOVED_TO), event->mask & (IN_DELETE | IN_MOVED_FROM), event->mask & IN_ISDIR);
+                    }
+                }
+            }
+        }
+
+        static constexpr uint32_t watchMask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR | IN_EXCL_UNLINK;
+    #endif
+
+    /**
+     * Stops watching all directories.
+     */
+    void close() noexcept {
+        #if defined(_WIN32)
+            for(const std::unique_ptr<WatchedRoot>& root: this->_watchedRoots){
+                if(root->reading){
+                    DWORD size;
+                    CancelIoEx(root->directory, &root->overlapped);
+                    GetOverlappedResult(root->directory, &root->overlapped, &size, TRUE);
+                }
+                if(root->directory != INVALID_HANDLE_VALUE){
+                    CloseHandle(root->directory);
+                }
+                if(root->overlapped.hEvent != nullptr){
+                    CloseHandle(root->overlapped.hEvent);
+                }
+            }
+            this->_watchedRoots.clear();
+        #elif defined(__linux__)
+            if(this->_inotify != -1){
+                ::close(this->_inotify);
+                this->_inotify = -1;
+            }
+        #endif
+    }
+
+    /**
+     * Returns true if something exists at the given path.
+     */
+    static bool exists(const std::string& filePath){
+        std::error_code error;
+        return std::filesystem::exists(utf8ToPath(filePath), error);
+    }
+
+    /**
+     * Returns true if the given path has the `.lnk` extension, case insensitive.
+     */
+    static bool isLnkFile(const std::string& filePath){
+        const size_t size = filePath.size();
+        return size > 4 && filePath[size - 4] == '.'
+            && (filePath[size - 3] == 'l' || filePath[size - 3] == 'L')
+            && (filePath[size - 2] == 'n' || filePath[size - 2] == 'N')
+            && (filePath[size - 1] == 'k' || filePath[size - 1] == 'K')
+            && !isSeparator(filePath[size - 5]);
+    }
+
+    static bool isSeparator(char c){
+        #ifdef _WIN32
+            return c == '\\' || c == '/';
+        #else
+            return c == '/';
+        #endif
+    }
+
+    /**
+     * Appends a file name to a directory path, adding a separator unless the directory path already ends with one.
+     */
+    static std::string joinPath(const std::string& directoryPath, const std::string& fileName){
+        std::string result;
+        result.reserve(directoryPath.size() + 1 + fileName.size());
+        result += directoryPath;
+        if(result.empty() || !isSeparator(result.back())){
+            result += separator;
+        }
+        result += fileName;
+        return result;
+    }
+
+    /**
+     * Converts a path to a UTF-8 encoded string. `std::filesystem::path::string()` isn't used since it uses the ANSI code page on Windows.
+     */
+    static std::string pathToUtf8(const std::filesystem::path& path){
+        const auto utf8 = path.u8string();    //std::string in C++17, std::u8string in C++20
+        return std::string(utf8.begin(), utf8.end());
+    }
+
+    /**
+     * Converts a UTF-8 encoded string to a path.
+     */
+    static std::filesystem::path utf8ToPath(const std::string& utf8){
+        #if defined(__cpp_char8_t)
+            return std::filesystem::path(std::u8string(utf8.begin(), utf8.end()));
+        #else
+            return std::filesystem::u8path(utf8);
+        #endif
+    }
+
+    #ifdef _WIN32
+        static constexpr char separator = '\\';
+    #else
+        static constexpr char separator = '/';
+    #endif
+
+    Options _options;
+    std::unordered_map<std::string, LnkFileInfo> _lnkFiles;
+    std::unordered_set<std::string> _pending;    //LNK files that events were received for and that haven't been read again yet
+    std::vector<std::string> _roots;
+    std::vector<uint8_t> _buffer;                //Reused to read new LNK files
+    bool _overflow = false;                      //True if events were lost and all directories need to be listed again
+    #if defined(_WIN32)
+        std::vector<std::unique_ptr<WatchedRoot>> _watchedRoots;
+    #elif defined(__linux__)
+        int _inotify = -1;
+        std::unordered_map<int, std::string> _watchedDirectories;    //The directories being watched by watch descriptor
+    #endif
+};
+
+#endif // LNKFILEWATCHER_HPP
@@ -1,5 +1,78 @@
 #include <gtest/gtest.h>
+#include <lnkfilearchivereader.hpp>
+#include <lnkfileasyncreader.hpp>
+#include <lnkfilecache.hpp>
+#include <lnkfilecarver.hpp>
 #include <lnkfileinfo.hpp>
+#include <lnkfileinfobatch.hpp>
+#include <lnkfilerecord.hpp>
+#include <lnkfilescanner.hpp>
+#include <lnkfileserializer.hpp>
+#include <lnkfileshard.hpp>
+#include <lnkfiletargetchecker.hpp>
+#include <lnkfilewatcher.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * Reads the contents of a file in the test directory into memory.
+ */
+static std::vector<uint8_t> readTestFile(const std::string& fileName){
+    std::ifstream file(TEST_LNK_FILES_DIR "/" + fileName, std::ios::binary);
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+/**
+ * Builds a minimal valid LNK file in memory pointing to the given target (C:\\Target.txt by default) on a hard drive called "Volume" with serial number 0x12345678, with the given description.
+ */
+static std::vector<uint8_t> makeLnkFile(const std::u16string& description, const std::string& targetPath = "C:\\Target.txt"){
+    std::vector<uint8_t> bytes(78, 0);
+    const uint8_t clsid[] = {0x01, 0x14, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x46};
+    bytes[0] = 0x4C;
+    std::copy(std::begin(clsid), std::end(clsid), bytes.begin() + 4);
+    bytes[20] = 0x06;    //Has link info and description
+    bytes[24] = 0x20;    //Archive
+
+    const auto appendInteger = [&bytes](uint32_t value, int size){
+        for(int i = 0; i < size; i++){
+            bytes.push_back(static_cast<uint8_t>(value >> (i * 8)));
+        }
+    };
+    const std::string volumeName = "Volume";
+    const uint32_t volumeSize = 16 + static_cast<uint32_t>(volumeName.size()) + 1;
+    const uint32_t linkInfoSize = 28 + volumeSize + static_cast<uint32_t>(targetPath.size()) + 2;
+    appendInteger(linkInfoSize, 4);
+    appendInteger(0x1C, 4);
+    appendInteger(0x01, 4);
+    appendInteger(28, 4);
+    appendInteger(28 + volumeSize, 4);
+    appendInteger(0, 4);
+    appendInteger(linkInfoSize - 1, 4);
+    appendInteger(volumeSize, 4);
+    appendInteger(3, 4);    //Hard drive
+    appendInteger(0x12345678, 4);
+    appendInteger(16, 4);
+    bytes.insert(bytes.end(), volumeName.begin(), volumeName.end());
+    bytes.push_back(0);
+    bytes.insert(bytes.end(), targetPath.begin(), targetPath.end());
+    bytes.push_back(0);
+    bytes.push_back(0);
+
+    appendInteger(static_cast<uint32_t>(description.size()), 2);
+    for(const char16_t codeUnit: description){
+        appendInteger(codeUnit, 2);
+    }
+    appendInteger(0, 4);    //Terminal block
+    return bytes;
+}
 
 /**
  * Test that trying to open a nonexistent file throws an exception.
@@ -15,9 +88,768 @@ TEST(LnkFileInfoTest, InvalidLnkFile){
     EXPECT_THROW(LnkFileInfo{TEST_LNK_FILES_DIR "/../unittest.cpp"}, LnkFileInfo::InvalidLnkFile);
 }
 
+/**
+ * Test that parsing LNK files from memory gives the same information as parsing them from the file system, and that invalid or truncated bytes throw an exception.
+ */
+TEST(LnkFileInfoTest, FromBytes){
+    for(const std::string fileName: {"BasicLnkFile.lnk", "DirectoryLnkFile.lnk", "EmojiNetworkDriveLnkFile.lnk", "ÅÄÖLnkFile.lnk"}){
+        const std::vector<uint8_t> bytes = readTestFile(fileName);
+        const LnkFileInfo fromFile{TEST_LNK_FILES_DIR "/" + fileName};
+        const LnkFileInfo fromBytes{bytes, fileName};
+        EXPECT_EQ(fromBytes.filePath(), fileName);
+        EXPECT_EQ(fromBytes.absoluteFilePath(), fileName);
+        EXPECT_EQ(fromBytes.absoluteTargetPath(), fromFile.absoluteTargetPath());
+        EXPECT_EQ(fromBytes.description(), fromFile.description());
+        EXPECT_EQ(fromBytes.iconPath(), fromFile.iconPath());
+        EXPECT_EQ(fromBytes.iconIndex(), fromFile.iconIndex());
+        EXPECT_EQ(fromBytes.relativeTargetPath(), fromFile.relativeTargetPath());
+        EXPECT_EQ(fromBytes.targetIsOnNetwork(), fromFile.targetIsOnNetwork());
+        EXPECT_EQ(fromBytes.targetSize(), fromFile.targetSize());
+        EXPECT_EQ(fromBytes.targetVolumeSerial(), fromFile.targetVolumeSerial());
+        EXPECT_EQ(fromBytes.targetVolumeType(), fromFile.targetVolumeType());
+        EXPECT_EQ(fromBytes.targetVolumeName(), fromFile.targetVolumeName());
+        EXPECT_EQ(fromBytes.workingDirectory(), fromFile.workingDirectory());
+
+        EXPECT_THROW((LnkFileInfo{bytes.data(), 78}), LnkFileInfo::InvalidLnkFile);
+    }
+    const std::vector<uint8_t> notLnk = readTestFile("../CMakeLists.txt");
+    EXPECT_THROW(LnkFileInfo{notLnk}, LnkFileInfo::InvalidLnkFile);
+    EXPECT_THROW((LnkFileInfo{nullptr, 0}), LnkFileInfo::InvalidLnkFile);
+}
+
+/**
+ * Test that memory mapping LNK files gives the same information as reading them, and that errors are still reported correctly.
+ */
+TEST(LnkFileInfoTest, MemoryMapped){
+    for(const std::string fileName: {"BasicLnkFile.lnk", "UsbLnkFile.lnk", "NetworkDriveLnkFile.lnk", "😊LnkFile.lnk"}){
+        const LnkFileInfo read{TEST_LNK_FILES_DIR "/" + fileName};
+        LnkFileInfo mapped{TEST_LNK_FILES_DIR "/" + fileName, LnkFileInfo::MemoryMapped};
+        EXPECT_EQ(mapped, read);
+        EXPECT_EQ(mapped.absoluteTargetPath(), read.absoluteTargetPath());
+        EXPECT_EQ(mapped.relativeTargetPath(), read.relativeTargetPath());
+        EXPECT_EQ(mapped.targetVolumeName(), read.targetVolumeName());
+        EXPECT_EQ(mapped.targetVolumeSerial(), read.targetVolumeSerial());
+        EXPECT_EQ(mapped.workingDirectory(), read.workingDirectory());
+        EXPECT_NO_THROW(mapped.refresh());
+        EXPECT_EQ(mapped.absoluteTargetPath(), read.absoluteTargetPath());
+    }
+    EXPECT_THROW((LnkFileInfo{TEST_LNK_FILES_DIR "/nonexistent.lnk", LnkFileInfo::MemoryMapped}), LnkFileInfo::IoError);
+    EXPECT_THROW((LnkFileInfo{TEST_LNK_FILES_DIR "/../unittest.cpp", LnkFileInfo::MemoryMapped}), LnkFileInfo::InvalidLnkFile);
+}
+
+/**
+ * Test that lazily decoding strings gives the same information as decoding them when parsing, including for copies made before the strings are decoded.
+ */
+TEST(LnkFileInfoTest, LazyStrings){
+    for(const std::string fileName: {"BasicLnkFile.lnk", "DirectoryLnkFile.lnk", "EmojiLnkFile.lnk", "😊NetworkDriveLnkFile.lnk"}){
+        const LnkFileInfo eager{TEST_LNK_FILES_DIR "/" + fileName};
+        const LnkFileInfo lazy{TEST_LNK_FILES_DIR "/" + fileName, LnkFileInfo::LazyStrings};
+        const LnkFileInfo lazyCopy = lazy;
+        EXPECT_EQ(lazy.hasCustomIcon(), eager.hasCustomIcon());
+        EXPECT_EQ(lazy.iconIndex(), eager.iconIndex());
+        for(const LnkFileInfo* lnk: {&lazy, &lazyCopy}){
+            EXPECT_EQ(lnk->absoluteTargetPath(), eager.absoluteTargetPath());
+            EXPECT_EQ(lnk->commandLineArgs(), eager.commandLineArgs());
+            EXPECT_EQ(lnk->description(), eager.description());
+            EXPECT_EQ(lnk->description(), eager.description());
+            EXPECT_EQ(lnk->iconPath(), eager.iconPath());
+            EXPECT_EQ(lnk->relativeTargetPath(), eager.relativeTargetPath());
+            EXPECT_EQ(lnk->workingDirectory(), eager.workingDirectory());
+        }
+
+        const std::vector<uint8_t> bytes = readTestFile(fileName);
+        const LnkFileInfo lazyFromBytes{bytes, fileName, LnkFileInfo::LazyStrings};
+        EXPECT_EQ(lazyFromBytes.description(), eager.description());
+        EXPECT_EQ(lazyFromBytes.workingDirectory(), eager.workingDirectory());
+    }
+}
+
+/**
+ * Test that the strings of an object parsed with LazyStrings can be decoded and copied from several threads at the same time.
+ */
+TEST(LnkFileInfoTest, LazyStringsFromSeveralThreads){
+    const LnkFileInfo eager{TEST_LNK_FILES_DIR "/DirectoryLnkFile.lnk"};
+    for(int i = 0; i < 20; i++){
+        const LnkFileInfo lazy{TEST_LNK_FILES_DIR "/DirectoryLnkFile.lnk", LnkFileInfo::LazyStrings};
+        std::vector<std::thread> threads;
+        for(int thread = 0; thread < 4; thread++){
+            threads.emplace_back([&lazy, &eager, thread](){
+                //Half of the threads copy the object while the others are decoding its strings
+                if(thread % 2 == 0){
+                    const LnkFileInfo copy = lazy;
+                    EXPECT_EQ(copy.description(), eager.description());
+                    EXPECT_EQ(copy.iconPath(), eager.iconPath());
+                }
+                EXPECT_EQ(lazy.description(), eager.description());
+                EXPECT_EQ(lazy.workingDirectory(), eager.workingDirectory());
+                EXPECT_EQ(lazy.iconPath(), eager.iconPath());
+                EXPECT_EQ(lazy.commandLineArgs(), eager.commandLineArgs());
+                EXPECT_EQ(lazy.relativeTargetPath(), eager.relativeTargetPath());
+            });
+        }
+        for(std::thread &thread: threads){
+            thread.join();
+        }
+    }
+}
+
+/**
+ * Test that methods returning strings return references to the cached strings instead of copies, including for lazily decoded strings.
+ */
+TEST(LnkFileInfoTest, StringReferences){
+    for(const LnkFileInfo::ParseOptions options: {LnkFileInfo::NoOptions, LnkFileInfo::LazyStrings}){
+        const LnkFileInfo lnk{TEST_LNK_FILES_DIR "/DirectoryLnkFile.lnk", options};
+        EXPECT_EQ(&lnk.absoluteFilePath(), &lnk.absoluteFilePath());
+        EXPECT_EQ(&lnk.absoluteTargetPath(), &lnk.absoluteTargetPath());
+        EXPECT_EQ(&lnk.description(), &lnk.description());
+        EXPECT_EQ(&lnk.iconPath(), &lnk.iconPath());
+        EXPECT_EQ(&lnk.targetVolumeName(), &lnk.targetVolumeName());
+        EXPECT_EQ(lnk.description(), "A description");
+    }
+}
+
+/**
+ * Test converting UTF-16 strings to UTF-8, including long ASCII runs, characters of all UTF-8 lengths at both ends of a string and unpaired surrogates.
+ */
+TEST(LnkFileInfoTest, Utf16Conversion){
+    const std::pair<std::u16string, std::string> strings[] = {
+        {u"", ""},
+        {u"A", "A"},
+        {u"Exactly 16 chars", "Exactly 16 chars"},
+        {u"This is a long ASCII description that spans several SIMD blocks.", "This is a long ASCII description that spans several SIMD blocks."},
+        {u"Det här är en kommentar med åäö på flera ställen", "Det här är en kommentar med åäö på flera ställen"},
+        {u"😊 at the start and at the end 😊", "😊 at the start and at the end 😊"},
+        {u"Ωмега 中文 한국어 ₿", "Ωмега 中文 한국어 ₿"},
+        {std::u16string(u"Unpaired high ") + char16_t(0xD83D) + u"surrogate", "Unpaired high \xEF\xBF\xBDsurrogate"},
+        {std::u16string(u"Unpaired low ") + char16_t(0xDE0A) + u"surrogate", "Unpaired low \xEF\xBF\xBDsurrogate"},
+        {std::u16string(u"Unpaired high at the end ") + char16_t(0xD83D), "Unpaired high at the end \xEF\xBF\xBD"}
+    };
+    for(const auto& [utf16, utf8]: strings){
+        const LnkFileInfo lnk{makeLnkFile(utf16)};
+        EXPECT_EQ(lnk.description(), utf8);
+        EXPECT_EQ(lnk.absoluteTargetPath(), "C:\\Target.txt");
+        EXPECT_EQ(lnk.targetVolumeName(), "Volume");
+        EXPECT_EQ(lnk.targetVolumeSerial(), 0x12345678);
+    }
+}
+
+/**
+ * Test that the non-throwing methods return the same information as the throwing ones, and the correct error codes when reading fails.
+ */
+TEST(LnkFileInfoTest, ErrorCodes){
+    LnkFileInfo::ErrorCode error = LnkFileInfo::Success;
+    const std::optional<LnkFileInfo> lnk = LnkFileInfo::tryOpen(TEST_LNK_FILES_DIR "/EmojiLnkFile.lnk", error);
+    ASSERT_TRUE(lnk.has_value());
+    EXPECT_EQ(error, LnkFileInfo::Success);
+    EXPECT_EQ(*lnk, LnkFileInfo{TEST_LNK_FILES_DIR "/EmojiLnkFile.lnk"});
+    EXPECT_EQ(lnk->description(), "This is a description 😊.");
+
+    EXPECT_FALSE(LnkFileInfo::tryOpen(TEST_LNK_FILES_DIR "/nonexistent.lnk", error).has_value());
+    EXPECT_EQ(error, LnkFileInfo::OpenFailed);
+    EXPECT_FALSE(LnkFileInfo::tryOpen(TEST_LNK_FILES_DIR "/../unittest.cpp", error, LnkFileInfo::MemoryMapped).has_value());
+    EXPECT_EQ(error, LnkFileInfo::InvalidHeader);
+
+    std::vector<uint8_t> bytes = readTestFile("BasicLnkFile.lnk");
+    EXPECT_TRUE(LnkFileInfo::tryParse(bytes.data(), bytes.size(), error).has_value());
+    EXPECT_EQ(error, LnkFileInfo::Success);
+    EXPECT_FALSE(LnkFileInfo::tryParse(bytes.data(), 78, error).has_value());
+    EXPECT_EQ(error, LnkFileInfo::IndexOutOfRange);
+    EXPECT_FALSE(LnkFileInfo::tryParse(bytes.data(), 77, error).has_value());
+    EXPECT_EQ(error, LnkFileInfo::IndexOutOfRange);
+    EXPECT_FALSE(LnkFileInfo::tryParse(bytes.data() + 1, 77, error).has_value());
+    EXPECT_EQ(error, LnkFileInfo::InvalidHeader);
+    EXPECT_FALSE(LnkFileInfo::tryParse(nullptr, 0, error).has_value());
+    EXPECT_EQ(error, LnkFileInfo::IndexOutOfRange);
+
+    //Change the LinkInfo header to an invalid value and check that the exception message contains it
+    bytes[78 + (bytes[76] | bytes[77] << 8) + 4] = 0x42;
+    EXPECT_FALSE(LnkFileInfo::tryParse(bytes.data(), bytes.size(), error).has_value());
+    EXPECT_EQ(error, LnkFileInfo::InvalidFileinfoHeader);
+    try{
+        LnkFileInfo{bytes};
+        FAIL() << "Expected LnkFileInfo::InvalidLnkFile";
+    }
+    catch(const LnkFileInfo::InvalidLnkFile& e){
+        EXPECT_NE(std::string(e.what()).find("Invalid fileinfo header: 66"), std::string::npos);
+    }
+    EXPECT_STREQ(LnkFileInfo::errorMessage(LnkFileInfo::IndexOutOfRange), "Index out of range");
+}
+
+/**
+ * Test that offsets and lengths that point outside of the file are rejected instead of wrapping around.
+ */
+TEST(LnkFileInfoTest, HostileOffsets){
+    const std::vector<uint8_t> valid = makeLnkFile(u"Description");
+    ASSERT_NO_THROW(LnkFileInfo{valid});
+    const auto parse = [](std::vector<uint8_t> bytes, size_t offset, uint32_t value, int size){
+        for(int i = 0; i < size; i++){
+            bytes[offset + i] = static_cast<uint8_t>(value >> (i * 8));
+        }
+        LnkFileInfo::ErrorCode error = LnkFileInfo::Success;
+        for(const LnkFileInfo::ParseOptions options: {LnkFileInfo::ParseOptions(LnkFileInfo::NoOptions), LnkFileInfo::ParseOptions(LnkFileInfo::LazyStrings), LnkFileInfo::ParseOptions(LnkFileInfo::TargetOnly)}){
+            EXPECT_FALSE(LnkFileInfo::tryParse(bytes.data(), bytes.size(), error, "", options).has_value());
+        }
+        return error;
+    };
+
+    //An ID list size close to 0xFFFF used to make the LinkInfo offset wrap around to the start of the file
+    EXPECT_EQ(parse(valid, 76, 0xFFFF, 2), LnkFileInfo::IndexOutOfRange);
+    EXPECT_EQ(parse(valid, 76, 0xFFB2, 2), LnkFileInfo::IndexOutOfRange);
+
+    //Offsets in the LinkInfo section close to 0xFFFFFFFF used to wrap around to earlier parts of the file
+    EXPECT_EQ(parse(valid, 78 + 12, 0xFFFFFFF0, 4), LnkFileInfo::IndexOutOfRange);
+    EXPECT_EQ(parse(valid, 78 + 16, 0xFFFFFFFF, 4), LnkFileInfo::IndexOutOfRange);
+    const std::vector<uint8_t> truncated(valid.begin(), valid.begin() + 78 + 28 + 23 + 14);    //Right after the Latin1 target path
+    EXPECT_EQ(parse(truncated, 78 + 4, 0x24, 1), LnkFileInfo::IndexOutOfRange);    //The Unicode target path would extend past the end of the file
+    std::vector<uint8_t> network = valid;
+    network[78 + 8] |= 0x02;
+    EXPECT_EQ(parse(network, 78 + 20, 0xFFFFFFF0, 4), LnkFileInfo::IndexOutOfRange);
+
+    //The StringData section is only checked if it's needed
+    std::vector<uint8_t> stringData = valid;
+    for(int i = 0; i < 4; i++){
+        stringData[78 + i] = 0xFF;
+    }
+    LnkFileInfo::ErrorCode error = LnkFileInfo::Success;
+    EXPECT_FALSE(LnkFileInfo::tryParse(stringData.data(), stringData.size(), error).has_value());
+    EXPECT_EQ(error, LnkFileInfo::IndexOutOfRange);
+    const std::optional<LnkFileInfo> targetOnly = LnkFileInfo::tryParse(stringData.data(), stringData.size(), error, "", LnkFileInfo::TargetOnly);
+    ASSERT_TRUE(targetOnly.has_value());
+    EXPECT_EQ(targetOnly->absoluteTargetPath(), "C:\\Target.txt");
+}
+
+/**
+ * Test that the inputs in the fuzzing corpus, which contains truncated and corrupted versions of the test LNK files, are parsed the same way regardless of the options.
+ */
+TEST(LnkFileInfoTest, FuzzCorpus){
+    size_t count = 0, valid = 0;
+    for(const auto& entry: std::filesystem::directory_iterator(FUZZ_CORPUS_DIR)){
+        std::ifstream file(entry.path(), std::ios::binary);
+        const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        count++;
+        LnkFileInfo::ErrorCode eagerError = LnkFileInfo::Success, lazyError = LnkFileInfo::Success, targetOnlyError = LnkFileInfo::Success;
+        const std::optional<LnkFileInfo> eager = LnkFileInfo::tryParse(bytes.data(), bytes.size(), eagerError, "", LnkFileInfo::IdList | LnkFileInfo::ExtraData);
+        const std::optional<LnkFileInfo> lazy = LnkFileInfo::tryParse(bytes.data(), bytes.size(), lazyError, "", LnkFileInfo::LazyStrings | LnkFileInfo::IdList | LnkFileInfo::ExtraData);
+        const std::optional<LnkFileInfo> targetOnly = LnkFileInfo::tryParse(bytes.data(), bytes.size(), targetOnlyError, "", LnkFileInfo::TargetOnly);
+        EXPECT_EQ(eagerError, lazyError) << entry.path();
+        if(eager.has_value()){
+            valid++;
+            ASSERT_TRUE(lazy.has_value() && targetOnly.has_value()) << entry.path();
+            EXPECT_EQ(lazy->description(), eager->description()) << entry.path();
+            EXPECT_EQ(lazy->iconPath(), eager->iconPath()) << entry.path();
+            EXPECT_EQ(targetOnly->absoluteTargetPath(), eager->absoluteTargetPath()) << entry.path();
+        }
+    }
+    EXPECT_GT(count, 100u);
+    EXPECT_GT(valid, 9);
+}
+
+/**
+ * Test that the statistics count the files, bytes and errors of each thread, and that the batch classes add up the statistics of their threads.
+ */
+TEST(LnkFileInfoTest, ParseStats){
+    ASSERT_TRUE(LnkFileInfo::ParseStats::enabled);
+    const std::string filePath = TEST_LNK_FILES_DIR "/BasicLnkFile.lnk";
+    const std::vector<uint8_t> bytes = readTestFile("BasicLnkFile.lnk");
+    LnkFileInfo::threadStats() = LnkFileInfo::ParseStats();
+    LnkFileInfo::ErrorCode error = LnkFileInfo::Success;
+    EXPECT_TRUE(LnkFileInfo::tryOpen(filePath, error).has_value());
+    EXPECT_TRUE(LnkFileInfo::tryParse(bytes.data(), bytes.size(), error).has_value());
+    EXPECT_FALSE(LnkFileInfo::tryParse(bytes.data(), 77, error).has_value());
+    EXPECT_FALSE(LnkFileInfo::tryOpen(TEST_LNK_FILES_DIR "/Nonexistent.lnk", error).has_value());
+    const LnkFileInfo::ParseStats stats = LnkFileInfo::threadStats();
+    EXPECT_EQ(stats.filesParsed, 3u);
+    EXPECT_EQ(stats.bytesRead, bytes.size());
+    EXPECT_EQ(stats.errors[LnkFileInfo::Success], 0);
+    EXPECT_EQ(stats.errors[LnkFileInfo::OpenFailed], 1);
+    EXPECT_EQ(stats.errors[LnkFileInfo::IndexOutOfRange], 1);
+    EXPECT_EQ(stats.errorCount(), 2);
+    EXPECT_GT(stats.stringAllocations, 0);
+    EXPECT_GT(stats.readNanoseconds, 0);
+    EXPECT_GT(stats.cpuNanoseconds(), 0);
+    EXPECT_EQ((stats - stats).filesParsed, 0);
+
+    //Parsing with the same objects again reuses the capacity of the strings
+    LnkParser parser;
+    parser.parse(bytes.data(), bytes.size());
+    const LnkFileInfo::ParseStats before = LnkFileInfo::threadStats();
+    parser.parse(bytes.data(), bytes.size());
+    EXPECT_EQ((LnkFileInfo::threadStats() - before).filesParsed, 1);
+    EXPECT_EQ((LnkFileInfo::threadStats() - before).stringAllocations, 0);
+
+    //The batch classes add up the statistics of all their threads, but not the statistics of the calling thread
+    LnkFileInfo::threadStats() = LnkFileInfo::ParseStats();
+    LnkFileInfo::ParseStats scannerStats;
+    LnkFileScanner::Options scannerOptions;
+    scannerOptions.threads = 3;
+    scannerOptions.stats = &scannerStats;
+    const size_t scanned = LnkFileScanner::scanDirectory(TEST_LNK_FILES_DIR, scannerOptions).size();
+    EXPECT_EQ(scannerStats.filesParsed, scanned);
+    EXPECT_EQ(scannerStats.errorCount(), 0);
+    EXPECT_GT(scannerStats.bytesRead, scanned * 76);
+    EXPECT_EQ(LnkFileInfo::threadStats().filesParsed, 0);
+
+    LnkFileInfo::ParseStats asyncStats;
+    LnkFileAsyncReader::Options asyncOptions;
+    asyncOptions.stats = &asyncStats;
+    LnkFileAsyncReader::readFiles({filePath, filePath, TEST_LNK_FILES_DIR "/Nonexistent.lnk"}, asyncOptions, [](LnkFileAsyncReader::Result&&){
+        LnkFileInfo::threadStats().filesParsed += 100;    //Not counted since the callback isn't included
+    });
+    EXPECT_EQ(asyncStats.filesParsed, 2);
+    EXPECT_EQ(asyncStats.bytesRead, bytes.size() * 2);
+    EXPECT_EQ(asyncStats.errors[LnkFileInfo::OpenFailed], 1);
+    EXPECT_GT(asyncStats.readNanoseconds, 0);
+}
+
+/**
+ * Test that filters check the attributes, volume type, network flag and target path of LNK files, and that LNK files that don't match aren't returned by the parsing methods and the scanner.
+ */
+TEST(LnkFileInfoTest, Filter){
+    const LnkFileInfo basic{TEST_LNK_FILES_DIR "/BasicLnkFile.lnk"};
+    const LnkFileInfo usb{TEST_LNK_FILES_DIR "/UsbLnkFile.lnk"};
+    const LnkFileInfo directory{TEST_LNK_FILES_DIR "/DirectoryLnkFile.lnk"};
+    const LnkFileInfo network{TEST_LNK_FILES_DIR "/NetworkDriveLnkFile.lnk"};
+    const LnkFileInfo emoji{TEST_LNK_FILES_DIR "/EmojiLnkFile.lnk"};
+    EXPECT_TRUE(LnkFileInfo::Filter().matches(basic));
+
+    LnkFileInfo::Filter filter;
+    filter.requiredAttributes = LnkFileInfo::Archive;
+    filter.excludedAttributes = LnkFileInfo::Directory;
+    EXPECT_TRUE(filter.matches(basic));
+    EXPECT_FALSE(filter.matches(directory));
+    EXPECT_FALSE(filter.matches(network));
+
+    filter = LnkFileInfo::Filter();
+    filter.volumeTypes = LnkFileInfo::volumeTypeMask(LnkFileInfo::Removable) | LnkFileInfo::volumeTypeMask(LnkFileInfo::CdRom);
+    EXPECT_TRUE(filter.matches(usb));
+    EXPECT_FALSE(filter.matches(basic));
+    filter.volumeTypes = 0;
+    filter.targetIsOnNetwork = true;
+    EXPECT_TRUE(filter.matches(network));
+    EXPECT_FALSE(filter.matches(usb));
+
+    //Patterns are case insensitive and `?` matches a whole UTF-8 character
+    filter = LnkFileInfo::Filter();
+    filter.targetPathPattern = "c:\\USERS\\*.TXT";
+    EXPECT_TRUE(filter.matches(basic));
+    EXPECT_TRUE(filter.matches(emoji));
+    EXPECT_FALSE(filter.matches(usb));
+    EXPECT_FALSE(filter.matches(directory));
+    filter.targetPathPattern = "*\\Target?.txt";
+    EXPECT_TRUE(filter.matches(emoji));
+    EXPECT_FALSE(filter.matches(basic));
+    filter.targetPathPattern = "*t*t*.txt";
+    EXPECT_TRUE(filter.matches(basic));
+    filter.targetPathPattern = "?:\\Target.txt*";
+    EXPECT_TRUE(filter.matches(usb));
+    filter.targetPathPattern = "?:\\Target.txt?";
+    EXPECT_FALSE(filter.matches(usb));
+    filter.targetPathPattern = "*\\t*?.TXT";
+    EXPECT_TRUE(filter.matches(emoji));
+    filter.targetPathPattern = "*\\t*?????.TXT";
+    EXPECT_TRUE(filter.matches(usb));
+    filter.targetPathPattern = "*\\t*??????.TXT";
+    EXPECT_FALSE(filter.matches(usb));
+    filter.targetPathPattern = "**";
+    EXPECT_TRUE(filter.matches(usb));
+
+    filter = LnkFileInfo::Filter();
+    filter.predicate = [](const LnkFileInfo& lnk){
+        return lnk.targetSize() > 0;
+    };
+    EXPECT_TRUE(filter.matches(basic));
+    EXPECT_FALSE(filter.matches(network));
+
+    //LNK files that don't match aren't an error
+    filter = LnkFileInfo::Filter();
+    filter.excludedAttributes = LnkFileInfo::Archive;
+    const std::vector<uint8_t> bytes = readTestFile("BasicLnkFile.lnk");
+    LnkFileInfo::ErrorCode error = LnkFileInfo::InvalidHeader;
+    EXPECT_FALSE(LnkFileInfo::tryParse(bytes.data(), bytes.size(), error, "", LnkFileInfo::NoOptions, filter).has_value());
+    EXPECT_EQ(error, LnkFileInfo::Success);
+    EXPECT_FALSE(LnkFileInfo::tryOpen(basic.filePath(), error, LnkFileInfo::LazyStrings, filter).has_value());
+    EXPECT_EQ(error, LnkFileInfo::Success);
+    EXPECT_TRUE(LnkFileInfo::tryOpen(directory.filePath(), error, LnkFileInfo::NoOptions, filter).has_value());
+    EXPECT_FALSE(LnkFileInfo::tryParse(bytes.data(), 77, error, "", LnkFileInfo::NoOptions, filter).has_value());
+    EXPECT_EQ(error, LnkFileInfo::IndexOutOfRange);
+
+    LnkParser parser;
+    EXPECT_EQ(parser.tryOpen(basic.filePath(), error, filter), nullptr);
+    EXPECT_EQ(error, LnkFileInfo::Success);
+    const LnkFileInfo* lnk = parser.tryOpen(directory.filePath(), error, filter);
+    ASSERT_NE(lnk, nullptr);
+    EXPECT_EQ(*lnk, directory);
+    EXPECT_EQ(lnk->description(), "A description");
+    EXPECT_EQ(parser.tryOpen(TEST_LNK_FILES_DIR "/Nonexistent.lnk", error, filter), nullptr);
+    EXPECT_EQ(error, LnkFileInfo::OpenFailed);
+    filter.excludedAttributes = 0;
+    filter.targetPathPattern = "*.txt";
+    lnk = parser.tryParse(bytes.data(), bytes.size(), error, "Path.lnk", filter);
+    ASSERT_NE(lnk, nullptr);
+    EXPECT_EQ(lnk->absoluteTargetPath(), basic.absoluteTargetPath());
+    EXPECT_EQ(lnk->workingDirectory(), basic.workingDirectory());
+
+    //The scanner only reports the LNK files that match
+    LnkFileScanner::Options options;
+    options.threads = 3;
+    options.filter = LnkFileInfo::Filter();
+    options.filter->targetIsOnNetwork = true;
+    const std::vector<LnkFileScanner::Result> results = LnkFileScanner::scanDirectory(TEST_LNK_FILES_DIR, options);
+    EXPECT_EQ(results.size(), 3);
+    for(const LnkFileScanner::Result& result: results){
+        ASSERT_TRUE(result.lnkFileInfo.has_value());
+        EXPECT_TRUE(result.lnkFileInfo->targetIsOnNetwork());
+        EXPECT_EQ(*result.lnkFileInfo, LnkFileInfo{result.filePath});
+    }
+}
+
+/**
+ * Test that LNK files with the same contents are only parsed once with a content cache, that only their paths differ, and that the batch classes use the cache.
+ */
+TEST(LnkFileInfoTest, ContentCache){
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "LnkFileContentCacheTest";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    const std::string fileNames[] = {"DirectoryLnkFile.lnk", "EmojiLnkFile.lnk", "😊NetworkDriveLnkFile.lnk"};
+    std::vector<std::string> filePaths;
+    for(int copy = 0; copy < 3; copy++){
+        for(const std::string &fileName: fileNames){
+            const std::filesystem::path path = root / std::filesystem::u8path(std::to_string(copy) + fileName);
+            std::filesystem::copy_file(std::filesystem::u8path(TEST_LNK_FILES_DIR "/" + fileName), path);
+            filePaths.push_back(path.u8string());
+        }
+    }
+
+    for(const LnkFileInfo::ParseOptions options: {LnkFileInfo::ParseOptions(LnkFileInfo::NoOptions), LnkFileInfo::LazyStrings | LnkFileInfo::IdList | LnkFileInfo::ExtraData, LnkFileInfo::MemoryMapped | LnkFileInfo::TargetOnly}){
+        LnkFileInfo::ContentCache cache;
+        for(const std::string &filePath: filePaths){
+            LnkFileInfo::ErrorCode error = LnkFileInfo::InvalidHeader;
+            const std::optional<LnkFileInfo> cached = cache.tryOpen(filePath, error, options);
+            ASSERT_TRUE(cached.has_value());
+            EXPECT_EQ(error, LnkFileInfo::Success);
+            const LnkFileInfo expected(filePath, options);
+            EXPECT_EQ(*cached, expected);
+            EXPECT_EQ(cached->filePath(), filePath);
+            EXPECT_EQ(cached->absoluteFilePath(), expected.absoluteFilePath());
+            EXPECT_EQ(cached->absoluteTargetPath(), expected.absoluteTargetPath());
+            EXPECT_EQ(cached->targetVolumeName(), expected.targetVolumeName());
+            EXPECT_EQ(cached->description(), expected.description());
+            EXPECT_EQ(cached->relativeTargetPath(), expected.relativeTargetPath());
+            EXPECT_EQ(cached->workingDirectory(), expected.workingDirectory());
+            EXPECT_EQ(cached->iconPath(), expected.iconPath());
+            EXPECT_EQ(cached->idList(), expected.idList());
+            EXPECT_EQ(cached->trackerMachineId(), expected.trackerMachineId());
+            EXPECT_EQ(cached->targetWriteTime(), expected.targetWriteTime());
+        }
+        EXPECT_EQ(cache.size(), 3);
+        EXPECT_EQ(cache.hits(), 6);
+    }
+
+    //Different parse options that change what is decoded and different contents don't use the same information
+    std::vector<uint8_t> bytes = readTestFile("DirectoryLnkFile.lnk");
+    LnkFileInfo::ContentCache cache;
+    LnkFileInfo::ErrorCode error;
+    EXPECT_EQ(cache.tryParse(bytes.data(), bytes.size(), error, "First.lnk")->filePath(), "First.lnk");
+    EXPECT_TRUE(cache.tryParse(bytes.data(), bytes.size(), error, "", LnkFileInfo::LazyStrings).has_value());
+    EXPECT_TRUE(cache.tryParse(bytes.data(), bytes.size(), error, "", LnkFileInfo::TargetOnly)->description().empty());
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_EQ(cache.hits(), 1);
+    const std::vector<uint8_t> other = makeLnkFile(u"Other description");
+    EXPECT_EQ(cache.tryParse(other.data(), other.size(), error)->description(), "Other description");
+    EXPECT_FALSE(cache.tryParse(bytes.data(), 77, error).has_value());
+    EXPECT_EQ(error, LnkFileInfo::IndexOutOfRange);
+    EXPECT_EQ(cache.size(), 3);
+
+    //The cached information stays valid after the cache is destroyed
+    std::optional<LnkFileInfo> copy;
+    {
+        LnkFileInfo::ContentCache temporaryCache;
+        temporaryCache.tryParse(bytes.data(), bytes.size(), error);
+        copy = temporaryCache.tryParse(bytes.data(), bytes.size(), error, "Copy.lnk");
+    }
+    EXPECT_EQ(copy->absoluteTargetPath(), "C:\\Users\\glind\\Target");
+    EXPECT_EQ(copy->iconPath(), "C:\\WINDOWS\\system32\\imageres.dll");
+
+    //The batch classes use the cache
+    LnkFileScanner::Options scannerOptions;
+    scannerOptions.threads = 3;
+    scannerOptions.contentCache = std::make_shared<LnkFileInfo::ContentCache>();
+    scannerOptions.stringPool = std::make_shared<LnkFileInfo::StringPool>();
+    for(const LnkFileScanner::Result &result: LnkFileScanner::scanDirectory(root.u8string(), scannerOptions)){
+        ASSERT_TRUE(result.lnkFileInfo.has_value());
+        EXPECT_EQ(result.lnkFileInfo->filePath(), result.filePath);
+        EXPECT_EQ(result.lnkFileInfo->workingDirectory(), LnkFileInfo(result.filePath).workingDirectory());
+        EXPECT_EQ(&result.lnkFileInfo->workingDirectory(), &scannerOptions.stringPool->intern(result.lnkFileInfo->workingDirectory()));
+    }
+    //Several threads can parse the same contents at the same time before it's in the cache, so the number of hits depends on the timing
+    EXPECT_EQ(scannerOptions.contentCache->size(), 3);
+    EXPECT_LE(scannerOptions.contentCache->hits(), 6u);
+
+    const uint64_t hitsBefore = scannerOptions.contentCache->hits();
+    LnkFileAsyncReader::Options asyncOptions;
+    asyncOptions.contentCache = scannerOptions.contentCache;
+    for(const LnkFileAsyncReader::Result &result: LnkFileAsyncReader::readFiles(filePaths, asyncOptions)){
+        ASSERT_TRUE(result.lnkFileInfo.has_value());
+        EXPECT_EQ(result.lnkFileInfo->filePath(), result.filePath);
+        EXPECT_EQ(result.lnkFileInfo->description(), LnkFileInfo(result.filePath).description());
+    }
+    EXPECT_EQ(scannerOptions.contentCache->hits(), hitsBefore + filePaths.size());
+    std::filesystem::remove_all(root);
+}
+
+/**
+ * Test checking whether files are LNK files without parsing them.
+ */
+TEST(LnkFileInfoTest, Probe){
+    for(const auto& entry: std::filesystem::directory_iterator(TEST_LNK_FILES_DIR)){
+        EXPECT_TRUE(LnkFileInfo::probe(entry.path().u8string())) << entry.path();
+    }
+    EXPECT_FALSE(LnkFileInfo::probe(TEST_LNK_FILES_DIR "/nonexistent.lnk"));
+    EXPECT_FALSE(LnkFileInfo::probe(TEST_LNK_FILES_DIR "/../unittest.cpp"));
+
+    const std::vector<uint8_t> bytes = makeLnkFile(u"Description");
+    EXPECT_TRUE(LnkFileInfo::probe(bytes.data(), bytes.size()));
+    EXPECT_TRUE(LnkFileInfo::probe(bytes.data(), 76));
+    EXPECT_FALSE(LnkFileInfo::probe(bytes.data(), 75));
+    std::vector<uint8_t> wrongClsid = bytes;
+    wrongClsid[19] = 0x47;
+    EXPECT_FALSE(LnkFileInfo::probe(wrongClsid.data(), wrongClsid.size()));
+}
+
+/**
+ * Test only parsing the target information.
+ */
+TEST(LnkFileInfoTest, TargetOnly){
+    for(const std::string fileName: {"DirectoryLnkFile.lnk", "EmojiLnkFile.lnk", "EmojiNetworkDriveLnkFile.lnk"}){
+        const LnkFileInfo full{TEST_LNK_FILES_DIR "/" + fileName};
+        const LnkFileInfo targetOnly{TEST_LNK_FILES_DIR "/" + fileName, LnkFileInfo::TargetOnly};
+        EXPECT_EQ(targetOnly.absoluteTargetPath(), full.absoluteTargetPath());
+        EXPECT_EQ(targetOnly.targetIsOnNetwork(), full.targetIsOnNetwork());
+        EXPECT_EQ(targetOnly.targetSize(), full.targetSize());
+        EXPECT_EQ(targetOnly.targetVolumeName(), full.targetVolumeName());
+        EXPECT_EQ(targetOnly.targetVolumeSerial(), full.targetVolumeSerial());
+        EXPECT_EQ(targetOnly.targetVolumeType(), full.targetVolumeType());
+        EXPECT_EQ(targetOnly.description(), "");
+        EXPECT_EQ(targetOnly.relativeTargetPath(), "");
+        EXPECT_EQ(targetOnly.workingDirectory(), "");
+        EXPECT_EQ(targetOnly.hasCustomIcon(), false);
+        EXPECT_EQ(targetOnly.iconIndex(), 0);
+    }
+
+    //The StringData section isn't read at all, so truncating it doesn't matter
+    const std::vector<uint8_t> bytes = makeLnkFile(u"A description that will be truncated");
+    EXPECT_THROW((LnkFileInfo{bytes.data(), bytes.size() - 20}), LnkFileInfo::InvalidLnkFile);
+    EXPECT_EQ((LnkFileInfo{bytes.data(), bytes.size() - 20, "", LnkFileInfo::TargetOnly}.absoluteTargetPath()), "C:\\Target.txt");
+}
+
+/**
+ * Test the header fields, and that the ID list and the extra data blocks are only decoded with the corresponding options.
+ */
+TEST(LnkFileInfoTest, HeaderIdListAndExtraData){
+    const LnkFileInfo basic(TEST_LNK_FILES_DIR "/BasicLnkFile.lnk");
+    EXPECT_EQ(basic.targetCreationTime(), 134043271258300000u);
+    EXPECT_EQ(basic.targetAccessTime(), 134043281814177749u);
+    EXPECT_EQ(basic.targetWriteTime(), 134043277980000000u);
+    EXPECT_EQ(basic.showCommand(), LnkFileInfo::ShowNormal);
+    EXPECT_EQ(basic.hotkeyKey(), 0);
+    EXPECT_EQ(basic.hotkeyModifiers(), 0);
+    EXPECT_TRUE(basic.idList().empty());
+    EXPECT_EQ(basic.trackerMachineId(), "");
+    EXPECT_TRUE(basic.trackerVolumeId().isNull());
+    EXPECT_TRUE(basic.knownFolderId().isNull());
+
+    const LnkFileInfo full(TEST_LNK_FILES_DIR "/BasicLnkFile.lnk", LnkFileInfo::IdList | LnkFileInfo::ExtraData);
+    EXPECT_EQ(full.absoluteTargetPath(), basic.absoluteTargetPath());
+    EXPECT_EQ(full.targetWriteTime(), basic.targetWriteTime());
+    ASSERT_EQ(full.idList().size(), 2);
+    EXPECT_EQ(full.idList()[0].size(), 18);
+    EXPECT_EQ(full.idList()[1].size(), 138);
+    EXPECT_EQ(full.trackerMachineId(), "laptop-ouebfcql");
+    EXPECT_EQ(full.trackerVolumeId().toString(), "{32BE0EC8-D859-4339-B462-EC707CADA013}");
+    EXPECT_EQ(full.trackerObjectId().toString(), "{673213AF-A39A-11F0-AF8B-749779EC4248}");
+    EXPECT_EQ(full.trackerBirthVolumeId(), full.trackerVolumeId());
+    EXPECT_EQ(full.trackerBirthObjectId(), full.trackerObjectId());
+    EXPECT_EQ(full.knownFolderId().toString(), "{F3CE0F7C-4901-4ACC-8648-D5D44B04EF8F}");
+    EXPECT_EQ(full.environmentTargetPath(), "");
+    EXPECT_EQ(LnkFileInfo(TEST_LNK_FILES_DIR "/NetworkDriveLnkFile.lnk", LnkFileInfo::ExtraData).trackerMachineId(), "");
+
+    //The fields are reset when an LnkParser parses a file that doesn't have them
+    LnkParser parser(LnkFileInfo::IdList | LnkFileInfo::ExtraData | LnkFileInfo::LazyStrings);
+    EXPECT_EQ(parser.open(TEST_LNK_FILES_DIR "/😊LnkFile.lnk").idList().size(), 8);
+    EXPECT_EQ(parser.open(TEST_LNK_FILES_DIR "/😊LnkFile.lnk").knownFolderId().toString(), "{5E6C858F-0E22-4760-9AFE-EA3317B67173}");
+    EXPECT_EQ(parser.open(TEST_LNK_FILES_DIR "/NetworkDriveLnkFile.lnk").idList().size(), 3);
+    EXPECT_TRUE(parser.open(TEST_LNK_FILES_DIR "/NetworkDriveLnkFile.lnk").knownFolderId().isNull());
+
+    //Show command, hotkey and an EnvironmentVariableDataBlock before the terminal block
+    std::vector<uint8_t> bytes = makeLnkFile(u"Description");
+    bytes[60] = LnkFileInfo::ShowMaximized;
+    bytes[64] = 0x41;
+    bytes[65] = LnkFileInfo::HotkeyControl | LnkFileInfo::HotkeyAlt;
+    bytes.resize(bytes.size() - 4);
+    std::vector<uint8_t> environmentBlock(0x314 + 4, 0);
+    environmentBlock[0] = 0x14;
+    environmentBlock[1] = 0x03;
+    environmentBlock[4] = 0x01;
+    environmentBlock[7] = 0xA0;
+    const std::string environmentPath = "%windir%\\notepad.exe";
+    for(size_t i = 0; i < environmentPath.size(); i++){
+        environmentBlock[8 + i] = environmentPath[i];
+        environmentBlock[268 + i * 2] = environmentPath[i];
+    }
+    bytes.insert(bytes.end(), environmentBlock.begin(), environmentBlock.end());
+    const LnkFileInfo synthetic(bytes, "", LnkFileInfo::ExtraData);
+    EXPECT_EQ(synthetic.showCommand(), LnkFileInfo::ShowMaximized);
+    EXPECT_EQ(synthetic.hotkeyKey(), 0x41);
+    EXPECT_EQ(synthetic.hotkeyModifiers(), LnkFileInfo::HotkeyControl | LnkFileInfo::HotkeyAlt);
+    EXPECT_EQ(synthetic.description(), "Description");
+    EXPECT_EQ(synthetic.environmentTargetPath(), environmentPath);
+
+    //Like on Windows, only the first block with each signature is used, so the paths of duplicate blocks aren't joined
+    std::vector<uint8_t> duplicated = bytes;
+    std::vector<uint8_t> secondEnvironmentBlock(environmentBlock.begin(), environmentBlock.end() - 4);
+    secondEnvironmentBlock[8] = secondEnvironmentBlock[268] = 'X';
+    duplicated.insert(duplicated.end() - 4, secondEnvironmentBlock.begin(), secondEnvironmentBlock.end());
+    EXPECT_EQ(LnkFileInfo(duplicated, "", LnkFileInfo::ExtraData).environmentTargetPath(), environmentPath);
+
+    //Unknown show commands are treated as ShowNormal
+    bytes[60] = 5;
+    EXPECT_EQ(LnkFileInfo(bytes).showCommand(), LnkFileInfo::ShowNormal);
+
+    //Without the terminal block, the blocks are still decoded, and a block that extends past the end of the file ends the extra data, so the same files are accepted with and without the option
+    bytes.resize(bytes.size() - 4);
+    EXPECT_EQ(LnkFileInfo(bytes, "", LnkFileInfo::ExtraData).environmentTargetPath(), environmentPath);
+    bytes.resize(bytes.size() - 1);
+    LnkFileInfo::ErrorCode error;
+    std::optional<LnkFileInfo> truncated = LnkFileInfo::tryParse(bytes.data(), bytes.size(), error, "", LnkFileInfo::ExtraData);
+    ASSERT_TRUE(truncated.has_value());
+    EXPECT_EQ(truncated->description(), "Description");
+    EXPECT_EQ(truncated->environmentTargetPath(), "");
+    EXPECT_TRUE(LnkFileInfo::tryParse(bytes.data(), bytes.size(), error).has_value());
+
+    //Same for a block that is too small to have a signature
+    bytes.resize(bytes.size() - environmentBlock.size() + 5);
+    bytes.insert(bytes.end(), {0x10, 0x00, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04});
+    truncated = LnkFileInfo::tryParse(bytes.data(), bytes.size(), error, "", LnkFileInfo::ExtraData);
+    ASSERT_TRUE(truncated.has_value());
+    EXPECT_EQ(truncated->description(), "Description");
+
+    //Same for an ID list item that extends past the end of the ID list, where the items before it are kept
+    bytes = readTestFile("BasicLnkFile.lnk");
+    bytes[78] = 0xFF;
+    const std::optional<LnkFileInfo> badIdList = LnkFileInfo::tryParse(bytes.data(), bytes.size(), error, "", LnkFileInfo::IdList);
+    ASSERT_TRUE(badIdList.has_value());
+    EXPECT_TRUE(badIdList->idList().empty());
+    EXPECT_EQ(badIdList->absoluteTargetPath(), basic.absoluteTargetPath());
+    EXPECT_TRUE(LnkFileInfo::tryParse(bytes.data(), bytes.size(), error).has_value());
+}
+
 /**
  * Test equality operators, copy constructors and move constructors.
  */
+/**
+ * Test that refreshIfChanged() only re-reads the LNK file when its last write time or size has changed, and only updates the information when its contents have changed.
+ */
+TEST(LnkFileInfoTest, RefreshIfChanged){
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "LnkFileInfoRefreshIfChangedTest";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const std::filesystem::path filePath = directory / "Shortcut.lnk";
+    for(const LnkFileInfo::ParseOptions options: {LnkFileInfo::NoOptions, LnkFileInfo::MemoryMapped, LnkFileInfo::LazyStrings}){
+        std::filesystem::copy_file(TEST_LNK_FILES_DIR "/BasicLnkFile.lnk", filePath, std::filesystem::copy_options::overwrite_existing);
+        LnkFileInfo lnk(filePath.string(), options);
+        EXPECT_FALSE(lnk.refreshIfChanged());
+        EXPECT_EQ(lnk.absoluteTargetPath(), "C:\\Users\\glind\\Target.txt");
+
+        //Different contents with a different size
+        std::filesystem::copy_file(TEST_LNK_FILES_DIR "/EmojiLnkFile.lnk", filePath, std::filesystem::copy_options::overwrite_existing);
+        EXPECT_TRUE(lnk.refreshIfChanged());
+        const LnkFileInfo expected{TEST_LNK_FILES_DIR "/EmojiLnkFile.lnk"};
+        EXPECT_EQ(lnk.absoluteTargetPath(), expected.absoluteTargetPath());
+        EXPECT_FALSE(lnk.refreshIfChanged());
+
+        //A new last write time with the same contents
+        std::filesystem::last_write_time(filePath, std::filesystem::last_write_time(filePath) + std::chrono::hours(1));
+        EXPECT_FALSE(lnk.refreshIfChanged());
+        EXPECT_EQ(lnk.absoluteTargetPath(), expected.absoluteTargetPath());
+        EXPECT_EQ(lnk.description(), expected.description());
+        EXPECT_EQ(lnk.workingDirectory(), expected.workingDirectory());
+
+        //Different contents with the same size, where only the order of 64-byte blocks has changed
+        std::filesystem::copy_file(TEST_LNK_FILES_DIR "/BasicLnkFile.lnk", filePath, std::filesystem::copy_options::overwrite_existing);
+        EXPECT_TRUE(lnk.refreshIfChanged());
+        std::vector<uint8_t> swapped = readTestFile("BasicLnkFile.lnk");
+        ASSERT_GE(swapped.size(), 6u * 64);
+        std::swap_ranges(swapped.begin() + 2 * 64, swapped.begin() + 3 * 64, swapped.begin() + 5 * 64);
+        std::ofstream(filePath, std::ios::binary).write(reinterpret_cast<const char*>(swapped.data()), static_cast<std::streamsize>(swapped.size()));
+        std::filesystem::last_write_time(filePath, std::filesystem::last_write_time(filePath) + std::chrono::hours(1));
+        EXPECT_TRUE(lnk.refreshIfChanged());
+        const LnkFileInfo expectedSwapped(filePath.string());
+        EXPECT_EQ(lnk.relativeTargetPath(), expectedSwapped.relativeTargetPath());
+        EXPECT_EQ(lnk.workingDirectory(), expectedSwapped.workingDirectory());
+        EXPECT_EQ(lnk, expectedSwapped);
+
+        //Refreshing a file that has been deleted fails, and refreshing it when it's back always reads it
+        std::filesystem::remove(filePath);
+        bool changed = true;
+        EXPECT_EQ(lnk.tryRefreshIfChanged(changed), LnkFileInfo::OpenFailed);
+        EXPECT_FALSE(changed);
+        EXPECT_THROW(lnk.refreshIfChanged(), LnkFileInfo::IoError);
+        std::filesystem::copy_file(TEST_LNK_FILES_DIR "/BasicLnkFile.lnk", filePath);
+        EXPECT_TRUE(lnk.refreshIfChanged());
+        EXPECT_EQ(lnk.absoluteTargetPath(), "C:\\Users\\glind\\Target.txt");
+    }
+
+    //LNK files parsed from memory are always read
+    const std::vector<uint8_t> bytes = readTestFile("EmojiLnkFile.lnk");
+    LnkFileInfo lnk(bytes, filePath.string());
+    EXPECT_TRUE(lnk.refreshIfChanged());
+    EXPECT_EQ(lnk.absoluteTargetPath(), "C:\\Users\\glind\\Target.txt");
+    EXPECT_FALSE(lnk.refreshIfChanged());
+    std::filesystem::remove_all(directory);
+}
+
+/**
+ * Test that a parser reused for several files gives the same information as parsing each file separately, including after a failure.
+ */
+TEST(LnkFileInfoTest, LnkParser){
+    const std::string fileNames[] = {"😊NetworkDriveLnkFile.lnk", "BasicLnkFile.lnk", "ÅÄÖLnkFile.lnk", "NetworkDriveLnkFile.lnk", "😊LnkFile.lnk"};
+    for(const LnkFileInfo::ParseOptions options: {LnkFileInfo::NoOptions, LnkFileInfo::MemoryMapped, LnkFileInfo::LazyStrings}){
+        LnkParser parser(options);
+        //Parse each file twice so that files with shorter strings are parsed after files with longer strings
+        for(int i = 0; i < 2; i++){
+            for(const std::string &fileName: fileNames){
+                const LnkFileInfo expected{TEST_LNK_FILES_DIR "/" + fileName};
+                const LnkFileInfo &actual = parser.open(TEST_LNK_FILES_DIR "/" + fileName);
+                EXPECT_EQ(actual, expected);
+                EXPECT_EQ(actual.filePath(), expected.filePath());
+                EXPECT_EQ(actual.absoluteTargetPath(), expected.absoluteTargetPath());
+                EXPECT_EQ(actual.targetVolumeName(), expected.targetVolumeName());
+                EXPECT_EQ(actual.description(), expected.description());
+                EXPECT_EQ(actual.relativeTargetPath(), expected.relativeTargetPath());
+                EXPECT_EQ(actual.workingDirectory(), expected.workingDirectory());
+                EXPECT_EQ(actual.commandLineArgs(), expected.commandLineArgs());
+                EXPECT_EQ(actual.iconPath(), expected.iconPath());
+                EXPECT_EQ(actual.iconIndex(), expected.iconIndex());
+            }
+        }
+
+        LnkFileInfo::ErrorCode error;
+        EXPECT_EQ(parser.tryOpen(TEST_LNK_FILES_DIR "/nonexistent.lnk", error), nullptr);
+        EXPECT_EQ(error, LnkFileInfo::OpenFailed);
+        EXPECT_THROW(parser.open(TEST_LNK_FILES_DIR "/../unittest.cpp"), LnkFileInfo::InvalidLnkFile);
+
+        const std::vector<uint8_t> bytes = makeLnkFile(u"Description");
+        const LnkFileInfo* lnk = parser.tryParse(bytes.data(), bytes.size(), error, "Path.lnk");
+        ASSERT_NE(lnk, nullptr);
+        EXPECT_EQ(error, LnkFileInfo::Success);
+        EXPECT_EQ(lnk->filePath(), "Path.lnk");
+        EXPECT_EQ(lnk->description(), "Description");
+        EXPECT_EQ(parser.tryParse(bytes.data(), 78, error), nullptr);
+        EXPECT_EQ(error, LnkFileInfo::IndexOutOfRange);
+        EXPECT_EQ(parser.parse(bytes.data(), bytes.size()).absoluteTargetPath(), "C:\\Target.txt");
+    }
+}
+
 TEST(LnkFileInfoTest, EqualityCopyMove){
     LnkFileInfo lnk1{TEST_LNK_FILES_DIR "/BasicLnkFile.lnk"};
     LnkFileInfo lnk2 = lnk1;
@@ -41,6 +873,106 @@ TEST(LnkFileInfoTest, EqualityCopyMove){
     EXPECT_NE(lnk5, lnk4);
 }
 
+TEST(LnkFileInfoTest, InternStrings){
+    const std::vector<uint8_t> shell32 = makeLnkFile(u"First", "C:\\Windows\\System32\\shell32.dll");
+    LnkFileInfo first(shell32);
+    LnkFileInfo second(makeLnkFile(u"Second", "C:\\Windows\\System32\\shell32.dll"));
+    LnkFileInfo other(makeLnkFile(u"Other", "C:\\Program Files\\Other.exe"), "", LnkFileInfo::LazyStrings);
+    std::shared_ptr<LnkFileInfo::StringPool> pool = std::make_shared<LnkFileInfo::StringPool>();
+    for(LnkFileInfo* lnk: {&first, &second, &other}){
+        lnk->internStrings(pool);
+    }
+    EXPECT_EQ(pool->size(), 4);    //Two targets, the volume name and the empty string
+    EXPECT_EQ(first.absoluteTargetPath(), "C:\\Windows\\System32\\shell32.dll");
+    EXPECT_EQ(other.absoluteTargetPath(), "C:\\Program Files\\Other.exe");
+    EXPECT_EQ(&first.absoluteTargetPath(), &second.absoluteTargetPath());
+    EXPECT_NE(&first.absoluteTargetPath(), &other.absoluteTargetPath());
+    EXPECT_EQ(&first.targetVolumeName(), &other.targetVolumeName());
+    EXPECT_EQ(&first.workingDirectory(), &other.iconPath());
+    EXPECT_EQ(first.targetVolumeName(), "Volume");
+    EXPECT_EQ(second.description(), "Second");
+    EXPECT_EQ(other.description(), "Other");
+
+    //Copies share the pool, which stays alive as long as they do
+    pool.reset();
+    const LnkFileInfo copy = first;
+    EXPECT_EQ(&copy.absoluteTargetPath(), &second.absoluteTargetPath());
+
+    //Refreshing interns the new strings in the same pool
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "LnkFileInfoInternStringsTest";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const auto writeFile = [](const std::filesystem::path& filePath, const std::vector<uint8_t>& bytes){
+        std::ofstream file(filePath, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    };
+    writeFile(directory / "First.lnk", shell32);
+    writeFile(directory / "Second.lnk", shell32);
+    first = LnkFileInfo((directory / "First.lnk").string());
+    first.internStrings(std::make_shared<LnkFileInfo::StringPool>());
+    writeFile(directory / "First.lnk", makeLnkFile(u"Changed", "C:\\Changed.exe"));
+    EXPECT_TRUE(first.refreshIfChanged());
+    EXPECT_EQ(first.absoluteTargetPath(), "C:\\Changed.exe");
+    EXPECT_EQ(first.description(), "Changed");
+    const LnkFileInfo changed = first;
+    first.refresh();
+    EXPECT_EQ(&first.absoluteTargetPath(), &changed.absoluteTargetPath());
+
+    //Batches and scanners can share a pool
+    std::shared_ptr<LnkFileInfo::StringPool> sharedPool = std::make_shared<LnkFileInfo::StringPool>();
+    LnkFileInfoBatch batch;
+    batch.add(second);
+    const LnkFileInfo fromBatch = batch.at(0, sharedPool);
+    EXPECT_EQ(fromBatch.absoluteTargetPath(), second.absoluteTargetPath());
+    EXPECT_EQ(fromBatch.description(), "Second");
+    LnkFileScanner::Options options;
+    options.stringPool = sharedPool;
+    const std::vector<LnkFileScanner::Result> results = LnkFileScanner::scanDirectory(directory.string(), options);
+    ASSERT_EQ(results.size(), 2);
+    for(const LnkFileScanner::Result& result: results){
+        EXPECT_EQ(&result.lnkFileInfo->targetVolumeName(), &fromBatch.targetVolumeName());
+    }
+    EXPECT_EQ(sharedPool->size(), 4);    //shell32.dll, Changed.exe, the volume name and the empty string
+    std::filesystem::remove_all(directory);
+}
+
+TEST(LnkFileInfoTest, AbsolutePathAndHash){
+    const std::string relativePath = std::filesystem::relative(TEST_LNK_FILES_DIR "/BasicLnkFile.lnk").string();
+    const std::string absolutePath = std::filesystem::absolute(relativePath).string();
+    ASSERT_FALSE(std::filesystem::path(relativePath).is_absolute());
+
+    //Relative paths are made absolute unless AbsolutePath is given, in which case the path is trusted as is
+    const LnkFileInfo relative(relativePath);
+    const LnkFileInfo trusted(absolutePath, LnkFileInfo::AbsolutePath);
+    const LnkFileInfo untrusted(relativePath, LnkFileInfo::AbsolutePath);
+    EXPECT_EQ(relative.absoluteFilePath(), absolutePath);
+    EXPECT_EQ(trusted.absoluteFilePath(), absolutePath);
+    EXPECT_EQ(untrusted.absoluteFilePath(), relativePath);
+    EXPECT_EQ(relative, trusted);
+    EXPECT_NE(relative, untrusted);
+    EXPECT_EQ(relative.hash(), trusted.hash());
+    EXPECT_NE(relative.hash(), untrusted.hash());
+
+    LnkFileInfo::ErrorCode error;
+    EXPECT_EQ(LnkFileInfo::tryOpen(relativePath, error, LnkFileInfo::AbsolutePath)->absoluteFilePath(), relativePath);
+    LnkParser parser(LnkFileInfo::AbsolutePath);
+    EXPECT_EQ(parser.open(relativePath).absoluteFilePath(), relativePath);
+
+    //The hash is kept up to date by everything that sets the absolute path
+    const std::vector<uint8_t> bytes = readTestFile("BasicLnkFile.lnk");
+    const LnkFileInfo fromBytes(bytes, absolutePath);
+    EXPECT_EQ(fromBytes, relative);
+    EXPECT_EQ(fromBytes.hash(), relative.hash());
+    EXPECT_EQ(parser.parse(bytes.data(), bytes.size(), absolutePath).hash(), relative.hash());
+    EXPECT_EQ(LnkFileInfo(bytes), LnkFileInfo(bytes, ""));
+    EXPECT_EQ(LnkFileInfo(bytes).hash(), LnkFileInfo(bytes, "").hash());
+
+    std::unordered_set<LnkFileInfo> set{relative, trusted, untrusted, fromBytes, LnkFileInfo(TEST_LNK_FILES_DIR "/UsbLnkFile.lnk")};
+    EXPECT_EQ(set.size(), 3);
+    EXPECT_EQ(set.count(LnkFileInfo(absolutePath)), 1);
+    EXPECT_EQ(std::hash<LnkFileInfo>()(relative), relative.hash());
+}
+
 /**
  * Test LNK file pointing to a file.
  */
@@ -337,3 +1269,951 @@ TEST(LnkFileInfoTest, EmojiNetworkDriveLnkFile2){
     EXPECT_EQ(lnk.targetVolumeName(), "\\\\wsl$\\Ubuntu");
     EXPECT_EQ(lnk.workingDirectory(), "B:\\tmp");
 }
+
+/**
+ * Test scanning a directory for LNK files on several threads.
+ */
+TEST(LnkFileScannerTest, ScanDirectory){
+    const std::vector<LnkFileScanner::Result> testFiles = LnkFileScanner::scanDirectory(TEST_LNK_FILES_DIR);
+    EXPECT_EQ(testFiles.size(), 9);
+    for(const LnkFileScanner::Result& result: testFiles){
+        ASSERT_TRUE(result.lnkFileInfo.has_value()) << result.filePath;
+        EXPECT_EQ(result.error, LnkFileInfo::Success);
+        EXPECT_EQ(result.lnkFileInfo->absoluteTargetPath(), LnkFileInfo{result.filePath}.absoluteTargetPath());
+    }
+
+    //Create a directory tree with LNK files in subdirectories, an invalid LNK file and a file that isn't an LNK file
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "LnkFileScannerTest";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root / "Subdirectory");
+    std::filesystem::copy_file(TEST_LNK_FILES_DIR "/BasicLnkFile.lnk", root / "Basic.LNK");
+    std::filesystem::copy_file(TEST_LNK_FILES_DIR "/UsbLnkFile.lnk", root / "Subdirectory" / "Usb.lnk");
+    std::filesystem::copy_file(TEST_LNK_FILES_DIR "/../CMakeLists.txt", root / "Invalid.lnk");
+    std::filesystem::copy_file(TEST_LNK_FILES_DIR "/BasicLnkFile.lnk", root / "NotAnLnkFile.txt");
+
+    LnkFileScanner::Options options;
+    options.threads = 3;
+    std::vector<LnkFileScanner::Result> results = LnkFileScanner::scanDirectory(root.string(), options);
+    std::sort(results.begin(), results.end(), [](const LnkFileScanner::Result& a, const LnkFileScanner::Result& b){
+        return a.filePath < b.filePath;
+    });
+    ASSERT_EQ(results.size(), 3);
+    EXPECT_EQ(results[0].lnkFileInfo->absoluteTargetPath(), "C:\\Users\\glind\\Target.txt");
+    EXPECT_FALSE(results[1].lnkFileInfo.has_value());
+    EXPECT_EQ(results[1].error, LnkFileInfo::InvalidHeader);
+    EXPECT_EQ(results[2].lnkFileInfo->absoluteTargetPath(), "D:\\Target.txt");
+
+    options.recursive = false;
+    EXPECT_EQ(LnkFileScanner::scanDirectory(root.string(), options).size(), 2);
+
+    //Exceptions thrown by the callback stop the scan and are rethrown
+    EXPECT_THROW(LnkFileScanner::scanDirectory(root.string(), options, [](LnkFileScanner::Result&&){
+        throw std::runtime_error("Callback error");
+    }), std::runtime_error);
+
+    EXPECT_THROW(LnkFileScanner::scanDirectory((root / "Basic.LNK").string()), LnkFileInfo::IoError);
+    std::filesystem::remove_all(root);
+}
+
+/**
+ * Test that the cache gives the same information as parsing the LNK files, that the information is kept when the cache is saved and loaded again, and that cached entries are only used if the LNK file hasn't changed.
+ */
+TEST(LnkFileCacheTest, Cache){
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "LnkFileCacheTest";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const std::string cacheFilePath = (directory / "cache.bin").string();
+    const std::string fileNames[] = {"BasicLnkFile.lnk", "DirectoryLnkFile.lnk", "😊NetworkDriveLnkFile.lnk", "ÅÄÖLnkFile.lnk"};
+    for(int i = 0; i < 2; i++){
+        LnkFileCache cache(cacheFilePath);
+        EXPECT_EQ(cache.size(), i == 0 ? 0 : std::size(fileNames));
+        for(const std::string &fileName: fileNames){
+            const LnkFileInfo expected{TEST_LNK_FILES_DIR "/" + fileName};
+            const LnkFileInfo actual = cache.open(TEST_LNK_FILES_DIR "/" + fileName);
+            EXPECT_EQ(actual, expected);
+            EXPECT_EQ(actual.filePath(), expected.filePath());
+            EXPECT_EQ(actual.absoluteTargetPath(), expected.absoluteTargetPath());
+            EXPECT_EQ(actual.targetHasAttribute(LnkFileInfo::Directory), expected.targetHasAttribute(LnkFileInfo::Directory));
+            EXPECT_EQ(actual.targetIsOnNetwork(), expected.targetIsOnNetwork());
+            EXPECT_EQ(actual.targetSize(), expected.targetSize());
+            EXPECT_EQ(actual.targetVolumeName(), expected.targetVolumeName());
+            EXPECT_EQ(actual.targetVolumeSerial(), expected.targetVolumeSerial());
+            EXPECT_EQ(actual.targetVolumeType(), expected.targetVolumeType());
+            EXPECT_EQ(actual.description(), expected.description());
+            EXPECT_EQ(actual.relativeTargetPath(), expected.relativeTargetPath());
+            EXPECT_EQ(actual.workingDirectory(), expected.workingDirectory());
+            EXPECT_EQ(actual.commandLineArgs(), expected.commandLineArgs());
+            EXPECT_EQ(actual.iconPath(), expected.iconPath());
+            EXPECT_EQ(actual.hasCustomIcon(), expected.hasCustomIcon());
+            EXPECT_EQ(actual.iconIndex(), expected.iconIndex());
+            EXPECT_EQ(actual.targetCreationTime(), expected.targetCreationTime());
+            EXPECT_EQ(actual.targetAccessTime(), expected.targetAccessTime());
+            EXPECT_EQ(actual.targetWriteTime(), expected.targetWriteTime());
+            EXPECT_EQ(actual.showCommand(), expected.showCommand());
+        }
+        EXPECT_EQ(cache.size(), std::size(fileNames));
+        cache.save();
+    }
+
+    //Overwrite the LNK file with different contents of the same size and restore the last write time, so that the cached information is used even though it's out of date
+    const std::string filePath = (directory / "Shortcut.lnk").string();
+    const auto writeFile = [&filePath](const std::vector<uint8_t> &bytes){
+        std::ofstream(filePath, std::ios::binary).write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    };
+    writeFile(makeLnkFile(u"Cached"));
+    {
+        LnkFileCache cache(cacheFilePath);
+        EXPECT_EQ(cache.open(filePath).description(), "Cached");
+        cache.save();
+    }
+    const std::filesystem::file_time_type lastWriteTime = std::filesystem::last_write_time(filePath);
+    writeFile(makeLnkFile(u"Parsed"));
+    std::filesystem::last_write_time(filePath, lastWriteTime);
+    {
+        LnkFileCache cache(cacheFilePath);
+        EXPECT_EQ(cache.size(), std::size(fileNames) + 1);
+        EXPECT_EQ(cache.open(filePath).description(), "Cached");
+        std::filesystem::last_write_time(filePath, lastWriteTime + std::chrono::hours(1));
+        EXPECT_EQ(cache.open(filePath).description(), "Parsed");
+        EXPECT_EQ(cache.size(), std::size(fileNames) + 1);
+
+        LnkFileInfo::ErrorCode error;
+        EXPECT_FALSE(cache.tryOpen(TEST_LNK_FILES_DIR "/nonexistent.lnk", error).has_value());
+        EXPECT_EQ(error, LnkFileInfo::OpenFailed);
+        EXPECT_THROW(cache.open(TEST_LNK_FILES_DIR "/../unittest.cpp"), LnkFileInfo::InvalidLnkFile);
+    }
+
+    //An invalid cache file gives an empty cache
+    std::ofstream(cacheFilePath, std::ios::binary) << "LNKCACHE but not really";
+    EXPECT_EQ(LnkFileCache(cacheFilePath).size(), 0);
+    std::filesystem::remove_all(directory);
+}
+
+/**
+ * Test that records encoded with LnkFileEncoder are decoded to the same information with and without string interning, and that invalid or truncated bytes are detected.
+ */
+TEST(LnkFileSerializerTest, EncodeDecode){
+    LnkFileScanner::Options scannerOptions;
+    scannerOptions.parseOptions = LnkFileInfo::IdList | LnkFileInfo::ExtraData;
+    std::vector<LnkFileInfo> testFiles;
+    for(LnkFileScanner::Result &result: LnkFileScanner::scanDirectory(TEST_LNK_FILES_DIR, scannerOptions)){
+        testFiles.push_back(std::move(*result.lnkFileInfo));
+    }
+    //None of the test files has a hotkey or a show command other than ShowNormal
+    std::vector<uint8_t> hotkeyFile = readTestFile("BasicLnkFile.lnk");
+    hotkeyFile[60] = LnkFileInfo::ShowMaximized;
+    hotkeyFile[64] = 0x41;
+    hotkeyFile[65] = LnkFileInfo::HotkeyControl;
+    testFiles.emplace_back(hotkeyFile, "Hotkey.lnk", scannerOptions.parseOptions);
+    //The drive type isn't validated when parsing, so it can be any value
+    std::vector<uint8_t> driveTypeFile = makeLnkFile(u"Unknown drive type");
+    driveTypeFile[110] = 0x1F;
+    testFiles.emplace_back(driveTypeFile, "DriveType.lnk", scannerOptions.parseOptions);
+    ASSERT_EQ(testFiles.back().targetVolumeType(), 0x1F);
+    ASSERT_FALSE(testFiles.back().targetIsOnNetwork());
+    ASSERT_FALSE(testFiles.back().hasCustomIcon());
+
+    size_t encodedSizes[2];
+    for(const bool internStrings: {false, true}){
+        LnkFileEncoder encoder(internStrings);
+        //Encode each file twice so that interned strings are used
+        for(int i = 0; i < 2; i++){
+            for(const LnkFileInfo &lnkFileInfo: testFiles){
+                encoder.add(lnkFileInfo);
+            }
+        }
+        EXPECT_EQ(encoder.recordCount(), testFiles.size() * 2);
+        const std::vector<uint8_t> bytes = encoder.bytes();
+        encodedSizes[internStrings] = bytes.size();
+
+        LnkFileDecoder decoder(bytes);
+        LnkFileDecoder::Record record;
+        for(int i = 0; i < 2; i++){
+            for(const LnkFileInfo &expected: testFiles){
+                ASSERT_TRUE(decoder.next(record));
+                EXPECT_EQ(record.filePath, expected.filePath());
+                EXPECT_EQ(record.absoluteFilePath, expected.absoluteFilePath());
+                EXPECT_EQ(record.absoluteTargetPath, expected.absoluteTargetPath());
+                EXPECT_EQ(record.targetVolumeName, expected.targetVolumeName());
+                EXPECT_EQ(record.description, expected.description());
+                EXPECT_EQ(record.relativeTargetPath, expected.relativeTargetPath());
+                EXPECT_EQ(record.workingDirectory, expected.workingDirectory());
+                EXPECT_EQ(record.commandLineArgs, expected.commandLineArgs());
+                EXPECT_EQ(record.iconPath, expected.iconPath());
+                EXPECT_EQ(record.targetSize, expected.targetSize());
+                EXPECT_EQ(record.iconIndex, expected.iconIndex());
+                EXPECT_EQ(record.targetVolumeSerial, expected.targetVolumeSerial());
+                EXPECT_EQ(record.targetVolumeType, expected.targetVolumeType());
+                EXPECT_EQ(record.targetIsOnNetwork, expected.targetIsOnNetwork());
+                EXPECT_EQ(record.hasCustomIcon, expected.hasCustomIcon());
+                EXPECT_EQ(record.targetHasAttribute(LnkFileInfo::Directory), expected.targetHasAttribute(LnkFileInfo::Directory));
+                EXPECT_EQ(record.targetCreationTime, expected.targetCreationTime());
+                EXPECT_EQ(record.targetAccessTime, expected.targetAccessTime());
+                EXPECT_EQ(record.targetWriteTime, expected.targetWriteTime());
+                EXPECT_EQ(record.showCommand, expected.showCommand());
+                EXPECT_EQ(record.hotkeyKey(), expected.hotkeyKey());
+                EXPECT_EQ(record.hotkeyModifiers(), expected.hotkeyModifiers());
+                EXPECT_EQ(record.environmentTargetPath, expected.environmentTargetPath());
+                EXPECT_EQ(record.trackerMachineId, expected.trackerMachineId());
+                EXPECT_EQ(record.trackerVolumeId, expected.trackerVolumeId());
+                EXPECT_EQ(record.trackerObjectId, expected.trackerObjectId());
+                EXPECT_EQ(record.trackerBirthVolumeId, expected.trackerBirthVolumeId());
+                EXPECT_EQ(record.trackerBirthObjectId, expected.trackerBirthObjectId());
+                EXPECT_EQ(record.knownFolderId, expected.knownFolderId());
+                ASSERT_EQ(record.idList.size(), expected.idList().size());
+                for(size_t item = 0; item < record.idList.size(); item++){
+                    EXPECT_EQ(record.idList[item], std::string_view(reinterpret_cast<const char*>(expected.idList()[item].data()), expected.idList()[item].size()));
+                }
+
+                //The strings refer to the encoded bytes
+                EXPECT_TRUE(record.absoluteTargetPath.data() >= reinterpret_cast<const char*>(bytes.data()) && record.absoluteTargetPath.data() < reinterpret_cast<const char*>(bytes.data() + bytes.size()));
+
+                const LnkFileInfo lnkFileInfo = record.toLnkFileInfo();
+                EXPECT_EQ(lnkFileInfo, expected);
+                EXPECT_EQ(lnkFileInfo.absoluteTargetPath(), expected.absoluteTargetPath());
+                EXPECT_EQ(lnkFileInfo.description(), expected.description());
+                EXPECT_EQ(lnkFileInfo.targetWriteTime(), expected.targetWriteTime());
+                EXPECT_EQ(lnkFileInfo.showCommand(), expected.showCommand());
+                EXPECT_EQ(lnkFileInfo.hotkeyKey(), expected.hotkeyKey());
+                EXPECT_EQ(lnkFileInfo.trackerMachineId(), expected.trackerMachineId());
+                EXPECT_EQ(lnkFileInfo.trackerObjectId(), expected.trackerObjectId());
+                EXPECT_EQ(lnkFileInfo.knownFolderId(), expected.knownFolderId());
+                EXPECT_EQ(lnkFileInfo.idList(), expected.idList());
+            }
+        }
+        EXPECT_FALSE(decoder.next(record));
+        EXPECT_EQ(decoder.error(), LnkFileInfo::Success);
+
+        //Truncated records
+        LnkFileDecoder truncatedDecoder(bytes.data(), bytes.size() - 1);
+        while(truncatedDecoder.next(record)){}
+        EXPECT_EQ(truncatedDecoder.error(), LnkFileInfo::IndexOutOfRange);
+    }
+    EXPECT_LT(encodedSizes[true], encodedSizes[false]);
+
+    //Invalid header
+    const std::vector<uint8_t> notEncoded = readTestFile("BasicLnkFile.lnk");
+    LnkFileDecoder invalidDecoder(notEncoded);
+    LnkFileDecoder::Record record;
+    EXPECT_FALSE(invalidDecoder.next(record));
+    EXPECT_EQ(invalidDecoder.error(), LnkFileInfo::InvalidHeader);
+    EXPECT_EQ(LnkFileDecoder(LnkFileEncoder().bytes()).next(record), false);
+}
+
+/**
+ * Test that a batch contains the same information as the LNK files that were added to it, and that exporting it to Arrow gives arrays with the same information.
+ */
+TEST(LnkFileInfoBatchTest, Batch){
+    LnkFileScanner::Options scannerOptions;
+    scannerOptions.parseOptions = LnkFileInfo::IdList | LnkFileInfo::ExtraData;
+    const std::vector<LnkFileScanner::Result> testFiles = LnkFileScanner::scanDirectory(TEST_LNK_FILES_DIR, scannerOptions);
+    LnkFileInfoBatch batch;
+    for(const LnkFileScanner::Result &result: testFiles){
+        batch.add(*result.lnkFileInfo);
+    }
+    ASSERT_EQ(batch.size(), testFiles.size());
+    size_t directories = 0;
+    for(size_t i = 0; i < batch.size(); i++){
+        const LnkFileInfo &expected = *testFiles[i].lnkFileInfo;
+        EXPECT_EQ(batch.absoluteTargetPaths()[i], expected.absoluteTargetPath());
+        EXPECT_EQ(batch.descriptions()[i], expected.description());
+        EXPECT_EQ(batch.iconPaths()[i], expected.iconPath());
+        EXPECT_EQ(batch.targetSizes()[i], expected.targetSize());
+        EXPECT_EQ(batch.targetVolumeSerials()[i], expected.targetVolumeSerial());
+        EXPECT_EQ(batch.targetVolumeTypes()[i], expected.targetVolumeType());
+        EXPECT_EQ(batch.targetIsOnNetwork()[i], expected.targetIsOnNetwork());
+        EXPECT_EQ(batch.targetHasAttribute(i, LnkFileInfo::Directory), expected.targetHasAttribute(LnkFileInfo::Directory));
+        directories += batch.targetHasAttribute(i, LnkFileInfo::Directory);
+
+        const LnkFileInfo lnkFileInfo = batch.at(i);
+        EXPECT_EQ(lnkFileInfo, expected);
+        EXPECT_EQ(lnkFileInfo.absoluteTargetPath(), expected.absoluteTargetPath());
+        EXPECT_EQ(lnkFileInfo.workingDirectory(), expected.workingDirectory());
+        EXPECT_EQ(lnkFileInfo.commandLineArgs(), expected.commandLineArgs());
+        EXPECT_EQ(lnkFileInfo.iconIndex(), expected.iconIndex());
+        EXPECT_EQ(lnkFileInfo.hasCustomIcon(), expected.hasCustomIcon());
+        EXPECT_EQ(lnkFileInfo.targetCreationTime(), expected.targetCreationTime());
+        EXPECT_EQ(lnkFileInfo.targetAccessTime(), expected.targetAccessTime());
+        EXPECT_EQ(lnkFileInfo.targetWriteTime(), expected.targetWriteTime());
+        EXPECT_EQ(lnkFileInfo.showCommand(), expected.showCommand());
+        EXPECT_EQ(lnkFileInfo.hotkeyKey(), expected.hotkeyKey());
+        EXPECT_EQ(lnkFileInfo.environmentTargetPath(), expected.environmentTargetPath());
+        EXPECT_EQ(lnkFileInfo.trackerMachineId(), expected.trackerMachineId());
+        EXPECT_EQ(lnkFileInfo.trackerVolumeId(), expected.trackerVolumeId());
+        EXPECT_EQ(lnkFileInfo.trackerBirthObjectId(), expected.trackerBirthObjectId());
+        EXPECT_EQ(lnkFileInfo.knownFolderId(), expected.knownFolderId());
+        EXPECT_EQ(lnkFileInfo.idList(), expected.idList());
+        EXPECT_EQ(static_cast<size_t>(batch.idListOffsets()[i + 1] - batch.idListOffsets()[i]), expected.idList().size());
+    }
+    EXPECT_EQ(static_cast<std::ptrdiff_t>(directories), std::count_if(testFiles.begin(), testFiles.end(), [](const LnkFileScanner::Result &result){
+        return result.lnkFileInfo->targetHasAttribute(LnkFileInfo::Directory);
+    }));
+
+    ArrowArray array;
+    ArrowSchema schema;
+    batch.exportToArrow(&array, &schema);
+    EXPECT_EQ(batch.size(), testFiles.size());
+    EXPECT_STREQ(schema.format, "+s");
+    ASSERT_EQ(schema.n_children, array.n_children);
+    ASSERT_EQ(array.length, static_cast<int64_t>(batch.size()));
+    for(int64_t column = 0; column < schema.n_children; column++){
+        const ArrowSchema &childSchema = *schema.children[column];
+        const ArrowArray &child = *array.children[column];
+        EXPECT_EQ(child.length, array.length);
+        EXPECT_EQ(child.null_count, 0);
+        for(int64_t i = 0; i < child.length; i++){
+            if(std::string(childSchema.name) == "absoluteTargetPath"){
+                EXPECT_STREQ(childSchema.format, "u");
+                const int32_t* offsets = static_cast<const int32_t*>(child.buffers[1]);
+                const std::string value(static_cast<const char*>(child.buffers[2]) + offsets[i], offsets[i + 1] - offsets[i]);
+                EXPECT_EQ(value, batch.absoluteTargetPaths()[i]);
+            }
+            else if(std::string(childSchema.name) == "targetVolumeSerial"){
+                EXPECT_STREQ(childSchema.format, "I");
+                EXPECT_EQ(static_cast<const uint32_t*>(child.buffers[1])[i], batch.targetVolumeSerials()[i]);
+            }
+            else if(std::string(childSchema.name) == "targetIsOnNetwork"){
+                EXPECT_STREQ(childSchema.format, "b");
+                EXPECT_EQ((static_cast<const uint8_t*>(child.buffers[1])[i / 8] >> (i % 8)) & 1, batch.targetIsOnNetwork()[i]);
+            }
+            else if(std::string(childSchema.name) == "targetWriteTime"){
+                EXPECT_STREQ(childSchema.format, "L");
+                EXPECT_EQ(static_cast<const uint64_t*>(child.buffers[1])[i], testFiles[i].lnkFileInfo->targetWriteTime());
+            }
+            else if(std::string(childSchema.name) == "knownFolderId"){
+                EXPECT_STREQ(childSchema.format, "w:16");
+                EXPECT_EQ(std::memcmp(static_cast<const uint8_t*>(child.buffers[1]) + i * 16, testFiles[i].lnkFileInfo->knownFolderId().bytes, 16), 0);
+            }
+            else if(std::string(childSchema.name) == "idList"){
+                EXPECT_STREQ(childSchema.format, "+l");
+                ASSERT_EQ(childSchema.n_children, 1);
+                EXPECT_STREQ(childSchema.children[0]->format, "z");
+                ASSERT_EQ(child.n_children, 1);
+                const ArrowArray &items = *child.children[0];
+                const int32_t* listOffsets = static_cast<const int32_t*>(child.buffers[1]);
+                const int32_t* itemOffsets = static_cast<const int32_t*>(items.buffers[1]);
+                const std::vector<std::vector<uint8_t>> &expected = testFiles[i].lnkFileInfo->idList();
+                ASSERT_EQ(static_cast<size_t>(listOffsets[i + 1] - listOffsets[i]), expected.size());
+                for(int32_t item = listOffsets[i]; item < listOffsets[i + 1]; item++){
+                    const uint8_t* const itemBytes = static_cast<const uint8_t*>(items.buffers[2]) + itemOffsets[item];
+                    EXPECT_EQ(std::vector<uint8_t>(itemBytes, itemBytes + (itemOffsets[item + 1] - itemOffsets[item])), expected[item - listOffsets[i]]);
+                }
+            }
+        }
+    }
+
+    //Moving a child out of the parent keeps it valid after the parent is released
+    ArrowArray movedChild = *array.children[2];
+    array.children[2]->release = nullptr;
+    array.release(&array);
+    EXPECT_EQ(array.release, nullptr);
+    EXPECT_EQ(std::string(static_cast<const char*>(movedChild.buffers[2]), static_cast<const int32_t*>(movedChild.buffers[1])[1]), batch.absoluteTargetPaths()[0]);
+    movedChild.release(&movedChild);
+
+    //The same goes for the schema, including the children of the moved child
+    ArrowSchema movedChildSchema = *schema.children[schema.n_children - 1];
+    schema.children[schema.n_children - 1]->release = nullptr;
+    schema.release(&schema);
+    EXPECT_EQ(schema.release, nullptr);
+    EXPECT_EQ(std::string(movedChildSchema.name), "idList");
+    ASSERT_EQ(movedChildSchema.n_children, 1);
+    EXPECT_EQ(std::string(movedChildSchema.children[0]->format), "z");
+    EXPECT_NE(movedChildSchema.children[0]->release, nullptr);
+    movedChildSchema.release(&movedChildSchema);
+    EXPECT_EQ(movedChildSchema.release, nullptr);
+
+    std::move(batch).exportToArrow(&array);
+    EXPECT_EQ(batch.size(), 0);
+    EXPECT_EQ(array.length, static_cast<int64_t>(testFiles.size()));
+    array.release(&array);
+}
+
+/**
+ * Test that reading files asynchronously gives the same information as reading them synchronously, and that errors are reported for each file.
+ */
+TEST(LnkFileAsyncReaderTest, ReadFiles){
+    std::vector<std::string> filePaths;
+    for(const std::filesystem::directory_entry &entry: std::filesystem::directory_iterator(TEST_LNK_FILES_DIR)){
+        filePaths.push_back(entry.path().string());
+    }
+    const size_t lnkFileCount = filePaths.size();
+    filePaths.push_back(TEST_LNK_FILES_DIR "/nonexistent.lnk");
+    filePaths.push_back(TEST_LNK_FILES_DIR "/../unittest.cpp");
+
+    for(const unsigned int maxInFlight: {1u, 3u, 64u, 100000u}){
+        for(const LnkFileInfo::ParseOptions options: {LnkFileInfo::NoOptions, LnkFileInfo::LazyStrings}){
+            LnkFileAsyncReader::Options readerOptions;
+            readerOptions.maxInFlight = maxInFlight;
+            readerOptions.parseOptions = options;
+            std::vector<LnkFileAsyncReader::Result> results = LnkFileAsyncReader::readFiles(filePaths, readerOptions);
+            ASSERT_EQ(results.size(), filePaths.size());
+            size_t succeeded = 0;
+            for(const LnkFileAsyncReader::Result &result: results){
+                if(result.filePath == filePaths[lnkFileCount]){
+                    EXPECT_EQ(result.error, LnkFileInfo::OpenFailed);
+                    EXPECT_FALSE(result.lnkFileInfo.has_value());
+                }
+                else if(result.filePath == filePaths[lnkFileCount + 1]){
+                    EXPECT_EQ(result.error, LnkFileInfo::InvalidHeader);
+                    EXPECT_FALSE(result.lnkFileInfo.has_value());
+                }
+                else{
+                    ASSERT_EQ(result.error, LnkFileInfo::Success);
+                    ASSERT_TRUE(result.lnkFileInfo.has_value());
+                    const LnkFileInfo expected(result.filePath);
+                    EXPECT_EQ(*result.lnkFileInfo, expected);
+                    EXPECT_EQ(result.lnkFileInfo->filePath(), expected.filePath());
+                    EXPECT_EQ(result.lnkFileInfo->absoluteFilePath(), expected.absoluteFilePath());
+                    EXPECT_EQ(result.lnkFileInfo->absoluteTargetPath(), expected.absoluteTargetPath());
+                    EXPECT_EQ(result.lnkFileInfo->description(), expected.description());
+                    EXPECT_EQ(result.lnkFileInfo->workingDirectory(), expected.workingDirectory());
+                    EXPECT_EQ(result.lnkFileInfo->iconPath(), expected.iconPath());
+                    succeeded++;
+                }
+            }
+            EXPECT_EQ(succeeded, lnkFileCount);
+        }
+    }
+
+    //An exception thrown by the callback stops the delivery of results and is rethrown
+    size_t delivered = 0;
+    LnkFileAsyncReader::Options readerOptions;
+    readerOptions.maxInFlight = 2;
+    EXPECT_THROW(LnkFileAsyncReader::readFiles(filePaths, readerOptions, [&delivered](LnkFileAsyncReader::Result&&){
+        delivered++;
+        throw std::runtime_error("Callback failed");
+    }), std::runtime_error);
+    EXPECT_EQ(delivered, 1);
+    EXPECT_TRUE(LnkFileAsyncReader::readFiles({}).empty());
+}
+
+/**
+ * Test that the LNK files in ZIP and TAR archives are found and give the same information as the extracted files, and that other members are skipped.
+ */
+TEST(LnkFileArchiveReaderTest, ReadArchive){
+    //The TAR archive is in the pax format, with the LNK files in a directory whose name is too long for a ustar header
+    std::string longDirectory = "Shortcuts/";
+    for(int i = 0; i < 6; i++){
+        longDirectory += "VeryLongDirectoryName";
+    }
+    for(const auto &[archive, directory]: {std::pair<std::string, std::string>(TEST_ARCHIVES_DIR "/LnkFiles.zip", "Shortcuts"), std::pair<std::string, std::string>(TEST_ARCHIVES_DIR "/LnkFiles.tar", longDirectory)}){
+        LnkFileArchiveReader::FileSource source(archive);
+        const std::vector<LnkFileArchiveReader::Result> results = LnkFileArchiveReader::readArchive(source);
+        ASSERT_EQ(results.size(), 10);
+        for(const LnkFileArchiveReader::Result &result: results){
+            const std::string fileName = result.filePath.substr(result.filePath.rfind('/') + 1);
+            if(fileName == "Invalid.LNK"){
+                EXPECT_EQ(result.filePath, "Shortcuts/Invalid.LNK");
+                EXPECT_EQ(result.error, LnkFileInfo::InvalidHeader);
+                EXPECT_FALSE(result.lnkFileInfo.has_value());
+                continue;
+            }
+            ASSERT_EQ(result.error, LnkFileInfo::Success) << result.filePath;
+            EXPECT_EQ(result.filePath, directory + "/" + fileName);
+            const LnkFileInfo expected(TEST_LNK_FILES_DIR "/" + fileName);
+            EXPECT_EQ(result.lnkFileInfo->filePath(), result.filePath);
+            EXPECT_EQ(result.lnkFileInfo->absoluteTargetPath(), expected.absoluteTargetPath());
+            EXPECT_EQ(result.lnkFileInfo->targetVolumeName(), expected.targetVolumeName());
+            EXPECT_EQ(result.lnkFileInfo->description(), expected.description());
+            EXPECT_EQ(result.lnkFileInfo->workingDirectory(), expected.workingDirectory());
+            EXPECT_EQ(result.lnkFileInfo->iconPath(), expected.iconPath());
+            EXPECT_EQ(result.lnkFileInfo->targetSize(), expected.targetSize());
+        }
+    }
+
+    //Corrupting a compressed member is detected by the CRC, and members that are too large are skipped
+    std::ifstream file(TEST_ARCHIVES_DIR "/LnkFiles.zip", std::ios::binary);
+    std::vector<uint8_t> bytes{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    bytes[30 + std::string("Shortcuts/BasicLnkFile.lnk").size() + 10] ^= 0x55;
+    LnkFileArchiveReader::MemorySource memorySource(bytes.data(), bytes.size());
+    std::vector<LnkFileArchiveReader::Result> results = LnkFileArchiveReader::readArchive(memorySource);
+    ASSERT_EQ(results.size(), 10);
+    EXPECT_EQ(results[0].filePath, "Shortcuts/BasicLnkFile.lnk");
+    EXPECT_EQ(results[0].error, LnkFileInfo::ReadFailed);
+    EXPECT_EQ(results[1].error, LnkFileInfo::Success);
+    LnkFileArchiveReader::Options options;
+    options.maxEntrySize = 100;
+    results = LnkFileArchiveReader::readArchive(memorySource, options);
+    EXPECT_EQ(std::count_if(results.begin(), results.end(), [](const LnkFileArchiveReader::Result &result){
+        return result.error == LnkFileInfo::ReadFailed;
+    }), 9);
+
+    //Files that aren't archives are rejected
+    LnkFileArchiveReader::FileSource lnkFile(TEST_LNK_FILES_DIR "/BasicLnkFile.lnk");
+    EXPECT_THROW(LnkFileArchiveReader::readArchive(lnkFile), LnkFileInfo::IoError);
+    options.format = LnkFileArchiveReader::Tar;
+    EXPECT_THROW(LnkFileArchiveReader::readArchive(memorySource, options), LnkFileInfo::IoError);
+    EXPECT_THROW(LnkFileArchiveReader::FileSource(TEST_ARCHIVES_DIR "/nonexistent.zip"), LnkFileInfo::IoError);
+}
+
+/**
+ * Test that LNK files embedded in raw bytes are found at the right offsets with the right sizes, and that false positives and truncated LNK files are handled.
+ */
+TEST(LnkFileCarverTest, Carve){
+    //Embed the test files in garbage, with some bytes between them that look like the start of an LNK header
+    const uint8_t signature[] = {0x4C, 0x00, 0x00, 0x00, 0x01, 0x14, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x46};
+    std::vector<uint8_t> image;
+    std::vector<std::pair<size_t, std::string>> expected;
+    uint32_t garbage = 12345;
+    for(const std::filesystem::directory_entry &entry: std::filesystem::directory_iterator(TEST_LNK_FILES_DIR)){
+        for(int i = 0; i < 1000 + static_cast<int>(expected.size()) * 7; i++){
+            garbage = garbage * 1103515245 + 12345;
+            image.push_back(static_cast<uint8_t>(garbage >> 16));
+        }
+        image.insert(image.end(), signature, signature + sizeof(signature));
+        image.insert(image.end(), 100, 0xFF);
+        std::ifstream file(entry.path(), std::ios::binary);
+        expected.emplace_back(image.size(), entry.path().string());
+        image.insert(image.end(), std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    const size_t lastSize = image.size() - expected.back().first;
+
+    std::vector<LnkFileCarver::Match> matches = LnkFileCarver::carve(image.data(), image.size());
+    ASSERT_EQ(matches.size(), expected.size());
+    for(size_t i = 0; i < matches.size(); i++){
+        const LnkFileInfo lnkFileInfo(expected[i].second);
+        EXPECT_EQ(matches[i].offset, expected[i].first);
+        EXPECT_EQ(matches[i].size, std::filesystem::file_size(expected[i].second));
+        EXPECT_TRUE(matches[i].complete);
+        EXPECT_EQ(matches[i].lnkFileInfo.absoluteTargetPath(), lnkFileInfo.absoluteTargetPath());
+        EXPECT_EQ(matches[i].lnkFileInfo.description(), lnkFileInfo.description());
+        EXPECT_EQ(matches[i].lnkFileInfo.iconPath(), lnkFileInfo.iconPath());
+        EXPECT_EQ(LnkFileCarver::findSignature(image.data(), image.size(), matches[i].offset), matches[i].offset);
+    }
+
+    //An LNK file whose extra data is cut off is still found, but isn't complete
+    image.resize(image.size() - 10);
+    matches = LnkFileCarver::carve(image.data(), image.size());
+    ASSERT_EQ(matches.size(), expected.size());
+    EXPECT_FALSE(matches.back().complete);
+    EXPECT_LT(matches.back().size, lastSize - 10);
+    EXPECT_EQ(matches.back().lnkFileInfo.absoluteTargetPath(), LnkFileInfo(expected.back().second).absoluteTargetPath());
+
+    //The bytes can also be read from a file
+    const std::filesystem::path imagePath = std::filesystem::temp_directory_path() / "LnkFileCarverTest.bin";
+    std::ofstream(imagePath, std::ios::binary).write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()));
+    EXPECT_EQ(LnkFileCarver::carveFile(imagePath.string()).size(), expected.size());
+    std::ofstream(imagePath, std::ios::binary | std::ios::trunc).close();
+    EXPECT_TRUE(LnkFileCarver::carveFile(imagePath.string()).empty());
+    std::filesystem::remove(imagePath);
+    EXPECT_THROW(LnkFileCarver::carveFile(imagePath.string()), LnkFileInfo::IoError);
+    EXPECT_EQ(LnkFileCarver::findSignature(image.data(), 10), 10);
+}
+
+/**
+ * Test that the targets of LNK files are reported as existing, missing, changed or on an unavailable volume, both when directories are listed and when each target is checked separately.
+ */
+TEST(LnkFileTargetCheckerTest, CheckTargets){
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "LnkFileTargetCheckerTest";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root / "Volume" / "Directory");
+    std::filesystem::create_directories(root / "Volume" / "Many");
+    const auto writeFile = [](const std::filesystem::path &path, size_t size){
+        std::ofstream(path, std::ios::binary) << std::string(size, 'x');
+    };
+    writeFile(root / "Volume" / "Single.txt", 10);
+    writeFile(root / "Volume" / "Directory" / "Unchanged.txt", 5);
+    writeFile(root / "Volume" / "Directory" / "Changed.txt", 3);
+    for(int i = 0; i < 20; i++){
+        writeFile(root / "Volume" / "Many" / ("File" + std::to_string(i) + ".txt"), 7);
+    }
+
+    const auto makeTarget = [](const std::string &targetPath, uint32_t size, uint32_t serial = 0x12345678, bool isDirectory = false){
+        std::vector<uint8_t> bytes = makeLnkFile(u"", targetPath);
+        for(int i = 0; i < 4; i++){
+            bytes[52 + i] = static_cast<uint8_t>(size >> (i * 8));
+            bytes[114 + i] = static_cast<uint8_t>(serial >> (i * 8));
+        }
+        bytes[24] = isDirectory ? 0x10 : 0x20;
+        return LnkFileInfo(bytes);
+    };
+    std::vector<LnkFileInfo> lnkFiles = {
+        makeTarget("C:\\Single.txt", 10),
+        makeTarget("C:\\Directory\\Unchanged.txt", 5),
+        makeTarget("C:\\Directory\\Changed.txt", 5),
+        makeTarget("C:\\Directory\\Missing.txt", 5),
+        makeTarget("C:\\Directory", 0, 0x12345678, true),
+        makeTarget("C:\\Missing\\First.txt", 5),
+        makeTarget("C:\\Missing\\Second.txt", 5),
+        makeTarget("C:\\Single.txt", 10, 0x87654321),
+        LnkFileInfo(TEST_LNK_FILES_DIR "/NetworkDriveLnkFile.lnk")
+    };
+    std::vector<LnkFileTargetChecker::Status> expected = {
+        LnkFileTargetChecker::Exists,
+        LnkFileTargetChecker::Exists,
+        LnkFileTargetChecker::SizeChanged,
+        LnkFileTargetChecker::Missing,
+        LnkFileTargetChecker::Exists,
+        LnkFileTargetChecker::Missing,
+        LnkFileTargetChecker::Missing,
+        LnkFileTargetChecker::VolumeUnavailable,
+        LnkFileTargetChecker::VolumeUnavailable
+    };
+    for(int i = 0; i < 22; i++){
+        lnkFiles.push_back(makeTarget("C:\\Many\\File" + std::to_string(i) + ".txt", 7));
+        expected.push_back(i < 20 ? LnkFileTargetChecker::Exists : LnkFileTargetChecker::Missing);
+    }
+    lnkFiles.push_back(makeTarget("C:\\Many\\FILE0.TXT", 7));
+    expected.push_back(std::filesystem::exists(root / "Volume" / "Many" / "FILE0.TXT") ? LnkFileTargetChecker::Exists : LnkFileTargetChecker::Missing);
+
+    LnkFileTargetChecker::Options options;
+    options.volumeMountPoints[0x12345678] = (root / "Volume").string() + "/";
+    for(const size_t listDirectoryThreshold: {0, 2, 16}){
+        for(const unsigned int threads: {1, 16}){
+            options.listDirectoryThreshold = listDirectoryThreshold;
+            options.threads = threads;
+            const std::vector<LnkFileTargetChecker::Result> results = LnkFileTargetChecker::checkTargets(lnkFiles, options);
+            ASSERT_EQ(results.size(), lnkFiles.size());
+            for(size_t i = 0; i < results.size(); i++){
+                EXPECT_EQ(results[i].status, expected[i]) << results[i].targetPath;
+            }
+            EXPECT_EQ(std::filesystem::path(results[1].targetPath), root / "Volume" / "Directory" / "Unchanged.txt");
+            EXPECT_EQ(results[1].size, 5);
+            EXPECT_EQ(results[2].size, 3);
+            EXPECT_EQ(results[3].size, 0);
+        }
+    }
+
+    //Network shares are looked up case insensitively, and sizes aren't compared if checkSize is false
+    options.networkShareMountPoints["\\\\WSL$\\UBUNTU"] = root.string();
+    options.checkSize = false;
+    std::filesystem::create_directories(root / "usr");
+    const std::vector<LnkFileTargetChecker::Result> results = LnkFileTargetChecker::checkTargets(lnkFiles, options);
+    EXPECT_EQ(results[2].status, LnkFileTargetChecker::Exists);
+    EXPECT_EQ(results[8].status, LnkFileTargetChecker::Exists);
+    EXPECT_EQ(std::filesystem::path(results[8].targetPath), root / "usr");
+    EXPECT_TRUE(LnkFileTargetChecker::checkTargets({}).empty());
+    std::filesystem::remove_all(root);
+}
+
+TEST(LnkFileWatcherTest, WatchDirectory){
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "LnkFileInfoWatcherTest";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root / "Subdirectory");
+    const auto writeFile = [](const std::filesystem::path& filePath, const std::vector<uint8_t>& bytes){
+        std::ofstream file(filePath, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    };
+    const auto path = [&root](const char* relativePath){
+        return (root / relativePath).lexically_normal().string();
+    };
+    writeFile(root / "Unchanged.lnk", makeLnkFile(u"Unchanged"));
+    writeFile(root / "Modified.lnk", makeLnkFile(u"Modified"));
+    writeFile(root / "Removed.lnk", makeLnkFile(u"Removed"));
+    writeFile(root / "Renamed.lnk", makeLnkFile(u"Renamed"));
+    writeFile(root / "Subdirectory" / "Nested.lnk", makeLnkFile(u"Nested"));
+    writeFile(root / "NotAnLnkFile.txt", makeLnkFile(u"Not an LNK file"));
+
+    LnkFileWatcher::Options options;
+    options.debounce = std::chrono::milliseconds(20);
+    LnkFileWatcher watcher({root.string()}, options);
+    EXPECT_EQ(watcher.lnkFiles().size(), 5);
+    EXPECT_EQ(watcher.lnkFiles().at(path("Subdirectory/Nested.lnk")).description(), "Nested");
+    EXPECT_TRUE(watcher.waitForChanges(std::chrono::milliseconds(50)).empty());
+    options.recursive = false;
+    EXPECT_EQ(LnkFileWatcher({root.string()}, options).lnkFiles().size(), 4);
+
+    const auto expectChanges = [&watcher](const std::vector<std::pair<std::string, LnkFileWatcher::ChangeType>>& expected){
+        const std::vector<LnkFileWatcher::Change> changes = watcher.waitForChanges(std::chrono::milliseconds(2000));
+        ASSERT_EQ(changes.size(), expected.size());
+        for(size_t i = 0; i < changes.size(); i++){
+            EXPECT_EQ(changes[i].filePath, expected[i].first);
+            EXPECT_EQ(changes[i].type, expected[i].second) << changes[i].filePath;
+            EXPECT_EQ(changes[i].error == LnkFileInfo::Success, changes[i].type != LnkFileWatcher::Failed) << changes[i].filePath;
+        }
+    };
+
+    //A burst of changes is reported as one change per file, and files whose contents didn't change aren't reported
+    writeFile(root / "Unchanged.lnk", makeLnkFile(u"Unchanged"));
+    writeFile(root / "Modified.lnk", makeLnkFile(u"Modified once"));
+    writeFile(root / "Modified.lnk", makeLnkFile(u"Modified twice"));
+    std::filesystem::remove(root / "Removed.lnk");
+    std::filesystem::rename(root / "Renamed.lnk", root / "Subdirectory" / "Renamed.lnk");
+    writeFile(root / "Added.lnk", makeLnkFile(u"Added"));
+    writeFile(root / "Invalid.lnk", {0x4C, 0x00, 0x00});
+    writeFile(root / "NotAnLnkFile.txt", makeLnkFile(u"Still not an LNK file"));
+    std::filesystem::create_directories(root / "New" / "Deep");
+    writeFile(root / "New" / "Deep" / "Deep.lnk", makeLnkFile(u"Deep"));
+    expectChanges({
+        {path("Added.lnk"), LnkFileWatcher::Added},
+        {path("Invalid.lnk"), LnkFileWatcher::Failed},
+        {path("Modified.lnk"), LnkFileWatcher::Modified},
+        {path("New/Deep/Deep.lnk"), LnkFileWatcher::Added},
+        {path("Removed.lnk"), LnkFileWatcher::Removed},
+        {path("Renamed.lnk"), LnkFileWatcher::Removed},
+        {path("Subdirectory/Renamed.lnk"), LnkFileWatcher::Added}
+    });
+    EXPECT_EQ(watcher.lnkFiles().at(path("Modified.lnk")).description(), "Modified twice");
+    EXPECT_EQ(watcher.lnkFiles().count(path("Invalid.lnk")), 0);
+
+    //Removing or renaming a directory removes the LNK files in it, and renamed directories are still watched
+    std::filesystem::remove_all(root / "Subdirectory");
+    std::filesystem::rename(root / "New", root / "Moved");
+    expectChanges({
+        {path("Moved/Deep/Deep.lnk"), LnkFileWatcher::Added},
+        {path("New/Deep/Deep.lnk"), LnkFileWatcher::Removed},
+        {path("Subdirectory/Nested.lnk"), LnkFileWatcher::Removed},
+        {path("Subdirectory/Renamed.lnk"), LnkFileWatcher::Removed}
+    });
+    writeFile(root / "Moved" / "Deep" / "Deep.lnk", makeLnkFile(u"Deeper"));
+    writeFile(root / "Invalid.lnk", makeLnkFile(u"Valid"));
+    expectChanges({
+        {path("Invalid.lnk"), LnkFileWatcher::Added},
+        {path("Moved/Deep/Deep.lnk"), LnkFileWatcher::Modified}
+    });
+
+    //Events that have already arrived are handled even without a timeout
+    writeFile(root / "Immediate.lnk", makeLnkFile(u"Immediate"));
+    const std::vector<LnkFileWatcher::Change> changes = watcher.waitForChanges(std::chrono::milliseconds(0));
+    ASSERT_EQ(changes.size(), 1);
+    EXPECT_EQ(changes[0].filePath, path("Immediate.lnk"));
+
+    EXPECT_TRUE(watcher.rescan().empty());
+    EXPECT_EQ(watcher.lnkFiles().size(), 6);
+    EXPECT_THROW(LnkFileWatcher({path("Nonexistent")}), LnkFileInfo::IoError);
+    std::filesystem::remove_all(root);
+}
+
+TEST(LnkFileRecordTest, Records){
+    const std::vector<std::string> fileNames = {"BasicLnkFile.lnk", "UsbLnkFile.lnk", "DirectoryLnkFile.lnk", "EmojiLnkFile.lnk", "NetworkDriveLnkFile.lnk", "BasicLnkFile.lnk"};
+    std::vector<LnkFileInfo> lnkFiles;
+    LnkFileRecordStrings strings;
+    LnkFileRecordStrings ownStrings(false);
+    std::vector<LnkFileRecord> records;
+    for(const std::string &fileName: fileNames){
+        lnkFiles.emplace_back(TEST_LNK_FILES_DIR "/" + fileName);
+        records.push_back(strings.add(lnkFiles.back()));
+        ownStrings.add(lnkFiles.back());
+    }
+    for(size_t i = 0; i < records.size(); i++){
+        const LnkFileRecord &record = records[i];
+        const LnkFileInfo &lnk = lnkFiles[i];
+        EXPECT_EQ(strings.view(record.filePath), lnk.filePath());
+        EXPECT_EQ(strings.view(record.absoluteTargetPath), lnk.absoluteTargetPath());
+        EXPECT_EQ(strings.view(record.targetVolumeName), lnk.targetVolumeName());
+        EXPECT_EQ(strings.view(record.description), lnk.description());
+        EXPECT_EQ(strings.view(record.workingDirectory), lnk.workingDirectory());
+        EXPECT_EQ(strings.view(record.iconPath), lnk.iconPath());
+        EXPECT_EQ(record.targetVolumeSerial, lnk.targetVolumeSerial());
+        EXPECT_EQ(record.targetVolumeType, lnk.targetVolumeType());
+        EXPECT_EQ(record.targetIsOnNetwork(), lnk.targetIsOnNetwork());
+        EXPECT_EQ(record.hasCustomIcon(), lnk.hasCustomIcon());
+        EXPECT_EQ(record.targetHasAttribute(LnkFileInfo::Directory), lnk.targetHasAttribute(LnkFileInfo::Directory));
+
+        const LnkFileInfo copy = strings.toLnkFileInfo(record);
+        EXPECT_EQ(copy, lnk);
+        EXPECT_EQ(copy.hash(), lnk.hash());
+        EXPECT_EQ(copy.absoluteTargetPath(), lnk.absoluteTargetPath());
+        EXPECT_EQ(copy.commandLineArgs(), lnk.commandLineArgs());
+        EXPECT_EQ(copy.targetSize(), lnk.targetSize());
+        EXPECT_EQ(copy.iconIndex(), lnk.iconIndex());
+    }
+
+    //Identical strings share their offsets, so the same LNK file twice takes no additional space
+    EXPECT_EQ(records[0].filePath.offset, records[5].filePath.offset);
+    EXPECT_EQ(records[0].absoluteTargetPath.offset, records[5].absoluteTargetPath.offset);
+    EXPECT_LT(strings.size(), ownStrings.size());
+
+    //Records can be copied with memcpy and sorted without touching the strings
+    std::vector<LnkFileRecord> copies(records.size());
+    std::memcpy(copies.data(), records.data(), records.size() * sizeof(LnkFileRecord));
+    std::sort(copies.begin(), copies.end(), [](const LnkFileRecord &a, const LnkFileRecord &b){
+        return a.targetVolumeSerial < b.targetVolumeSerial;
+    });
+    EXPECT_TRUE(std::is_sorted(copies.begin(), copies.end(), [](const LnkFileRecord &a, const LnkFileRecord &b){
+        return a.targetVolumeSerial < b.targetVolumeSerial;
+    }));
+    for(const LnkFileRecord &record: copies){
+        const auto original = std::find_if(records.begin(), records.end(), [&](const LnkFileRecord &other){
+            return std::memcmp(&record, &other, sizeof(LnkFileRecord)) == 0;
+        });
+        ASSERT_NE(original, records.end());
+        EXPECT_EQ(strings.toLnkFileInfo(record), lnkFiles[original - records.begin()]);
+    }
+
+    strings.clear();
+    EXPECT_EQ(strings.size(), 0);
+    const LnkFileRecord record = strings.add(lnkFiles[0]);
+    EXPECT_EQ(record.filePath.offset, 0);
+    EXPECT_EQ(strings.view(record.filePath), lnkFiles[0].filePath());
+}
+
+/**
+ * Test that the shards of a scan are disjoint and contain all LNK files, and that merging them removes duplicates and adds up the statistics.
+ */
+TEST(LnkFileShardTest, ShardAndMerge){
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "LnkFileShardTest";
+    std::filesystem::remove_all(root);
+    const std::string fileNames[] = {"BasicLnkFile.lnk", "UsbLnkFile.lnk", "DirectoryLnkFile.lnk", "NetworkDriveLnkFile.lnk"};
+    for(const char* directory: {"A", "B", "C", "D", "E", "F", "G", "H"}){
+        std::filesystem::create_directories(root / directory / "Subdirectory");
+        for(const std::string &fileName: fileNames){
+            std::filesystem::copy_file(TEST_LNK_FILES_DIR "/" + fileName, root / directory / fileName);
+            std::filesystem::copy_file(TEST_LNK_FILES_DIR "/" + fileName, root / directory / "Subdirectory" / fileName);
+        }
+    }
+    std::filesystem::copy_file(TEST_LNK_FILES_DIR "/BasicLnkFile.lnk", root / "Basic.lnk");
+    std::filesystem::copy_file(TEST_LNK_FILES_DIR "/../CMakeLists.txt", root / "Invalid.lnk");
+    const size_t fileCount = 8 * 2 * std::size(fileNames) + 2;
+    EXPECT_EQ(LnkFileScanner::scanDirectory(root.string()).size(), fileCount);
+    const std::filesystem::path otherRoot = std::filesystem::temp_directory_path() / "LnkFileShardTestOtherMount";
+    std::filesystem::remove_all(otherRoot);
+    std::filesystem::copy(root, otherRoot, std::filesystem::copy_options::recursive);
+
+    for(const LnkFileScanner::ShardBy shardBy: {LnkFileScanner::PathHash, LnkFileScanner::Subtree}){
+        LnkFileScanner::Options options;
+        options.shardCount = 3;
+        options.shardBy = shardBy;
+        options.parseOptions = LnkFileInfo::IdList | LnkFileInfo::ExtraData;
+        std::unordered_set<std::string> found;
+        std::vector<std::vector<uint8_t>> shards;
+        for(unsigned int shardIndex = 0; shardIndex < options.shardCount; shardIndex++){
+            options.shardIndex = shardIndex;
+            const std::vector<LnkFileScanner::Result> results = LnkFileScanner::scanDirectory(root.string(), options);
+            EXPECT_LT(results.size(), fileCount) << shardBy;
+            for(const LnkFileScanner::Result &result: results){
+                EXPECT_TRUE(found.insert(result.filePath).second) << result.filePath;
+            }
+            //Sharding is deterministic
+            EXPECT_EQ(LnkFileScanner::scanDirectory(root.string(), options).size(), results.size());
+            shards.push_back(LnkFileShardWriter::scanShard(root.string(), options));
+        }
+        EXPECT_EQ(found.size(), fileCount) << shardBy;
+
+        LnkFileShardMerger merger;
+        for(size_t i = 0; i < shards.size(); i++){
+            EXPECT_FALSE(merger.isComplete());
+            EXPECT_EQ(merger.add(shards[i]), LnkFileInfo::Success);
+        }
+        EXPECT_TRUE(merger.isComplete());
+        EXPECT_EQ(merger.recordCount(), fileCount - 1);
+        EXPECT_EQ(merger.duplicateCount(), 0);
+        ASSERT_EQ(merger.failures().size(), 1);
+        EXPECT_EQ(merger.failures()[0].error, LnkFileInfo::InvalidHeader);
+        EXPECT_EQ(merger.failures()[0].filePath, (root / "Invalid.lnk").string());
+        EXPECT_EQ(merger.stats().filesParsed, fileCount);
+        EXPECT_EQ(merger.stats().errors[LnkFileInfo::InvalidHeader], 1);
+
+        //The merged records contain every LNK file once with all its information, and can be merged again
+        const auto expectAllInformation = [&options](const LnkFileDecoder::Record &record){
+            const LnkFileInfo lnkFileInfo = record.toLnkFileInfo();
+            const LnkFileInfo expected(std::string(record.filePath), options.parseOptions);
+            EXPECT_EQ(lnkFileInfo, expected);
+            EXPECT_EQ(lnkFileInfo.absoluteTargetPath(), expected.absoluteTargetPath());
+            EXPECT_EQ(lnkFileInfo.workingDirectory(), expected.workingDirectory());
+            EXPECT_EQ(lnkFileInfo.targetCreationTime(), expected.targetCreationTime());
+            EXPECT_EQ(lnkFileInfo.targetAccessTime(), expected.targetAccessTime());
+            EXPECT_EQ(lnkFileInfo.targetWriteTime(), expected.targetWriteTime());
+            EXPECT_EQ(lnkFileInfo.showCommand(), expected.showCommand());
+            EXPECT_EQ(lnkFileInfo.hotkeyKey(), expected.hotkeyKey());
+            EXPECT_EQ(lnkFileInfo.hotkeyModifiers(), expected.hotkeyModifiers());
+            EXPECT_EQ(lnkFileInfo.idList(), expected.idList());
+            EXPECT_EQ(lnkFileInfo.environmentTargetPath(), expected.environmentTargetPath());
+            EXPECT_EQ(lnkFileInfo.trackerMachineId(), expected.trackerMachineId());
+            EXPECT_EQ(lnkFileInfo.trackerVolumeId(), expected.trackerVolumeId());
+            EXPECT_EQ(lnkFileInfo.trackerObjectId(), expected.trackerObjectId());
+            EXPECT_EQ(lnkFileInfo.trackerBirthVolumeId(), expected.trackerBirthVolumeId());
+            EXPECT_EQ(lnkFileInfo.trackerBirthObjectId(), expected.trackerBirthObjectId());
+            EXPECT_EQ(lnkFileInfo.knownFolderId(), expected.knownFolderId());
+        };
+        LnkFileDecoder decoder(merger.records());
+        std::unordered_set<std::string> absolutePaths;
+        size_t withIdList = 0;
+        for(LnkFileDecoder::Record record; decoder.next(record);){
+            EXPECT_TRUE(absolutePaths.emplace(record.absoluteFilePath).second);
+            expectAllInformation(record);
+            withIdList += !record.idList.empty();
+        }
+        EXPECT_EQ(decoder.error(), LnkFileInfo::Success);
+        EXPECT_EQ(absolutePaths.size(), fileCount - 1);
+        EXPECT_GT(withIdList, 0u);
+        EXPECT_EQ(merger.add(shards[0]), LnkFileInfo::Success);
+        EXPECT_GT(merger.duplicateCount(), 0);
+        EXPECT_EQ(merger.recordCount(), fileCount - 1);
+        EXPECT_EQ(merger.stats().filesParsed, fileCount);
+
+        //The same tree mounted at a different place contains the same LNK files
+        const size_t duplicateCount = merger.duplicateCount();
+        LnkFileScanner::Options otherOptions;
+        otherOptions.shardCount = 2;
+        otherOptions.shardBy = shardBy;
+        for(unsigned int shardIndex = 0; shardIndex < otherOptions.shardCount; shardIndex++){
+            otherOptions.shardIndex = shardIndex;
+            EXPECT_EQ(merger.add(LnkFileShardWriter::scanShard(otherRoot.string(), otherOptions)), LnkFileInfo::Success);
+        }
+        EXPECT_EQ(merger.recordCount(), fileCount - 1);
+        EXPECT_EQ(merger.duplicateCount(), duplicateCount + fileCount - 1);
+        EXPECT_EQ(merger.failures().size(), 1);
+        EXPECT_EQ(merger.stats().filesParsed, 2 * fileCount);
+        LnkFileShardMerger merged;
+        EXPECT_EQ(merged.add(merger.bytes()), LnkFileInfo::Success);
+        EXPECT_TRUE(merged.isComplete());
+        EXPECT_EQ(merged.recordCount(), fileCount - 1);
+        EXPECT_EQ(merged.failures().size(), 1);
+        EXPECT_EQ(merged.stats().filesParsed, merger.stats().filesParsed);
+        LnkFileDecoder mergedDecoder(merged.records());
+        for(LnkFileDecoder::Record record; mergedDecoder.next(record);){
+            expectAllInformation(record);
+        }
+        EXPECT_EQ(mergedDecoder.error(), LnkFileInfo::Success);
+    }
+
+    //Invalid shards aren't added at all
+    LnkFileShardWriter writer(1, 2);
+    writer.add(LnkFileScanner::Result{(root / "Basic.lnk").string(), LnkFileInfo(TEST_LNK_FILES_DIR "/BasicLnkFile.lnk"), LnkFileInfo::Success});
+    writer.addFailure("Missing.lnk", LnkFileInfo::OpenFailed);
+    EXPECT_EQ(writer.recordCount(), 1);
+    EXPECT_EQ(writer.failureCount(), 1);
+    std::vector<uint8_t> bytes = writer.bytes();
+    LnkFileShardMerger merger;
+    EXPECT_EQ(merger.add(bytes.data(), bytes.size() - 1), LnkFileInfo::IndexOutOfRange);
+    EXPECT_EQ(merger.add(bytes.data(), 10), LnkFileInfo::IndexOutOfRange);
+    EXPECT_EQ(merger.add(LnkFileEncoder().bytes()), LnkFileInfo::InvalidHeader);
+    bytes[4]++;
+    EXPECT_EQ(merger.add(bytes), LnkFileInfo::InvalidHeader);
+    EXPECT_EQ(merger.recordCount(), 0);
+    EXPECT_TRUE(merger.failures().empty());
+    bytes[4]--;
+    EXPECT_EQ(merger.add(bytes), LnkFileInfo::Success);
+    EXPECT_FALSE(merger.isComplete());
+    EXPECT_EQ(merger.recordCount(), 1);
+    EXPECT_EQ(merger.failures().size(), 1);
+
+    //A huge shard count doesn't make the merger allocate anything for the shards that haven't been added
+    LnkFileShardMerger hugeMerger;
+    for(const unsigned int shardIndex: {0u, 0xFFFFFFFEu, 0u}){
+        EXPECT_EQ(hugeMerger.add(LnkFileShardWriter(shardIndex, 0xFFFFFFFF).bytes()), LnkFileInfo::Success);
+    }
+    EXPECT_FALSE(hugeMerger.isComplete());
+    EXPECT_EQ(hugeMerger.add(LnkFileShardWriter(0, 1).bytes()), LnkFileInfo::Success);
+    EXPECT_TRUE(hugeMerger.isComplete());
+
+    //Failures are dropped once the same LNK file is parsed successfully in another shard, even if the directory is mounted elsewhere
+    const std::vector<uint8_t> lnkFile = readTestFile("BasicLnkFile.lnk");
+    LnkParser parser;
+    LnkFileShardWriter failedShard(0, 2, true, "/mnt/share");
+    failedShard.addFailure("/mnt/share/Directory/Retried.lnk", LnkFileInfo::OpenFailed);
+    failedShard.addFailure("/mnt/share/Directory/Failed.lnk", LnkFileInfo::InvalidHeader);
+    LnkFileShardWriter retriedShard(1, 2, true, "\\\\Server\\Share");
+    retriedShard.add(LnkFileScanner::Result{"", parser.parse(lnkFile.data(), lnkFile.size(), "\\\\Server\\Share\\Directory\\Retried.lnk"), LnkFileInfo::Success});
+    for(const bool failedFirst: {true, false}){
+        LnkFileShardMerger retriedMerger;
+        EXPECT_EQ(retriedMerger.add(failedFirst ? failedShard.bytes() : retriedShard.bytes()), LnkFileInfo::Success);
+        EXPECT_EQ(retriedMerger.add(failedFirst ? retriedShard.bytes() : failedShard.bytes()), LnkFileInfo::Success);
+        EXPECT_TRUE(retriedMerger.isComplete());
+        EXPECT_EQ(retriedMerger.recordCount(), 1);
+        ASSERT_EQ(retriedMerger.failures().size(), 1);
+        EXPECT_EQ(retriedMerger.failures()[0].filePath, "/mnt/share/Directory/Failed.lnk");
+        LnkFileShardMerger remerged;
+        EXPECT_EQ(remerged.add(retriedMerger.bytes()), LnkFileInfo::Success);
+        EXPECT_EQ(remerged.add(failedShard.bytes()), LnkFileInfo::Success);
+        EXPECT_EQ(remerged.failures().size(), 1);
+    }
+
+    LnkFileScanner::Options options;
+    options.shardCount = 2;
+    options.shardIndex = 2;
+    EXPECT_THROW(LnkFileScanner::scanDirectory(root.string(), options), std::invalid_argument);
+    std::filesystem::remove_all(root);
+    std::filesystem::remove_all(otherRoot);
+}